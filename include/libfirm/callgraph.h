@@ -79,9 +79,24 @@ FIRM_API int has_irg_callee_backedge(const ir_graph *irg);
 /** Returns the maximal loop depth of call nodes that call along this edge. */
 FIRM_API size_t get_irg_callee_loop_depth(const ir_graph *irg, size_t pos);
 
-/** Returns the method execution frequency of a graph. */
+/**
+ * Returns the method execution frequency of a graph.
+ * @see compute_method_execution_frequencies()
+ */
 FIRM_API double get_irg_method_execution_frequency(const ir_graph *irg);
 
+/**
+ * Computes the method execution frequency of all graphs.
+ *
+ * Graphs without callers are assumed to be executed once, all other graphs
+ * get the sum of the execution frequencies of their call sites. Recursive
+ * calls do not contribute to the frequency of the callee.
+ *
+ * Expects a consistent callgraph and block execution frequencies, see
+ * compute_callgraph() and ir_estimate_execfreq().
+ */
+FIRM_API void compute_method_execution_frequencies(void);
+
 /**
  * Construct the callgraph. Expects callee information, i.e.,
  * irg_callee_info_consistent must be set.  This can be computed with
@@ -283,6 +283,26 @@ FIRM_API void opt_osr(ir_graph *irg, unsigned flags);
  */
 FIRM_API void remove_phi_cycles(ir_graph *irg);
 
+/**
+ * Inserts software prefetches for memory streams in loops.
+ *
+ * Loads whose address is an affine function of an induction variable of
+ * their innermost loop get a prefetch builtin for the address @p distance
+ * iterations ahead, if the address changes by at least @p min_stride bytes
+ * per iteration or the loop touches at least @p min_footprint bytes (based
+ * on the estimated execution frequencies). Backends without prefetch
+ * instructions simply drop the builtins.
+ *
+ * @param irg            the graph which should be optimized
+ * @param distance       number of iterations to prefetch ahead
+ * @param min_stride     minimum stride in bytes
+ * @param min_footprint  minimum number of bytes accessed by the loop
+ *
+ * This algorithm destroys the link field of nodes.
+ */
+FIRM_API void opt_prefetch(ir_graph *irg, unsigned distance,
+                           unsigned min_stride, unsigned min_footprint);
+
 /** A default threshold. */
 #define DEFAULT_CLONE_THRESHOLD 20
 
@@ -368,6 +388,46 @@ FIRM_API void normalize_n_returns(ir_graph *irg);
  */
 FIRM_API void scalar_replacement_opt(ir_graph *irg);
 
+/**
+ * Callback used by escape_analysis() to recognize heap allocations.
+ *
+ * @param call  a Call node
+ * @return the node computing the number of bytes allocated by @p call or NULL
+ *         if @p call is no heap allocation
+ */
+typedef ir_node *(*get_alloc_size_func)(const ir_node *call);
+
+/**
+ * Callback used by escape_analysis() to recognize calls releasing heap
+ * memory.
+ *
+ * @param call  a Call node
+ * @return non-zero if @p call frees the memory its first argument points to
+ */
+typedef int (*is_free_call_func)(const ir_node *call);
+
+/**
+ * Performs escape analysis of heap allocations and promotes allocations which
+ * do not escape the function to the stack frame.
+ *
+ * Addresses are followed through Member, Sel, pointer arithmetic, Phi and Mux
+ * nodes. An address escapes if it is returned, stored, converted or passed to
+ * a call whose possible callees (see cgana()) let the corresponding parameter
+ * escape. Promoted allocations become frame entities, the calls freeing them
+ * are removed. Run scalar_replacement_opt() afterwards to turn the promoted
+ * objects into SSA values.
+ *
+ * @param irg       the graph which should be optimized
+ * @param max_size  maximum size in bytes of an allocation promoted to the stack
+ * @param get_size  recognizes allocations, if NULL calls of functions with
+ *                  mtp_property_malloc and a single size argument are used
+ * @param is_free   recognizes calls freeing memory, if NULL such calls let
+ *                  the memory escape
+ */
+FIRM_API void escape_analysis(ir_graph *irg, unsigned max_size,
+                              get_alloc_size_func get_size,
+                              is_free_call_func is_free);
+
 /**
  * Optimizes tail-recursion calls by converting them into loops.
  * Depends on the flag opt_tail_recursion.
@@ -412,6 +472,32 @@ typedef void (*opt_ptr)(ir_graph *irg);
 FIRM_API void inline_functions(unsigned maxsize, int inline_threshold,
                                opt_ptr after_inline_opt);
 
+/**
+ * Profile-driven inliner. Visits the call graph bottom-up and weighs every
+ * call site with its execution count. Calls are inlined in order of
+ * decreasing execution count per node of code growth until the code growth
+ * budget is used up.
+ *
+ * If a call is too expensive to inline and @p partial is set, only the entry
+ * path and a hot early exit of the callee are inlined; the remaining paths
+ * call the original function.
+ *
+ * @param profile_filename  profile written by an instrumented program or NULL
+ *                          to use estimated execution frequencies. The graphs
+ *                          must have the same blocks as when instrumented.
+ * @param maxsize           Do not inline into a method if it would have more
+ *                          than maxsize firm nodes afterwards.
+ * @param growth_budget     allowed growth of the program in percent of the
+ *                          total number of nodes
+ * @param partial           enable partial inlining
+ * @param after_inline_opt  optimizations performed immediately after inlining
+ *                          some calls
+ */
+FIRM_API void inline_functions_profiled(const char *profile_filename,
+                                        unsigned maxsize,
+                                        unsigned growth_budget, int partial,
+                                        opt_ptr after_inline_opt);
+
 /**
  * Combines congruent blocks into one.
  *
@@ -438,6 +524,16 @@ FIRM_API void do_loop_unrolling(ir_graph *irg);
  */
 FIRM_API void do_loop_peeling(ir_graph *irg);
 
+/**
+ * Perform loop unswitching on a given graph.
+ * Loop unswitching moves a condition that does not change inside a loop in
+ * front of the loop by duplicating the loop for both outcomes of the
+ * condition. Loops are only duplicated if their size, reduced by their nest
+ * depth and increased by their estimated execution frequency, is small
+ * enough.
+ */
+FIRM_API void do_loop_unswitching(ir_graph *irg);
+
 /**
  * Removes all entities which are unused.
  *
@@ -10,6 +10,8 @@
 #ifndef FIRM_JIT_H
 #define FIRM_JIT_H
 
+#include <stddef.h>
+
 #include "firm_types.h"
 
 #include "begin.h"
@@ -58,10 +60,52 @@ FIRM_API void const *be_jit_get_entity_addr(ir_entity const *entity);
 
 /**
  * Compile graph \p irg to a sequence of machine instructions and relocations.
+ * This is the same as be_jit_compile_tier() with ir_jit_tier_optimized.
  */
 FIRM_API ir_jit_function_t *be_jit_compile(ir_jit_segment_t *segment,
                                            ir_graph *irg);
 
+/**
+ * Backend pipelines to choose from when compiling a function just in time.
+ */
+typedef enum ir_jit_tier_t {
+	/**
+	 * Compile as fast as possible: No execution frequency estimation, trivial
+	 * scheduling, naive spilling, single pass register allocation without
+	 * copy minimization or spill slot coalescing and no peephole
+	 * optimization.
+	 * The graph is left unchanged, so it can be compiled again with
+	 * ir_jit_tier_optimized later, and the function starts with a patchable
+	 * entry for be_jit_patch_entry().
+	 */
+	ir_jit_tier_fast,
+	/**
+	 * Run the complete backend pipeline. This consumes the graph.
+	 */
+	ir_jit_tier_optimized,
+} ir_jit_tier_t;
+
+/**
+ * Compile graph \p irg with the backend pipeline \p tier.
+ * Functions compiled in the fast tier must be emitted to 8 byte aligned
+ * addresses.
+ */
+FIRM_API ir_jit_function_t *be_jit_compile_tier(ir_jit_segment_t *segment,
+                                                ir_graph *irg,
+                                                ir_jit_tier_t tier);
+
+/**
+ * Redirect all calls of a function emitted to \p entry to \p target.
+ * \p entry must hold a function compiled with ir_jit_tier_fast and has to be
+ * writable. The entry is replaced by a jump with a single atomic store, so
+ * this is safe while other threads execute the function: They either run the
+ * old code or jump to \p target.
+ *
+ * This allows to upgrade a hot function in place: Compile its graph again
+ * with ir_jit_tier_optimized, emit the result and patch the old entry.
+ */
+FIRM_API void be_jit_patch_entry(char *entry, void const *target);
+
 /**
  * Return the buffer size necessary to emit \p function with be_emit_function().
  */
@@ -72,6 +116,74 @@ FIRM_API unsigned be_get_function_size(ir_jit_function_t const *function);
  */
 FIRM_API void be_emit_function(char *buffer, ir_jit_function_t *function);
 
+/**
+ * Executable memory for jit compiled functions. Functions are installed into
+ * pooled pages and can be freed individually, independent of the segment
+ * they were compiled in.
+ *
+ * Memory is never writable and executable at the same time: Where the
+ * operating system allows it, code is written through a separate writable
+ * mapping of the executable pages. Otherwise the pages are made writable
+ * while code is written to them and made executable again by
+ * be_jit_commit_memory(). In this case other functions sharing pages with
+ * newly installed code must not run until the next commit.
+ */
+typedef struct ir_jit_memory_t ir_jit_memory_t;
+
+/**
+ * Create new executable memory for jit compiled functions.
+ */
+FIRM_API ir_jit_memory_t *be_new_jit_memory(void);
+
+/**
+ * Destroy \p memory with all functions installed in it.
+ */
+FIRM_API void be_destroy_jit_memory(ir_jit_memory_t *memory);
+
+/**
+ * Emit \p function into \p memory and resolve symbols and relocations.
+ * Returns the address of the function, which is 8 byte aligned. The function
+ * must not be called before the next be_jit_commit_memory(). \p function is
+ * not needed anymore afterwards, so the segment it was compiled in may be
+ * destroyed.
+ */
+FIRM_API void *be_jit_install_function(ir_jit_memory_t *memory,
+                                       ir_jit_function_t *function);
+
+/**
+ * Make all functions installed or patched in \p memory since the last commit
+ * executable. Installing several functions before committing them saves
+ * permission changes and instruction cache flushes.
+ */
+FIRM_API void be_jit_commit_memory(ir_jit_memory_t *memory);
+
+/**
+ * Free the function installed at \p code. Its memory is reused by later
+ * functions of a similar size, so no thread may execute the function anymore
+ * and no entry may be patched to jump to it.
+ */
+FIRM_API void be_jit_free_function(ir_jit_memory_t *memory, void *code);
+
+/**
+ * Like be_jit_patch_entry() for a fast tier function installed at \p entry.
+ * The patch takes effect immediately, no commit is necessary.
+ *
+ * If \p memory has no separate writable mapping (see ir_jit_memory_t), the
+ * page containing \p entry is replaced by a patched copy, so it stays
+ * executable and is never writable. Where the operating system cannot replace
+ * pages, this is not supported.
+ */
+FIRM_API void be_jit_patch_installed_entry(ir_jit_memory_t *memory,
+                                           void *entry, void const *target);
+
+/**
+ * Reorder the \p n_irgs graphs in \p irgs so that functions calling each other
+ * frequently are next to each other. Compiling the graphs and laying out the
+ * resulting functions in a segment in this order improves instruction cache
+ * locality.
+ */
+FIRM_API void be_jit_order_graphs(ir_graph **irgs, size_t n_irgs);
+
 /** @} */
 
 #include "end.h"
@@ -20,6 +20,7 @@
 #include "irnode_t.h"
 
 #include "cgana.h"
+#include "execfreq.h"
 
 #include "array.h"
 #include "pmap.h"
@@ -324,6 +325,64 @@ void callgraph_walk(callgraph_walk_func *pre, callgraph_walk_func *post, void *e
 	}
 }
 
+double get_irg_method_execution_frequency(const ir_graph *irg)
+{
+	return irg->method_execfreq;
+}
+
+typedef struct method_execfreq_env_t {
+	ir_graph **order; /**< graphs in callgraph postorder */
+	size_t     n;
+} method_execfreq_env_t;
+
+static void collect_postorder(ir_graph *irg, void *data)
+{
+	method_execfreq_env_t *env = (method_execfreq_env_t*)data;
+	env->order[env->n++] = irg;
+}
+
+void compute_method_execution_frequencies(void)
+{
+	assert(get_irp_callgraph_state() != irp_callgraph_none);
+
+	size_t                n_irgs = get_irp_n_irgs();
+	method_execfreq_env_t env    = {
+		.order = XMALLOCN(ir_graph*, n_irgs),
+		.n     = 0,
+	};
+	callgraph_walk(NULL, collect_postorder, &env);
+	assert(env.n == n_irgs);
+
+	/* Reverse postorder visits callers before their callees, except for
+	 * recursions which we ignore. */
+	size_t *const rpo_num = XMALLOCN(size_t, get_irp_last_idx());
+	for (size_t i = n_irgs; i-- > 0;) {
+		ir_graph *irg = env.order[i];
+		rpo_num[get_irg_idx(irg)] = n_irgs - i;
+		irg->method_execfreq = get_irg_n_callers(irg) == 0 ? 1.0 : 0.0;
+	}
+
+	for (size_t i = n_irgs; i-- > 0;) {
+		ir_graph *const irg    = env.order[i];
+		size_t    const number = rpo_num[get_irg_idx(irg)];
+		for (size_t c = 0, n_callees = get_irg_n_callees(irg); c < n_callees;
+		     ++c) {
+			cg_callee_entry *const entry  = irg->callees[c];
+			ir_graph        *const callee = entry->irg;
+			if (rpo_num[get_irg_idx(callee)] <= number)
+				continue;
+
+			double freq = 0.0;
+			for (size_t k = 0, n = ARR_LEN(entry->call_list); k < n; ++k)
+				freq += get_block_execfreq(get_nodes_block(entry->call_list[k]));
+			callee->method_execfreq += irg->method_execfreq * freq;
+		}
+	}
+
+	free(rpo_num);
+	free(env.order);
+}
+
 static ir_graph *outermost_ir_graph;   /**< The outermost graph the scc is computed
                                             for */
 static ir_loop *current_loop;      /**< Current cfloop construction is working
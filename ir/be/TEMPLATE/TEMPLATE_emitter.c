@@ -108,13 +108,13 @@ void TEMPLATE_emitf(const ir_node *node, const char *format, ...)
 
 		case 'u': {
 			unsigned num = va_arg(ap, unsigned);
-			be_emit_irprintf("%u", num);
+			be_emit_uint(num);
 			break;
 		}
 
 		case 'd': {
 			int num = va_arg(ap, int);
-			be_emit_irprintf("%d", num);
+			be_emit_int(num);
 			break;
 		}
 
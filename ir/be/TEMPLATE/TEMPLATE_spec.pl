@@ -13,8 +13,8 @@ $mode_fp = "mode_F";  # mode used by floatingpoint registers
 # <op-name> => {
 #   state     => "floats|pinned|mem_pinned|exc_pinned", # optional, default floats
 #   comment   => "any comment for constructor",  # optional
-#   in_reqs   => [ "reg_class|register" ] | "...",
-#   out_reqs  => [ "reg_class|register|in_rX" ] | "...",
+#   in_reqs   => [ "reg_class|register|reg_class/subreg" ] | "...",
+#   out_reqs  => [ "reg_class|register|reg_class/subreg|in_rX" ] | "...",
 #   ins       => { "in1", "in2" },  # optional, creates n_op_in1, ... consts
 #   outs      => { "out1", "out2" },# optional, creates pn_op_out1, ... consts
 #   mode      => "first" | "<mode>" # optional, determines the mode, auto-detected by default
@@ -28,6 +28,11 @@ $mode_fp = "mode_F";  # mode used by floatingpoint registers
 # ... # (all nodes you need to describe)
 #
 # );
+#
+# A register may name its aliasing sub-registers, e.g.
+#   { name => "r0", subregs => { 8 => "r0b", "8h" => "r0h", 16 => "r0w" } },
+# The requirement "gp/8" then allows all registers of class gp which have an
+# 8 bit sub-register.
 
 %reg_classes = (
 	gp => [
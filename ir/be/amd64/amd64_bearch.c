@@ -23,6 +23,7 @@
 #include "bestack.h"
 #include "beutil.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "gen_amd64_regalloc_if.h"
 #include "irarch_t.h"
 #include "ircons.h"
@@ -32,6 +33,7 @@
 #include "irgwalk.h"
 #include "iropt_t.h"
 #include "irtools.h"
+#include "lc_opts_enum.h"
 #include "lower_alloc.h"
 #include "lower_builtins.h"
 #include "lower_calls.h"
@@ -39,12 +41,18 @@
 #include "lowering.h"
 #include "panic.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
 pmap *amd64_constants;
 
 ir_mode *amd64_mode_xmm;
 
+amd64_codegen_config_t amd64_cg_config;
+
 static ir_node *create_push(ir_node *node, ir_node *schedpoint, ir_node *sp,
                             ir_node *mem, ir_entity *ent, x86_insn_size_t size)
 {
@@ -367,11 +375,34 @@ static void amd64_handle_intrinsics(ir_graph *irg)
 	}
 }
 
+/**
+ * Spills are created with the full register width. Once all reloads of a
+ * spill slot are known, narrow the spill to the slot size: A slot of 4 or 8
+ * bytes only gets reloaded by 32/64bit operations.
+ */
+static void narrow_spill(ir_node *const node, unsigned const size)
+{
+	x86_insn_size_t const insn_size = size == 4 ? X86_SIZE_32
+	                                : size == 8 ? X86_SIZE_64
+	                                : X86_SIZE_128;
+	amd64_attr_t *const attr = get_amd64_attr(node);
+	if (is_amd64_mov_store(node)) {
+		if (insn_size < attr->size)
+			attr->size = insn_size;
+	} else if (is_amd64_movdqu_store(node)) {
+		if (insn_size < X86_SIZE_128) {
+			set_irn_op(node, op_amd64_movs_store_xmm);
+			attr->size = insn_size;
+		}
+	}
+}
+
 static void amd64_set_frame_entity(ir_node *node, ir_entity *entity,
                                    unsigned size, unsigned po2align)
 {
-	(void)size;
 	(void)po2align;
+	if (arch_get_irn_flags(node) & arch_irn_flag_spill)
+		narrow_spill(node, size);
 	amd64_addr_attr_t *attr = get_amd64_addr_attr(node);
 	attr->addr.immediate.entity = entity;
 }
@@ -505,6 +536,42 @@ static void introduce_prologue(ir_graph *const irg, bool omit_fp)
 	}
 }
 
+/** Size of the area below the stack pointer that is safe from signal
+ * handlers and interrupts in the System V ABI. */
+#define AMD64_RED_ZONE_SIZE 128
+
+static void check_stack_usage(ir_node *const block, void *const data)
+{
+	bool *const leaf = (bool*)data;
+	sched_foreach(block, node) {
+		if (be_is_IncSP(node) || be_is_MemPerm(node) || is_amd64_call(node)
+		 || is_amd64_sub_sp(node) || is_amd64_push_am(node)
+		 || is_amd64_push_reg(node) || is_amd64_push_rax(node)
+		 || is_amd64_pop_am(node) || is_amd64_pop_reg(node)) {
+			*leaf = false;
+			return;
+		}
+	}
+}
+
+/**
+ * Check whether the frame can be placed in the red zone below the stack
+ * pointer, so no stack pointer adjustment is necessary. This is the case for
+ * functions which neither call other functions nor otherwise move the stack
+ * pointer (MemPerms are implemented with push/pop).
+ */
+static bool can_use_red_zone(ir_graph *const irg)
+{
+	if (amd64_no_red_zone || amd64_use_x64_abi)
+		return false;
+	if (get_type_size(get_irg_frame_type(irg)) > AMD64_RED_ZONE_SIZE)
+		return false;
+
+	bool leaf = true;
+	irg_block_walk_graph(irg, check_stack_usage, NULL, &leaf);
+	return leaf;
+}
+
 static void introduce_prologue_epilogue(ir_graph *irg, bool omit_fp)
 {
 	/* introduce epilogue for every return node */
@@ -565,9 +632,11 @@ static void amd64_sp_sim(ir_node *const node, stack_pointer_state_t *state)
 	if (is_amd64_push_am(node)) {
 		const amd64_addr_attr_t *attr = get_amd64_addr_attr_const(node);
 		state->offset       += x86_bytes_from_size(attr->base.size);
-	} else if (is_amd64_push_reg(node)) {
+	} else if (is_amd64_push_reg(node) || is_amd64_push_rax(node)) {
 		/* 64-bit register size */
 		state->offset       += AMD64_REGISTER_SIZE;
+	} else if (is_amd64_pop_reg(node)) {
+		state->offset       -= AMD64_REGISTER_SIZE;
 	} else if (is_amd64_leave(node)) {
 		state->offset        = 0;
 		state->align_padding = 0;
@@ -615,9 +684,14 @@ static void amd64_finish_and_emit(ir_graph *irg)
 	int      const begin    = omit_fp ? 0 : -AMD64_REGISTER_SIZE;
 	be_layout_frame_type(frame, begin, misalign);
 
+	/* Without frame pointer the prologue and epilogue only adjust the stack
+	 * pointer, which is unnecessary if the frame fits into the red zone. */
+	bool const red_zone = omit_fp && can_use_red_zone(irg);
+
 	irg_block_walk_graph(irg, NULL, amd64_after_ra_walker, NULL);
 
-	introduce_prologue_epilogue(irg, omit_fp);
+	if (!red_zone)
+		introduce_prologue_epilogue(irg, omit_fp);
 
 	/* fix stack entity offsets */
 	be_fix_stack_nodes(irg, &amd64_registers[REG_RSP]);
@@ -643,11 +717,133 @@ static void amd64_finish(void)
 	amd64_free_opcodes();
 }
 
+/**
+ * Check if irn can load its operand at position i from memory (source
+ * address mode). Supported are register/register ALU, compare and scalar SSE
+ * operations; packed SSE operations would need an aligned spill slot.
+ * @param irn    The irn to be checked
+ * @param i      The operands position
+ * @return whether operand can be loaded
+ */
+static bool amd64_possible_memory_operand(const ir_node *irn, unsigned i)
+{
+	if (!is_amd64_irn(irn)
+	 || get_amd64_attr_const(irn)->op_mode != AMD64_OP_REG_REG)
+		return false;
+
+	switch ((amd64_opcodes)get_amd64_irn_opcode(irn)) {
+	case iro_amd64_add:
+	case iro_amd64_and:
+	case iro_amd64_cmp:
+	case iro_amd64_imul:
+	case iro_amd64_or:
+	case iro_amd64_sub:
+	case iro_amd64_xor: {
+		/* like the address mode matcher, ignore 8/16bit operations */
+		x86_insn_size_t const size = get_amd64_attr_const(irn)->size;
+		if (size == X86_SIZE_8 || size == X86_SIZE_16)
+			return false;
+		break;
+	}
+	case iro_amd64_adds:
+	case iro_amd64_divs:
+	case iro_amd64_muls:
+	case iro_amd64_subs:
+	case iro_amd64_ucomis:
+		break;
+	default:
+		return false;
+	}
+
+	switch (i) {
+	case 0:
+		/* input 0 is also the result register, so only commutative
+		 * operations can exchange it with the memory operand */
+		if (!(arch_get_irn_flags(irn) & amd64_arch_irn_flag_commutative_binop))
+			return false;
+		break;
+	case 1:
+		break;
+	default:
+		return false;
+	}
+
+	/* like ia32, the operation must not read more bytes than the reload:
+	 * a 32bit reload only guarantees the lower 4 bytes of the spill slot.
+	 * A narrower operation just reads the low part of the slot. */
+	ir_node const *const load = get_Proj_pred(get_irn_n(irn, i));
+	return get_amd64_attr_const(irn)->size
+	    <= get_amd64_attr_const(load)->size;
+}
+
+static void amd64_perform_memory_operand(ir_node *irn, unsigned i)
+{
+	if (!amd64_possible_memory_operand(irn, i))
+		return;
+
+	ir_node                 *const op    = get_irn_n(irn, i);
+	ir_node                 *const load  = get_Proj_pred(op);
+	amd64_addr_attr_t const *const lattr = get_amd64_addr_attr_const(load);
+	ir_node                 *const spill = get_irn_n(load, lattr->addr.mem_input);
+	ir_node                 *const other = get_irn_n(irn, 1 - i);
+	ir_graph                *const irg   = get_irn_irg(irn);
+	bool                     const xmm
+		= arch_get_irn_register_req_in(irn, 0)->cls
+		  == &amd64_reg_classes[CLASS_amd64_xmm];
+
+	DBG((dbg, LEVEL_2, "folding %+F into %+F\n", load, irn));
+
+	/* the operand remaining in a register becomes input 0 */
+	ir_node *const in[] = { other, get_irg_frame(irg), spill };
+	set_irn_in(irn, ARRAY_SIZE(in), in);
+	arch_set_irn_register_reqs_in(irn, xmm ? xmm_reg_mem_reqs : gp_am_reqs[2]);
+
+	amd64_binop_addr_attr_t *const attr = get_amd64_binop_addr_attr(irn);
+	attr->base.base.op_mode = AMD64_OP_REG_ADDR;
+	attr->base.addr         = (x86_addr_t) {
+		.immediate = {
+			.kind = X86_IMM_FRAMEENT,
+		},
+		.variant    = X86_ADDR_BASE,
+		.base_input = 1,
+		.mem_input  = 2,
+	};
+	attr->u.reg_input = 0;
+
+	/* kill the reload */
+	assert(get_irn_n_edges(op) == 0);
+	assert(get_irn_n_edges(load) == 1);
+	sched_remove(load);
+	kill_node(op);
+	kill_node(load);
+}
+
+static unsigned amd64_get_op_estimated_cost(const ir_node *node);
+
+/**
+ * Immediates and address computations are recomputed instead of reloaded,
+ * this is always cheaper than the load from the spill slot. Constants from
+ * the constant pool are loaded as fast as a spilled value, but they need no
+ * spill, so they are rated slightly below the reload cost.
+ */
+static unsigned amd64_get_remat_cost(const ir_node *node)
+{
+	if (is_amd64_mov_imm(node) || is_amd64_lea(node) || is_amd64_xor_0(node)
+	    || is_amd64_xorp_0(node))
+		return 1;
+	if (is_amd64_irn(node) && amd64_loads(node) && !get_irn_pinned(node))
+		return 4;
+	return amd64_get_op_estimated_cost(node);
+}
+
 static const regalloc_if_t amd64_regalloc_if = {
-	.spill_cost  = 7,
-	.reload_cost = 5,
-	.new_spill   = amd64_new_spill,
-	.new_reload  = amd64_new_reload,
+	.spill_cost             = 7,
+	.reload_cost            = 5,
+	.flags_cls              = &amd64_reg_classes[CLASS_amd64_flags],
+	.get_remat_cost         = amd64_get_remat_cost,
+	.new_spill              = amd64_new_spill,
+	.new_reload             = amd64_new_reload,
+	.perform_memory_operand = amd64_perform_memory_operand,
 };
 
 static void amd64_generate_code(FILE *output, const char *cup_name)
@@ -685,6 +881,61 @@ static void amd64_generate_code(FILE *output, const char *cup_name)
 	pmap_destroy(amd64_constants);
 }
 
+/**
+ * Replace a popcount builtin by the SWAR ("SIMD within a register") bit count
+ * sequence for targets without popcnt instruction.
+ */
+static void lower_popcount(ir_node *const node, void *const env)
+{
+	if (!is_Builtin(node) || get_Builtin_kind(node) != ir_bk_popcount)
+		return;
+
+	dbg_info *const dbgi   = get_irn_dbg_info(node);
+	ir_node  *const block  = get_nodes_block(node);
+	ir_graph *const irg    = get_irn_irg(node);
+	ir_node        *x      = get_Builtin_param(node, 0);
+	ir_mode  *const x_mode = get_irn_mode(x);
+	if (mode_is_signed(x_mode))
+		x = new_rd_Conv(dbgi, block, x, find_unsigned_mode(x_mode));
+	unsigned  const bits = get_mode_size_bits(x_mode) <= 32 ? 32 : 64;
+	ir_mode  *const mode = bits == 32 ? mode_Iu : mode_Lu;
+	x = new_rd_Conv(dbgi, block, x, mode);
+
+	/* all_one / 3 = 0x55..., all_one / 5 = 0x33..., all_one / 17 = 0x0f...,
+	 * all_one / 255 = 0x01... */
+	ir_tarval *const all_one = get_mode_all_one(mode);
+	ir_node   *const m1  = new_r_Const(irg, tarval_div(all_one, new_tarval_from_long(3, mode)));
+	ir_node   *const m2  = new_r_Const(irg, tarval_div(all_one, new_tarval_from_long(5, mode)));
+	ir_node   *const m4  = new_r_Const(irg, tarval_div(all_one, new_tarval_from_long(17, mode)));
+	ir_node   *const h01 = new_r_Const(irg, tarval_div(all_one, new_tarval_from_long(255, mode)));
+	ir_node   *const c1  = new_r_Const_long(irg, mode_Iu, 1);
+	ir_node   *const c2  = new_r_Const_long(irg, mode_Iu, 2);
+	ir_node   *const c4  = new_r_Const_long(irg, mode_Iu, 4);
+	ir_node   *const c56 = new_r_Const_long(irg, mode_Iu, bits - 8);
+
+	/* x = x - ((x >> 1) & 0x55...) */
+	ir_node *const shr1 = new_rd_Shr(dbgi, block, x, c1);
+	x = new_rd_Sub(dbgi, block, x, new_rd_And(dbgi, block, shr1, m1));
+	/* x = (x & 0x33...) + ((x >> 2) & 0x33...) */
+	ir_node *const shr2 = new_rd_Shr(dbgi, block, x, c2);
+	x = new_rd_Add(dbgi, block, new_rd_And(dbgi, block, x, m2),
+	               new_rd_And(dbgi, block, shr2, m2));
+	/* x = (x + (x >> 4)) & 0x0f... */
+	ir_node *const shr4 = new_rd_Shr(dbgi, block, x, c4);
+	x = new_rd_And(dbgi, block, new_rd_Add(dbgi, block, x, shr4), m4);
+	/* the multiplication sums up all bytes in the most significant one */
+	x = new_rd_Shr(dbgi, block, new_rd_Mul(dbgi, block, x, h01), c56);
+
+	ir_type *const res_type = get_method_res_type(get_Builtin_type(node), 0);
+	ir_node *const res      = new_rd_Conv(dbgi, block, x, get_type_mode(res_type));
+	ir_node *const in[]     = {
+		[pn_Builtin_M]       = get_Builtin_mem(node),
+		[pn_Builtin_max + 1] = res,
+	};
+	turn_into_tuple(node, ARRAY_SIZE(in), in);
+	*(bool*)env = true;
+}
+
 static void amd64_lower_for_target(void)
 {
 	/* lower compound param handling */
@@ -713,27 +964,147 @@ static void amd64_lower_for_target(void)
 		be_after_transform(irg, "lower-copyb");
 	}
 
-	ir_builtin_kind supported[6];
+	if (!amd64_cg_config.use_popcnt) {
+		foreach_irp_irg(i, irg) {
+			bool changed = false;
+			irg_walk_graph(irg, NULL, lower_popcount, &changed);
+			confirm_irg_properties(irg, changed
+			                       ? IR_GRAPH_PROPERTIES_CONTROL_FLOW
+			                       : IR_GRAPH_PROPERTIES_ALL);
+			be_after_transform(irg, "lower-popcount");
+		}
+	}
+
+	ir_builtin_kind supported[10];
 	size_t  s = 0;
 	supported[s++] = ir_bk_ffs;
 	supported[s++] = ir_bk_clz;
 	supported[s++] = ir_bk_ctz;
+	supported[s++] = ir_bk_popcount;
+	supported[s++] = ir_bk_parity;
+	supported[s++] = ir_bk_bswap;
 	supported[s++] = ir_bk_compare_swap;
 	supported[s++] = ir_bk_saturating_increment;
 	supported[s++] = ir_bk_va_start;
+	supported[s++] = ir_bk_prefetch;
 
 	assert(s <= ARRAY_SIZE(supported));
 	lower_builtins(s, supported);
 	be_after_irp_transform("lower-builtins");
 }
 
+/** Estimated cost of a mispredicted branch in cycles. */
+#define AMD64_BRANCH_MISS_COST 14
+/** Estimated cost of a cmov/setcc compared to a correctly predicted branch. */
+#define AMD64_SELECT_COST      1
+/** Maximum number of operations if-conversion may execute speculatively. */
+#define AMD64_MAX_SPECULATED   8
+
+/**
+ * Returns the probability that the Cond using @p sel jumps to its true
+ * successor. Block execution frequencies are taken from a loaded profile or
+ * an earlier estimation, 0.5 is assumed if they are not available.
+ */
+static double get_branch_probability(ir_node const *const sel)
+{
+	if (!edges_activated(get_irn_irg(sel)))
+		return 0.5;
+
+	double freq[2] = { 0.0, 0.0 };
+	foreach_out_edge(sel, edge) {
+		ir_node *const cond = get_edge_src_irn(edge);
+		if (!is_Cond(cond))
+			continue;
+		foreach_out_edge(cond, proj_edge) {
+			ir_node *const proj = get_edge_src_irn(proj_edge);
+			foreach_out_edge(proj, target_edge) {
+				ir_node *const target = get_edge_src_irn(target_edge);
+				if (is_Block(target))
+					freq[get_Proj_num(proj)] += get_block_execfreq(target);
+			}
+		}
+		break;
+	}
+	double const sum = freq[pn_Cond_false] + freq[pn_Cond_true];
+	if (!(sum > 0.0))
+		return 0.5;
+	return freq[pn_Cond_true] / sum;
+}
+
+/**
+ * Counts the operations computing @p node that if-conversion would move out of
+ * the conditionally executed block @p block.
+ */
+static unsigned count_speculated(ir_node const *const node,
+                                 ir_node const *const block,
+                                 unsigned const limit)
+{
+	if (get_nodes_block(node) != block || is_Phi(node)
+	 || is_irn_constlike(node))
+		return 0;
+	unsigned cost = 1;
+	foreach_irn_in(node, i, pred) {
+		if (cost > limit)
+			break;
+		cost += count_speculated(pred, block, limit - cost);
+	}
+	return cost;
+}
+
+static unsigned get_speculation_cost(ir_node const *const sel,
+                                     ir_node const *const value)
+{
+	ir_node const *const block = get_nodes_block(value);
+	if (block == get_nodes_block(sel))
+		return 0;
+	return count_speculated(value, block, AMD64_MAX_SPECULATED);
+}
+
+static bool amd64_can_select(ir_node *sel, ir_node *mux_false,
+                             ir_node *mux_true)
+{
+	ir_mode *const mode = get_irn_mode(mux_true);
+	if (mode_is_float(mode)) {
+		ir_node *op1;
+		ir_node *op2;
+		return amd64_mux_is_float_min_max(sel, mux_true, mux_false, &op1,
+		                                  &op2) != ir_relation_false;
+	}
+	if (!mode_is_int(mode) && !mode_is_reference(mode))
+		return false;
+
+	/* a single cmov/setcc can not test the parity flag in addition */
+	if (is_Cmp(sel)) {
+		x86_condition_code_t const cc = amd64_get_cmp_condition_code(sel);
+		if (cc & x86_cc_float_parity_cases)
+			return false;
+	}
+	return true;
+}
+
 static int amd64_is_mux_allowed(ir_node *sel, ir_node *mux_false,
                                 ir_node *mux_true)
 {
 	/* optimizable by middleend */
 	if (ir_is_optimizable_mux(sel, mux_false, mux_true))
 		return true;
-	return false;
+	if (!amd64_can_select(sel, mux_false, mux_true))
+		return false;
+
+	/* The select executes the computations of both values, the branch costs
+	 * a misprediction with the probability of the rarer direction. */
+	unsigned const cost_true  = get_speculation_cost(sel, mux_true);
+	unsigned const cost_false = get_speculation_cost(sel, mux_false);
+	if (cost_true > AMD64_MAX_SPECULATED || cost_false > AMD64_MAX_SPECULATED)
+		return false;
+
+	double const p_true      = get_branch_probability(sel);
+	double const p_miss      = p_true < 0.5 ? p_true : 1.0 - p_true;
+	double const branch_cost = AMD64_BRANCH_MISS_COST * p_miss;
+	double const select_cost = AMD64_SELECT_COST
+	                         + (1.0 - p_true) * cost_true
+	                         + p_true * cost_false;
+	return select_cost <= branch_cost;
 }
 
 static const ir_settings_arch_dep_t amd64_arch_dep = {
@@ -743,7 +1114,7 @@ static const ir_settings_arch_dep_t amd64_arch_dep = {
 	.evaluate             = NULL,
 	.allow_mulhs          = true,
 	.allow_mulhu          = true,
-	.max_bits_for_mulh    = 32,
+	.max_bits_for_mulh    = 64,
 };
 
 static backend_params amd64_backend_params = {
@@ -773,7 +1144,7 @@ static const backend_params *amd64_get_backend_params(void) {
 
 static int amd64_is_valid_clobber(const char *clobber)
 {
-	return x86_parse_clobber(amd64_additional_clobber_names, clobber) != NULL;
+	return arch_find_register(clobber) != NULL;
 }
 
 static void amd64_init_types(void)
@@ -791,8 +1162,69 @@ static void amd64_init_types(void)
 	amd64_backend_params.vararg.va_list_type = amd64_build_va_list_type();
 }
 
+#if defined(__x86_64__) || defined(_M_X64)
+static void amd64_cpuid(unsigned *const regs, unsigned const leaf)
+{
+#if defined(_MSC_VER)
+	__cpuidex((int*)regs, leaf, 0);
+#else
+	__asm__("cpuid"
+	        : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	        : "a" (leaf), "c" (0));
+#endif
+}
+
+/**
+ * Enable the features of the compiling cpu.
+ */
+static void autodetect_features(amd64_codegen_config_t *const c)
+{
+	unsigned regs[4];
+	amd64_cpuid(regs, 0);
+	unsigned const max_leaf = regs[0];
+	amd64_cpuid(regs, 0x80000000);
+	unsigned const max_ext_leaf = regs[0];
+
+	if (max_leaf >= 1) {
+		amd64_cpuid(regs, 1);
+		c->use_popcnt |= (regs[2] & (1u << 23)) != 0;
+	}
+	if (max_leaf >= 7) {
+		amd64_cpuid(regs, 7);
+		c->use_tzcnt |= (regs[1] & (1u << 3)) != 0;
+	}
+	if (max_ext_leaf >= 0x80000001) {
+		amd64_cpuid(regs, 0x80000001);
+		c->use_lzcnt |= (regs[2] & (1u << 5)) != 0;
+	}
+}
+#endif
+
+static void amd64_setup_cg_config(void)
+{
+	amd64_codegen_config_t *const c = &amd64_cg_config;
+	switch (c->isa_level) {
+	case AMD64_ISA_X86_64_V4:
+	case AMD64_ISA_X86_64_V3:
+		c->use_lzcnt = true;
+		c->use_tzcnt = true;
+		/* fall through */
+	case AMD64_ISA_X86_64_V2:
+		c->use_popcnt = true;
+		/* fall through */
+	case AMD64_ISA_X86_64:
+		break;
+	case AMD64_ISA_NATIVE:
+#if defined(__x86_64__) || defined(_M_X64)
+		autodetect_features(c);
+#endif
+		break;
+	}
+}
+
 static void amd64_init(void)
 {
+	amd64_setup_cg_config();
 	amd64_init_types();
 	amd64_register_init();
 	amd64_create_opcodes();
@@ -800,10 +1232,31 @@ static void amd64_init(void)
 	x86_set_be_asm_constraint_support(&amd64_asm_constraints);
 }
 
+/** Load-to-use latency of a memory operand for each cost model. */
+static const unsigned amd64_load_latency[] = {
+	[AMD64_COST_MODEL_GENERIC] = 5,
+	[AMD64_COST_MODEL_SKYLAKE] = 5,
+	[AMD64_COST_MODEL_ZEN]     = 4,
+};
+
 static unsigned amd64_get_op_estimated_cost(const ir_node *node)
 {
-	(void)node;/* TODO */
-	return 1;
+	if (!is_amd64_irn(node))
+		return 1;
+
+	amd64_cost_model_t const model = amd64_cg_config.cost_model;
+	unsigned                 cost  = amd64_get_op_cost(model, node)->latency;
+
+	/* The cost tables describe the register form of an instruction. Add the
+	 * load for memory operands, stores are completely described by the table
+	 * as nothing waits for their result. */
+	if (get_irn_mode(node) != mode_M) {
+		amd64_op_mode_t const op_mode = get_amd64_attr_const(node)->op_mode;
+		if (amd64_loads(node) || op_mode == AMD64_OP_ADDR_REG
+		    || op_mode == AMD64_OP_ADDR_IMM)
+			cost += amd64_load_latency[model];
+	}
+	return cost;
 }
 
 static arch_isa_if_t const amd64_isa_if = {
@@ -827,9 +1280,39 @@ void be_init_arch_amd64(void)
 	be_register_isa_if("amd64", &amd64_isa_if);
 	FIRM_DBG_REGISTER(dbg, "firm.be.amd64.cg");
 
+	static const lc_opt_enum_int_items_t arch_items[] = {
+		{ "x86-64",    AMD64_ISA_X86_64    },
+		{ "x86-64-v2", AMD64_ISA_X86_64_V2 },
+		{ "x86-64-v3", AMD64_ISA_X86_64_V3 },
+		{ "x86-64-v4", AMD64_ISA_X86_64_V4 },
+		{ "generic",   AMD64_ISA_X86_64    },
+#if defined(__x86_64__) || defined(_M_X64)
+		{ "native",    AMD64_ISA_NATIVE    },
+#endif
+		{ NULL,        0                   },
+	};
+	static lc_opt_enum_int_var_t arch_var = {
+		(int*)&amd64_cg_config.isa_level, arch_items
+	};
+
+	static const lc_opt_enum_int_items_t tune_items[] = {
+		{ "generic", AMD64_COST_MODEL_GENERIC },
+		{ "skylake", AMD64_COST_MODEL_SKYLAKE },
+		{ "zen",     AMD64_COST_MODEL_ZEN     },
+		{ NULL,      0                        },
+	};
+	static lc_opt_enum_int_var_t tune_var = {
+		(int*)&amd64_cg_config.cost_model, tune_items
+	};
+
 	static const lc_opt_table_entry_t options[] = {
-		LC_OPT_ENT_BOOL("x64abi",      "Use x64 ABI (otherwise system V)", &amd64_use_x64_abi),
-		LC_OPT_ENT_BOOL("no-red-zone", "gcc compatibility",                &amd64_use_red_zone),
+		LC_OPT_ENT_BOOL    ("x64abi",      "Use x64 ABI (otherwise system V)", &amd64_use_x64_abi),
+		LC_OPT_ENT_BOOL    ("no-red-zone", "gcc compatibility",                &amd64_no_red_zone),
+		LC_OPT_ENT_ENUM_INT("arch",        "select the instruction set level", &arch_var),
+		LC_OPT_ENT_ENUM_INT("tune",        "optimize for microarchitecture",   &tune_var),
+		LC_OPT_ENT_BOOL    ("popcnt",      "gcc compatibility",                &amd64_cg_config.use_popcnt),
+		LC_OPT_ENT_BOOL    ("lzcnt",       "gcc compatibility",                &amd64_cg_config.use_lzcnt),
+		LC_OPT_ENT_BOOL    ("bmi",         "gcc compatibility",                &amd64_cg_config.use_tzcnt),
 		LC_OPT_LAST
 	};
 	lc_opt_entry_t *be_grp    = lc_opt_get_grp(firm_opt_get_root(), "be");
@@ -11,6 +11,7 @@
 #define FIRM_BE_AMD64_AMD64_BEARCH_T_H
 
 #include "beirg.h"
+#include "gen_amd64_new_nodes.h"
 #include "../ia32/x86_cconv.h"
 #include "../ia32/x86_x87.h"
 
@@ -23,9 +24,30 @@ extern pmap *amd64_constants; /**< A map of entities that store const tarvals */
 
 extern ir_mode *amd64_mode_xmm;
 
-extern bool amd64_use_red_zone;
+extern bool amd64_no_red_zone;
 extern bool amd64_use_x64_abi;
 
+/**
+ * Microarchitecture levels of the x86-64 psABI.
+ */
+typedef enum {
+	AMD64_ISA_X86_64,    /**< baseline instruction set (sse2) */
+	AMD64_ISA_X86_64_V2, /**< adds popcnt, sse3, ssse3, sse4.1, sse4.2 */
+	AMD64_ISA_X86_64_V3, /**< adds avx, avx2, bmi1, bmi2, lzcnt */
+	AMD64_ISA_X86_64_V4, /**< adds avx512 */
+	AMD64_ISA_NATIVE,    /**< features of the compiling machine */
+} amd64_isa_level_t;
+
+typedef struct amd64_codegen_config_t {
+	amd64_isa_level_t  isa_level;
+	bool               use_popcnt; /**< popcnt instruction */
+	bool               use_lzcnt;  /**< lzcnt instruction */
+	bool               use_tzcnt;  /**< tzcnt instruction (bmi1) */
+	amd64_cost_model_t cost_model; /**< instruction costs to optimize for */
+} amd64_codegen_config_t;
+
+extern amd64_codegen_config_t amd64_cg_config;
+
 #define AMD64_REGISTER_SIZE   8
 /** power of two stack alignment on calls */
 #define AMD64_PO2_STACK_ALIGNMENT 4
@@ -31,8 +31,8 @@
  * Note: "X64 ABI" refers to the Windows ABI for x86_64 (the SysV ABI
  * calls itself "AMD64 ABI").
  */
-bool amd64_use_x64_abi  = false;
-bool amd64_use_red_zone = true;
+bool amd64_use_x64_abi = false;
+bool amd64_no_red_zone = false;
 
 static const unsigned ignore_regs[] = {
 	REG_RSP,
@@ -90,86 +90,6 @@ static void amd64_emit_x87_size_suffix(x86_insn_size_t const size)
 	be_emit_char(get_x87_size_suffix(size));
 }
 
-static const char *get_register_name_8bit(const arch_register_t *reg)
-{
-	switch (reg->global_index) {
-	case REG_RAX: return "al";
-	case REG_RBX: return "bl";
-	case REG_RCX: return "cl";
-	case REG_RDX: return "dl";
-	case REG_RSP: return "spl";
-	case REG_RBP: return "bpl";
-	case REG_RSI: return "sil";
-	case REG_RDI: return "dil";
-	case REG_R8:  return "r8b";
-	case REG_R9:  return "r9b";
-	case REG_R10: return "r10b";
-	case REG_R11: return "r11b";
-	case REG_R12: return "r12b";
-	case REG_R13: return "r13b";
-	case REG_R14: return "r14b";
-	case REG_R15: return "r15b";
-	}
-	panic("unexpected register number");
-}
-
-static const char *get_register_name_8bit_high(const arch_register_t *reg)
-{
-	switch (reg->global_index) {
-	case REG_RAX: return "ah";
-	case REG_RBX: return "bh";
-	case REG_RCX: return "ch";
-	case REG_RDX: return "dh";
-	}
-	panic("unexpected register number");
-}
-
-static const char *get_register_name_16bit(const arch_register_t *reg)
-{
-	switch (reg->global_index) {
-	case REG_RAX: return "ax";
-	case REG_RBX: return "bx";
-	case REG_RCX: return "cx";
-	case REG_RDX: return "dx";
-	case REG_RSP: return "sp";
-	case REG_RBP: return "bp";
-	case REG_RSI: return "si";
-	case REG_RDI: return "di";
-	case REG_R8:  return "r8w";
-	case REG_R9:  return "r9w";
-	case REG_R10: return "r10w";
-	case REG_R11: return "r11w";
-	case REG_R12: return "r12w";
-	case REG_R13: return "r13w";
-	case REG_R14: return "r14w";
-	case REG_R15: return "r15w";
-	}
-	panic("unexpected register number");
-}
-
-static const char *get_register_name_32bit(const arch_register_t *reg)
-{
-	switch (reg->global_index) {
-	case REG_RAX: return "eax";
-	case REG_RBX: return "ebx";
-	case REG_RCX: return "ecx";
-	case REG_RDX: return "edx";
-	case REG_RSP: return "esp";
-	case REG_RBP: return "ebp";
-	case REG_RSI: return "esi";
-	case REG_RDI: return "edi";
-	case REG_R8:  return "r8d";
-	case REG_R9:  return "r9d";
-	case REG_R10: return "r10d";
-	case REG_R11: return "r11d";
-	case REG_R12: return "r12d";
-	case REG_R13: return "r13d";
-	case REG_R14: return "r14d";
-	case REG_R15: return "r15d";
-	}
-	panic("unexpected register number");
-}
-
 static void emit_register(const arch_register_t *reg)
 {
 	be_emit_char('%');
@@ -180,9 +100,9 @@ static const char *get_register_name_mode(const arch_register_t *reg,
                                           const x86_insn_size_t size)
 {
 	switch (size) {
-	case X86_SIZE_8:  return get_register_name_8bit(reg);
-	case X86_SIZE_16: return get_register_name_16bit(reg);
-	case X86_SIZE_32: return get_register_name_32bit(reg);
+	case X86_SIZE_8:  return arch_get_subreg_name(reg, arch_subreg_8);
+	case X86_SIZE_16: return arch_get_subreg_name(reg, arch_subreg_16);
+	case X86_SIZE_32: return arch_get_subreg_name(reg, arch_subreg_32);
 	case X86_SIZE_64:
 	case X86_SIZE_80:
 	case X86_SIZE_128: return reg->name;
@@ -220,12 +140,13 @@ static void amd64_emit_immediate64(const amd64_imm64_t *const imm)
 {
 	if (imm->kind == X86_IMM_VALUE) {
 		assert(imm->entity == NULL);
-		be_emit_irprintf("0x%" PRIX64, imm->offset);
+		be_emit_cstring("0x");
+		be_emit_hex(imm->offset, 0, true);
 		return;
 	}
 	x86_emit_relocation_no_offset(imm->kind, imm->entity);
 	if (imm->offset != 0)
-		be_emit_irprintf("%+" PRId64, imm->offset);
+		be_emit_int_signed(imm->offset);
 }
 
 static void amd64_emit_am(const ir_node *const node, bool indirect_star)
@@ -518,7 +439,7 @@ emit_R:
 
 			case 'd': {
 				int const num = va_arg(ap, int);
-				be_emit_irprintf("%d", num);
+				be_emit_int(num);
 				break;
 			}
 
@@ -530,7 +451,7 @@ emit_R:
 
 			case 'u': {
 				unsigned const num = va_arg(ap, unsigned);
-				be_emit_irprintf("%u", num);
+				be_emit_uint(num);
 				break;
 			}
 
@@ -550,9 +471,9 @@ static const char *get_register_name_ir_mode(const arch_register_t *reg,
 	if (get_mode_arithmetic(mode) != irma_twos_complement)
 		return reg->name;
 	switch (get_mode_size_bits(mode)) {
-	case 8:  return get_register_name_8bit(reg);
-	case 16: return get_register_name_16bit(reg);
-	case 32: return get_register_name_32bit(reg);
+	case 8:  return arch_get_subreg_name(reg, arch_subreg_8);
+	case 16: return arch_get_subreg_name(reg, arch_subreg_16);
+	case 32: return arch_get_subreg_name(reg, arch_subreg_32);
 	case 64: return reg->name;
 	default:
 		panic("unexpected mode size");
@@ -567,10 +488,10 @@ static void emit_amd64_asm_register(const arch_register_t *reg, char modifier,
 	case '\0':
 		name = mode != NULL ? get_register_name_ir_mode(reg, mode) : reg->name;
 		break;
-	case  'b': name = get_register_name_8bit(reg); break;
-	case  'h': name = get_register_name_8bit_high(reg); break;
-	case  'w': name = get_register_name_16bit(reg); break;
-	case  'k': name = get_register_name_32bit(reg); break;
+	case  'b': name = arch_get_subreg_name(reg, arch_subreg_8); break;
+	case  'h': name = arch_get_subreg_name(reg, arch_subreg_8h); break;
+	case  'w': name = arch_get_subreg_name(reg, arch_subreg_16); break;
+	case  'k': name = arch_get_subreg_name(reg, arch_subreg_32); break;
 	case  'q': name = reg->name; break;
 	// gcc also knows 'x' V4SFmode, 't' V8SFmode, 'y' "st(0)" instead of "st",
 	// 'd' duplicate operand for AVX instruction
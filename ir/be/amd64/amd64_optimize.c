@@ -9,12 +9,16 @@
  */
 #include "amd64_optimize.h"
 
+#include "amd64_bearch_t.h"
 #include "amd64_new_nodes.h"
 #include "amd64_transform.h"
+#include "beirg.h"
 #include "benode.h"
 #include "bepeephole.h"
 #include "besched.h"
 #include "gen_amd64_regalloc_if.h"
+#include "iredges_t.h"
+#include "raw_bitset.h"
 #include "util.h"
 
 static void make_add(ir_node *const node, size_t const n_in, ir_node *const *const in, arch_register_req_t const **const reqs, amd64_binop_addr_attr_t const *const attr, arch_register_t const *const oreg)
@@ -109,9 +113,316 @@ static void peephole_amd64_mov_imm(ir_node *const node)
 	}
 }
 
+/* only optimize up to 16 stores behind IncSPs */
+#define MAXPUSH_OPTIMIZE 16
+
+static ir_node *create_push(ir_node *const store, ir_node *const block, ir_node *const stack)
+{
+	amd64_binop_addr_attr_t const *const attr = get_amd64_binop_addr_attr_const(store);
+	dbg_info                      *const dbgi = get_irn_dbg_info(store);
+	ir_node                       *const mem  = get_irn_n(store, attr->base.addr.mem_input);
+	ir_node                       *const val  = get_irn_n(store, attr->u.reg_input);
+	return new_bd_amd64_push_reg(dbgi, block, stack, mem, val, X86_SIZE_64);
+}
+
+/**
+ * Tries to create pushes from IncSP, Store combinations.
+ * Stores to the topmost slots of the allocated area are replaced by pushes
+ * before the IncSP (typically saving callee-save registers in the prologue),
+ * stores to the lowest slots by pushes after the IncSP (typically outgoing
+ * call arguments). The IncSP is modified (possibly into IncSP 0, but not
+ * removed).
+ */
+static void peephole_IncSP_Store_to_push(ir_node *const irn)
+{
+	int inc_ofs = be_get_IncSP_offset(irn);
+	if (inc_ofs < AMD64_REGISTER_SIZE)
+		return;
+
+	/* stores sorted by their distance from the bottom and from the top of the
+	 * allocated area in slots */
+	ir_node *low[MAXPUSH_OPTIMIZE];
+	ir_node *high[MAXPUSH_OPTIMIZE];
+	memset(low,  0, sizeof(low));
+	memset(high, 0, sizeof(high));
+
+	/* We first walk the schedule after the IncSP node as long as we find
+	 * suitable Stores that could be transformed to a push. Any other node
+	 * stops the search: A push writes a whole 64bit slot, so no unrelated
+	 * store may have written to the slot before. */
+	sched_foreach_after(irn, node) {
+		if (!is_amd64_mov_store(node))
+			break;
+
+		amd64_binop_addr_attr_t const *const attr = get_amd64_binop_addr_attr_const(node);
+		x86_addr_t              const *const addr = &attr->base.addr;
+		if (attr->base.base.op_mode != AMD64_OP_ADDR_REG
+		 || addr->variant != X86_ADDR_BASE
+		 || addr->immediate.kind != X86_IMM_VALUE
+		 || attr->base.base.size < X86_SIZE_32)
+			break;
+
+		/* it has to use our sp value, be attached to NoMem and must not store
+		 * the sp value itself */
+		if (get_irn_n(node, addr->base_input) != irn
+		 || !is_NoMem(get_irn_n(node, addr->mem_input))
+		 || get_irn_n(node, attr->u.reg_input) == irn)
+			break;
+
+		/* we should NEVER access uninitialized stack BELOW the current SP */
+		int32_t const offset = addr->immediate.offset;
+		assert(offset >= 0);
+
+		/* storing at half-slots or outside the allocated area is bad */
+		if (offset % AMD64_REGISTER_SIZE != 0
+		 || offset > inc_ofs - AMD64_REGISTER_SIZE)
+			break;
+
+		int const low_slot  = offset / AMD64_REGISTER_SIZE;
+		int const high_slot = (inc_ofs - AMD64_REGISTER_SIZE - offset) / AMD64_REGISTER_SIZE;
+		if (low_slot >= MAXPUSH_OPTIMIZE && high_slot >= MAXPUSH_OPTIMIZE)
+			break;
+
+		/* storing into the same slot twice is bad (and shouldn't happen...) */
+		if (low_slot < MAXPUSH_OPTIMIZE) {
+			if (low[low_slot] != NULL)
+				break;
+			low[low_slot] = node;
+		}
+		if (high_slot < MAXPUSH_OPTIMIZE) {
+			if (high[high_slot] != NULL)
+				break;
+			high[high_slot] = node;
+		}
+	}
+
+	int const n_slots = inc_ofs / AMD64_REGISTER_SIZE;
+	int       n_high  = 0;
+	while (n_high < MAXPUSH_OPTIMIZE && high[n_high] != NULL)
+		++n_high;
+	int n_low = 0;
+	while (n_low < MAXPUSH_OPTIMIZE && n_low < n_slots - n_high && low[n_low] != NULL)
+		++n_low;
+	if (n_high == 0 && n_low == 0)
+		return;
+
+	/* the topmost slots are pushed before the IncSP */
+	ir_node *const block   = get_nodes_block(irn);
+	ir_node       *curr_sp = be_get_IncSP_pred(irn);
+	for (int i = 0; i < n_high; ++i) {
+		ir_node *const store = high[i];
+		ir_node *const push  = create_push(store, block, curr_sp);
+		sched_add_before(irn, push);
+		curr_sp = be_new_Proj_reg(push, pn_amd64_push_reg_stack, &amd64_registers[REG_RSP]);
+		be_peephole_exchange(store, be_new_Proj(push, pn_amd64_push_reg_M));
+	}
+	be_set_IncSP_pred(irn, curr_sp);
+
+	/* the lowest slots are pushed after the IncSP */
+	curr_sp = irn;
+	ir_node *first_push = NULL;
+	for (int i = n_low; i-- > 0;) {
+		ir_node *const store = low[i];
+		ir_node *const push  = create_push(store, block, curr_sp);
+		if (first_push == NULL)
+			first_push = push;
+		sched_add_after(skip_Proj(curr_sp), push);
+		curr_sp = be_new_Proj_reg(push, pn_amd64_push_reg_stack, &amd64_registers[REG_RSP]);
+		be_peephole_exchange(store, be_new_Proj(push, pn_amd64_push_reg_M));
+	}
+	if (first_push != NULL)
+		edges_reroute_except(irn, curr_sp, first_push);
+
+	be_set_IncSP_offset(irn, inc_ofs - (n_high + n_low) * AMD64_REGISTER_SIZE);
+}
+
+/**
+ * Tries to create pops from Load, IncSP combinations.
+ * The Loads are replaced by pops, the IncSP is modified
+ * (possibly into IncSP 0, but not removed).
+ */
+static void peephole_Load_IncSP_to_pop(ir_node *const irn)
+{
+	int inc_ofs = -be_get_IncSP_offset(irn);
+	if (inc_ofs < AMD64_REGISTER_SIZE)
+		return;
+
+	ir_node *loads[MAXPUSH_OPTIMIZE];
+	memset(loads, 0, sizeof(loads));
+
+	/* We first walk the schedule before the IncSP node as long as we find
+	 * suitable Loads that could be transformed to a pop. We save them into
+	 * the loads array which is sorted by the frame offset/8. */
+	unsigned  regmask  = 0;
+	unsigned  copymask = ~0u;
+	int       maxslot  = -1;
+	ir_node  *pred_sp  = be_get_IncSP_pred(irn);
+	sched_foreach_reverse_before(irn, node) {
+		if (!is_amd64_mov_gp(node)) {
+			if (be_is_Copy(node)) {
+				arch_register_t const *const dreg = arch_get_irn_register(node);
+				if (dreg->cls != &amd64_reg_classes[CLASS_amd64_gp]) {
+					/* not a GP copy, ignore */
+					continue;
+				}
+				arch_register_t const *const sreg = arch_get_irn_register(be_get_Copy_op(node));
+				unsigned               const mask = (1u << dreg->index) | (1u << sreg->index);
+				if (regmask & copymask & mask)
+					break;
+				/* we CAN skip Copies if neither the destination nor the
+				 * source is in our regmask, ie none of our future pops will
+				 * overwrite it */
+				regmask  |= mask;
+				copymask &= ~mask;
+				continue;
+			}
+			break;
+		}
+
+		/* pop always loads 64bit, while narrower loads zero extend */
+		amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+		x86_addr_t        const *const addr = &attr->addr;
+		if (attr->base.op_mode != AMD64_OP_ADDR
+		 || attr->base.size != X86_SIZE_64
+		 || addr->variant != X86_ADDR_BASE
+		 || addr->immediate.kind != X86_IMM_VALUE)
+			break;
+
+		/* it has to use our predecessor sp value */
+		if (get_irn_n(node, addr->base_input) != pred_sp)
+			break;
+
+		/* we should NEVER access uninitialized stack BELOW the current SP */
+		int32_t const offset = addr->immediate.offset;
+		assert(offset >= 0);
+
+		/* loading from half-slots is bad */
+		if (offset % AMD64_REGISTER_SIZE != 0)
+			break;
+
+		/* ignore those outside the possible windows */
+		if (offset >= MAXPUSH_OPTIMIZE * AMD64_REGISTER_SIZE
+		 || offset > inc_ofs - AMD64_REGISTER_SIZE)
+			continue;
+
+		/* loading from the same slot twice is bad (and shouldn't happen...) */
+		int const loadslot = offset / AMD64_REGISTER_SIZE;
+		if (loads[loadslot] != NULL)
+			break;
+
+		arch_register_t const *const dreg = arch_get_irn_register_out(node, pn_amd64_mov_gp_res);
+		if (regmask & (1u << dreg->index)) {
+			/* this register is already used */
+			break;
+		}
+		regmask |= 1u << dreg->index;
+
+		loads[loadslot] = node;
+		maxslot = MAX(maxslot, loadslot);
+	}
+
+	if (maxslot < 0)
+		return;
+
+	/* find the first slot */
+	int i;
+	for (i = maxslot; i >= 0; --i) {
+		if (loads[i] == NULL)
+			break;
+	}
+
+	int const ofs = inc_ofs - (maxslot + 1) * AMD64_REGISTER_SIZE;
+	inc_ofs = (i + 1) * AMD64_REGISTER_SIZE;
+
+	/* create a new IncSP if needed */
+	ir_node *const block = get_nodes_block(irn);
+	if (inc_ofs > 0) {
+		pred_sp = amd64_new_IncSP(block, pred_sp, -inc_ofs, be_get_IncSP_no_align(irn));
+		sched_add_before(irn, pred_sp);
+	}
+
+	/* walk through the Loads and create pops for them */
+	for (++i; i <= maxslot; ++i) {
+		ir_node                 *const load = loads[i];
+		amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(load);
+		ir_node                 *const mem  = get_irn_n(load, attr->addr.mem_input);
+		arch_register_t   const *const reg  = arch_get_irn_register_out(load, pn_amd64_mov_gp_res);
+		ir_node                 *const pop  = new_bd_amd64_pop_reg(get_irn_dbg_info(load), block, mem, pred_sp, X86_SIZE_64);
+		arch_set_irn_register_out(pop, pn_amd64_pop_reg_res, reg);
+
+		pred_sp = be_new_Proj_reg(pop, pn_amd64_pop_reg_stack, &amd64_registers[REG_RSP]);
+
+		sched_add_before(irn, pop);
+		be_peephole_exchange(load, pop);
+	}
+
+	be_set_IncSP_offset(irn, -ofs);
+	be_set_IncSP_pred(irn, pred_sp);
+}
+
+/**
+ * Find a free GP register if possible, else return NULL.
+ */
+static arch_register_t const *get_free_gp_reg(ir_graph *const irg)
+{
+	be_irg_t *const birg = be_birg_from_irg(irg);
+	for (unsigned i = 0; i < N_amd64_gp_REGS; ++i) {
+		arch_register_t const *const reg = &amd64_reg_classes[CLASS_amd64_gp].regs[i];
+		if (!rbitset_is_set(birg->allocatable_regs, reg->global_index))
+			continue;
+
+		if (be_peephole_get_value(reg->global_index) == NULL)
+			return reg;
+	}
+	return NULL;
+}
+
+/**
+ * Optimize an IncSP by replacing it with push/pop.
+ */
 static void peephole_be_IncSP(ir_node *const node)
 {
-	be_peephole_IncSP_IncSP(node);
+	/* first optimize incsp->incsp combinations */
+	if (be_peephole_IncSP_IncSP(node))
+		return;
+
+	/* transform IncSP->Store combinations to push where possible */
+	peephole_IncSP_Store_to_push(node);
+
+	/* transform Load->IncSP combinations to pop where possible */
+	peephole_Load_IncSP_to_pop(node);
+
+	/* replace IncSP +8 by push %rax and IncSP -8 by pop into a free
+	 * register: 1 byte instead of 4 */
+	int const offset = be_get_IncSP_offset(node);
+	if (offset != AMD64_REGISTER_SIZE && offset != -AMD64_REGISTER_SIZE)
+		return;
+
+	ir_node  *stack = be_get_IncSP_pred(node);
+	dbg_info *dbgi  = get_irn_dbg_info(node);
+	ir_node  *block = get_nodes_block(node);
+	if (offset < 0) {
+		/* we need a free register for pop */
+		arch_register_t const *const reg = get_free_gp_reg(get_irn_irg(node));
+		if (!reg)
+			return;
+
+		ir_graph *const irg = get_irn_irg(node);
+		ir_node  *const pop = new_bd_amd64_pop_reg(dbgi, block, get_irg_no_mem(irg), stack, X86_SIZE_64);
+		sched_add_before(node, pop);
+
+		ir_node *const val  = be_new_Proj_reg(pop, pn_amd64_pop_reg_res, reg);
+		ir_node *const keep = be_new_Keep_one(val);
+		sched_add_before(node, keep);
+
+		stack = be_new_Proj_reg(pop, pn_amd64_pop_reg_stack, &amd64_registers[REG_RSP]);
+	} else {
+		stack = new_bd_amd64_push_rax(dbgi, block, stack);
+		arch_set_irn_register(stack, &amd64_registers[REG_RSP]);
+		sched_add_before(node, stack);
+	}
+
+	be_peephole_exchange(node, stack);
 }
 
 void amd64_peephole_optimization(ir_graph *const irg)
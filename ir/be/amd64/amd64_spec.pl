@@ -5,24 +5,29 @@ $mode_flags = "mode_Iu";
 $mode_xmm   = "amd64_mode_xmm";
 $mode_x87   = "x86_mode_E";
 
+# Microarchitectures selectable with the "tune" option. The "costs" of a node
+# give the latency, micro-operations and reciprocal throughput of its register
+# form, the backend adds the costs of memory operands.
+@cost_models = ( "generic", "skylake", "zen" );
+
 %reg_classes = (
 	gp => [
-		{ name => "rax", dwarf => 0 },
-		{ name => "rcx", dwarf => 2 },
-		{ name => "rdx", dwarf => 1 },
-		{ name => "rsi", dwarf => 4 },
-		{ name => "rdi", dwarf => 5 },
-		{ name => "rbx", dwarf => 3 },
-		{ name => "rbp", dwarf => 6 },
-		{ name => "rsp", dwarf => 7 },
-		{ name => "r8",  dwarf => 8 },
-		{ name => "r9",  dwarf => 9 },
-		{ name => "r10", dwarf => 10 },
-		{ name => "r11", dwarf => 11 },
-		{ name => "r12", dwarf => 12 },
-		{ name => "r13", dwarf => 13 },
-		{ name => "r14", dwarf => 14 },
-		{ name => "r15", dwarf => 15 },
+		{ name => "rax", dwarf => 0, subregs => { 8 => "al", "8h" => "ah", 16 => "ax", 32 => "eax" } },
+		{ name => "rcx", dwarf => 2, subregs => { 8 => "cl", "8h" => "ch", 16 => "cx", 32 => "ecx" } },
+		{ name => "rdx", dwarf => 1, subregs => { 8 => "dl", "8h" => "dh", 16 => "dx", 32 => "edx" } },
+		{ name => "rsi", dwarf => 4, subregs => { 8 => "sil", 16 => "si", 32 => "esi" } },
+		{ name => "rdi", dwarf => 5, subregs => { 8 => "dil", 16 => "di", 32 => "edi" } },
+		{ name => "rbx", dwarf => 3, subregs => { 8 => "bl", "8h" => "bh", 16 => "bx", 32 => "ebx" } },
+		{ name => "rbp", dwarf => 6, subregs => { 8 => "bpl", 16 => "bp", 32 => "ebp" } },
+		{ name => "rsp", dwarf => 7, subregs => { 8 => "spl", 16 => "sp", 32 => "esp" } },
+		{ name => "r8",  dwarf => 8, subregs => { 8 => "r8b", 16 => "r8w", 32 => "r8d" } },
+		{ name => "r9",  dwarf => 9, subregs => { 8 => "r9b", 16 => "r9w", 32 => "r9d" } },
+		{ name => "r10", dwarf => 10, subregs => { 8 => "r10b", 16 => "r10w", 32 => "r10d" } },
+		{ name => "r11", dwarf => 11, subregs => { 8 => "r11b", 16 => "r11w", 32 => "r11d" } },
+		{ name => "r12", dwarf => 12, subregs => { 8 => "r12b", 16 => "r12w", 32 => "r12d" } },
+		{ name => "r13", dwarf => 13, subregs => { 8 => "r13b", 16 => "r13w", 32 => "r13d" } },
+		{ name => "r14", dwarf => 14, subregs => { 8 => "r14b", 16 => "r14w", 32 => "r14d" } },
+		{ name => "r15", dwarf => 15, subregs => { 8 => "r15b", 16 => "r15w", 32 => "r15d" } },
 		{ mode => $mode_gp }
 	],
 	flags => [
@@ -110,6 +115,11 @@ my $binop = {
 	outs      => [ "res", "flags", "M" ],
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.25 },
+		zen     => { throughput => 0.25 },
+	},
 };
 
 my $binop_commutative = {
@@ -120,6 +130,11 @@ my $binop_commutative = {
 	outs      => [ "res", "flags", "M" ],
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.25 },
+		zen     => { throughput => 0.25 },
+	},
 };
 
 my $divop = {
@@ -132,6 +147,11 @@ my $divop = {
 	fixed     => "x86_addr_t addr = { .base_input = 0, .variant = X86_ADDR_REG };\n"
 	            ."amd64_op_mode_t op_mode = AMD64_OP_REG;\n",
 	attr      => "x86_insn_size_t size",
+	costs     => {
+		latency => 40, uops => 36, throughput => 25,
+		skylake => { latency => 42, uops => 36, throughput => 24 },
+		zen     => { latency => 30, uops => 2, throughput => 30 },
+	},
 };
 
 my $mulop = {
@@ -146,6 +166,11 @@ my $mulop = {
 	outs      => [ "res_low", "flags", "M", "res_high" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
+	costs     => {
+		latency => 4, uops => 2, throughput => 2,
+		skylake => { latency => 3, uops => 2, throughput => 1 },
+		zen     => { latency => 3, uops => 2, throughput => 2 },
+	},
 };
 
 my $shiftop = {
@@ -155,6 +180,10 @@ my $shiftop = {
 	outs      => [ "res", "flags" ],
 	attr_type => "amd64_shift_attr_t",
 	attr      => "const amd64_shift_attr_t *attr_init",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.5,
+		zen => { throughput => 0.25 },
+	},
 };
 
 my $unop = {
@@ -167,6 +196,11 @@ my $unop = {
 	attr      => "x86_insn_size_t size",
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_REG;\n"
 	            ."x86_addr_t addr = { .base_input = 0, .variant = X86_ADDR_REG };",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.25 },
+		zen     => { throughput => 0.25 },
+	},
 };
 
 my $unop_out = {
@@ -176,6 +210,39 @@ my $unop_out = {
 	outs      => [ "res", "flags", "M" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
+	costs     => {
+		latency => 3, uops => 1, throughput => 1,
+		zen => { latency => 1, throughput => 0.25 },
+	},
+};
+
+my $binop_mem = {
+	irn_flags => [ "modify_flags" ],
+	state     => "exc_pinned",
+	in_reqs   => "...",
+	out_reqs  => [ "none", "flags", "mem" ],
+	outs      => [ "dummy", "flags", "M" ],
+	attr_type => "amd64_binop_addr_attr_t",
+	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	costs     => {
+		latency => 2, uops => 3, throughput => 1,
+		zen => { latency => 1, uops => 1 },
+	},
+};
+
+my $unop_mem = {
+	irn_flags => [ "modify_flags" ],
+	state     => "exc_pinned",
+	in_reqs   => "...",
+	out_reqs  => [ "none", "flags", "mem" ],
+	outs      => [ "dummy", "flags", "M" ],
+	attr_type => "amd64_addr_attr_t",
+	attr      => "x86_insn_size_t size, x86_addr_t addr",
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;",
+	costs     => {
+		latency => 1, uops => 3, throughput => 1,
+		zen => { uops => 1 },
+	},
 };
 
 my $binopx = {
@@ -186,6 +253,10 @@ my $binopx = {
 	outs      => [ "res", "none", "M" ],
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	costs     => {
+		latency => 4, uops => 1, throughput => 0.5,
+		zen => { latency => 3 },
+	},
 };
 
 my $binopx_commutative = {
@@ -196,6 +267,10 @@ my $binopx_commutative = {
 	outs      => [ "res", "none", "M" ],
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	costs     => {
+		latency => 4, uops => 1, throughput => 0.5,
+		zen => { latency => 3 },
+	},
 };
 
 my $cvtop2x = {
@@ -205,6 +280,10 @@ my $cvtop2x = {
 	outs      => [ "res", "none", "M" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
+	costs     => {
+		latency => 5, uops => 2, throughput => 1,
+		zen => { latency => 4, uops => 1 },
+	},
 };
 
 my $cvtopx2i = {
@@ -214,6 +293,10 @@ my $cvtopx2i = {
 	outs      => [ "res", "none", "M" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
+	costs     => {
+		latency => 6, uops => 2, throughput => 1,
+		zen => { latency => 5 },
+	},
 };
 
 my $movopx = {
@@ -223,6 +306,11 @@ my $movopx = {
 	out_reqs  => [ "xmm", "none", "mem" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "amd64_op_mode_t op_mode, x86_addr_t addr",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.33 },
+		zen     => { throughput => 0.25 },
+	},
 };
 
 my $x87const = {
@@ -233,6 +321,11 @@ my $x87const = {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_X87;\n"
 	            ."x86_insn_size_t size    = X86_SIZE_80;\n",
 	mode      => $mode_x87,
+	costs     => {
+		latency => 1, uops => 2, throughput => 2,
+		skylake => { throughput => 2 },
+		zen     => { uops => 1, throughput => 1 },
+	},
 };
 
 my $x87unop = {
@@ -242,6 +335,7 @@ my $x87unop = {
 	ins       => [ "value" ],
 	attr_type => "amd64_x87_attr_t",
 	mode      => $mode_x87,
+	costs     => { latency => 1, uops => 1, throughput => 1 },
 };
 
 my $x87binop = {
@@ -252,6 +346,11 @@ my $x87binop = {
 	ins       => [ "left", "right" ],
 	attr_type => "amd64_x87_attr_t",
 	mode      => $mode_x87,
+	costs     => {
+		latency => 5, uops => 1, throughput => 1,
+		skylake => { latency => 3 },
+		zen     => { latency => 5 },
+	},
 };
 
 my $x87store = {
@@ -263,6 +362,21 @@ my $x87store = {
 	attr_type => "amd64_x87_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	mode      => "mode_M",
+	costs     => { latency => 4, uops => 2, throughput => 1 },
+};
+
+my $prefetchop = {
+	op_flags  => [ "uses_memory" ],
+	state     => "exc_pinned",
+	in_reqs   => "...",
+	out_reqs  => [ "mem" ],
+	outs      => [ "M" ],
+	attr_type => "amd64_addr_attr_t",
+	attr      => "x86_addr_t addr",
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;\n"
+	            ."x86_insn_size_t size    = X86_SIZE_8;\n",
+	mode      => "mode_M",
+	costs     => { latency => 1, uops => 1, throughput => 0.5 },
 };
 
 %nodes = (
@@ -276,6 +390,7 @@ push_am => {
 	attr      => "x86_insn_size_t size, x86_addr_t addr",
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;\n",
 	emit      => "push%M %A",
+	costs     => { latency => 1, uops => 2, throughput => 1 },
 },
 
 push_reg => {
@@ -288,6 +403,35 @@ push_reg => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n",
 	attr      => "x86_insn_size_t size",
 	emit      => "push%M %^S2",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
+},
+
+push_rax => {
+	state     => "exc_pinned",
+	in_reqs   => [ "rsp" ],
+	ins       => [ "stack" ],
+	out_reqs  => [ "rsp:I" ],
+	outs      => [ "stack" ],
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
+	            ."x86_insn_size_t size    = X86_SIZE_64;\n",
+	emit      => "pushq %%rax",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
+},
+
+pop_reg => {
+	op_flags  => [ "uses_memory" ],
+	state     => "exc_pinned",
+	in_reqs   => [ "mem", "rsp"   ],
+	ins       => [ "mem", "stack" ],
+	out_reqs  => [ "gp",  "none",   "mem", "rsp:I" ],
+	outs      => [ "res", "unused", "M",   "stack" ],
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n",
+	attr      => "x86_insn_size_t size",
+	emit      => "pop%M %D0",
+	costs     => {
+		latency => 5, uops => 1, throughput => 0.5,
+		zen => { latency => 4 },
+	},
 },
 
 pop_am => {
@@ -300,6 +444,7 @@ pop_am => {
 	attr      => "x86_insn_size_t size, x86_addr_t addr",
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;\n",
 	emit      => "pop%M %A",
+	costs     => { latency => 1, uops => 2, throughput => 1 },
 },
 
 sub_sp => {
@@ -324,6 +469,10 @@ leave => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
 	            ."x86_insn_size_t size    = X86_SIZE_64;\n",
 	emit      => "leave",
+	costs     => {
+		latency => 5, uops => 2, throughput => 1,
+		zen => { latency => 4 },
+	},
 },
 
 add => {
@@ -349,6 +498,7 @@ idiv => {
 imul => {
 	template => $binop_commutative,
 	emit     => "imul%M %AM",
+	costs    => { latency => 3, uops => 1, throughput => 1 },
 },
 
 imul_1op => {
@@ -390,6 +540,10 @@ sub => {
 sbb => {
 	template => $binop,
 	emit     => "sbb%M %AM",
+	costs    => {
+		latency => 1, uops => 1, throughput => 0.5,
+		zen => { throughput => 0.25 },
+	},
 },
 
 neg => {
@@ -407,6 +561,41 @@ xor => {
 	emit     => "xor%M %AM",
 },
 
+shl_mem => {
+	template => $binop_mem,
+	emit     => "shl%M %AM",
+},
+
+shr_mem => {
+	template => $binop_mem,
+	emit     => "shr%M %AM",
+},
+
+sar_mem => {
+	template => $binop_mem,
+	emit     => "sar%M %AM",
+},
+
+inc_mem => {
+	template => $unop_mem,
+	emit     => "inc%M %AM",
+},
+
+dec_mem => {
+	template => $unop_mem,
+	emit     => "dec%M %AM",
+},
+
+neg_mem => {
+	template => $unop_mem,
+	emit     => "neg%M %AM",
+},
+
+not_mem => {
+	template => $unop_mem,
+	emit     => "not%M %AM",
+},
+
 xor_0 => {
 	op_flags  => [ "constlike" ],
 	irn_flags => [ "modify_flags", "rematerializable" ],
@@ -415,6 +604,7 @@ xor_0 => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;",
 	attr      => "x86_insn_size_t size",
 	emit      => "xor%M %3D0, %3D0",
+	costs     => { latency => 1, uops => 1, throughput => 0.25 },
 },
 
 mov_imm => {
@@ -425,6 +615,11 @@ mov_imm => {
 	attr_type => "amd64_movimm_attr_t",
 	attr      => "x86_insn_size_t size, const amd64_imm64_t *imm",
 	emit      => 'mov%M $%C, %D0',
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.25 },
+		zen     => { throughput => 0.25 },
+	},
 },
 
 movs => {
@@ -435,6 +630,11 @@ movs => {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "movs%Mq %AM, %^D0",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.25 },
+		zen     => { throughput => 0.25 },
+	},
 },
 
 mov_gp => {
@@ -444,6 +644,11 @@ mov_gp => {
 	outs      => [ "res", "unused", "M" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.25 },
+		zen     => { throughput => 0.25 },
+	},
 },
 
 ijmp => {
@@ -455,6 +660,11 @@ ijmp => {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "jmp %*AM",
+	costs     => {
+		latency => 2, uops => 1, throughput => 2,
+		skylake => { throughput => 2 },
+		zen     => { throughput => 2 },
+	},
 },
 
 jmp => {
@@ -463,6 +673,11 @@ jmp => {
 	out_reqs => [ "exec" ],
 	fixed    => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
 	           ."x86_insn_size_t size    = X86_SIZE_64;\n",
+	costs    => {
+		latency => 1, uops => 1, throughput => 1,
+		skylake => { throughput => 1 },
+		zen     => { throughput => 0.5 },
+	},
 },
 
 cmp => {
@@ -474,6 +689,11 @@ cmp => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "cmp%M %AM",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.33,
+		skylake => { throughput => 0.25 },
+		zen     => { throughput => 0.25 },
+	},
 },
 
 cmpxchg => {
@@ -485,6 +705,11 @@ cmpxchg => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "lock cmpxchg%M %AM",
+	costs     => {
+		latency => 18, uops => 9, throughput => 18,
+		skylake => { latency => 18, uops => 10, throughput => 18 },
+		zen     => { latency => 8, uops => 8, throughput => 8 },
+	},
 },
 
 # TODO Setcc can also operate on memory
@@ -498,6 +723,21 @@ setcc => {
 	attr      => "x86_condition_code_t cc",
 	fixed     => "x86_insn_size_t size = X86_SIZE_8;",
 	emit      => "set%P0 %D0",
+	costs     => { latency => 1, uops => 1, throughput => 0.5 },
+},
+
+cmov => {
+	in_reqs   => [ "gp", "gp", "eflags" ],
+	out_reqs  => [ "in_r0 !in_r1" ],
+	ins       => [ "val_false", "val_true", "eflags" ],
+	outs      => [ "res" ],
+	attr_type => "amd64_cc_attr_t",
+	attr      => "x86_insn_size_t size, x86_condition_code_t cc",
+	emit      => "cmov%P0 %S1, %D0",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.5,
+		zen => { throughput => 0.25 },
+	},
 },
 
 lea => {
@@ -509,6 +749,10 @@ lea => {
 	attr      => "x86_insn_size_t size, x86_addr_t addr",
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;\n",
 	emit      => "lea%M %A, %D0",
+	costs     => {
+		latency => 1, uops => 1, throughput => 0.5,
+		zen => { throughput => 0.25 },
+	},
 },
 
 jcc => {
@@ -521,6 +765,7 @@ jcc => {
 	attr_type => "amd64_cc_attr_t",
 	attr      => "x86_condition_code_t cc",
 	fixed     => "x86_insn_size_t size = X86_SIZE_64;",
+	costs     => { latency => 1, uops => 1, throughput => 0.5 },
 },
 
 mov_store => {
@@ -532,6 +777,7 @@ mov_store => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "mov%M %AM",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
 },
 
 jmp_switch => {
@@ -541,6 +787,7 @@ jmp_switch => {
 	out_reqs  => "...",
 	attr_type => "amd64_switch_jmp_attr_t",
 	attr      => "amd64_op_mode_t op_mode, x86_insn_size_t size, const x86_addr_t *addr, const ir_switch_table *table, ir_entity *table_entity",
+	costs     => { latency => 2, uops => 2, throughput => 2 },
 },
 
 call => {
@@ -552,6 +799,11 @@ call => {
 	attr_type => "amd64_call_addr_attr_t",
 	attr      => "const amd64_call_addr_attr_t *attr_init",
 	emit      => "call %*AM",
+	costs     => {
+		latency => 3, uops => 3, throughput => 2,
+		skylake => { uops => 3, throughput => 2 },
+		zen     => { uops => 2, throughput => 2 },
+	},
 },
 
 ret => {
@@ -563,16 +815,76 @@ ret => {
 	fixed    => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
 	           ."x86_insn_size_t size    = X86_SIZE_64;\n",
 	emit     => "ret",
+	costs    => { latency => 2, uops => 2, throughput => 1 },
 },
 
 bsf => {
 	template => $unop_out,
 	emit => "bsf%M %AM, %D0",
+	costs    => {
+		zen => { latency => 3, uops => 6, throughput => 3 },
+	},
 },
 
 bsr => {
 	template => $unop_out,
 	emit => "bsr%M %AM, %D0",
+	costs    => {
+		zen => { latency => 4, uops => 7, throughput => 4 },
+	},
+},
+
+lzcnt => {
+	template => $unop_out,
+	emit => "lzcnt%M %AM, %D0",
+},
+
+popcnt => {
+	template => $unop_out,
+	emit => "popcnt%M %AM, %D0",
+},
+
+tzcnt => {
+	template => $unop_out,
+	emit => "tzcnt%M %AM, %D0",
+},
+
+bswap => {
+	irn_flags => [ "rematerializable" ],
+	in_reqs   => [ "gp" ],
+	out_reqs  => [ "in_r0" ],
+	ins       => [ "val" ],
+	outs      => [ "res" ],
+	attr_type => "amd64_addr_attr_t",
+	attr      => "x86_insn_size_t size",
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_REG;\n"
+	            ."x86_addr_t addr = { .base_input = 0, .variant = X86_ADDR_REG };",
+	emit      => "bswap%M %AM",
+	costs     => {
+		latency => 2, uops => 2, throughput => 1,
+		skylake => { latency => 2, uops => 2, throughput => 1 },
+		zen     => { latency => 1, uops => 1, throughput => 0.25 },
+	},
+},
+
+prefetcht0 => {
+	template => $prefetchop,
+	emit     => "prefetcht0 %A",
+},
+
+prefetcht1 => {
+	template => $prefetchop,
+	emit     => "prefetcht1 %A",
+},
+
+prefetcht2 => {
+	template => $prefetchop,
+	emit     => "prefetcht2 %A",
+},
+
+prefetchnta => {
+	template => $prefetchop,
+	emit     => "prefetchnta %A",
 },
 
 # SSE
@@ -585,12 +897,36 @@ adds => {
 divs => {
 	template => $binopx,
 	emit     => "divs%MX %AM",
+	costs    => {
+		latency => 14, uops => 1, throughput => 4,
+		zen => { latency => 13, throughput => 5 },
+	},
+},
+
+maxs => {
+	template => $binopx,
+	emit     => "maxs%MX %AM",
+	costs    => {
+		zen => { latency => 1 },
+	},
+},
+
+mins => {
+	template => $binopx,
+	emit     => "mins%MX %AM",
+	costs    => {
+		zen => { latency => 1 },
+	},
 },
 
 movs_xmm => {
 	template => $movopx,
 	attr     => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit     => "movs%MX %AM, %D0",
+	costs    => {
+		latency => 1, uops => 1, throughput => 0.33,
+		zen => { throughput => 0.25 },
+	},
 },
 
 muls => {
@@ -607,6 +943,7 @@ movs_store_xmm => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "movs%MX %^S0, %A",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
 },
 
 subs => {
@@ -623,6 +960,10 @@ ucomis => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "ucomis%MX %AM",
+	costs     => {
+		latency => 3, uops => 1, throughput => 1,
+		zen => { latency => 4 },
+	},
 },
 
 xorp_0 => {
@@ -633,11 +974,16 @@ xorp_0 => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;",
 	attr      => "x86_insn_size_t size",
 	emit      => "xorp%MX %^D0, %^D0",
+	costs     => { latency => 1, uops => 1, throughput => 0.25 },
 },
 
 xorp => {
 	template => $binopx_commutative,
 	emit     => "xorp%MX %AM",
+	costs    => {
+		latency => 1, uops => 1, throughput => 0.33,
+		zen => { throughput => 0.25 },
+	},
 },
 
 movd_xmm_gp => {
@@ -648,7 +994,11 @@ movd_xmm_gp => {
 	out_reqs  => [ "gp" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
-	emit      => "movd %S0, %D0"
+	emit      => "movd %S0, %D0",
+	costs     => {
+		latency => 2, uops => 1, throughput => 1,
+		zen => { latency => 3 },
+	},
 },
 
 movd_gp_xmm => {
@@ -659,7 +1009,11 @@ movd_gp_xmm => {
 	out_reqs  => [ "xmm" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
-	emit      => "movd %S0, %D0"
+	emit      => "movd %S0, %D0",
+	costs     => {
+		latency => 2, uops => 1, throughput => 1,
+		zen => { latency => 3 },
+	},
 },
 
 # Conversion operations
@@ -723,6 +1077,7 @@ movdqu_store => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "movdqu %^S0, %A",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
 },
 
 l_punpckldq => {
@@ -752,6 +1107,10 @@ l_haddpd => {
 punpckldq => {
 	template => $binopx,
 	emit     => "punpckldq %AM",
+	costs    => {
+		latency => 1, uops => 1, throughput => 1,
+		zen => { throughput => 0.5 },
+	},
 },
 
 subpd => {
@@ -762,6 +1121,10 @@ subpd => {
 haddpd => {
 	template => $binopx,
 	emit     => "haddpd %AM",
+	costs    => {
+		latency => 6, uops => 3, throughput => 2,
+		zen => { latency => 7, uops => 4 },
+	},
 },
 
 fldz => {
@@ -784,6 +1147,7 @@ fld => {
 	attr_type => "amd64_x87_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "fld%FM %AM",
+	costs     => { latency => 1, uops => 1, throughput => 0.5 },
 },
 
 fild => {
@@ -796,11 +1160,16 @@ fild => {
 	attr_type => "amd64_x87_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "fild%M %AM",
+	costs     => {
+		latency => 5, uops => 1, throughput => 1,
+		zen => { latency => 6 },
+	},
 },
 
 fisttp => {
 	template => $x87store,
 	emit     => "fisttp%M %AM",
+	costs    => { latency => 5, uops => 3, throughput => 2 },
 },
 
 fst => {
@@ -821,6 +1190,11 @@ fadd => {
 fdiv => {
 	template => $x87binop,
 	emit     => "fdiv%FR%FP %AF",
+	costs    => {
+		latency => 15, uops => 1, throughput => 5,
+		skylake => { latency => 15, throughput => 4 },
+		zen     => { latency => 15, throughput => 6 },
+	},
 },
 
 fmul => {
@@ -836,6 +1210,7 @@ fsub => {
 fchs => {
 	template => $x87unop,
 	emit     => "fchs",
+	costs    => { latency => 1, uops => 1, throughput => 1 },
 },
 
 fucomi => {
@@ -846,6 +1221,7 @@ fucomi => {
 	outs      => [ "flags" ],
 	attr_type => "amd64_x87_attr_t",
 	emit      => "fucom%FPi %F0",
+	costs     => { latency => 3, uops => 1, throughput => 1 },
 },
 
 fdup => {
@@ -857,6 +1233,7 @@ fdup => {
 	attr        => "const arch_register_t *reg",
 	init        => "attr->x87.reg = reg;",
 	emit        => "fld %F0",
+	costs       => { latency => 1, uops => 1, throughput => 0.5 },
 },
 
 fxch => {
@@ -867,6 +1244,7 @@ fxch => {
 	attr        => "const arch_register_t *reg",
 	init        => "attr->x87.reg = reg;",
 	emit        => "fxch %F0",
+	costs       => { latency => 1, uops => 1, throughput => 0.5 },
 },
 
 fpop => {
@@ -877,6 +1255,7 @@ fpop => {
 	attr        => "const arch_register_t *reg",
 	init        => "attr->x87.reg = reg;",
 	emit        => "fstp %F0",
+	costs       => { latency => 1, uops => 1, throughput => 0.5 },
 },
 
 );
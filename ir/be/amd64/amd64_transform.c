@@ -41,28 +41,6 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 static x86_cconv_t    *current_cconv = NULL;
 static be_stack_env_t  stack_env;
 
-/** we don't have a concept of aliasing registers, so enumerate them
- * manually for the asm nodes. */
-const x86_clobber_name_t amd64_additional_clobber_names[] = {
-	{ "al", REG_RAX }, { "ah", REG_RAX }, { "ax", REG_RAX }, { "eax", REG_RAX },
-	{ "bl", REG_RBX }, { "bh", REG_RBX }, { "bx", REG_RBX }, { "ebx", REG_RBX },
-	{ "cl", REG_RCX }, { "ch", REG_RCX }, { "cx", REG_RCX }, { "ecx", REG_RCX },
-	{ "dl", REG_RDX }, { "dh", REG_RDX }, { "dx", REG_RDX }, { "edx", REG_RDX },
-	{ "sil",  REG_RSI }, { "si",   REG_RSI }, { "esi",  REG_RSI },
-	{ "dil",  REG_RDI }, { "di",   REG_RDI }, { "edi",  REG_RDI },
-	{ "bpl",  REG_RBP }, { "bp",   REG_RBP }, { "ebp",  REG_RBP },
-	{ "spl",  REG_RSP }, { "sp",   REG_RSP }, { "esp",  REG_RSP },
-	{ "r8b",  REG_R8  }, { "r8w",  REG_R8  }, { "r8d",  REG_R8  },
-	{ "r9b",  REG_R9  }, { "r9w",  REG_R9  }, { "r9d",  REG_R9  },
-	{ "r10b", REG_R10 }, { "r10w", REG_R10 }, { "r10d", REG_R10 },
-	{ "r11b", REG_R11 }, { "r11w", REG_R11 }, { "r11d", REG_R11 },
-	{ "r12b", REG_R12 }, { "r12w", REG_R12 }, { "r12d", REG_R12 },
-	{ "r13b", REG_R13 }, { "r13w", REG_R13 }, { "r13d", REG_R13 },
-	{ "r14b", REG_R14 }, { "r14w", REG_R14 }, { "r14d", REG_R14 },
-	{ "r15b", REG_R15 }, { "r15w", REG_R15 }, { "r15d", REG_R15 },
-	{ NULL, ~0u }
-};
-
 #define GP &amd64_reg_classes[CLASS_amd64_gp]
 const x86_asm_constraint_list_t amd64_asm_constraints = {
 	['A'] = { MATCH_REG, GP, 1 << REG_GP_RAX | 1 << REG_GP_RDX },
@@ -235,12 +213,24 @@ static const arch_register_req_t *reg_rax_rdx_mem_reqs[] = {
 	&arch_memory_requirement,
 };
 
+static const arch_register_req_t *rax_mem_reqs[] = {
+	&amd64_single_reg_req_gp_rax,
+	&arch_memory_requirement,
+};
+
 static const arch_register_req_t *rax_reg_mem_reqs[] = {
 	&amd64_single_reg_req_gp_rax,
 	&amd64_class_reg_req_gp,
 	&arch_memory_requirement,
 };
 
+static const arch_register_req_t *rax_reg_reg_mem_reqs[] = {
+	&amd64_single_reg_req_gp_rax,
+	&amd64_class_reg_req_gp,
+	&amd64_class_reg_req_gp,
+	&arch_memory_requirement,
+};
+
 static const arch_register_req_t *reg_rax_reg_mem_reqs[] = {
 	&amd64_class_reg_req_gp,
 	&amd64_single_reg_req_gp_rax,
@@ -281,6 +271,13 @@ arch_register_req_t const **const gp_am_reqs[] = {
 	reg_reg_reg_mem_reqs,
 };
 
+static arch_register_req_t const **const rax_am_reqs[] = {
+	NULL,
+	rax_mem_reqs,
+	rax_reg_mem_reqs,
+	rax_reg_reg_mem_reqs,
+};
+
 static arch_register_req_t const **const xmm_am_reqs[] = {
 	mem_reqs,
 	xmm_mem_reqs,
@@ -381,6 +378,7 @@ static ir_node *create_float_const(dbg_info *dbgi, ir_node *block,
 		pn_res = pn_amd64_movs_xmm_res;
 	}
 	set_irn_pinned(load, false);
+	arch_add_irn_flags(load, arch_irn_flag_rematerializable);
 
 	return be_new_Proj(load, pn_res);
 }
@@ -524,6 +522,9 @@ typedef enum match_flags_t {
 	match_mode_neutral = 1 << 1,
 	match_immediate    = 1 << 2,
 	match_commutative  = 1 << 3,
+	/** The operation only produces flags, so a memory operand may be combined
+	 * with an immediate. */
+	match_am_immediate = 1 << 4,
 } match_flags_t;
 
 typedef struct amd64_args_t {
@@ -555,12 +556,18 @@ static bool match_immediate_32(x86_imm32_t *const imm, ir_node const *const op,
 		val = 0;
 	}
 
-	if ((entity != NULL) != must_match_ip_relative)
+	if (must_match_ip_relative && entity == NULL)
 		return false;
 
 	x86_immediate_kind_t kind = (x86_immediate_kind_t)reloc_kind;
 	if (entity != NULL) {
-		if (kind == X86_IMM_VALUE || kind == X86_IMM_ADDR) {
+		if (!must_match_ip_relative) {
+			/* Address nodes only survive without PIC, where the small code
+			 * model allows sign extended 32bit absolute addresses. */
+			if (kind != X86_IMM_VALUE && kind != X86_IMM_ADDR)
+				return false;
+			kind = X86_IMM_ADDR;
+		} else if (kind == X86_IMM_VALUE || kind == X86_IMM_ADDR) {
 			kind = X86_IMM_PCREL;
 		} else if (kind != X86_IMM_PCREL && kind != X86_IMM_PLT)
 			return false;
@@ -668,40 +675,45 @@ static bool use_address_matching(ir_mode *mode, match_flags_t flags,
 	return false;
 }
 
-static void perform_address_matching(ir_node *ptr, int *arity,
-                                     ir_node **in, x86_addr_t *addr)
+static void set_address(x86_address_t const *const maddr, int *arity,
+                        ir_node **in, x86_addr_t *addr)
 {
-	x86_address_t maddr;
-	memset(&maddr, 0, sizeof(maddr));
-	x86_create_address_mode(&maddr, ptr, x86_create_am_normal);
-
-	x86_addr_variant_t variant = maddr.variant;
+	x86_addr_variant_t variant = maddr->variant;
 	assert(variant != X86_ADDR_INVALID);
 	if (x86_addr_variant_has_base(variant)) {
 		int base_input   = (*arity)++;
 		addr->base_input = base_input;
-		in[base_input]   = be_transform_node(maddr.base);
+		in[base_input]   = be_transform_node(maddr->base);
 	} else {
-		assert(maddr.base == NULL);
+		assert(maddr->base == NULL);
 	}
 	if (x86_addr_variant_has_index(variant)) {
 		int index_input   = (*arity)++;
 		addr->index_input = index_input;
-		in[index_input]   = be_transform_node(maddr.index);
+		in[index_input]   = be_transform_node(maddr->index);
 	} else {
-		assert(maddr.index == NULL);
+		assert(maddr->index == NULL);
 	}
-	ir_entity *entity = maddr.imm.entity;
+	ir_entity *entity = maddr->imm.entity;
 	if (entity != NULL && is_parameter_entity(entity) &&
 		get_entity_parameter_number(entity) == IR_VA_START_PARAMETER_NUMBER)
 		panic("perform_address_matching: Request for invalid parameter (va_start parameter)");
 
 	addr->segment   = X86_SEGMENT_DEFAULT;
-	addr->immediate = maddr.imm;
-	addr->log_scale = maddr.scale;
+	addr->immediate = maddr->imm;
+	addr->log_scale = maddr->scale;
 	addr->variant   = variant;
 }
 
+static void perform_address_matching(ir_node *ptr, int *arity,
+                                     ir_node **in, x86_addr_t *addr)
+{
+	x86_address_t maddr;
+	memset(&maddr, 0, sizeof(maddr));
+	x86_create_address_mode(&maddr, ptr, x86_create_am_normal);
+	set_address(&maddr, arity, in, addr);
+}
+
 static void match_binop(amd64_args_t *args, ir_node *block,
                         ir_mode *mode, ir_node *op1, ir_node *op2,
                         match_flags_t flags)
@@ -733,6 +745,24 @@ static void match_binop(amd64_args_t *args, ir_node *block,
 	if (use_immediate && match_immediate_32(&attr->u.immediate, op2, false)) {
 		assert(!use_xmm && "Can't (yet) match binop with xmm immediate");
 		/* fine, we found an immediate */
+		ir_node *load1;
+		ir_node *imm_op;
+		if ((flags & match_am_immediate)
+		 && use_address_matching(mode, flags & ~match_commutative, block, op2, op1, &load1, &imm_op)) {
+			/* memory operand combined with the immediate */
+			ir_node *ptr = get_Load_ptr(load1);
+			perform_address_matching(ptr, &(args->arity), args->in, addr);
+
+			ir_node *new_mem    = be_transform_node(get_Load_mem(load1));
+			int mem_input       = args->arity++;
+			args->in[mem_input] = new_mem;
+			addr->mem_input     = mem_input;
+
+			args->reqs              = gp_am_reqs[args->arity - 1];
+			args->mem_proj          = get_Proj_for_pn(load1, pn_Load_M);
+			attr->base.base.op_mode = AMD64_OP_ADDR_IMM;
+			return;
+		}
 		int const reg_input = args->arity++;
 		args->in[reg_input]     = be_transform_node(op1);
 		addr->variant           = X86_ADDR_REG;
@@ -837,7 +867,7 @@ static ir_node *gen_binop_rax(ir_node *node, ir_node *op0, ir_node *op1,
 		ir_node *ptr = get_Load_ptr(load);
 		perform_address_matching(ptr, &arity, in, &addr);
 
-		reqs = gp_am_reqs[arity];
+		reqs = rax_am_reqs[arity];
 
 		ir_node *new_mem = be_transform_node(get_Load_mem(load));
 		int mem_input    = arity++;
@@ -1010,27 +1040,23 @@ static ir_node *create_add_lea(dbg_info *dbgi, ir_node *new_block,
 	                        amd64_reg_reg_reqs, size, addr);
 }
 
-static ir_node *match_simple_lea(dbg_info *dbgi, ir_node *new_block,
-                                 x86_insn_size_t size, ir_node *op1,
-                                 ir_node *op2)
+static ir_node *create_lea_from_address(dbg_info *dbgi, ir_node *new_block,
+                                        x86_insn_size_t size,
+                                        x86_address_t const *maddr)
 {
-	x86_imm32_t immediate;
-	memset(&immediate, 0, sizeof(immediate));
-	if (match_immediate_32(&immediate, op2, false)) {
-		ir_node *in[] = {
-			be_transform_node(op1)
-		};
-		x86_addr_t addr = {
-			.immediate = immediate,
-			.variant   = X86_ADDR_BASE,
-		};
-		return new_bd_amd64_lea(dbgi, new_block, ARRAY_SIZE(in), in, reg_reqs,
-		                        size, addr);
-	} else {
-		ir_node *const new_op1 = be_transform_node(op1);
-		ir_node *const new_op2 = be_transform_node(op2);
-		return create_add_lea(dbgi, new_block, size, new_op1, new_op2);
-	}
+	ir_node   *in[2];
+	int        arity = 0;
+	x86_addr_t addr;
+	memset(&addr, 0, sizeof(addr));
+	set_address(maddr, &arity, in, &addr);
+	arch_register_req_t const **const reqs
+		= arity == 0 ? NULL : arity == 1 ? reg_reqs : amd64_reg_reg_reqs;
+	return new_bd_amd64_lea(dbgi, new_block, arity, in, reqs, size, addr);
+}
+
+static bool am_has_immediates(x86_address_t const *const addr)
+{
+	return addr->imm.offset != 0 || addr->imm.entity != NULL;
 }
 
 static ir_node *gen_Add(ir_node *const node)
@@ -1047,27 +1073,63 @@ static ir_node *gen_Add(ir_node *const node)
 		                    pn_amd64_adds_res, match_commutative | match_am);
 	}
 
+	x86_mark_non_am(node);
+
+	/* Rules for an Add:
+	 *   0. Immediate trees (Add(Address, Const)) -> mov or rip relative lea
+	 *   1. Add with immediate -> lea
+	 *   2. Add with possible source address mode -> add
+	 *   3. Otherwise -> lea with all folded address operands */
+	x86_address_t maddr;
+	memset(&maddr, 0, sizeof(maddr));
+	x86_create_address_mode(&maddr, node, x86_create_am_force);
+
+	x86_insn_size_t const size = get_mode_size_bits(mode) <= 32
+	                             ? X86_SIZE_32 : X86_SIZE_64;
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_node(block);
+
+	/* a constant? */
+	if (maddr.base == NULL && maddr.index == NULL) {
+		if (maddr.variant == X86_ADDR_RIP)
+			return create_lea_from_address(dbgi, new_block, size, &maddr);
+		amd64_imm64_t const imm = {
+			.kind   = maddr.imm.kind,
+			.entity = maddr.imm.entity,
+			.offset = maddr.imm.offset,
+		};
+		return new_bd_amd64_mov_imm(dbgi, new_block, size, &imm);
+	}
+
+	/* add with immediate? */
+	ir_node *add_immediate_op = NULL;
+	if (maddr.index == NULL) {
+		add_immediate_op = maddr.base;
+	} else if (maddr.base == NULL && maddr.scale == 0) {
+		add_immediate_op = maddr.index;
+	}
+	if (add_immediate_op != NULL) {
+		if (!am_has_immediates(&maddr))
+			return be_transform_node(add_immediate_op);
+		if (maddr.base == NULL) {
+			maddr.base    = maddr.index;
+			maddr.index   = NULL;
+			maddr.variant = X86_ADDR_BASE;
+		}
+		return create_lea_from_address(dbgi, new_block, size, &maddr);
+	}
+
+	/* test if we can use source address mode */
 	match_flags_t flags = match_immediate | match_am | match_mode_neutral
 	                    | match_commutative;
 	ir_node *load;
 	ir_node *op;
-	bool     use_am
-		= use_address_matching(mode, flags, block, op1, op2, &load, &op);
-
-	ir_node *res;
-	if (use_am)
-		res = gen_binop_am(node, op1, op2, new_bd_amd64_add, pn_amd64_add_res,
-		                   flags);
-	else {
-		x86_insn_size_t size = get_mode_size_bits(mode) <= 32
-		                       ? X86_SIZE_32 : X86_SIZE_64;
-		dbg_info *const dbgi      = get_irn_dbg_info(node);
-		ir_node  *const new_block = be_transform_node(block);
-		res = match_simple_lea(dbgi, new_block, size, op1, op2);
-	}
+	if (use_address_matching(mode, flags, block, op1, op2, &load, &op))
+		return gen_binop_am(node, op1, op2, new_bd_amd64_add, pn_amd64_add_res,
+		                    flags);
 
-	x86_mark_non_am(node);
-	return res;
+	/* otherwise construct a lea */
+	return create_lea_from_address(dbgi, new_block, size, &maddr);
 }
 
 static ir_node *gen_Sub(ir_node *const node)
@@ -1146,18 +1208,20 @@ static ir_node *gen_Mulh(ir_node *const node)
 	ir_node *const op2  = get_Mulh_right(node);
 	ir_mode *const mode = get_irn_mode(op1);
 
+	/* the one operand forms leave the high half of the product in rdx, for
+	 * 64bit operands this is the upper half of the 128bit result */
 	unsigned pn_res;
 	ir_node *new_node;
 	if (mode_is_signed(mode)) {
 		new_node = gen_binop_rax(node, op1, op2, new_bd_amd64_imul_1op,
-                        /* match_am TODO */
-                        match_mode_neutral | match_commutative);
-        pn_res = pn_amd64_imul_1op_res_high;
+		                         match_am | match_mode_neutral
+		                         | match_commutative);
+		pn_res = pn_amd64_imul_1op_res_high;
 	} else {
 		new_node = gen_binop_rax(node, op1, op2, new_bd_amd64_mul,
-                         /* match_am TODO */
-                         match_mode_neutral | match_commutative);
-        pn_res = pn_amd64_mul_res_high;
+		                         match_am | match_mode_neutral
+		                         | match_commutative);
+		pn_res = pn_amd64_mul_res_high;
 	}
 	return be_new_Proj(new_node, pn_res);
 }
@@ -1247,6 +1311,30 @@ static ir_node *create_sse_div(ir_node *const node, ir_mode *const mode,
 	return new_node;
 }
 
+static ir_node *gen_binop_xmm_noncommutative(ir_node *const node,
+                                              ir_node *const op1,
+                                              ir_node *const op2,
+                                              construct_binop_func const func,
+                                              unsigned const pn_res)
+{
+	ir_node *const block = get_nodes_block(node);
+	amd64_args_t   args;
+	match_binop(&args, block, get_irn_mode(node), op1, op2, match_am);
+
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_node(block);
+	ir_node  *const new_node  = func(dbgi, new_block, args.arity, args.in,
+	                                 args.reqs, &args.attr);
+	fix_node_mem_proj(new_node, args.mem_proj);
+
+	/* the operands cannot be swapped, see create_sse_div() */
+	arch_register_req_t const *const req = args.reqs == amd64_xmm_xmm_reqs
+		? &amd64_requirement_xmm_same_0_not_1
+		: &amd64_requirement_xmm_same_0;
+	arch_set_irn_register_req_out(new_node, 0, req);
+	return be_new_Proj(new_node, pn_res);
+}
+
 static ir_node *gen_Div(ir_node *const node)
 {
 	ir_mode *const mode = get_Div_resmode(node);
@@ -1887,6 +1975,7 @@ no_call_mem:;
 					},
 					.variant    = X86_ADDR_BASE,
 					.base_input = 1,
+					.mem_input  = 2,
 				},
 			},
 		};
@@ -2051,7 +2140,7 @@ static ir_node *gen_Cmp(ir_node *const node)
 		match_binop(&args, block, cmp_mode, op1, op2, match_am);
 		new_node = new_bd_amd64_ucomis(dbgi, new_block, args.arity, args.in, args.reqs, &args.attr);
 	} else {
-		match_binop(&args, block, cmp_mode, op1, op2, match_immediate | match_am);
+		match_binop(&args, block, cmp_mode, op1, op2, match_immediate | match_am | match_am_immediate);
 		new_node = new_bd_amd64_cmp(dbgi, new_block, args.arity, args.in, args.reqs, &args.attr);
 	}
 
@@ -2059,9 +2148,8 @@ static ir_node *gen_Cmp(ir_node *const node)
 	return be_new_Proj(new_node, pn_amd64_cmp_flags);
 }
 
-static ir_node *get_flags_node(ir_node *cmp, x86_condition_code_t *cc_out)
+x86_condition_code_t amd64_get_cmp_condition_code(ir_node const *const cmp)
 {
-	/* must have a Cmp as input */
 	ir_relation       relation = get_Cmp_relation(cmp);
 	ir_node    *const l        = get_Cmp_left(cmp);
 	ir_node    *const r        = get_Cmp_right(cmp);
@@ -2077,10 +2165,15 @@ static ir_node *get_flags_node(ir_node *cmp, x86_condition_code_t *cc_out)
 		relation |= get_negated_relation(ir_get_possible_cmp_relations(l, r)) & ir_relation_less_greater;
 
 	bool const overflow_possible = !is_Const(r) || !is_Const_null(r);
+	return ir_relation_to_x86_condition_code(relation, mode,
+	                                         overflow_possible);
+}
 
+static ir_node *get_flags_node(ir_node *cmp, x86_condition_code_t *cc_out)
+{
+	/* must have a Cmp as input */
+	*cc_out = amd64_get_cmp_condition_code(cmp);
 	/* just do a normal transformation of the Cmp */
-	*cc_out = ir_relation_to_x86_condition_code(relation, mode,
-	                                            overflow_possible);
 	ir_node *flags = be_transform_node(cmp);
 	return flags;
 }
@@ -2095,10 +2188,109 @@ static ir_node *gen_Cond(ir_node *const node)
 	return new_bd_amd64_jcc(dbgi, block, flags, cc);
 }
 
+ir_relation amd64_mux_is_float_min_max(ir_node const *const sel,
+                                       ir_node *const mux_true,
+                                       ir_node *const mux_false,
+                                       ir_node **const op1,
+                                       ir_node **const op2)
+{
+	if (!is_Cmp(sel))
+		return ir_relation_false;
+	ir_node *l = get_Cmp_left(sel);
+	ir_node *r = get_Cmp_right(sel);
+	ir_mode *const mode = get_irn_mode(l);
+	if (!mode_is_float(mode) || mode == x86_mode_E)
+		return ir_relation_false;
+
+	/* mins/maxs return the second operand if the operands are unordered or
+	 * equal, which matches the C semantics of Mux(a < b, a, b) and
+	 * Mux(a > b, a, b) only. */
+	ir_relation relation = get_Cmp_relation(sel);
+	if (mux_true == r && mux_false == l) {
+		ir_node *const tmp = l;
+		l        = r;
+		r        = tmp;
+		relation = get_inversed_relation(relation);
+	} else if (mux_true != l || mux_false != r) {
+		return ir_relation_false;
+	}
+	if (relation != ir_relation_less && relation != ir_relation_greater)
+		return ir_relation_false;
+
+	*op1 = l;
+	*op2 = r;
+	return relation;
+}
+
+static ir_node *gen_Mux(ir_node *const node)
+{
+	ir_node  *const sel       = get_Mux_sel(node);
+	ir_node  *const mux_true  = get_Mux_true(node);
+	ir_node  *const mux_false = get_Mux_false(node);
+	ir_mode  *const mode      = get_irn_mode(node);
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+
+	if (mode_is_float(mode)) {
+		ir_node *op1;
+		ir_node *op2;
+		switch (amd64_mux_is_float_min_max(sel, mux_true, mux_false, &op1,
+		                                   &op2)) {
+		case ir_relation_less:
+			return gen_binop_xmm_noncommutative(node, op1, op2,
+			                                    new_bd_amd64_mins,
+			                                    pn_amd64_mins_res);
+		case ir_relation_greater:
+			return gen_binop_xmm_noncommutative(node, op1, op2,
+			                                    new_bd_amd64_maxs,
+			                                    pn_amd64_maxs_res);
+		default:
+			panic("cannot transform floating point Mux %+F", node);
+		}
+	}
+
+	assert(mode_needs_gp_reg(mode));
+	x86_condition_code_t cc;
+	ir_node *const flags     = get_flags_node(sel, &cc);
+	ir_node *const new_block = be_transform_nodes_block(node);
+	if (is_Const(mux_true) && is_Const(mux_false)) {
+		bool set = false;
+		if (is_Const_one(mux_true) && is_Const_null(mux_false)) {
+			set = true;
+		} else if (is_Const_null(mux_true) && is_Const_one(mux_false)) {
+			cc  = x86_negate_condition_code(cc);
+			set = true;
+		}
+		if (set && !(cc & x86_cc_additional_float_cases)) {
+			ir_node *const setcc
+				= new_bd_amd64_setcc(dbgi, new_block, flags, cc);
+			if (get_mode_size_bits(mode) <= 8)
+				return setcc;
+
+			/* movzbl setcc, res */
+			ir_node   *const movzbl_in[] = { setcc };
+			x86_addr_t const movzbl_addr = {
+				.base_input = 0,
+				.variant    = X86_ADDR_REG,
+			};
+			ir_node *const movzbl
+				= new_bd_amd64_mov_gp(dbgi, new_block, ARRAY_SIZE(movzbl_in),
+				                      movzbl_in, reg_reqs, X86_SIZE_8,
+				                      AMD64_OP_REG, movzbl_addr);
+			return be_new_Proj(movzbl, pn_amd64_mov_gp_res);
+		}
+	}
+
+	ir_node        *const new_false = be_transform_node(mux_false);
+	ir_node        *const new_true  = be_transform_node(mux_true);
+	x86_insn_size_t const size      = get_mode_size_bits(mode) > 32
+	                                  ? X86_SIZE_64 : X86_SIZE_32;
+	return new_bd_amd64_cmov(dbgi, new_block, new_false, new_true, flags, size,
+	                         cc);
+}
+
 static ir_node *gen_ASM(ir_node *const node)
 {
-	return x86_match_ASM(node, amd64_additional_clobber_names,
-	                     &amd64_asm_constraints);
+	return x86_match_ASM(node, &amd64_asm_constraints);
 }
 
 static ir_node *gen_Phi(ir_node *const node)
@@ -2539,8 +2731,246 @@ static ir_node *gen_Conv(ir_node *const node)
 	return be_new_Proj(conv, pn_res);
 }
 
+static const unsigned pn_amd64_mem = 2;
+
+/**
+ * Returns the Load producing @p op if the Load, the operation and a Store with
+ * pointer @p ptr and memory @p mem can be merged into a single
+ * read-modify-write instruction.
+ */
+static ir_node *dest_am_possible(ir_node *const block, ir_node *const op,
+                                 ir_node *const other, ir_node *const ptr,
+                                 ir_node *const mem)
+{
+	ir_node *const load = source_am_possible(block, op);
+	if (load == NULL || get_Load_ptr(load) != ptr)
+		return NULL;
+	if (get_Load_volatility(load) == volatility_is_volatile
+	 || ir_throws_exception(load))
+		return NULL;
+	/* the Store has to follow the Load directly in the memory chain */
+	if (!is_Proj(mem) || get_Proj_pred(mem) != load)
+		return NULL;
+	if (other != NULL && input_depends_on_load(load, other))
+		return NULL;
+	return load;
+}
+
+static ir_node *finish_dest_am(ir_node *const load, ir_node *const new_node)
+{
+	/* the memory Proj of the Load is now produced by the new node */
+	be_set_transformed_node(load, new_node);
+	return new_node;
+}
+
+static ir_node *dest_am_binop(ir_node *const node, ir_node *op1, ir_node *op2,
+                              construct_binop_func const func,
+                              match_flags_t const flags)
+{
+	ir_node *const block = get_nodes_block(node);
+	ir_node *const ptr   = get_Store_ptr(node);
+	ir_node *const mem   = get_Store_mem(node);
+	ir_node       *load  = dest_am_possible(block, op1, op2, ptr, mem);
+	if (load == NULL) {
+		if (!(flags & match_commutative))
+			return NULL;
+		ir_node *const tmp = op1;
+		op1  = op2;
+		op2  = tmp;
+		load = dest_am_possible(block, op1, op2, ptr, mem);
+		if (load == NULL)
+			return NULL;
+	}
+
+	amd64_binop_addr_attr_t attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.base.base.size = x86_size_from_mode(get_irn_mode(op1));
+
+	ir_node *in[4];
+	int      arity = 0;
+	if (match_immediate_32(&attr.u.immediate, op2, false)) {
+		attr.base.base.op_mode = AMD64_OP_ADDR_IMM;
+	} else {
+		/* only the lower bits of the register are used */
+		attr.base.base.op_mode = AMD64_OP_ADDR_REG;
+		int const reg_input = arity++;
+		in[reg_input]    = be_transform_node(be_skip_downconv(op2, true));
+		attr.u.reg_input = reg_input;
+	}
+	perform_address_matching(ptr, &arity, in, &attr.base.addr);
+
+	int const mem_input = arity++;
+	in[mem_input]            = be_transform_node(get_Load_mem(load));
+	attr.base.addr.mem_input = mem_input;
+
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_node(block);
+	ir_node  *const new_node
+		= func(dbgi, new_block, arity, in, gp_am_reqs[arity - 1], &attr);
+	/* the result of the operation is not needed anymore */
+	arch_set_irn_register_req_out(new_node, 0, arch_no_register_req);
+	return finish_dest_am(load, new_node);
+}
+
+static ir_node *dest_am_shift(ir_node *const node, ir_node *const op1,
+                              ir_node *op2, construct_binop_func const func)
+{
+	ir_mode *const mode = get_irn_mode(op1);
+	unsigned const bits = get_mode_size_bits(mode);
+	if (bits < 32 || get_mode_modulo_shift(mode) != bits)
+		return NULL;
+
+	/* only the lowest 5/6 bits of the shift count are used */
+	while (is_Conv(op2) && get_irn_n_edges(op2) == 1) {
+		ir_node *const op = get_Conv_op(op2);
+		if (get_mode_arithmetic(get_irn_mode(op)) != irma_twos_complement)
+			break;
+		op2 = op;
+	}
+	if (!is_Const(op2))
+		return NULL;
+
+	ir_node *const block = get_nodes_block(node);
+	ir_node *const ptr   = get_Store_ptr(node);
+	ir_node *const mem   = get_Store_mem(node);
+	ir_node *const load  = dest_am_possible(block, op1, NULL, ptr, mem);
+	if (load == NULL)
+		return NULL;
+
+	amd64_binop_addr_attr_t attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.base.base.op_mode  = AMD64_OP_ADDR_IMM;
+	attr.base.base.size     = x86_size_from_mode(mode);
+	attr.u.immediate.kind   = X86_IMM_VALUE;
+	attr.u.immediate.offset = get_Const_long(op2) & (bits - 1);
+
+	ir_node *in[3];
+	int      arity = 0;
+	perform_address_matching(ptr, &arity, in, &attr.base.addr);
+	int const mem_input = arity++;
+	in[mem_input]            = be_transform_node(get_Load_mem(load));
+	attr.base.addr.mem_input = mem_input;
+
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_node(block);
+	ir_node  *const new_node
+		= func(dbgi, new_block, arity, in, gp_am_reqs[arity - 1], &attr);
+	return finish_dest_am(load, new_node);
+}
+
+typedef ir_node *(*construct_unop_mem_func)(dbg_info *dbgi, ir_node *block, int arity, ir_node *const *in, arch_register_req_t const **in_reqs, x86_insn_size_t size, x86_addr_t addr);
+
+static ir_node *dest_am_unop(ir_node *const node, ir_node *const op,
+                             construct_unop_mem_func const func)
+{
+	ir_node *const block = get_nodes_block(node);
+	ir_node *const ptr   = get_Store_ptr(node);
+	ir_node *const mem   = get_Store_mem(node);
+	ir_node *const load  = dest_am_possible(block, op, NULL, ptr, mem);
+	if (load == NULL)
+		return NULL;
+
+	x86_addr_t addr;
+	memset(&addr, 0, sizeof(addr));
+	ir_node *in[3];
+	int      arity = 0;
+	perform_address_matching(ptr, &arity, in, &addr);
+	int const mem_input = arity++;
+	in[mem_input]  = be_transform_node(get_Load_mem(load));
+	addr.mem_input = mem_input;
+
+	dbg_info       *const dbgi      = get_irn_dbg_info(node);
+	ir_node        *const new_block = be_transform_node(block);
+	x86_insn_size_t const size      = x86_size_from_mode(get_irn_mode(op));
+	ir_node        *const new_node
+		= func(dbgi, new_block, arity, in, gp_am_reqs[arity - 1], size, addr);
+	return finish_dest_am(load, new_node);
+}
+
+/**
+ * Tries to merge a Store with the operation producing its value and the Load
+ * feeding that operation into a read-modify-write instruction.
+ */
+static ir_node *try_create_dest_am(ir_node *const node)
+{
+	ir_node *const val  = get_Store_value(node);
+	ir_mode *const mode = get_irn_mode(val);
+	if (!mode_needs_gp_reg(mode))
+		return NULL;
+	if (get_Store_volatility(node) == volatility_is_volatile
+	 || ir_throws_exception(node))
+		return NULL;
+	/* the Store must be the only user of the value */
+	if (get_irn_n_edges(val) > 1)
+		return NULL;
+	if (get_nodes_block(val) != get_nodes_block(node))
+		return NULL;
+
+	ir_node *new_node;
+	switch (get_irn_opcode(val)) {
+	case iro_Add: {
+		ir_node *const op1 = get_Add_left(val);
+		ir_node *const op2 = get_Add_right(val);
+		if (is_Const(op2) && is_Const_one(op2)) {
+			new_node = dest_am_unop(node, op1, new_bd_amd64_inc_mem);
+		} else if (is_Const(op2) && is_Const_all_one(op2)) {
+			new_node = dest_am_unop(node, op1, new_bd_amd64_dec_mem);
+		} else {
+			new_node = dest_am_binop(node, op1, op2, new_bd_amd64_add,
+			                         match_commutative);
+		}
+		break;
+	}
+	case iro_Sub:
+		new_node = dest_am_binop(node, get_Sub_left(val), get_Sub_right(val),
+		                         new_bd_amd64_sub, 0);
+		break;
+	case iro_And:
+		new_node = dest_am_binop(node, get_And_left(val), get_And_right(val),
+		                         new_bd_amd64_and, match_commutative);
+		break;
+	case iro_Or:
+		new_node = dest_am_binop(node, get_Or_left(val), get_Or_right(val),
+		                         new_bd_amd64_or, match_commutative);
+		break;
+	case iro_Eor:
+		new_node = dest_am_binop(node, get_Eor_left(val), get_Eor_right(val),
+		                         new_bd_amd64_xor, match_commutative);
+		break;
+	case iro_Shl:
+		new_node = dest_am_shift(node, get_Shl_left(val), get_Shl_right(val),
+		                         new_bd_amd64_shl_mem);
+		break;
+	case iro_Shr:
+		new_node = dest_am_shift(node, get_Shr_left(val), get_Shr_right(val),
+		                         new_bd_amd64_shr_mem);
+		break;
+	case iro_Shrs:
+		new_node = dest_am_shift(node, get_Shrs_left(val), get_Shrs_right(val),
+		                         new_bd_amd64_sar_mem);
+		break;
+	case iro_Minus:
+		new_node = dest_am_unop(node, get_Minus_op(val), new_bd_amd64_neg_mem);
+		break;
+	case iro_Not:
+		new_node = dest_am_unop(node, get_Not_op(val), new_bd_amd64_not_mem);
+		break;
+	default:
+		return NULL;
+	}
+	if (new_node == NULL)
+		return NULL;
+
+	set_irn_pinned(new_node, get_irn_pinned(node));
+	return be_new_Proj(new_node, pn_amd64_mem);
+}
+
 static ir_node *gen_Store(ir_node *const node)
 {
+	ir_node *const dest_am = try_create_dest_am(node);
+	if (dest_am != NULL)
+		return dest_am;
+
 	dbg_info *const dbgi  = get_irn_dbg_info(node);
 	ir_node  *const block = be_transform_nodes_block(node);
 	ir_node  *const val   = get_Store_value(node);
@@ -2607,6 +3037,7 @@ ir_node *amd64_new_spill(ir_node *const value, ir_node *const after)
 				.immediate.kind = X86_IMM_FRAMEENT,
 				.variant        = X86_ADDR_BASE,
 				.base_input     = 1,
+				.mem_input      = 2,
 			},
 		},
 		.u.reg_input = 0,
@@ -2633,6 +3064,52 @@ static ir_node *create_sse_spill(dbg_info *const dbgi, ir_node *const block,
 	return new_bd_amd64_movdqu(dbgi, block, arity, in, in_reqs, op_mode, addr);
 }
 
+/**
+ * Returns the number of bits of the register holding @p value that carry
+ * information. For gp values the remaining upper bits are known to be zero,
+ * for xmm values they are irrelevant to all users (scalar SSE values).
+ * Returns X86_SIZE_64 for gp and X86_SIZE_128 for xmm values if nothing is
+ * known about the producer.
+ */
+static x86_insn_size_t get_value_size(ir_node const *const value)
+{
+	ir_mode        *const mode   = get_irn_mode(value);
+	bool            const is_xmm = mode_is_float(mode) || mode == amd64_mode_xmm;
+	x86_insn_size_t const full   = is_xmm ? X86_SIZE_128 : X86_SIZE_64;
+	ir_node const  *const pred   = skip_Proj_const(value);
+	if (!is_amd64_irn(pred))
+		return full;
+
+	x86_insn_size_t const size = get_amd64_attr_const(pred)->size;
+	switch ((amd64_opcodes)get_amd64_irn_opcode(pred)) {
+	case iro_amd64_call:
+		/* the size of a call does not describe its results */
+	case iro_amd64_movs:
+		/* sign extends its 32bit operand */
+		return full;
+	case iro_amd64_mov_gp:
+		/* movzb/movzw/movl clear the upper bits */
+		return size < X86_SIZE_64 ? X86_SIZE_32 : full;
+	case iro_amd64_adds:
+	case iro_amd64_divs:
+	case iro_amd64_maxs:
+	case iro_amd64_mins:
+	case iro_amd64_movs_xmm:
+	case iro_amd64_muls:
+	case iro_amd64_subs:
+		return size;
+	case iro_amd64_cvtsd2ss:
+	case iro_amd64_cvtsi2ss:
+		return X86_SIZE_32;
+	case iro_amd64_cvtss2sd:
+	case iro_amd64_cvtsi2sd:
+		return X86_SIZE_64;
+	default:
+		/* 32bit operations on gp registers zero the upper half */
+		return !is_xmm && size == X86_SIZE_32 ? X86_SIZE_32 : full;
+	}
+}
+
 ir_node *amd64_new_reload(ir_node *value, ir_node *spill, ir_node *before)
 {
 	ir_node  *const block = get_block(before);
@@ -2657,12 +3134,17 @@ ir_node *amd64_new_reload(ir_node *value, ir_node *spill, ir_node *before)
 			cons   = &new_bd_amd64_fld;
 			pn_res = pn_amd64_fld_res;
 		} else {
-			size   = X86_SIZE_128;
-			cons   = &create_sse_spill;
-			pn_res = pn_amd64_movdqu_res;
+			size = get_value_size(value);
+			if (size == X86_SIZE_128) {
+				cons   = &create_sse_spill;
+				pn_res = pn_amd64_movdqu_res;
+			} else {
+				cons   = &new_bd_amd64_movs_xmm;
+				pn_res = pn_amd64_movs_xmm_res;
+			}
 		}
 	} else {
-		size   = X86_SIZE_64;
+		size   = get_value_size(value);
 		cons   = &new_bd_amd64_mov_gp;
 		pn_res = pn_amd64_mov_gp_res;
 	}
@@ -2722,8 +3204,6 @@ static ir_node *gen_Unknown(ir_node *const node)
 	}
 }
 
-static const unsigned pn_amd64_mem = 2;
-
 static ir_node *gen_Proj_Load(ir_node *const node)
 {
 	ir_node  *const load     = get_Proj_pred(node);
@@ -2773,6 +3253,18 @@ static ir_node *gen_Proj_Load(ir_node *const node)
 	case iro_amd64_add:
 	case iro_amd64_and:
 	case iro_amd64_cmp:
+	case iro_amd64_imul_1op:
+	case iro_amd64_mul:
+	case iro_amd64_or:
+	case iro_amd64_sub:
+	case iro_amd64_xor:
+	case iro_amd64_shl_mem:
+	case iro_amd64_shr_mem:
+	case iro_amd64_sar_mem:
+	case iro_amd64_inc_mem:
+	case iro_amd64_dec_mem:
+	case iro_amd64_neg_mem:
+	case iro_amd64_not_mem:
 		assert(pn == pn_Load_M);
 		return be_new_Proj(new_load, pn_amd64_mem);
 	default:
@@ -2859,6 +3351,10 @@ static ir_node *gen_Proj_Alloc(ir_node *const node)
 
 static ir_node *gen_clz(ir_node *const node)
 {
+	if (amd64_cg_config.use_lzcnt)
+		return gen_unop_out(node, n_Builtin_max + 1, new_bd_amd64_lzcnt,
+		                    pn_amd64_lzcnt_res);
+
 	ir_node         *const bsr   = gen_unop_out(node, n_Builtin_max + 1,
 	                                            new_bd_amd64_bsr, pn_amd64_bsr_res);
 	ir_node         *const real  = skip_Proj(bsr);
@@ -2892,10 +3388,193 @@ static ir_node *gen_clz(ir_node *const node)
 
 static ir_node *gen_ctz(ir_node *const node)
 {
+	/* tzcnt only differs from bsf for zero, which is undefined for ctz, but
+	 * is faster on some cpus */
+	if (amd64_cg_config.use_tzcnt)
+		return gen_unop_out(node, n_Builtin_max + 1, new_bd_amd64_tzcnt,
+		                    pn_amd64_tzcnt_res);
 	return gen_unop_out(node, n_Builtin_max + 1, new_bd_amd64_bsf,
 	                    pn_amd64_bsf_res);
 }
 
+static ir_node *gen_popcount(ir_node *const node)
+{
+	/* the popcount has been lowered to bit arithmetic if !use_popcnt */
+	assert(amd64_cg_config.use_popcnt);
+	return gen_unop_out(node, n_Builtin_max + 1, new_bd_amd64_popcnt,
+	                    pn_amd64_popcnt_res);
+}
+
+static ir_node *create_shr(dbg_info *dbgi, ir_node *const new_block,
+                           x86_insn_size_t size, ir_node *const value,
+                           int32_t immediate)
+{
+	amd64_shift_attr_t attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.base.op_mode = AMD64_OP_SHIFT_IMM;
+	attr.base.size    = size;
+	attr.immediate    = immediate;
+	ir_node *in[1]    = { value };
+	ir_node *const shr = new_bd_amd64_shr(dbgi, new_block, ARRAY_SIZE(in), in,
+	                                      reg_reqs, &attr);
+	arch_set_irn_register_req_out(shr, 0, &amd64_requirement_gp_same_0);
+	return be_new_Proj(shr, pn_amd64_shr_res);
+}
+
+static ir_node *create_xor(dbg_info *dbgi, ir_node *const new_block,
+                           x86_insn_size_t size, ir_node *const left,
+                           ir_node *const right)
+{
+	ir_node *const in[] = { left, right };
+	amd64_binop_addr_attr_t const attr = {
+		.base = {
+			.base = {
+				.op_mode = AMD64_OP_REG_REG,
+				.size    = size,
+			},
+			.addr = {
+				.base_input = 0,
+				.variant    = X86_ADDR_REG,
+			},
+		},
+		.u = {
+			.reg_input = 1,
+		},
+	};
+	ir_node *const xor = new_bd_amd64_xor(dbgi, new_block, ARRAY_SIZE(in), in,
+	                                      amd64_reg_reg_reqs, &attr);
+	arch_set_irn_register_req_out(xor, 0, &amd64_requirement_gp_same_0);
+	return xor;
+}
+
+/**
+ * Zero extends an 8 or 16bit @p value, whose upper register bits are
+ * undefined, to 32bit.
+ */
+static ir_node *create_zero_extension(dbg_info *const dbgi,
+                                      ir_node *const new_block,
+                                      x86_insn_size_t const size,
+                                      ir_node *const value)
+{
+	ir_node   *const in[] = { value };
+	x86_addr_t const addr = {
+		.base_input = 0,
+		.variant    = X86_ADDR_REG,
+	};
+	ir_node *const movzx = new_bd_amd64_mov_gp(dbgi, new_block, ARRAY_SIZE(in),
+	                                           in, reg_reqs, size,
+	                                           AMD64_OP_REG, addr);
+	return be_new_Proj(movzx, pn_amd64_mov_gp_res);
+}
+
+static ir_node *gen_parity(ir_node *const node)
+{
+	dbg_info        *const dbgi      = get_irn_dbg_info(node);
+	ir_node         *const new_block = be_transform_nodes_block(node);
+	ir_node         *const param     = get_Builtin_param(node, 0);
+	x86_insn_size_t  const size      = x86_size_from_mode(get_irn_mode(param));
+	bool             const narrow    = size == X86_SIZE_8
+	                                || size == X86_SIZE_16;
+
+	if (amd64_cg_config.use_popcnt) {
+		/* and $1, popcnt */
+		ir_node *cnt;
+		if (narrow) {
+			/* there is no 8bit popcnt and the upper bits are undefined */
+			ir_node *const value = be_transform_node(param);
+			ir_node *const in[]  = {
+				create_zero_extension(dbgi, new_block, size, value)
+			};
+			x86_addr_t const addr = {
+				.base_input = 0,
+				.variant    = X86_ADDR_REG,
+			};
+			ir_node *const popcnt
+				= new_bd_amd64_popcnt(dbgi, new_block, ARRAY_SIZE(in), in,
+				                      reg_reqs, X86_SIZE_32, AMD64_OP_REG,
+				                      addr);
+			cnt = be_new_Proj(popcnt, pn_amd64_popcnt_res);
+		} else {
+			cnt = gen_unop_out(node, n_Builtin_max + 1, new_bd_amd64_popcnt,
+			                   pn_amd64_popcnt_res);
+		}
+		ir_node *const in[] = { cnt };
+		amd64_binop_addr_attr_t const attr = {
+			.base = {
+				.base = {
+					.op_mode = AMD64_OP_REG_IMM,
+					.size    = X86_SIZE_32,
+				},
+				.addr = {
+					.base_input = 0,
+					.variant    = X86_ADDR_REG,
+				},
+			},
+			.u.immediate = {
+				.kind   = X86_IMM_VALUE,
+				.offset = 1,
+			},
+		};
+		ir_node *const and = new_bd_amd64_and(dbgi, new_block, ARRAY_SIZE(in),
+		                                      in, reg_reqs, &attr);
+		arch_set_irn_register_req_out(and, 0, &amd64_requirement_gp_same_0);
+		return be_new_Proj(and, pn_amd64_and_res);
+	}
+
+	/* The parity flag only reflects the lowest byte of a result, so fold the
+	 * upper bytes into it first. The upper bits of narrow values are
+	 * undefined and must not take part. */
+	ir_node *value = be_transform_node(param);
+	if (narrow) {
+		value = create_zero_extension(dbgi, new_block, size, value);
+	} else {
+		if (size == X86_SIZE_64) {
+			ir_node *const shr
+				= create_shr(dbgi, new_block, X86_SIZE_64, value, 32);
+			ir_node *const xor
+				= create_xor(dbgi, new_block, X86_SIZE_32, shr, value);
+			value = be_new_Proj(xor, pn_amd64_xor_res);
+		}
+		ir_node *const shr16
+			= create_shr(dbgi, new_block, X86_SIZE_32, value, 16);
+		ir_node *const xor16
+			= create_xor(dbgi, new_block, X86_SIZE_32, shr16, value);
+		value = be_new_Proj(xor16, pn_amd64_xor_res);
+	}
+	ir_node *const shr8  = create_shr(dbgi, new_block, X86_SIZE_32, value, 8);
+	ir_node *const xor8  = create_xor(dbgi, new_block, X86_SIZE_32, shr8, value);
+	ir_node *const flags = be_new_Proj(xor8, pn_amd64_xor_flags);
+
+	/* setnp; movzbl */
+	ir_node *const setcc = new_bd_amd64_setcc(dbgi, new_block, flags,
+	                                          x86_cc_not_parity);
+	return create_zero_extension(dbgi, new_block, X86_SIZE_8, setcc);
+}
+
+static ir_node *gen_bswap(ir_node *const node)
+{
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_nodes_block(node);
+	ir_node  *const param     = get_Builtin_param(node, 0);
+	ir_node  *const new_param = be_transform_node(param);
+	unsigned  const bits      = get_mode_size_bits(get_irn_mode(param));
+
+	switch (bits) {
+	case 64:
+		return new_bd_amd64_bswap(dbgi, new_block, new_param, X86_SIZE_64);
+	case 32:
+		return new_bd_amd64_bswap(dbgi, new_block, new_param, X86_SIZE_32);
+	case 16: {
+		/* the swapped bytes end up in the upper half */
+		ir_node *const bswap = new_bd_amd64_bswap(dbgi, new_block, new_param,
+		                                          X86_SIZE_32);
+		return create_shr(dbgi, new_block, X86_SIZE_32, bswap, 16);
+	}
+	default:
+		panic("invalid bswap size (%u)", bits);
+	}
+}
+
 static ir_node *gen_ffs(ir_node *const node)
 {
 	/* bsf input, result */
@@ -3072,6 +3751,41 @@ static ir_node *gen_saturating_increment(ir_node *const node)
 	return sbb;
 }
 
+static ir_node *gen_prefetch(ir_node *const node)
+{
+	dbg_info *const dbgi     = get_irn_dbg_info(node);
+	ir_node  *const block    = be_transform_nodes_block(node);
+	ir_node  *const ptr      = get_Builtin_param(node, 0);
+	ir_node  *const mem      = get_Builtin_mem(node);
+	long      const locality = get_Const_long(get_Builtin_param(node, 2));
+
+	ir_node *in[3];
+	int arity = 0;
+	x86_addr_t addr;
+	perform_address_matching(ptr, &arity, in, &addr);
+	arch_register_req_t const **const reqs = gp_am_reqs[arity];
+	in[arity++] = be_transform_node(mem);
+
+	/* the write hint needs prefetchw, which is not part of the base ISA */
+	ir_node *new_node;
+	switch (locality) {
+	case 0:
+		new_node = new_bd_amd64_prefetchnta(dbgi, block, arity, in, reqs, addr);
+		break;
+	case 1:
+		new_node = new_bd_amd64_prefetcht2(dbgi, block, arity, in, reqs, addr);
+		break;
+	case 2:
+		new_node = new_bd_amd64_prefetcht1(dbgi, block, arity, in, reqs, addr);
+		break;
+	default:
+		new_node = new_bd_amd64_prefetcht0(dbgi, block, arity, in, reqs, addr);
+		break;
+	}
+	set_irn_pinned(new_node, get_irn_pinned(node));
+	return new_node;
+}
+
 static ir_node *gen_va_start(ir_node *const node)
 {
 	ir_graph *const irg   = get_irn_irg(node);
@@ -3094,12 +3808,20 @@ static ir_node *gen_Builtin(ir_node *const node)
 		return gen_ctz(node);
 	case ir_bk_ffs:
 		return gen_ffs(node);
+	case ir_bk_popcount:
+		return gen_popcount(node);
+	case ir_bk_parity:
+		return gen_parity(node);
+	case ir_bk_bswap:
+		return gen_bswap(node);
 	case ir_bk_compare_swap:
 		return gen_compare_swap(node);
 	case ir_bk_saturating_increment:
 		return gen_saturating_increment(node);
 	case ir_bk_va_start:
 		return gen_va_start(node);
+	case ir_bk_prefetch:
+		return gen_prefetch(node);
 	default:
 		break;
 	}
@@ -3116,7 +3838,9 @@ static ir_node *gen_Proj_Builtin(ir_node *const proj)
 	case ir_bk_clz:
 	case ir_bk_ctz:
 	case ir_bk_ffs:
+	case ir_bk_popcount:
 	case ir_bk_parity:
+	case ir_bk_bswap:
 		return new_node;
 	case ir_bk_compare_swap:
 		assert(is_amd64_cmpxchg(new_node));
@@ -3129,6 +3853,7 @@ static ir_node *gen_Proj_Builtin(ir_node *const proj)
 	case ir_bk_saturating_increment:
 		return be_new_Proj(new_node, pn_amd64_sbb_res);
 	case ir_bk_va_start:
+	case ir_bk_prefetch:
 		assert(get_Proj_num(proj) == pn_Builtin_M);
 		return new_node;
 	default:
@@ -3211,6 +3936,7 @@ static void amd64_register_transformers(void)
 	be_set_transform_function(op_Mod,               gen_Mod);
 	be_set_transform_function(op_Mul,               gen_Mul);
 	be_set_transform_function(op_Mulh,              gen_Mulh);
+	be_set_transform_function(op_Mux,               gen_Mux);
 	be_set_transform_function(op_Not,               gen_Not);
 	be_set_transform_function(op_Or,                gen_Or);
 	be_set_transform_function(op_Phi,               gen_Phi);
@@ -13,7 +13,6 @@
 #include "firm_types.h"
 #include "x86_asm.h"
 
-extern const x86_clobber_name_t        amd64_additional_clobber_names[];
 extern const x86_asm_constraint_list_t amd64_asm_constraints;
 
 extern arch_register_req_t const         amd64_requirement_gp_same_0;
@@ -52,4 +51,20 @@ void init_lconst_addr(x86_addr_t *addr, ir_entity *entity);
   */
 ir_tarval *create_sign_tv(ir_mode *mode);
 
+/**
+ * Returns the condition code a flags consumer of the Cmp @p cmp tests.
+ */
+x86_condition_code_t amd64_get_cmp_condition_code(ir_node const *cmp);
+
+/**
+ * Checks whether a floating point Mux is a minimum or maximum that mins/maxs
+ * compute exactly.
+ *
+ * @return ir_relation_less for a minimum, ir_relation_greater for a maximum
+ *         of @p op1 and @p op2 and ir_relation_false otherwise.
+ */
+ir_relation amd64_mux_is_float_min_max(ir_node const *sel, ir_node *mux_true,
+                                       ir_node *mux_false, ir_node **op1,
+                                       ir_node **op2);
+
 #endif
@@ -26,6 +26,7 @@
 #include "irarch_t.h"
 #include "irgopt.h"
 #include "irgwalk.h"
+#include "iropt_t.h"
 #include "irprog_t.h"
 #include "irtools.h"
 #include "lc_opts_enum.h"
@@ -212,10 +213,24 @@ static void arm_generate_code(FILE *output, const char *cup_name)
 static int arm_is_mux_allowed(ir_node *sel, ir_node *mux_false,
                               ir_node *mux_true)
 {
-	(void)sel;
-	(void)mux_false;
-	(void)mux_true;
-	return false;
+	if (ir_is_optimizable_mux(sel, mux_false, mux_true))
+		return true;
+
+	/* Every variant can execute a mov conditionally, a Mux costs no more than
+	 * a mov and a movcc. Floating point and 64bit values have no conditional
+	 * move. */
+	ir_mode *const mode = get_irn_mode(mux_true);
+	if (!mode_is_int(mode) && !mode_is_reference(mode))
+		return false;
+	if (get_mode_size_bits(mode) > 32)
+		return false;
+	if (!is_Cmp(sel))
+		return false;
+	/* 64bit compares are lowered to a combination of 32bit compares */
+	ir_mode *const cmp_mode = get_irn_mode(get_Cmp_left(sel));
+	if (mode_is_float(cmp_mode) || get_mode_size_bits(cmp_mode) > 32)
+		return false;
+	return true;
 }
 
 static void arm_lower_for_target(void)
@@ -311,8 +326,9 @@ static void arm_finish(void)
 
 static unsigned arm_get_op_estimated_cost(const ir_node *node)
 {
-	(void)node; /* TODO */
-	return 1;
+	if (!is_arm_irn(node))
+		return 1;
+	return arm_get_op_cost(arm_cg_config.cost_model, node)->latency;
 }
 
 static arch_isa_if_t const arm_isa_if = {
@@ -351,9 +367,20 @@ static lc_opt_enum_int_var_t arch_var = {
 	(int*)&arm_cg_config.variant, arm_arch_items
 };
 
+static const lc_opt_enum_int_items_t arm_tune_items[] = {
+	{ "generic",   ARM_COST_MODEL_GENERIC   },
+	{ "arm9",      ARM_COST_MODEL_ARM9      },
+	{ "cortex-a9", ARM_COST_MODEL_CORTEX_A9 },
+	{ NULL,        0                        },
+};
+static lc_opt_enum_int_var_t arch_tune_var = {
+	(int*)&arm_cg_config.cost_model, arm_tune_items
+};
+
 static const lc_opt_table_entry_t arm_options[] = {
 	LC_OPT_ENT_ENUM_INT("fpu", "select the floating point unit", &arch_fpu_var),
 	LC_OPT_ENT_ENUM_INT("arch", "select architecture variant", &arch_var),
+	LC_OPT_ENT_ENUM_INT("tune", "optimize for microarchitecture", &arch_tune_var),
 	LC_OPT_LAST
 };
 
@@ -363,6 +390,7 @@ static void arm_init_architecture(void)
 	arm_cg_config.variant    = ARM_VARIANT_6T2;
 	arm_cg_config.fpu        = ARM_FPU_SOFTFLOAT;
 	arm_cg_config.big_endian = false;
+	arm_cg_config.cost_model = ARM_COST_MODEL_GENERIC;
 
 	lc_opt_entry_t *be_grp  = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *arm_grp = lc_opt_get_grp(be_grp, "arm");
@@ -15,6 +15,7 @@
 
 #include "beirg.h"
 #include "firm_types.h"
+#include "gen_arm_new_nodes.h"
 
 #define ARM_PO2_STACK_ALIGNMENT 3
 
@@ -45,6 +46,7 @@ typedef struct arm_codegen_config_t {
 	arm_variant_t     variant;
 	arm_fpu_variant_t fpu;
 	bool              big_endian;
+	arm_cost_model_t  cost_model; /**< instruction costs to optimize for */
 } arm_codegen_config_t;
 
 extern arm_codegen_config_t arm_cg_config;
@@ -9,6 +9,7 @@
  * @author  Oliver Richter, Tobias Gneist, Michael Beck, Matthias Braun
  */
 #include <inttypes.h>
+#include <limits.h>
 
 #include "arm_bearch_t.h"
 #include "arm_cconv.h"
@@ -50,6 +51,8 @@ static struct obstack obst;
 static pmap          *ent_or_tv;
 static ent_or_tv_t   *ent_or_tv_first;
 static ent_or_tv_t  **ent_or_tv_anchor;
+static pmap          *predicated_blocks; /**< block -> condition suffix */
+static char const    *cond_suffix = "";  /**< condition of the current block */
 
 static void arm_emit_register(const arch_register_t *reg)
 {
@@ -235,11 +238,27 @@ static void arm_emit_cfop_target(const ir_node *irn)
 	be_gas_emit_block_name(block);
 }
 
+/**
+ * Emits the mnemonic at the begin of an instruction format followed by the
+ * condition of a predicated block.
+ */
+static char const *arm_emit_mnemonic(char const *format)
+{
+	char const *start = format;
+	while ('a' <= *format && *format <= 'z')
+		++format;
+	be_emit_string_len(start, format - start);
+	if (format != start)
+		be_emit_string(cond_suffix);
+	return format;
+}
+
 void arm_emitf(const ir_node *node, const char *format, ...)
 {
 	va_list ap;
 	va_start(ap, format);
 	be_emit_char('\t');
+	format = arm_emit_mnemonic(format);
 	for (;;) {
 		const char *start = format;
 		while (*format != '%' && *format != '\n'  && *format != '\0')
@@ -254,6 +273,7 @@ void arm_emitf(const ir_node *node, const char *format, ...)
 			be_emit_char('\n');
 			be_emit_write_line();
 			be_emit_char('\t');
+			format = arm_emit_mnemonic(format);
 			continue;
 		}
 
@@ -324,13 +344,13 @@ void arm_emitf(const ir_node *node, const char *format, ...)
 
 		case 'u': {
 			unsigned num = va_arg(ap, unsigned);
-			be_emit_irprintf("%u", num);
+			be_emit_uint(num);
 			break;
 		}
 
 		case 'd': {
 			int num = va_arg(ap, int);
-			be_emit_irprintf("%d", num);
+			be_emit_int(num);
 			break;
 		}
 
@@ -416,37 +436,69 @@ static void emit_arm_fConst(const ir_node *irn)
 }
 
 /**
- * Emit a Compare with conditional branch.
+ * Returns the condition code suffix for a relation evaluated on the flags
+ * produced by @p flags.
  */
-static void emit_arm_B(const ir_node *irn)
+static char const *get_cond_suffix(ir_node const *const flags,
+                                   ir_relation relation)
+{
+	assert(is_arm_Cmn(flags) || is_arm_Cmp(flags) || is_arm_Tst(flags));
+	arm_cmp_attr_t const *const cmp_attr = get_arm_cmp_attr_const(flags);
+	if (cmp_attr->ins_permuted)
+		relation = get_inversed_relation(relation);
+
+	assert(relation != ir_relation_false);
+	assert(relation != ir_relation_true);
+
+	bool const is_signed = !cmp_attr->is_unsigned;
+	switch (relation & (ir_relation_less_equal_greater)) {
+		case ir_relation_equal:         return "eq";
+		case ir_relation_less:          return is_signed ? "lt" : "lo";
+		case ir_relation_less_equal:    return is_signed ? "le" : "ls";
+		case ir_relation_greater:       return is_signed ? "gt" : "hi";
+		case ir_relation_greater_equal: return is_signed ? "ge" : "hs";
+		case ir_relation_less_greater:  return "ne";
+		case ir_relation_less_equal_greater: return "al";
+		default: panic("Cmp has unsupported relation");
+	}
+}
+
+static void get_cond_projs(ir_node const *const irn, ir_node const **proj_true,
+                           ir_node const **proj_false)
 {
-	const ir_node *proj_true  = NULL;
-	const ir_node *proj_false = NULL;
 	foreach_out_edge(irn, edge) {
 		ir_node *proj = get_edge_src_irn(edge);
 		unsigned nr   = get_Proj_num(proj);
 		if (nr == pn_Cond_true) {
-			proj_true = proj;
+			*proj_true = proj;
 		} else {
-			proj_false = proj;
+			*proj_false = proj;
 		}
 	}
+}
 
-	ir_node *const op1 = get_irn_n(irn, n_arm_B_flags);
-	assert(is_arm_Cmn(op1) || is_arm_Cmp(op1) || is_arm_Tst(op1));
+/**
+ * Emit a Compare with conditional branch.
+ */
+static void emit_arm_B(const ir_node *irn)
+{
+	const ir_node *proj_true  = NULL;
+	const ir_node *proj_false = NULL;
+	get_cond_projs(irn, &proj_true, &proj_false);
 
-	arm_cmp_attr_t const *const cmp_attr = get_arm_cmp_attr_const(op1);
+	ir_node const *const block = get_nodes_block(irn);
+	ir_node const *const true_target  = be_emit_get_cfop_target(proj_true);
+	ir_node const *const false_target = be_emit_get_cfop_target(proj_false);
+	ir_node const *const next_block   = be_emit_get_prev_block(true_target) == block
+		? true_target : false_target;
+	if (pmap_contains(predicated_blocks, next_block)) {
+		if (be_options.verbose_asm)
+			arm_emitf(irn, "/* branch replaced by predication */");
+		return;
+	}
 
 	ir_relation relation = get_arm_CondJmp_relation(irn);
-	if (cmp_attr->ins_permuted)
-		relation = get_inversed_relation(relation);
-
-	assert(relation != ir_relation_false);
-	assert(relation != ir_relation_true);
-
-	ir_node const *const block       = get_nodes_block(irn);
-	ir_node const *const true_target = be_emit_get_cfop_target(proj_true);
-	if (be_emit_get_prev_block(true_target) == block) {
+	if (next_block == true_target) {
 		/* exchange both proj's so the second one can be omitted */
 		const ir_node *t = proj_true;
 
@@ -455,30 +507,24 @@ static void emit_arm_B(const ir_node *irn)
 		relation   = get_negated_relation(relation);
 	}
 
-	char const *suffix;
-	bool const  is_signed = !cmp_attr->is_unsigned;
-	switch (relation & (ir_relation_less_equal_greater)) {
-		case ir_relation_equal:         suffix = "eq"; break;
-		case ir_relation_less:          suffix = is_signed ? "lt" : "lo"; break;
-		case ir_relation_less_equal:    suffix = is_signed ? "le" : "ls"; break;
-		case ir_relation_greater:       suffix = is_signed ? "gt" : "hi"; break;
-		case ir_relation_greater_equal: suffix = is_signed ? "ge" : "hs"; break;
-		case ir_relation_less_greater:  suffix = "ne"; break;
-		case ir_relation_less_equal_greater: suffix = "al"; break;
-		default: panic("Cmp has unsupported relation");
-	}
-
 	/* emit the true proj */
-	arm_emitf(irn, "b%s %t", suffix, proj_true);
+	ir_node const *const flags = get_irn_n(irn, n_arm_B_flags);
+	arm_emitf(irn, "b%s %t", get_cond_suffix(flags, relation), proj_true);
 
-	ir_node const *const false_target = be_emit_get_cfop_target(proj_false);
-	if (be_emit_get_prev_block(false_target) != block) {
+	if (be_emit_get_prev_block(be_emit_get_cfop_target(proj_false)) != block) {
 		arm_emitf(irn, "b %t", proj_false);
 	} else if (be_options.verbose_asm) {
 		arm_emitf(irn, "/* fallthrough to %t */", proj_false);
 	}
 }
 
+static void emit_arm_MovCC(const ir_node *irn)
+{
+	ir_node         const *const flags = get_irn_n(irn, n_arm_MovCC_flags);
+	arm_cmov_attr_t const *const attr  = get_arm_cmov_attr_const(irn);
+	arm_emitf(irn, "mov%s %D0, %O", get_cond_suffix(flags, attr->relation));
+}
+
 static void emit_jumptable_target(ir_entity const *const table,
                                   ir_node const *const proj_x)
 {
@@ -598,6 +644,7 @@ static void arm_register_emitters(void)
 	be_set_emitter(op_arm_fConst,    emit_arm_fConst);
 	be_set_emitter(op_arm_FrameAddr, emit_arm_FrameAddr);
 	be_set_emitter(op_arm_Jmp,       emit_arm_Jmp);
+	be_set_emitter(op_arm_MovCC,     emit_arm_MovCC);
 	be_set_emitter(op_arm_SwitchJmp, emit_arm_SwitchJmp);
 	be_set_emitter(op_be_Copy,       emit_be_Copy);
 	be_set_emitter(op_be_CopyKeep,   emit_be_Copy);
@@ -637,9 +684,124 @@ static void arm_gen_block(ir_node *block)
 {
 	arm_emit_block_header(block);
 	be_dwarf_location(get_irn_dbg_info(block));
+	char const *const suffix = pmap_get(char const, predicated_blocks, block);
+	cond_suffix = suffix != NULL ? suffix : "";
 	sched_foreach(block, irn) {
 		be_emit_node(irn);
 	}
+	cond_suffix = "";
+}
+
+/**
+ * Returns the maximum number of instructions executed conditionally instead
+ * of being branched over.
+ */
+static unsigned get_max_predicated(void)
+{
+	/* Cores before ARMv6 predict no branches, every taken branch refills the
+	 * pipeline. Later cores predict dynamically, so skipped instructions are
+	 * only cheaper than a branch for very short sequences. */
+	return arm_cg_config.variant < ARM_VARIANT_6 ? 4 : 2;
+}
+
+/**
+ * Returns the number of instructions emitted for @p node if it can be executed
+ * conditionally, -1 otherwise.
+ */
+static int get_predicated_size(ir_node const *const node)
+{
+	if (be_is_Keep(node))
+		return 0;
+	if (be_is_Copy(node) || be_is_CopyKeep(node) || be_is_Perm(node)) {
+		arch_register_t const *const out = arch_get_irn_register_out(node, 0);
+		if (out->cls != &arm_reg_classes[CLASS_arm_gp])
+			return -1;
+		if (be_is_Perm(node))
+			return 3;
+		return arch_get_irn_register_in(node, 0) == out ? 0 : 1;
+	}
+	if (!is_arm_irn(node) || arch_irn_is(node, modify_flags))
+		return -1;
+
+	switch ((arm_opcodes)get_arm_irn_opcode(node)) {
+	case iro_arm_Add:
+	case iro_arm_Address:
+	case iro_arm_And:
+	case iro_arm_Bic:
+	case iro_arm_Clz:
+	case iro_arm_Eor:
+	case iro_arm_FrameAddr:
+	case iro_arm_Ldr:
+	case iro_arm_Mla:
+	case iro_arm_Mls:
+	case iro_arm_Mov:
+	case iro_arm_Mul:
+	case iro_arm_Mvn:
+	case iro_arm_Or:
+	case iro_arm_Rsb:
+	case iro_arm_Str:
+	case iro_arm_Sub:
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+/**
+ * Replaces short forward branches by conditional execution: A block which is
+ * only reached by a conditional branch, placed directly behind it and
+ * falling through to the other branch target is emitted with its
+ * instructions predicated on the branch condition, the branch is dropped.
+ */
+static void arm_predicate_blocks(ir_node **const blk_sched)
+{
+	unsigned const max_predicated = get_max_predicated();
+	for (size_t i = 0, n = ARR_LEN(blk_sched); i + 2 < n; ++i) {
+		ir_node *const block = blk_sched[i];
+		ir_node *const cfop  = sched_last(block);
+		if (!is_arm_B(cfop))
+			continue;
+
+		ir_node *const cond_block = blk_sched[i + 1];
+		ir_node *const join_block = blk_sched[i + 2];
+		if (get_Block_n_cfgpreds(cond_block) != 1)
+			continue;
+
+		ir_node const *proj_true  = NULL;
+		ir_node const *proj_false = NULL;
+		get_cond_projs(cfop, &proj_true, &proj_false);
+		ir_node const *const true_target  = be_emit_get_cfop_target(proj_true);
+		ir_node const *const false_target = be_emit_get_cfop_target(proj_false);
+		ir_relation          relation     = get_arm_CondJmp_relation(cfop);
+		if (false_target == cond_block && true_target == join_block) {
+			relation = get_negated_relation(relation);
+		} else if (true_target != cond_block || false_target != join_block) {
+			continue;
+		}
+
+		ir_node const *const jmp = sched_last(cond_block);
+		if (!is_arm_Jmp(jmp) || be_emit_get_cfop_target(jmp) != join_block)
+			continue;
+
+		unsigned n_insns = 0;
+		sched_foreach(cond_block, node) {
+			if (node == jmp)
+				break;
+			int const size = get_predicated_size(node);
+			if (size < 0) {
+				n_insns = UINT_MAX;
+				break;
+			}
+			n_insns += size;
+		}
+		if (n_insns > max_predicated)
+			continue;
+
+		ir_node    const *const flags  = get_irn_n(cfop, n_arm_B_flags);
+		char const       *const suffix = get_cond_suffix(flags, relation);
+		DBG((dbg, LEVEL_1, "predicate %+F on %s\n", cond_block, suffix));
+		pmap_insert(predicated_blocks, cond_block, (void*)suffix);
+	}
 }
 
 static parameter_dbg_info_t *construct_parameter_infos(ir_graph *irg)
@@ -685,11 +847,15 @@ void arm_emit_function(ir_graph *irg)
 
 	be_emit_init_cf_links(blk_sched);
 
+	predicated_blocks = pmap_create();
+	arm_predicate_blocks(blk_sched);
+
 	for (size_t i = 0, n = ARR_LEN(blk_sched); i < n;) {
 		ir_node *block = blk_sched[i++];
 		arm_gen_block(block);
 	}
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	pmap_destroy(predicated_blocks);
 
 	/* emit entity and tarval values */
 	if (ent_or_tv_first != NULL) {
@@ -46,7 +46,7 @@ static bool has_shifter_operand(const ir_node *node)
 		|| is_arm_Eor(node) || is_arm_Bic(node) || is_arm_Sub(node)
 		|| is_arm_Rsb(node) || is_arm_Mov(node) || is_arm_Mvn(node)
 		|| is_arm_Cmn(node) || is_arm_Cmp(node) || is_arm_Tst(node)
-		|| is_arm_LinkMovPC(node);
+		|| is_arm_LinkMovPC(node) || is_arm_MovCC(node);
 }
 
 static bool has_cmp_attr(const ir_node *node)
@@ -145,6 +145,10 @@ void arm_dump_node(FILE *F, const ir_node *n, dump_reason_t reason)
 			}
 			fputc('\n', F);
 		}
+		if (is_arm_MovCC(n)) {
+			const arm_cmov_attr_t *attr = get_arm_cmov_attr_const(n);
+			fprintf(F, "relation = %s\n", get_relation_string(attr->relation));
+		}
 		if (arm_has_address_attr(n)) {
 			const arm_Address_attr_t *attr = get_arm_Address_attr_const(n);
 
@@ -303,6 +307,12 @@ void init_arm_cmp_attr(ir_node *res, bool ins_permuted, bool is_unsigned)
 	attr->is_unsigned  = is_unsigned;
 }
 
+void init_arm_cmov_attr(ir_node *res, ir_relation relation)
+{
+	arm_cmov_attr_t *attr = get_arm_cmov_attr(res);
+	attr->relation = relation;
+}
+
 void init_arm_Address_attributes(ir_node *res, ir_entity *entity, int offset)
 {
 	arm_Address_attr_t *attr = get_arm_Address_attr(res);
@@ -425,6 +435,24 @@ int arm_cmp_attrs_equal(const ir_node *a, const ir_node *b)
 	    && attr_a->is_unsigned == attr_b->is_unsigned;
 }
 
+arm_cmov_attr_t *get_arm_cmov_attr(ir_node *node)
+{
+	return (arm_cmov_attr_t*) get_irn_generic_attr(node);
+}
+
+const arm_cmov_attr_t *get_arm_cmov_attr_const(const ir_node *node)
+{
+	return (const arm_cmov_attr_t*) get_irn_generic_attr_const(node);
+}
+
+int arm_cmov_attrs_equal(const ir_node *a, const ir_node *b)
+{
+	const arm_cmov_attr_t *attr_a = get_arm_cmov_attr_const(a);
+	const arm_cmov_attr_t *attr_b = get_arm_cmov_attr_const(b);
+	return arm_shifter_operands_equal(a, b)
+	    && attr_a->relation == attr_b->relation;
+}
+
 int arm_farith_attrs_equal(const ir_node *a, const ir_node *b)
 {
 	const arm_farith_attr_t *attr_a = get_arm_farith_attr_const(a);
@@ -26,6 +26,7 @@ void init_arm_shifter_operand(ir_node *res, unsigned shifter_op_input,
                               unsigned shift_immediate);
 
 void init_arm_cmp_attr(ir_node *res, bool ins_permuted, bool is_unsigned);
+void init_arm_cmov_attr(ir_node *res, ir_relation relation);
 void init_arm_Address_attributes(ir_node *res, ir_entity *entity, int offset);
 void init_arm_farith_attributes(ir_node *res, ir_mode *mode);
 void init_arm_SwitchJmp_attributes(ir_node *res, const ir_switch_table *table);
@@ -34,6 +35,7 @@ int arm_Address_attrs_equal(const ir_node *a, const ir_node *b);
 int arm_CondJmp_attrs_equal(const ir_node *a, const ir_node *b);
 int arm_SwitchJmp_attrs_equal(const ir_node *a, const ir_node *b);
 int arm_attrs_equal(const ir_node *a, const ir_node *b);
+int arm_cmov_attrs_equal(const ir_node *a, const ir_node *b);
 int arm_cmp_attrs_equal(const ir_node *a, const ir_node *b);
 int arm_fConst_attrs_equal(const ir_node *a, const ir_node *b);
 int arm_farith_attrs_equal(const ir_node *a, const ir_node *b);
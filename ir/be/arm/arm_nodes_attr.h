@@ -69,6 +69,12 @@ typedef struct arm_cmp_attr_t {
 	bool                  is_unsigned  : 1;
 } arm_cmp_attr_t;
 
+/** Attributes for a conditional move */
+typedef struct arm_cmov_attr_t {
+	arm_shifter_operand_t base;
+	ir_relation           relation; /**< condition under which to move */
+} arm_cmov_attr_t;
+
 /**
  * this struct holds information needed to produce the arm addressing modes
  * for "Load and Store Word or Unsigned Byte", "Miscellaneous Loads and Stores"
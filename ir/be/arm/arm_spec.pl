@@ -7,6 +7,10 @@ $mode_gp    = "arm_mode_gp";
 $mode_flags = "arm_mode_flags";
 $mode_fp    = "mode_F";
 
+# Microarchitectures selectable with the "tune" option, the "costs" of a node
+# give its latency, micro-operations and reciprocal throughput.
+@cost_models = ( "generic", "arm9", "cortex-a9" );
+
 %reg_classes = (
 	gp => [
 		{ name => "r0",  dwarf => 0 },
@@ -63,6 +67,9 @@ $mode_fp    = "mode_F";
 		"init_arm_attributes(res, irn_flags, in_reqs, n_res);",
 	arm_cmp_attr_t =>
 		"init_arm_attributes(res, irn_flags, in_reqs, n_res);",
+	arm_cmov_attr_t =>
+		"init_arm_attributes(res, irn_flags, in_reqs, n_res);\n".
+		"\tinit_arm_cmov_attr(res, relation);",
 	arm_farith_attr_t =>
 		"init_arm_attributes(res, irn_flags, in_reqs, n_res);\n".
 		"\tinit_arm_farith_attributes(res, op_mode);",
@@ -96,6 +103,10 @@ my $unop_shifter_operand = {
 			ins     => [ "Rm" ],
 		},
 	},
+	costs        => {
+		latency => 1, uops => 1, throughput => 1,
+		"cortex-a9" => { throughput => 0.5 },
+	},
 },
 
 my $binop_shifter_operand = {
@@ -127,6 +138,10 @@ my $binop_shifter_operand = {
 			ins     => [ "left", "right" ],
 		},
 	},
+	costs        => {
+		latency => 1, uops => 1, throughput => 1,
+		"cortex-a9" => { throughput => 0.5 },
+	},
 };
 
 my $binop_shifter_operand_setflags = {
@@ -159,6 +174,10 @@ my $binop_shifter_operand_setflags = {
 			ins     => [ "left", "right" ],
 		},
 	},
+	costs        => {
+		latency => 1, uops => 1, throughput => 1,
+		"cortex-a9" => { throughput => 0.5 },
+	},
 };
 
 my $binop_shifter_operand_flags = {
@@ -190,6 +209,10 @@ my $binop_shifter_operand_flags = {
 			ins     => [ "left", "right", "flags" ],
 		},
 	},
+	costs        => {
+		latency => 1, uops => 1, throughput => 1,
+		"cortex-a9" => { throughput => 0.5 },
+	},
 };
 
 my $cmp_shifter_operand = {
@@ -231,6 +254,10 @@ my $cmp_shifter_operand = {
 			ins     => [ "left", "right" ],
 		},
 	},
+	costs        => {
+		latency => 1, uops => 1, throughput => 1,
+		"cortex-a9" => { throughput => 0.5 },
+	},
 };
 
 my $mullop = {
@@ -238,6 +265,11 @@ my $mullop = {
 	in_reqs   => [ "gp", "gp" ],
 	out_reqs  => [ "gp", "gp" ],
 	outs      => [ "low", "high" ],
+	costs     => {
+		latency => 4, uops => 2, throughput => 2,
+		arm9        => { latency => 5, throughput => 3 },
+		"cortex-a9" => { latency => 5, throughput => 3 },
+	},
 };
 
 my $binopf = {
@@ -246,6 +278,7 @@ my $binopf = {
 	out_reqs  => [ "fpa" ],
 	attr_type => "arm_farith_attr_t",
 	attr      => "ir_mode *op_mode",
+	costs     => { latency => 4, uops => 1, throughput => 1 },
 };
 
 
@@ -277,6 +310,11 @@ Mul => {
 		# for this scheme we would need a special if both inputs are the same value.
 		v5 => { out_reqs => [ "!in_r0" ] },
 	},
+	costs        => {
+		latency => 3, uops => 1, throughput => 1,
+		arm9        => { latency => 3, throughput => 2 },
+		"cortex-a9" => { latency => 4, throughput => 2 },
+	},
 },
 
 SMulL => {
@@ -298,7 +336,12 @@ Mla => {
 		"" => { out_reqs => [ "gp" ]     },
 		# See comments for Mul_v5 out register constraint
 		v5 => { out_reqs => [ "!in_r0" ] },
-	}
+	},
+	costs     => {
+		latency => 3, uops => 1, throughput => 1,
+		arm9        => { latency => 3, throughput => 2 },
+		"cortex-a9" => { latency => 4, throughput => 2 },
+	},
 },
 
 Mls => {
@@ -307,6 +350,10 @@ Mls => {
 	out_reqs  => [ "gp" ],
 	ins       => [ "left", "right", "sub" ],
 	emit      => 'mls %D0, %S0, %S1, %S2',
+	costs     => {
+		latency => 3, uops => 1, throughput => 1,
+		"cortex-a9" => { latency => 4, throughput => 2 },
+	},
 },
 
 And => {
@@ -375,6 +422,26 @@ Mov => {
 	ins      => [ "Rm", "Rs" ],
 },
 
+# mov<cond>: the result is falseval unless the condition holds
+MovCC => {
+	attr_type    => "arm_cmov_attr_t",
+	ins          => [ "falseval", "flags", "Rm" ],
+	constructors => {
+		imm => {
+			attr     => "ir_relation relation, unsigned char immediate_value, unsigned char immediate_rot",
+			init     => "init_arm_shifter_operand(res, 0, immediate_value, ARM_SHF_IMM, immediate_rot);",
+			in_reqs  => [ "gp", "flags" ],
+			out_reqs => [ "in_r0" ],
+		},
+		reg => {
+			attr     => "ir_relation relation",
+			init     => "init_arm_shifter_operand(res, 2, 0, ARM_SHF_REG, 0);",
+			in_reqs  => [ "gp", "flags", "gp" ],
+			out_reqs => [ "in_r0 !in_r2" ],
+		},
+	},
+},
+
 Mvn => {
 	template => $unop_shifter_operand,
 	emit     => 'mvn %D0, %O',
@@ -409,6 +476,11 @@ LinkMovPC => {
 	init      => "init_arm_shifter_operand(res, shiftop_input, immediate_value, shift_modifier, immediate_rot);\n",
 	emit      => "mov lr, pc\n".
 	             "mov pc, %O",
+	costs     => {
+		latency => 3, uops => 2, throughput => 2,
+		arm9        => { latency => 3, throughput => 3 },
+		"cortex-a9" => { latency => 2, throughput => 1 },
+	},
 },
 
 # mov lr, pc\n ldr pc, XXX -- This combination is used for calls to function
@@ -422,6 +494,11 @@ LinkLdrPC => {
 	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
 	emit      => "mov lr, pc\n".
 	             "ldr pc, %O",
+	costs     => {
+		latency => 5, uops => 2, throughput => 3,
+		arm9        => { latency => 5, throughput => 5 },
+		"cortex-a9" => { latency => 4, throughput => 2 },
+	},
 },
 
 Bl => {
@@ -433,6 +510,11 @@ Bl => {
 	attr_type => "arm_Address_attr_t",
 	attr      => "ir_entity *entity, int offset",
 	emit      => 'bl %I',
+	costs     => {
+		latency => 2, uops => 1, throughput => 2,
+		arm9        => { latency => 3, throughput => 3 },
+		"cortex-a9" => { latency => 1, throughput => 1 },
+	},
 },
 
 FrameAddr => {
@@ -451,6 +533,11 @@ Address => {
 	attr      => "ir_entity *entity, int offset",
 	out_reqs  => [ "gp" ],
 	attr_type => "arm_Address_attr_t",
+	costs     => {
+		latency => 2, uops => 1, throughput => 1,
+		arm9        => { latency => 3, throughput => 1 },
+		"cortex-a9" => { latency => 2, uops => 2, throughput => 1 },
+	},
 },
 
 Cmn => {
@@ -477,6 +564,11 @@ B => {
 	attr      => "ir_relation relation",
 	attr_type => "arm_CondJmp_attr_t",
 	init      => "\tset_arm_CondJmp_relation(res, relation);",
+	costs     => {
+		latency => 2, uops => 1, throughput => 2,
+		arm9        => { latency => 3, throughput => 3 },
+		"cortex-a9" => { latency => 1, throughput => 1 },
+	},
 },
 
 Jmp => {
@@ -484,6 +576,11 @@ Jmp => {
 	op_flags  => [ "cfopcode" ],
 	irn_flags => [ "simple_jump" ],
 	out_reqs  => [ "exec" ],
+	costs     => {
+		latency => 2, uops => 1, throughput => 2,
+		arm9        => { latency => 3, throughput => 3 },
+		"cortex-a9" => { latency => 1, throughput => 1 },
+	},
 },
 
 SwitchJmp => {
@@ -494,6 +591,11 @@ SwitchJmp => {
 	in_reqs   => [ "gp" ],
 	out_reqs  => "...",
 	attr_type => "arm_SwitchJmp_attr_t",
+	costs     => {
+		latency => 5, uops => 1, throughput => 3,
+		arm9        => { latency => 5, throughput => 5 },
+		"cortex-a9" => { latency => 4, throughput => 2 },
+	},
 },
 
 Ldr => {
@@ -506,6 +608,11 @@ Ldr => {
 	emit      => 'ldr%ML %D0, %A',
 	attr_type => "arm_load_store_attr_t",
 	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
+	costs     => {
+		latency => 3, uops => 1, throughput => 1,
+		arm9        => { latency => 2 },
+		"cortex-a9" => { latency => 4 },
+	},
 },
 
 Str => {
@@ -518,6 +625,7 @@ Str => {
 	emit      => 'str%MS %S1, %A',
 	attr_type => "arm_load_store_attr_t",
 	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
 },
 
 
@@ -529,6 +637,7 @@ Adf => {
 Muf => {
 	template => $binopf,
 	emit     => 'muf%MA %D0, %S0, %S1',
+	costs    => { latency => 5, uops => 1, throughput => 2 },
 },
 
 Suf => {
@@ -544,6 +653,7 @@ Dvf => {
 	attr_type => "arm_farith_attr_t",
 	attr      => "ir_mode *op_mode",
 	mode      => "first",
+	costs     => { latency => 30, uops => 1, throughput => 30 },
 },
 
 Mvf => {
@@ -553,6 +663,7 @@ Mvf => {
 	emit      => 'mvf%MA %S0, %D0',
 	attr_type => "arm_farith_attr_t",
 	attr      => "ir_mode *op_mode",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
 },
 
 FltX => {
@@ -562,6 +673,7 @@ FltX => {
 	emit      => 'flt%MA %D0, %S0',
 	attr_type => "arm_farith_attr_t",
 	attr      => "ir_mode *op_mode",
+	costs     => { latency => 4, uops => 1, throughput => 1 },
 },
 
 Cmfe => {
@@ -572,6 +684,7 @@ Cmfe => {
 	in_reqs   => [ "fpa", "fpa" ],
 	out_reqs  => [ "flags" ],
 	emit      => 'cmfe %S0, %S1',
+	costs     => { latency => 4, uops => 1, throughput => 1 },
 },
 
 Ldf => {
@@ -584,6 +697,7 @@ Ldf => {
 	emit      => 'ldf%MF %D0, %A',
 	attr_type => "arm_load_store_attr_t",
 	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
+	costs     => { latency => 3, uops => 1, throughput => 1 },
 },
 
 Stf => {
@@ -596,6 +710,7 @@ Stf => {
 	emit      => 'stf%MF %S1, %A',
 	attr_type => "arm_load_store_attr_t",
 	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
+	costs     => { latency => 1, uops => 1, throughput => 1 },
 },
 
 # floating point constants
@@ -606,6 +721,7 @@ fConst => {
 	init      => "attr->tv = tv;",
 	out_reqs  => [ "fpa" ],
 	attr_type => "arm_fConst_attr_t",
+	costs     => { latency => 3, uops => 1, throughput => 1 },
 },
 
 Return => {
@@ -615,6 +731,11 @@ Return => {
 	ins      => [ "mem", "sp", "first_result" ],
 	out_reqs => [ "exec" ],
 	emit     => "bx lr",
+	costs    => {
+		latency => 2, uops => 1, throughput => 2,
+		arm9        => { latency => 3, throughput => 3 },
+		"cortex-a9" => { latency => 1, throughput => 1 },
+	},
 },
 
 AddS_t => {
@@ -1260,6 +1260,36 @@ static ir_node *gen_Cond(ir_node *node)
 	return new_bd_arm_B(dbgi, block, flag_node, relation);
 }
 
+static ir_node *gen_Mux(ir_node *node)
+{
+	ir_node    *const block     = be_transform_nodes_block(node);
+	dbg_info   *const dbgi      = get_irn_dbg_info(node);
+	ir_node    *const sel       = get_Mux_sel(node);
+	ir_node    *const flags     = be_transform_node(sel);
+	ir_node          *val_true  = get_Mux_true(node);
+	ir_node          *val_false = get_Mux_false(node);
+	ir_relation       relation  = get_Cmp_relation(sel);
+	assert(!mode_is_float(get_irn_mode(get_Cmp_left(sel))));
+
+	/* The false value is moved into the result register first, so prefer the
+	 * immediate form for the conditional move. */
+	arm_immediate_t imm;
+	if (try_encode_as_immediate(val_true, &imm, IMM_POS) == IMM_NONE
+	    && try_encode_as_immediate(val_false, &imm, IMM_POS) != IMM_NONE) {
+		ir_node *const t = val_true;
+		val_true  = val_false;
+		val_false = t;
+		relation  = get_negated_relation(relation);
+	}
+
+	ir_node *const new_false = be_transform_node(val_false);
+	if (try_encode_as_immediate(val_true, &imm, IMM_POS) != IMM_NONE)
+		return new_bd_arm_MovCC_imm(dbgi, block, new_false, flags, relation, imm.imm_8, imm.rot);
+
+	ir_node *const new_true = be_transform_node(val_true);
+	return new_bd_arm_MovCC_reg(dbgi, block, new_false, flags, new_true, relation);
+}
+
 enum fpa_imm_mode {
 	FPA_IMM_FLOAT  = 0,
 	FPA_IMM_DOUBLE = 1,
@@ -1976,6 +2006,7 @@ static void arm_register_transformers(void)
 	be_set_transform_function(op_Member,      gen_Member);
 	be_set_transform_function(op_Minus,       gen_Minus);
 	be_set_transform_function(op_Mul,         gen_Mul);
+	be_set_transform_function(op_Mux,         gen_Mux);
 	be_set_transform_function(op_Not,         gen_Not);
 	be_set_transform_function(op_Or,          gen_Or);
 	be_set_transform_function(op_Phi,         gen_Phi);
@@ -48,8 +48,11 @@ struct be_options_t {
 	bool opt_profile_use;      /**< use existing profile data */
 	bool omit_fp;              /**< try to omit the frame pointer */
 	bool do_verify;            /**< backend verify option */
+	bool verify_liveness;      /**< check updated liveness sets (slow) */
 	char ilp_solver[128];      /**< the ilp solver name */
 	bool verbose_asm;          /**< dump verbose assembler */
+	bool order_functions;      /**< order functions by call frequencies */
+	bool emit_object;          /**< write an ELF object instead of assembler */
 	be_pic_style_t pic_style;
 };
 extern be_options_t be_options;
@@ -100,6 +103,7 @@ typedef enum {
 	T_LIVE,
 	T_EXECFREQ,
 	T_SSA_CONSTR,
+	T_SPILLSLOTS,
 	T_RA_EPILOG,
 	T_RA_CONSTR,
 	T_RA_SPILL,
@@ -46,6 +46,16 @@ typedef enum arch_irn_flags_t {
 } arch_irn_flags_t;
 ENUM_BITSET(arch_irn_flags_t)
 
+/**
+ * Execution costs of a machine instruction on some microarchitecture, as
+ * specified in the node specification of a backend.
+ */
+typedef struct be_op_cost_t {
+	unsigned short latency;    /**< cycles until the result is available */
+	unsigned short uops;       /**< number of issued micro-operations */
+	float          throughput; /**< reciprocal throughput in cycles */
+} be_op_cost_t;
+
 typedef struct be_lv_t         be_lv_t;
 typedef struct be_lv_info_t    be_lv_info_t;
 typedef struct backend_info_t  backend_info_t;
@@ -56,5 +66,6 @@ typedef struct copy_opt_t      copy_opt_t;
 typedef struct be_main_env_t   be_main_env_t;
 typedef struct be_options_t    be_options_t;
 typedef struct regalloc_if_t   regalloc_if_t;
+typedef struct be_elf_target_t be_elf_target_t;
 
 #endif
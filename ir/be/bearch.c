@@ -120,9 +120,27 @@ arch_register_t const *arch_find_register(char const *const name)
 		if (streq(reg->name, name))
 			return reg;
 	}
+	for (size_t i = 0, n = isa_if->n_registers; i < n; ++i) {
+		arch_register_t const *const reg = &regs[i];
+		for (arch_subreg_t s = arch_subreg_8; s <= arch_subreg_last; ++s) {
+			char const *const subreg_name = reg->subreg_names[s];
+			if (subreg_name != NULL && streq(subreg_name, name))
+				return reg;
+		}
+	}
 	return NULL;
 }
 
+char const *arch_get_subreg_name(arch_register_t const *const reg,
+                                 arch_subreg_t const subreg)
+{
+	char const *const name = reg->subreg_names[subreg];
+	if (name == NULL)
+		panic("register %s has no sub-register of kind %d", reg->name,
+		      (int)subreg);
+	return name;
+}
+
 void arch_set_additional_pressure(ir_node *const node,
                                   arch_register_class_t const *const cls,
                                   uint8_t const pressure)
@@ -163,6 +163,18 @@ static inline unsigned arch_get_irn_n_outs(const ir_node *node)
  */
 void be_register_isa_if(const char *name, const arch_isa_if_t *isa);
 
+/**
+ * Partial accesses of a register which name an aliasing sub-register, like
+ * al, ah and ax of eax on x86.
+ */
+typedef enum arch_subreg_t {
+	arch_subreg_8,  /**< the lowest 8 bits */
+	arch_subreg_8h, /**< bits 8 to 15 */
+	arch_subreg_16, /**< the lowest 16 bits */
+	arch_subreg_32, /**< the lowest 32 bits */
+	arch_subreg_last = arch_subreg_32
+} arch_subreg_t;
+
 /**
  * A register.
  */
@@ -183,8 +195,20 @@ struct arch_register_t {
 	 * constraints as long as the register class matches. It is allowed to
 	 * have multiple definitions for the same virtual register at a point */
 	bool                         is_virtual : 1;
+	/** names of the aliasing sub-registers, NULL if the register has no
+	 * such sub-register */
+	const char                  *subreg_names[arch_subreg_last + 1];
 };
 
+/**
+ * Returns whether register @p reg can be accessed partially by @p subreg.
+ */
+static inline bool arch_register_has_subreg(const arch_register_t *reg,
+                                            arch_subreg_t subreg)
+{
+	return reg->subreg_names[subreg] != NULL;
+}
+
 /**
  * A class of registers.
  * Like general purpose or floating point.
@@ -290,7 +314,20 @@ struct arch_isa_if_t {
 
 	ir_jit_function_t* (*jit_compile)(ir_jit_segment_t *segment, ir_graph *irg);
 
-	void (*emit_function)(char *buffer, ir_jit_function_t *function);
+	/**
+	 * Writes @p function to @p buffer with relocations resolved for
+	 * execution at @p address.
+	 */
+	void (*emit_function)(char *buffer, char const *address,
+	                      ir_jit_function_t *function);
+
+	/**
+	 * Redirects the patchable entry of a function compiled in the fast jit
+	 * tier to @p target. The entry is written at @p entry and executed at
+	 * @p address. See be_jit_patch_entry().
+	 */
+	void (*jit_patch_entry)(char *entry, char const *address,
+	                        void const *target);
 
 	/**
 	 * lowers current program for target. See the documentation for
@@ -315,6 +352,12 @@ struct arch_isa_if_t {
 	 * number of cycles necessary to execute the instruction.
 	 */
 	unsigned (*get_op_estimated_cost)(const ir_node *irn);
+
+	/**
+	 * Describes the ELF object output, NULL if the backend cannot write
+	 * object files directly.
+	 */
+	const be_elf_target_t *elf_target;
 };
 
 static inline bool arch_irn_is_ignore(const ir_node *irn)
@@ -330,8 +373,19 @@ static inline bool arch_irn_consider_in_reg_alloc(
 	return req->cls == cls && !req->ignore;
 }
 
+/**
+ * Returns the register named @p name. The name of an aliasing sub-register
+ * yields the register containing it.
+ */
 arch_register_t const *arch_find_register(char const *name);
 
+/**
+ * Returns the name of sub-register @p subreg of register @p reg. Panics if
+ * there is no such sub-register.
+ */
+char const *arch_get_subreg_name(arch_register_t const *reg,
+                                 arch_subreg_t subreg);
+
 #define be_foreach_value(node, value, code) \
 	do { \
 		if (get_irn_mode(node) == mode_T) { \
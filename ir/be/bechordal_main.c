@@ -32,6 +32,7 @@
 #include "irtools.h"
 #include "execfreq.h"
 #include "iredges_t.h"
+#include "irnodeset.h"
 
 #include "bechordal_t.h"
 #include "belive.h"
@@ -122,23 +123,48 @@ void be_chordal_dump(unsigned const mask, ir_graph *const irg, arch_register_cla
 	}
 }
 
+typedef struct memory_operand_env_t {
+	const regalloc_if_t *regif;
+	be_lv_t             *lv;
+	ir_nodeset_t         changed; /**< values which gained or lost uses */
+} memory_operand_env_t;
+
 /**
  * Post-Walker: Checks for the given reload if has only one user that can
  * perform the reload as part of its address mode.
  * Fold the reload into the user it that is possible.
  */
-static void memory_operand_walker(ir_node *irn, void *env)
+static void memory_operand_walker(ir_node *irn, void *data)
 {
-	const regalloc_if_t *regif = (const regalloc_if_t*)env;
+	memory_operand_env_t *const env = (memory_operand_env_t*)data;
 	foreach_irn_in(irn, i, in) {
-		if (!arch_irn_is(skip_Proj(in), reload))
+		ir_node *const reload = skip_Proj(in);
+		if (!arch_irn_is(reload, reload))
 			continue;
 		if (get_nodes_block(in) != get_nodes_block(irn))
 			continue;
 		/* only use memory operands, if the reload is only used by 1 node */
 		if (get_irn_n_edges(in) > 1)
 			continue;
-		regif->perform_memory_operand(irn, i);
+
+		/* The reload is only used in its own block, so it is not in the
+		 * liveness sets. Remember the operands, which lose a use, when the
+		 * reload is folded. */
+		if (env->lv->sets_valid) {
+			foreach_irn_in(irn, j, op) {
+				if (j != i)
+					ir_nodeset_insert(&env->changed, op);
+			}
+			foreach_irn_in(reload, j, op) {
+				ir_nodeset_insert(&env->changed, op);
+			}
+		}
+		env->regif->perform_memory_operand(irn, i);
+		if (env->lv->sets_valid && get_irn_n(irn, i) != in) {
+			foreach_irn_in(irn, j, op) {
+				ir_nodeset_insert(&env->changed, op);
+			}
+		}
 	}
 }
 
@@ -149,7 +175,19 @@ void check_for_memory_operands(ir_graph *irg, const regalloc_if_t *regif)
 {
 	if (regif->perform_memory_operand == NULL)
 		return;
-	irg_walk_graph(irg, NULL, memory_operand_walker, (void*)regif);
+
+	memory_operand_env_t env = {
+		.regif = regif,
+		.lv    = be_get_irg_liveness(irg),
+	};
+	ir_nodeset_init(&env.changed);
+	irg_walk_graph(irg, NULL, memory_operand_walker, &env);
+
+	/* keep valid liveness sets up to date */
+	foreach_ir_nodeset(&env.changed, op, iter) {
+		be_liveness_update(env.lv, op);
+	}
+	ir_nodeset_destroy(&env.changed);
 }
 
 static be_node_stats_t last_node_stats;
@@ -191,6 +229,15 @@ static void post_spill(be_chordal_env_t *const chordal_env, ir_graph *const irg,
 		be_check_verify_result(check_pressure, irg);
 		be_timer_pop(T_VERIFY);
 	}
+	/* recomputes the whole liveness, so it is not part of the default
+	 * verification */
+	be_lv_t *const lv = be_get_irg_liveness(irg);
+	if (be_options.verify_liveness && lv->sets_valid) {
+		be_timer_push(T_VERIFY);
+		bool check_liveness = be_liveness_check(lv);
+		be_check_verify_result(check_liveness, irg);
+		be_timer_pop(T_VERIFY);
+	}
 
 	/* Color the graph. */
 	be_timer_push(T_RA_COLOR);
@@ -218,11 +265,34 @@ static void post_spill(be_chordal_env_t *const chordal_env, ir_graph *const irg,
 		stat_ev_dbl("bechordal_perms_before_coal",  node_stats[BE_STAT_PERMS]);
 		stat_ev_dbl("bechordal_copies_before_coal", node_stats[BE_STAT_COPIES]);
 	}
+}
 
+/**
+ * Minimize the copies of all register classes. This only reads the graph and
+ * reassigns registers within each class, so the classes may be handled on
+ * separate threads.
+ */
+static void copy_minimization(be_chordal_env_t *const envs, size_t const n_envs)
+{
 	be_timer_push(T_RA_COPYMIN);
-	co_driver(chordal_env);
+	if (co_can_run_parallel()) {
+		co_driver_parallel(envs, n_envs);
+	} else {
+		for (size_t i = 0; i < n_envs; ++i) {
+			stat_ev_ctx_push_str("bechordal_cls", envs[i].cls->name);
+			co_driver(&envs[i]);
+			stat_ev_ctx_pop("bechordal_cls");
+		}
+	}
 	be_timer_pop(T_RA_COPYMIN);
+}
 
+/**
+ * Perform things which need to be done per register class after copy
+ * minimization.
+ */
+static void post_copymin(be_chordal_env_t *const chordal_env, ir_graph *const irg)
+{
 	be_chordal_dump(BE_CH_DUMP_COPYMIN, irg, chordal_env->cls, "copymin");
 
 	/* ssa destruction */
@@ -238,11 +308,34 @@ static void post_spill(be_chordal_env_t *const chordal_env, ir_graph *const irg,
 	/* free some always allocated data structures */
 	pmap_destroy(chordal_env->border_heads);
 	free(chordal_env->allocatable_regs);
+	obstack_free(&chordal_env->obst, NULL);
+}
+
+/**
+ * Adds the nodes created since the last call to the statistics of a register
+ * class.
+ */
+static void add_class_node_stats(be_node_stats_t *const class_stats,
+                                 ir_graph *const irg)
+{
+	be_node_stats_t node_stats;
+	be_collect_node_stats(&node_stats, irg);
+	be_node_stats_t new_nodes;
+	be_copy_node_stats(&new_nodes, &node_stats);
+	be_subtract_node_stats(&new_nodes, &last_node_stats);
+	be_add_node_stats(class_stats, &new_nodes);
+	be_copy_node_stats(&last_node_stats, &node_stats);
 }
 
 /**
  * Performs chordal register allocation for each register class on given irg.
  *
+ * Spilling, coloring and SSA destruction change the graph, so they handle one
+ * register class after another. They only create and color values of their
+ * own class, so a class is not affected by the classes handled after it. This
+ * allows to spill and color all classes first, minimize their copies at once
+ * and commit the result of each class with SSA destruction afterwards.
+ *
  * @param irg    the graph
  * @return Structure containing timer for the single phases or NULL if no
  *         timing requested.
@@ -253,21 +346,18 @@ static void be_ra_chordal_main(ir_graph *irg, const regalloc_if_t *regif)
 
 	be_spill_prepare_for_constraints(irg);
 
-	be_chordal_env_t chordal_env;
-	obstack_init(&chordal_env.obst);
-	chordal_env.irg              = irg;
-	chordal_env.border_heads     = NULL;
-	chordal_env.ifg              = NULL;
-	chordal_env.allocatable_regs = NULL;
-
 	if (stat_ev_enabled)
 		be_collect_node_stats(&last_node_stats, irg);
 
 	/* use one of the generic spiller */
 
-	/* Perform the following for each register class. */
+	/* Spill and color each register class. */
 	arch_register_class_t const *const reg_classes = isa_if->register_classes;
-	for (int j = 0, m = isa_if->n_register_classes; j < m; ++j) {
+	size_t            const        n_classes   = isa_if->n_register_classes;
+	be_chordal_env_t *const        envs        = XMALLOCN(be_chordal_env_t, n_classes);
+	be_node_stats_t  *const        class_stats = XMALLOCNZ(be_node_stats_t, n_classes);
+	size_t                         n_envs      = 0;
+	for (size_t j = 0; j < n_classes; ++j) {
 		arch_register_class_t const *const cls = &reg_classes[j];
 		if (cls->manual_ra)
 			continue;
@@ -280,7 +370,11 @@ static void be_ra_chordal_main(ir_graph *irg, const regalloc_if_t *regif)
 			pre_spill_cost = be_estimate_irg_costs(irg);
 		}
 
-		pre_spill(&chordal_env, cls, irg);
+		be_chordal_env_t *const chordal_env = &envs[n_envs++];
+		obstack_init(&chordal_env->obst);
+		chordal_env->irg = irg;
+		chordal_env->ifg = NULL;
+		pre_spill(chordal_env, cls, irg);
 
 		be_timer_push(T_RA_SPILL);
 		be_do_spill(irg, cls, regif);
@@ -288,23 +382,35 @@ static void be_ra_chordal_main(ir_graph *irg, const regalloc_if_t *regif)
 		be_chordal_dump(BE_CH_DUMP_SPILL, irg, cls, "spill");
 		stat_ev_dbl("bechordal_spillcosts", be_estimate_irg_costs(irg) - pre_spill_cost);
 
-		post_spill(&chordal_env, irg, regif);
+		post_spill(chordal_env, irg, regif);
+
+		if (stat_ev_enabled) {
+			add_class_node_stats(&class_stats[n_envs - 1], irg);
+			stat_ev_ctx_pop("bechordal_cls");
+		}
+	}
+
+	copy_minimization(envs, n_envs);
+
+	for (size_t i = 0; i < n_envs; ++i) {
+		be_chordal_env_t *const chordal_env = &envs[i];
+		stat_ev_ctx_push_str("bechordal_cls", chordal_env->cls->name);
+
+		post_copymin(chordal_env, irg);
 
 		if (stat_ev_enabled) {
-			be_node_stats_t node_stats;
-			be_collect_node_stats(&node_stats, irg);
-			be_subtract_node_stats(&node_stats, &last_node_stats);
-			be_emit_node_stats(&node_stats, "bechordal_");
-			be_copy_node_stats(&last_node_stats, &node_stats);
+			add_class_node_stats(&class_stats[i], irg);
+			be_emit_node_stats(&class_stats[i], "bechordal_");
 			stat_ev_ctx_pop("bechordal_cls");
 		}
 	}
+	free(class_stats);
+	free(envs);
 
 	be_timer_push(T_RA_EPILOG);
 	lower_nodes_after_ra(irg, options.lower_perm_opt == BE_CH_LOWER_PERM_COPY);
 	be_chordal_dump(BE_CH_DUMP_LOWER, irg, NULL, "belower-after-ra");
 
-	obstack_free(&chordal_env.obst, NULL);
 	be_invalidate_live_sets(irg);
 	be_timer_pop(T_RA_EPILOG);
 
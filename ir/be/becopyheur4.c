@@ -57,7 +57,6 @@ static firm_dbg_module_t *dbg = NULL;
 typedef float real_t;
 #define REAL(C)   (C ## f)
 
-static unsigned last_chunk_id;
 static int      recolor_limit     = 7;
 static double   dislike_influence = REAL(0.1);
 
@@ -104,6 +103,7 @@ typedef struct co_mst_env_t {
 	col_cost_t      **single_cols;
 	unsigned          n_regs;         /**< number of regs in class */
 	unsigned          chunk_visited;
+	unsigned          last_chunk_id;  /**< id of the last created chunk */
 } co_mst_env_t;
 
 /* stores coalescing related information for a node */
@@ -300,7 +300,7 @@ static inline aff_chunk_t *new_aff_chunk(co_mst_env_t *env)
 #ifndef NDEBUG
 	c->deleted           = false;
 #endif
-	c->id                = ++last_chunk_id;
+	c->id                = ++env->last_chunk_id;
 	c->visited           = 0;
 	list_add(&c->list, &env->chunklist);
 	return c;
@@ -1265,8 +1265,6 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
  */
 static int co_solve_heuristic_mst(copy_opt_t *co)
 {
-	last_chunk_id = 0;
-
 	stat_ev_tim_push();
 
 	/* init phase */
@@ -1283,6 +1281,7 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	mst_env.ifg              = co->cenv->ifg;
 	INIT_LIST_HEAD(&mst_env.chunklist);
 	mst_env.chunk_visited    = 0;
+	mst_env.last_chunk_id    = 0;
 	mst_env.single_cols      = OALLOCN(&mst_env.obst, col_cost_t*, n_regs);
 
 	for (unsigned i = 0; i < n_regs; ++i) {
@@ -1355,7 +1354,7 @@ void be_init_copyheur4(void)
 	lc_opt_entry_t *heur4_grp   = lc_opt_get_grp(co_grp, "heur4");
 
 	static co_algo_info copyheur = {
-		co_solve_heuristic_mst
+		co_solve_heuristic_mst, true
 	};
 
 	lc_opt_add_table(heur4_grp, options);
@@ -14,6 +14,11 @@
  * - Register-constrained nodes
  * - Two-address code instructions
  */
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 #include "debug.h"
 #include "panic.h"
 #include "execfreq_t.h"
@@ -85,6 +90,8 @@ static int co_get_costs_all_one(const ir_node *root, int pos);
 static unsigned   dump_flags  = 0;
 static unsigned   style_flags = CO_IFG_DUMP_COLORS;
 static bool       do_stats    = false;
+static bool       use_threads = true;
+static int        thread_min  = 1000;
 static cost_fct_t cost_func   = co_get_costs_exec_freq;
 
 static const lc_opt_enum_mask_items_t dump_items[] = {
@@ -125,10 +132,12 @@ static lc_opt_enum_func_ptr_var_t cost_func_var = {
 };
 
 static const lc_opt_table_entry_t options[] = {
-	LC_OPT_ENT_ENUM_FUNC_PTR ("cost",  "select a cost function",                     &cost_func_var),
-	LC_OPT_ENT_ENUM_MASK     ("dump",  "dump ifg before or after copy optimization", &dump_var),
-	LC_OPT_ENT_ENUM_MASK     ("style", "dump style for ifg dumping",                 &style_var),
-	LC_OPT_ENT_BOOL          ("stats", "dump statistics after each optimization",    &do_stats),
+	LC_OPT_ENT_ENUM_FUNC_PTR ("cost",       "select a cost function",                      &cost_func_var),
+	LC_OPT_ENT_ENUM_MASK     ("dump",       "dump ifg before or after copy optimization",  &dump_var),
+	LC_OPT_ENT_ENUM_MASK     ("style",      "dump style for ifg dumping",                  &style_var),
+	LC_OPT_ENT_BOOL          ("stats",      "dump statistics after each optimization",     &do_stats),
+	LC_OPT_ENT_BOOL          ("threads",    "handle the register classes in parallel",     &use_threads),
+	LC_OPT_ENT_INT           ("thread_min", "affinity edges of a class to use a thread",   &thread_min),
 	LC_OPT_LAST
 };
 
@@ -165,7 +174,7 @@ BE_REGISTER_MODULE_CONSTRUCTOR(be_init_copynone)
 void be_init_copynone(void)
 {
 	static co_algo_info copyheur = {
-		void_algo
+		void_algo, true
 	};
 
 	be_register_copyopt("none", &copyheur);
@@ -771,13 +780,30 @@ static FILE *my_open(const be_chordal_env_t *env, const char *prefix,
 	return result;
 }
 
-void co_driver(be_chordal_env_t *cenv)
-{
-	ir_timer_t *timer = ir_timer_new();
+/**
+ * Copy minimization of one register class. Only solving the problem may run
+ * on a separate thread, preparing and finishing it walk the graph.
+ */
+typedef struct co_job_t {
+	copy_opt_t          *co;
+	co_complete_stats_t  before;
+	int                  was_optimal;
+	double               time;      /**< msec, only measured for statistics */
+#ifndef _WIN32
+	pthread_t            thread;
+	bool                 on_thread;
+#endif
+} co_job_t;
 
+/**
+ * Builds the copy minimization problem of @p cenv.
+ * @return false if there is nothing to do
+ */
+static bool co_prepare(co_job_t *const job, be_chordal_env_t *const cenv)
+{
 	/* skip copymin if algo is 'none' */
 	if (selected_copyopt->copyopt == void_algo)
-		return;
+		return false;
 
 	if (cost_func == co_get_costs_exec_freq && irg_for_factors != cenv->irg) {
 		ir_calculate_execfreq_int_factors(&factors, cenv->irg);
@@ -789,33 +815,54 @@ void co_driver(be_chordal_env_t *cenv)
 	copy_opt_t *co = new_copy_opt(cenv, cost_func);
 	co_build_ou_structure(co);
 	co_build_graph_structure(co);
+	job->co = co;
 
-	co_complete_stats_t before;
-	co_complete_stats(co, &before);
+	co_complete_stats_t *const before = &job->before;
+	co_complete_stats(co, before);
 
-	stat_ev_ull("co_aff_nodes",    before.aff_nodes);
-	stat_ev_ull("co_aff_edges",    before.aff_edges);
-	stat_ev_ull("co_max_costs",    before.max_costs);
-	stat_ev_ull("co_inevit_costs", before.inevit_costs);
-	stat_ev_ull("co_aff_int",      before.aff_int);
+	stat_ev_ull("co_aff_nodes",    before->aff_nodes);
+	stat_ev_ull("co_aff_edges",    before->aff_edges);
+	stat_ev_ull("co_max_costs",    before->max_costs);
+	stat_ev_ull("co_inevit_costs", before->inevit_costs);
+	stat_ev_ull("co_aff_int",      before->aff_int);
 
-	stat_ev_ull("co_init_costs",   before.costs);
-	stat_ev_ull("co_init_unsat",   before.unsatisfied_edges);
+	stat_ev_ull("co_init_costs",   before->costs);
+	stat_ev_ull("co_init_unsat",   before->unsatisfied_edges);
 
 	if (dump_flags & DUMP_BEFORE) {
 		FILE *f = my_open(cenv, "", "-before.vcg");
 		be_dump_ifg_co(f, co, style_flags & CO_IFG_DUMP_LABELS, style_flags & CO_IFG_DUMP_COLORS);
 		fclose(f);
 	}
+	return true;
+}
+
+static void co_solve(co_job_t *const job)
+{
+	/* timers are not thread safe, but statistics keep all classes on one
+	 * thread anyway */
+	ir_timer_t *const timer = stat_ev_enabled ? ir_timer_new() : NULL;
+	if (timer != NULL)
+		ir_timer_reset_and_start(timer);
 
 	/* perform actual copy minimization */
-	ir_timer_reset_and_start(timer);
-	int was_optimal = selected_copyopt->copyopt(co);
-	ir_timer_stop(timer);
+	job->was_optimal = selected_copyopt->copyopt(job->co);
+
+	job->time = 0;
+	if (timer != NULL) {
+		ir_timer_stop(timer);
+		job->time = ir_timer_elapsed_msec(timer);
+		ir_timer_free(timer);
+	}
+}
+
+static void co_finish(co_job_t *const job)
+{
+	copy_opt_t       *const co   = job->co;
+	be_chordal_env_t *const cenv = co->cenv;
 
-	stat_ev_dbl("co_time", ir_timer_elapsed_msec(timer));
-	stat_ev_ull("co_optimal", was_optimal);
-	ir_timer_free(timer);
+	stat_ev_dbl("co_time", job->time);
+	stat_ev_ull("co_optimal", job->was_optimal);
 
 	if (dump_flags & DUMP_AFTER) {
 		FILE *f = my_open(cenv, "", "-after.vcg");
@@ -823,6 +870,7 @@ void co_driver(be_chordal_env_t *cenv)
 		fclose(f);
 	}
 
+	co_complete_stats_t const *const before = &job->before;
 	co_complete_stats_t after;
 	co_complete_stats(co, &after);
 
@@ -831,7 +879,7 @@ void co_driver(be_chordal_env_t *cenv)
 		unsigned long long evitable          = after.costs     - after.inevit_costs;
 
 		ir_printf("%30F ", cenv->irg);
-		printf("%10s %10llu%10llu%10llu", cenv->cls->name, after.max_costs, before.costs, after.inevit_costs);
+		printf("%10s %10llu%10llu%10llu", cenv->cls->name, after.max_costs, before->costs, after.inevit_costs);
 
 		if (optimizable_costs > 0)
 			printf("%10llu %5.2f\n", after.costs, (evitable * 100.0) / optimizable_costs);
@@ -854,3 +902,86 @@ void co_driver(be_chordal_env_t *cenv)
 	co_free_ou_structure(co);
 	free_copy_opt(co);
 }
+
+void co_driver(be_chordal_env_t *cenv)
+{
+	co_job_t job;
+	if (co_prepare(&job, cenv)) {
+		co_solve(&job);
+		co_finish(&job);
+	}
+}
+
+#ifndef _WIN32
+static void *co_solve_thread(void *data)
+{
+	co_solve((co_job_t*)data);
+	return NULL;
+}
+
+/** Threads only pay off for classes with many affinities. */
+static bool co_is_worth_thread(co_job_t const *const job)
+{
+	return job->before.aff_edges >= (unsigned long long)MAX(thread_min, 0);
+}
+#endif
+
+bool co_can_run_parallel(void)
+{
+#ifndef _WIN32
+	static long n_cpus = 0;
+	if (n_cpus == 0)
+		n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	/* dumps and statistics are written in class order */
+	return use_threads && n_cpus > 1 && selected_copyopt->thread_safe
+	    && dump_flags == 0 && !do_stats && !stat_ev_enabled;
+#else
+	return false;
+#endif
+}
+
+void co_driver_parallel(be_chordal_env_t *const cenvs, size_t const n_cenvs)
+{
+#ifndef _WIN32
+	if (co_can_run_parallel()) {
+		co_job_t *const jobs   = XMALLOCN(co_job_t, n_cenvs);
+		size_t          n_jobs = 0;
+		for (size_t i = 0; i < n_cenvs; ++i) {
+			if (co_prepare(&jobs[n_jobs], &cenvs[i]))
+				++n_jobs;
+		}
+
+		/* Big classes except the first one get a thread of their own. The
+		 * current thread solves the others, also if no thread can be
+		 * created. */
+		bool first_big = true;
+		for (size_t i = 0; i < n_jobs; ++i) {
+			co_job_t *const job = &jobs[i];
+			job->on_thread = false;
+			if (!co_is_worth_thread(job))
+				continue;
+			if (first_big) {
+				first_big = false;
+				continue;
+			}
+			job->on_thread
+				= pthread_create(&job->thread, NULL, co_solve_thread, job) == 0;
+		}
+		for (size_t i = 0; i < n_jobs; ++i) {
+			if (!jobs[i].on_thread)
+				co_solve(&jobs[i]);
+		}
+		for (size_t i = 0; i < n_jobs; ++i) {
+			if (jobs[i].on_thread)
+				pthread_join(jobs[i].thread, NULL);
+		}
+
+		for (size_t i = 0; i < n_jobs; ++i)
+			co_finish(&jobs[i]);
+		free(jobs);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < n_cenvs; ++i)
+		co_driver(&cenvs[i]);
+}
@@ -18,6 +18,7 @@
 #define FIRM_BE_BECOPYOPT_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "firm_types.h"
 #include "bechordal.h"
@@ -25,7 +26,9 @@
 typedef int(*cost_fct_t)(const ir_node *node, int input);
 
 typedef struct {
-	int (*copyopt)(copy_opt_t *co); /**< function ptr to run copyopt */
+	int  (*copyopt)(copy_opt_t *co); /**< function ptr to run copyopt */
+	bool thread_safe;                /**< copyopt only reads the graph and
+	                                      may run for several classes at once */
 } co_algo_info;
 
 /**
@@ -40,4 +43,18 @@ void be_register_copyopt(const char *name, co_algo_info *copyopt);
 /** The driver for copy minimization. */
 void co_driver(be_chordal_env_t *cenv);
 
+/**
+ * Checks whether co_driver_parallel() may handle the register classes on
+ * separate threads. This needs more than one processor.
+ */
+bool co_can_run_parallel(void);
+
+/**
+ * Like co_driver() for the @p n_cenvs register classes in @p cenvs. Copy
+ * minimization only reads the graph and assigns registers of its own class,
+ * so the classes are handled on separate threads if co_can_run_parallel().
+ * Classes with few affinity edges are handled on the current thread.
+ */
+void co_driver_parallel(be_chordal_env_t *cenvs, size_t n_cenvs);
+
 #endif
@@ -943,6 +943,11 @@ void be_dwarf_open(void)
 	pset_new_init(&env.emitted_types);
 }
 
+bool be_dwarf_enabled(void)
+{
+	return debug_level >= LEVEL_BASIC;
+}
+
 void be_dwarf_set_source_language(dwarf_source_language new_language)
 {
 	language = new_language;
@@ -11,6 +11,8 @@
 #ifndef FIRM_BE_BEDWARF_H
 #define FIRM_BE_BEDWARF_H
 
+#include <stdbool.h>
+
 #include "be_types.h"
 
 typedef struct parameter_dbg_info_t {
@@ -21,6 +23,9 @@ typedef struct parameter_dbg_info_t {
 /** initialize and open debug handle */
 void be_dwarf_open(void);
 
+/** Returns whether any debug information is produced. */
+bool be_dwarf_enabled(void);
+
 /** close a debug handler. */
 void be_dwarf_close(void);
 
@@ -0,0 +1,979 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes ELF relocatable object files directly.
+ *
+ * Sections are collected in memory while the backend emits functions, global
+ * variables follow at the end of the compilation unit. Relocations are
+ * recorded against symbols and finalized when the file is written: Like the
+ * GNU assembler, relocations against local symbols refer to the section
+ * symbol where possible and pc-relative references inside a section are
+ * resolved directly.
+ */
+#include "beelf.h"
+
+#include <string.h>
+
+#include "array.h"
+#include "be_t.h"
+#include "begnuas.h"
+#include "bejit.h"
+#include "bitfiddle.h"
+#include "entity_t.h"
+#include "irnode_t.h"
+#include "irprog_t.h"
+#include "obst.h"
+#include "panic.h"
+#include "pmap.h"
+#include "tv.h"
+#include "util.h"
+
+enum {
+	ELF_ET_REL         = 1,
+	ELF_EV_CURRENT     = 1,
+	ELF_CLASS32        = 1,
+	ELF_CLASS64        = 2,
+	ELF_DATA2LSB       = 1,
+	ELF_DATA2MSB       = 2,
+
+	ELF_SHT_NULL       = 0,
+	ELF_SHT_PROGBITS   = 1,
+	ELF_SHT_SYMTAB     = 2,
+	ELF_SHT_STRTAB     = 3,
+	ELF_SHT_RELA       = 4,
+	ELF_SHT_NOBITS     = 8,
+	ELF_SHT_REL        = 9,
+
+	ELF_SHF_WRITE      = 0x1,
+	ELF_SHF_ALLOC      = 0x2,
+	ELF_SHF_EXECINSTR  = 0x4,
+	ELF_SHF_INFO_LINK  = 0x40,
+	ELF_SHF_TLS        = 0x400,
+
+	ELF_SHN_UNDEF      = 0,
+	ELF_SHN_COMMON     = 0xFFF2,
+
+	ELF_STB_LOCAL      = 0,
+	ELF_STB_GLOBAL     = 1,
+	ELF_STB_WEAK       = 2,
+
+	ELF_STT_NOTYPE     = 0,
+	ELF_STT_OBJECT     = 1,
+	ELF_STT_FUNC       = 2,
+	ELF_STT_SECTION    = 3,
+	ELF_STT_FILE       = 4,
+	ELF_STT_TLS        = 6,
+
+	ELF_STV_DEFAULT    = 0,
+	ELF_STV_HIDDEN     = 2,
+	ELF_STV_PROTECTED  = 3,
+};
+
+typedef struct elf_symbol_t  elf_symbol_t;
+typedef struct elf_section_t elf_section_t;
+
+typedef struct elf_reloc_t {
+	unsigned long  offset;  /**< position of the field in the section */
+	elf_symbol_t  *symbol;  /**< the referenced symbol */
+	elf_section_t *base;    /**< if set, relative to this section instead */
+	int64_t        addend;
+	be_elf_reloc_t kind;
+} elf_reloc_t;
+
+struct elf_section_t {
+	char const    *name;
+	uint32_t       type;
+	uint32_t       flags;
+	unsigned       align;
+	unsigned long  size;      /**< size, only used for SHT_NOBITS */
+	char          *data;      /**< flexible array with the contents */
+	elf_reloc_t   *relocs;    /**< flexible array of relocations */
+	unsigned       index;     /**< section header index */
+	unsigned       sym_index; /**< symbol table index of the section symbol */
+};
+
+struct elf_symbol_t {
+	ir_entity const *entity;
+	char const      *name;
+	elf_section_t   *section;   /**< defining section, NULL if undefined */
+	uint64_t         value;     /**< offset in section, alignment if common */
+	uint64_t         size;
+	uint8_t          bind;
+	uint8_t          type;
+	uint8_t          visibility;
+	bool             common;
+	bool             in_symtab; /**< symbol needs a symbol table entry */
+	unsigned         index;     /**< symbol table index */
+};
+
+typedef struct elf_env_t {
+	FILE                  *output;
+	be_elf_target_t const *target;
+	char const            *cup_name;
+	bool                   big_endian;
+	struct obstack         obst;
+	elf_section_t        **sections; /**< sections in creation order */
+	elf_symbol_t         **symbols;  /**< symbols in creation order */
+	pmap                  *entity_symbols;
+} elf_env_t;
+
+static elf_env_t elf;
+
+/** Section name, ELF type and flags of the gas section kinds. */
+static const struct {
+	char const *name;
+	uint32_t    type;
+	uint32_t    flags;
+} elf_section_kinds[] = {
+	[GAS_SECTION_TEXT]         = { "text",              ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_EXECINSTR },
+	[GAS_SECTION_DATA]         = { "data",              ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE     },
+	[GAS_SECTION_RODATA]       = { "rodata",            ELF_SHT_PROGBITS, ELF_SHF_ALLOC                     },
+	[GAS_SECTION_REL_RO_LOCAL] = { "data.rel.ro.local", ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE     },
+	[GAS_SECTION_REL_RO]       = { "data.rel.ro",       ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE     },
+	[GAS_SECTION_BSS]          = { "bss",               ELF_SHT_NOBITS,   ELF_SHF_ALLOC | ELF_SHF_WRITE     },
+	[GAS_SECTION_CONSTRUCTORS] = { "ctors",             ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE     },
+	[GAS_SECTION_DESTRUCTORS]  = { "dtors",             ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE     },
+	[GAS_SECTION_JCR]          = { "jcr",               ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE     },
+};
+
+static elf_section_t *get_section(be_gas_section_t const section)
+{
+	be_gas_section_t const base = section & GAS_SECTION_TYPE_MASK;
+	bool             const tls  = section & GAS_SECTION_FLAG_TLS;
+	if ((size_t)base >= ARRAY_SIZE(elf_section_kinds)
+	    || elf_section_kinds[base].name == NULL)
+		panic("section kind %u not supported in object files", (unsigned)base);
+
+	char name[32];
+	snprintf(name, sizeof(name), ".%s%s", tls ? "t" : "",
+	         elf_section_kinds[base].name);
+	for (size_t i = 0, n = ARR_LEN(elf.sections); i < n; ++i) {
+		if (streq(elf.sections[i]->name, name))
+			return elf.sections[i];
+	}
+
+	elf_section_t *const res = OALLOCZ(&elf.obst, elf_section_t);
+	res->name   = obstack_copy0(&elf.obst, name, strlen(name));
+	res->type   = elf_section_kinds[base].type;
+	res->flags  = elf_section_kinds[base].flags | (tls ? ELF_SHF_TLS : 0);
+	res->align  = 1;
+	res->data   = NEW_ARR_F(char, 0);
+	res->relocs = NEW_ARR_F(elf_reloc_t, 0);
+	ARR_APP1(elf_section_t*, elf.sections, res);
+	return res;
+}
+
+static unsigned long get_section_size(elf_section_t const *const section)
+{
+	return section->type == ELF_SHT_NOBITS ? section->size
+	                                       : ARR_LEN(section->data);
+}
+
+/**
+ * Aligns the end of a section and appends @p size zero bytes.
+ * Returns the offset of the new bytes.
+ */
+static unsigned long section_append(elf_section_t *const section,
+                                    unsigned const align,
+                                    unsigned long const size,
+                                    void (*const fill)(char*, unsigned))
+{
+	unsigned long const old_size = get_section_size(section);
+	unsigned long const offset   = (old_size + align - 1) & ~(unsigned long)(align - 1);
+	section->align = MAX(section->align, align);
+	if (section->type == ELF_SHT_NOBITS) {
+		section->size = offset + size;
+		return offset;
+	}
+
+	ARR_RESIZE(char, section->data, offset + size);
+	char *const padding = section->data + old_size;
+	if (fill != NULL && offset > old_size)
+		fill(padding, offset - old_size);
+	else
+		memset(padding, 0, offset - old_size);
+	memset(section->data + offset, 0, size);
+	return offset;
+}
+
+static void put_value(char *const dest, uint64_t const value,
+                      unsigned const size)
+{
+	for (unsigned i = 0; i < size; ++i) {
+		unsigned const pos = elf.big_endian ? size - i - 1 : i;
+		dest[pos] = (char)(value >> (8 * i));
+	}
+}
+
+static char const *get_symbol_name(ir_entity const *const entity)
+{
+	char const *const name = get_entity_ld_name(entity);
+	if (get_entity_visibility(entity) != ir_visibility_private)
+		return name;
+	obstack_printf(&elf.obst, "%s%s", be_gas_get_private_prefix(), name);
+	obstack_1grow(&elf.obst, '\0');
+	return (char const*)obstack_finish(&elf.obst);
+}
+
+static elf_symbol_t *get_symbol(ir_entity const *const entity)
+{
+	elf_symbol_t *res = pmap_get(elf_symbol_t, elf.entity_symbols, entity);
+	if (res != NULL)
+		return res;
+
+	if (get_entity_kind(entity) == IR_ENTITY_LABEL)
+		panic("label %+F not supported in object files", entity);
+
+	res         = OALLOCZ(&elf.obst, elf_symbol_t);
+	res->entity = entity;
+	res->name   = get_symbol_name(entity);
+
+	ir_linkage const linkage = get_entity_linkage(entity);
+	switch (get_entity_visibility(entity)) {
+	case ir_visibility_external:
+		res->bind = ELF_STB_GLOBAL;
+		break;
+	case ir_visibility_external_private:
+		res->bind       = ELF_STB_GLOBAL;
+		res->visibility = ELF_STV_HIDDEN;
+		break;
+	case ir_visibility_external_protected:
+		res->bind       = ELF_STB_GLOBAL;
+		res->visibility = ELF_STV_PROTECTED;
+		break;
+	case ir_visibility_local:
+	case ir_visibility_private:
+		res->bind = ELF_STB_LOCAL;
+		break;
+	}
+	/* We do not produce COMDAT groups, mergeable definitions become weak. */
+	if (res->bind == ELF_STB_GLOBAL
+	    && (linkage & IR_LINKAGE_WEAK
+	        || (linkage & IR_LINKAGE_MERGE && entity_has_definition(entity)
+	            && is_method_entity(entity))))
+		res->bind = ELF_STB_WEAK;
+
+	if (is_method_entity(entity)) {
+		res->type = ELF_STT_FUNC;
+	} else if (get_entity_owner(entity) == get_tls_type()) {
+		res->type = ELF_STT_TLS;
+	} else if (entity_has_definition(entity)) {
+		res->type = ELF_STT_OBJECT;
+	}
+	res->in_symtab = get_entity_visibility(entity) != ir_visibility_private;
+
+	pmap_insert(elf.entity_symbols, entity, res);
+	ARR_APP1(elf_symbol_t*, elf.symbols, res);
+	return res;
+}
+
+static void define_symbol(ir_entity const *const entity,
+                          elf_section_t *const section,
+                          unsigned long const offset, unsigned long const size)
+{
+	elf_symbol_t *const symbol = get_symbol(entity);
+	if (symbol->section != NULL || symbol->common)
+		panic("%+F defined twice", entity);
+	symbol->section = section;
+	symbol->value   = offset;
+	symbol->size    = size;
+}
+
+static void add_reloc(elf_section_t *const section, unsigned long const offset,
+                      be_elf_reloc_t const *const kind,
+                      ir_entity const *const entity, int64_t const addend)
+{
+	elf_reloc_t const reloc = {
+		.offset = offset,
+		.symbol = get_symbol(entity),
+		.addend = addend,
+		.kind   = *kind,
+	};
+	ARR_APP1(elf_reloc_t, section->relocs, reloc);
+}
+
+void be_elf_begin_compilation_unit(FILE *const output,
+                                   be_elf_target_t const *const target,
+                                   char const *const cup_name)
+{
+	elf.output         = output;
+	elf.target         = target;
+	elf.big_endian     = be_get_backend_param()->byte_order_big_endian;
+	obstack_init(&elf.obst);
+	elf.cup_name       = cup_name != NULL
+		? obstack_copy0(&elf.obst, cup_name, strlen(cup_name)) : NULL;
+	elf.sections       = NEW_ARR_F(elf_section_t*, 0);
+	elf.symbols        = NEW_ARR_F(elf_symbol_t*, 0);
+	elf.entity_symbols = pmap_create();
+}
+
+static elf_section_t *code_section;
+
+static unsigned elf_code_relocation(char *const buffer,
+                                    char const *const address,
+                                    uint8_t const be_kind,
+                                    ir_entity *const entity,
+                                    int32_t const offset)
+{
+	(void)address;
+	be_elf_reloc_t reloc;
+	elf.target->get_reloc(be_kind, &reloc);
+	if (entity == NULL) {
+		/* fragment relative, already resolved */
+		put_value(buffer, (uint64_t)(int64_t)offset, reloc.size);
+		return reloc.size;
+	}
+
+	unsigned long const reloc_offset = buffer - code_section->data;
+	add_reloc(code_section, reloc_offset, &reloc, entity, offset);
+	return reloc.size;
+}
+
+void be_elf_emit_function(ir_entity const *const entity,
+                          unsigned const p2align,
+                          ir_jit_function_t *const function)
+{
+	be_gas_section_t const kind    = be_gas_get_section(NULL, entity);
+	elf_section_t   *const section = get_section(kind & ~GAS_SECTION_FLAG_COMDAT);
+	unsigned         const size    = be_get_function_size(function);
+	unsigned long    const offset
+		= section_append(section, 1u << p2align, size, elf.target->nops);
+	define_symbol(entity, section, offset, size);
+
+	be_jit_emit_interface_t const emitter = {
+		.nops       = elf.target->nops,
+		.relocation = elf_code_relocation,
+	};
+	code_section = section;
+	char *const code = section->data + offset;
+	be_jit_emit_memory(code, code, function, &emitter);
+	code_section = NULL;
+}
+
+/** Result of evaluating a constant expression: entity + value */
+typedef struct elf_const_t {
+	ir_entity const *entity;
+	int64_t          value;
+} elf_const_t;
+
+static elf_const_t eval_init_expression(ir_node const *const init)
+{
+	switch (get_irn_opcode(init)) {
+	case iro_Conv:
+		return eval_init_expression(get_Conv_op(init));
+
+	case iro_Const: {
+		ir_tarval *const tv = get_Const_tarval(init);
+		if (!tarval_is_long(tv))
+			panic("constant %+F does not fit into a relocation", init);
+		return (elf_const_t){ NULL, get_tarval_long(tv) };
+	}
+
+	case iro_Address:
+		return (elf_const_t){ get_Address_entity(init), 0 };
+
+	case iro_Offset:
+		return (elf_const_t){ NULL, get_entity_offset(get_Offset_entity(init)) };
+
+	case iro_Align:
+		return (elf_const_t){ NULL, get_type_alignment(get_Align_type(init)) };
+
+	case iro_Size:
+		return (elf_const_t){ NULL, get_type_size(get_Size_type(init)) };
+
+	case iro_Add: {
+		elf_const_t const l = eval_init_expression(get_Add_left(init));
+		elf_const_t const r = eval_init_expression(get_Add_right(init));
+		if (l.entity != NULL && r.entity != NULL)
+			panic("cannot add two addresses in %+F", init);
+		return (elf_const_t){ l.entity != NULL ? l.entity : r.entity,
+		                      l.value + r.value };
+	}
+
+	case iro_Sub: {
+		elf_const_t const l = eval_init_expression(get_Sub_left(init));
+		elf_const_t const r = eval_init_expression(get_Sub_right(init));
+		if (r.entity != NULL)
+			panic("address differences in %+F not supported in object files",
+			      init);
+		return (elf_const_t){ l.entity, l.value - r.value };
+	}
+
+	case iro_Mul: {
+		elf_const_t const l = eval_init_expression(get_Mul_left(init));
+		elf_const_t const r = eval_init_expression(get_Mul_right(init));
+		if (l.entity != NULL || r.entity != NULL)
+			panic("cannot multiply addresses in %+F", init);
+		return (elf_const_t){ NULL, l.value * r.value };
+	}
+
+	case iro_Unknown:
+		return (elf_const_t){ NULL, 0 };
+
+	default:
+		panic("unsupported IR-node %+F", init);
+	}
+}
+
+static void put_tarval(char *const dest, ir_tarval *const tv,
+                       unsigned const size)
+{
+	for (unsigned i = 0; i < size; ++i) {
+		unsigned const pos = elf.big_endian ? size - i - 1 : i;
+		dest[pos] = (char)get_tarval_sub_bits(tv, i);
+	}
+}
+
+static ir_tarval *get_bitfield_tarval(ir_initializer_t const *const init)
+{
+	switch (get_initializer_kind(init)) {
+	case IR_INITIALIZER_NULL:
+		return NULL;
+	case IR_INITIALIZER_TARVAL:
+		return get_initializer_tarval_value(init);
+	case IR_INITIALIZER_CONST: {
+		ir_node *const node = get_initializer_const_value(init);
+		if (!is_Const(node))
+			panic("bitfield initializer not a Const node");
+		return get_Const_tarval(node);
+	}
+	case IR_INITIALIZER_COMPOUND:
+		panic("bitfield initializer is compound");
+	}
+	panic("invalid initializer");
+}
+
+static void put_bitfield(char *const dest, ir_initializer_t const *const init,
+                         ir_type *const type, unsigned const offset_bits,
+                         unsigned const bitfield_size)
+{
+	ir_tarval *const tv = get_bitfield_tarval(init);
+	if (tv == NULL)
+		return;
+	if (tv == tarval_bad)
+		panic("couldn't get numeric value for bitfield initializer");
+
+	unsigned const size = get_type_size(type);
+	for (unsigned bit = 0; bit < bitfield_size; ++bit) {
+		unsigned const src = bit;
+		if (!(get_tarval_sub_bits(tv, src / 8) >> (src % 8) & 1))
+			continue;
+		unsigned const dst      = bit + offset_bits;
+		unsigned const dst_byte = dst / 8;
+		unsigned const pos      = elf.big_endian ? size - dst_byte - 1
+		                                         : dst_byte;
+		dest[pos] |= (char)(1u << (dst % 8));
+	}
+}
+
+static void put_initializer(elf_section_t *const section,
+                            unsigned long const offset,
+                            ir_initializer_t const *const init,
+                            ir_type *const type)
+{
+	char *const dest = section->data + offset;
+	switch (get_initializer_kind(init)) {
+	case IR_INITIALIZER_NULL:
+		return;
+
+	case IR_INITIALIZER_TARVAL:
+		put_tarval(dest, get_initializer_tarval_value(init),
+		           get_type_size(type));
+		return;
+
+	case IR_INITIALIZER_CONST: {
+		ir_node *const node = get_initializer_const_value(init);
+		unsigned const size = get_type_size(type);
+		if (size > 8 || (is_Const(node) && !tarval_is_long(get_Const_tarval(node)))) {
+			if (!is_Const(node))
+				panic("large initializers only support Const nodes");
+			put_tarval(dest, get_Const_tarval(node), size);
+			return;
+		}
+
+		elf_const_t const value = eval_init_expression(node);
+		if (value.entity == NULL) {
+			put_value(dest, (uint64_t)value.value, size);
+			return;
+		}
+		be_elf_reloc_t const reloc = {
+			.type       = elf.target->data_reloc,
+			.size       = elf.target->is_64bit ? 8 : 4,
+			.adjustable = true,
+		};
+		if (size != reloc.size)
+			panic("address in %u byte initializer not supported", size);
+		add_reloc(section, offset, &reloc, value.entity, value.value);
+		return;
+	}
+
+	case IR_INITIALIZER_COMPOUND:
+		if (is_Array_type(type)) {
+			ir_type *const element_type = get_array_element_type(type);
+			unsigned       skip         = get_type_size(element_type);
+			unsigned const alignment    = get_type_alignment(element_type);
+			unsigned const misalign     = skip % alignment;
+			if (misalign != 0)
+				skip += alignment - misalign;
+
+			for (size_t i = 0, n = get_initializer_compound_n_entries(init);
+			     i < n; ++i) {
+				ir_initializer_t const *const sub
+					= get_initializer_compound_value(init, i);
+				put_initializer(section, offset + i * skip, sub, element_type);
+			}
+		} else {
+			assert(is_compound_type(type));
+			for (size_t i = 0, n = get_compound_n_members(type); i < n; ++i) {
+				ir_entity *const member = get_compound_member(type, i);
+				assert(i < get_initializer_compound_n_entries(init));
+				ir_initializer_t const *const sub
+					= get_initializer_compound_value(init, i);
+				ir_type       *const subtype       = get_entity_type(member);
+				unsigned long  const member_offset
+					= offset + get_entity_offset(member);
+				unsigned       const bitfield_size
+					= get_entity_bitfield_size(member);
+				if (bitfield_size > 0) {
+					put_bitfield(section->data + member_offset, sub, subtype,
+					             get_entity_bitfield_offset(member),
+					             bitfield_size);
+					continue;
+				}
+				put_initializer(section, member_offset, sub, subtype);
+			}
+		}
+		return;
+	}
+	panic("invalid initializer");
+}
+
+static void emit_global(be_main_env_t const *const main_env,
+                        ir_entity const *const entity)
+{
+	ir_entity_kind const kind = get_entity_kind(entity);
+	if (kind == IR_ENTITY_LABEL || kind == IR_ENTITY_METHOD)
+		return;
+
+	be_gas_section_t const section_kind = be_gas_get_section(main_env, entity);
+	ir_visibility    const visibility   = get_entity_visibility(entity);
+	ir_linkage       const linkage      = get_entity_linkage(entity);
+	bool             const zero_init    = be_gas_entity_is_zero_initialized(entity);
+	bool             const tls          = section_kind & GAS_SECTION_FLAG_TLS;
+	unsigned long          size         = be_gas_get_entity_size(entity);
+	unsigned         const alignment    = MAX(be_gas_get_entity_alignment(entity), 1u);
+	if (size == 0)
+		size = 1;
+	if (!is_po2_or_zero(alignment))
+		panic("alignment not a power of 2");
+
+	if ((linkage & IR_LINKAGE_MERGE || zero_init) && !tls) {
+		bool const is_local = visibility == ir_visibility_local
+		                   || visibility == ir_visibility_private;
+		if (!is_local && linkage & IR_LINKAGE_MERGE) {
+			elf_symbol_t *const symbol = get_symbol(entity);
+			symbol->common = true;
+			symbol->value  = alignment;
+			symbol->size   = size;
+			return;
+		} else if (is_local && !(linkage & IR_LINKAGE_CONSTANT)) {
+			elf_section_t *const bss = get_section(GAS_SECTION_BSS);
+			unsigned long  const offset
+				= section_append(bss, alignment, size, NULL);
+			define_symbol(entity, bss, offset, size);
+			return;
+		}
+	}
+
+	if (!entity_has_definition(entity))
+		return;
+
+	if (kind == IR_ENTITY_ALIAS) {
+		/* resolved when writing the symbol table */
+		get_symbol(entity);
+		return;
+	}
+
+	be_gas_section_t const base = section_kind & ~GAS_SECTION_FLAG_COMDAT;
+	elf_section_t   *const section = get_section(base);
+	unsigned long    const offset
+		= section_append(section, alignment, size, NULL);
+	define_symbol(entity, section, offset, get_type_size(get_entity_type(entity)));
+
+	if (!zero_init && section->type != ELF_SHT_NOBITS) {
+		put_initializer(section, offset, get_entity_initializer(entity),
+		                get_entity_type(entity));
+	}
+}
+
+static void emit_globals(be_main_env_t const *const main_env,
+                         ir_type *const type)
+{
+	for (size_t i = 0, n = get_compound_n_members(type); i < n; ++i) {
+		ir_entity *const entity = get_compound_member(type, i);
+		if (!(get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN))
+			emit_global(main_env, entity);
+	}
+}
+
+static void resolve_aliases(void)
+{
+	for (size_t i = 0, n = ARR_LEN(elf.symbols); i < n; ++i) {
+		elf_symbol_t *const symbol = elf.symbols[i];
+		if (!is_alias_entity(symbol->entity)
+		    || !entity_has_definition(symbol->entity))
+			continue;
+
+		ir_entity const *aliased = get_entity_alias(symbol->entity);
+		while (is_alias_entity(aliased))
+			aliased = get_entity_alias(aliased);
+		elf_symbol_t const *const target = get_symbol(aliased);
+		if (target->section == NULL)
+			panic("alias %+F refers to undefined %+F", symbol->entity, aliased);
+		symbol->section = target->section;
+		symbol->value   = target->value;
+		symbol->size    = target->size;
+		symbol->type    = target->type;
+	}
+}
+
+/** Resolves relocations which do not need the linker, adjusts the others. */
+static void finish_relocs(elf_section_t *const section)
+{
+	elf_reloc_t *const relocs = section->relocs;
+	size_t             n_out  = 0;
+	for (size_t i = 0, n = ARR_LEN(relocs); i < n; ++i) {
+		elf_reloc_t         reloc  = relocs[i];
+		elf_symbol_t *const symbol = reloc.symbol;
+		bool          const local  = symbol->bind == ELF_STB_LOCAL;
+		if (local && symbol->section == NULL && !symbol->common)
+			panic("local %+F is referenced but not defined", symbol->entity);
+
+		if (local && reloc.kind.pc_relative && symbol->section == section) {
+			int64_t const value
+				= (int64_t)symbol->value + reloc.addend - (int64_t)reloc.offset;
+			put_value(section->data + reloc.offset, (uint64_t)value,
+			          reloc.kind.size);
+			continue;
+		}
+
+		if (local && reloc.kind.adjustable) {
+			reloc.addend += symbol->value;
+			reloc.base    = symbol->section;
+		} else {
+			symbol->in_symtab = true;
+		}
+		if (!elf.target->use_rela) {
+			put_value(section->data + reloc.offset, (uint64_t)reloc.addend,
+			          reloc.kind.size);
+		}
+		relocs[n_out++] = reloc;
+	}
+	ARR_SHRINKLEN(section->relocs, n_out);
+}
+
+/** A growing byte buffer holding the file contents. */
+static struct obstack file_obst;
+
+static void file_put(uint64_t const value, unsigned const size)
+{
+	char buf[8];
+	put_value(buf, value, size);
+	obstack_grow(&file_obst, buf, size);
+}
+
+static void file_put_word(uint64_t const value)
+{
+	file_put(value, elf.target->is_64bit ? 8 : 4);
+}
+
+static void file_align(unsigned const align)
+{
+	size_t const size = obstack_object_size(&file_obst);
+	for (size_t i = size; i % align != 0; ++i)
+		obstack_1grow(&file_obst, 0);
+}
+
+static unsigned add_string(struct obstack *const strtab, char const *const str)
+{
+	unsigned const offset = obstack_object_size(strtab);
+	obstack_grow0(strtab, str, strlen(str));
+	return offset;
+}
+
+typedef struct elf_shdr_t {
+	unsigned name;
+	uint32_t type;
+	uint64_t flags;
+	uint64_t offset;
+	uint64_t size;
+	uint32_t link;
+	uint32_t info;
+	uint64_t align;
+	uint64_t entsize;
+} elf_shdr_t;
+
+static void put_symbol(unsigned const name, uint64_t const value,
+                       uint64_t const size, uint8_t const info,
+                       uint8_t const other, uint16_t const shndx)
+{
+	if (elf.target->is_64bit) {
+		file_put(name, 4);
+		file_put(info, 1);
+		file_put(other, 1);
+		file_put(shndx, 2);
+		file_put(value, 8);
+		file_put(size, 8);
+	} else {
+		file_put(name, 4);
+		file_put(value, 4);
+		file_put(size, 4);
+		file_put(info, 1);
+		file_put(other, 1);
+		file_put(shndx, 2);
+	}
+}
+
+static uint8_t get_symbol_info(uint8_t const bind, uint8_t const type)
+{
+	return bind << 4 | type;
+}
+
+static void write_object(void)
+{
+	be_elf_target_t const *const target   = elf.target;
+	bool                   const is_64bit = target->is_64bit;
+	unsigned               const word     = is_64bit ? 8 : 4;
+	size_t                 const n_secs   = ARR_LEN(elf.sections);
+
+	struct obstack strtab;
+	struct obstack shstrtab;
+	obstack_init(&strtab);
+	obstack_init(&shstrtab);
+	obstack_init(&file_obst);
+	obstack_1grow(&strtab, '\0');
+	obstack_1grow(&shstrtab, '\0');
+
+	/* assign section header indices: sections, relocations, tables */
+	unsigned n_shdrs = 1;
+	for (size_t i = 0; i < n_secs; ++i)
+		elf.sections[i]->index = n_shdrs++;
+	for (size_t i = 0; i < n_secs; ++i) {
+		elf_section_t *const section = elf.sections[i];
+		section->sym_index = 1 + (elf.cup_name != NULL) + i;
+		if (section->type != ELF_SHT_NOBITS)
+			finish_relocs(section);
+	}
+	unsigned n_rel_secs = 0;
+	for (size_t i = 0; i < n_secs; ++i) {
+		if (ARR_LEN(elf.sections[i]->relocs) > 0)
+			++n_rel_secs;
+	}
+	unsigned const symtab_index   = n_shdrs + n_rel_secs;
+	unsigned const strtab_index   = symtab_index + 1;
+	unsigned const shstrtab_index = symtab_index + 2;
+	n_shdrs = shstrtab_index + 1;
+	elf_shdr_t *const shdrs = XMALLOCNZ(elf_shdr_t, n_shdrs);
+
+	/* ELF header is filled in at the end */
+	unsigned const ehdr_size = is_64bit ? 64 : 52;
+	obstack_blank(&file_obst, ehdr_size);
+
+	/* section contents */
+	for (size_t i = 0; i < n_secs; ++i) {
+		elf_section_t *const section = elf.sections[i];
+		elf_shdr_t    *const shdr    = &shdrs[section->index];
+		file_align(section->align);
+		shdr->name   = add_string(&shstrtab, section->name);
+		shdr->type   = section->type;
+		shdr->flags  = section->flags;
+		shdr->offset = obstack_object_size(&file_obst);
+		shdr->size   = get_section_size(section);
+		shdr->align  = section->align;
+		if (section->type != ELF_SHT_NOBITS)
+			obstack_grow(&file_obst, section->data, ARR_LEN(section->data));
+	}
+
+	/* symbol table: null, file, sections, locals, globals */
+	size_t   const n_syms        = ARR_LEN(elf.symbols);
+	unsigned       sym_index     = 1 + (elf.cup_name != NULL) + n_secs;
+	for (size_t i = 0; i < n_syms; ++i) {
+		elf_symbol_t *const symbol = elf.symbols[i];
+		if (symbol->in_symtab && symbol->bind == ELF_STB_LOCAL)
+			symbol->index = sym_index++;
+	}
+	unsigned const first_global = sym_index;
+	for (size_t i = 0; i < n_syms; ++i) {
+		elf_symbol_t *const symbol = elf.symbols[i];
+		if (symbol->in_symtab && symbol->bind != ELF_STB_LOCAL)
+			symbol->index = sym_index++;
+	}
+
+	file_align(word);
+	elf_shdr_t *const symtab = &shdrs[symtab_index];
+	symtab->name    = add_string(&shstrtab, ".symtab");
+	symtab->type    = ELF_SHT_SYMTAB;
+	symtab->offset  = obstack_object_size(&file_obst);
+	symtab->link    = strtab_index;
+	symtab->info    = first_global;
+	symtab->align   = word;
+	symtab->entsize = is_64bit ? 24 : 16;
+	put_symbol(0, 0, 0, 0, 0, ELF_SHN_UNDEF);
+	if (elf.cup_name != NULL) {
+		unsigned const name = add_string(&strtab, elf.cup_name);
+		put_symbol(name, 0, 0, get_symbol_info(ELF_STB_LOCAL, ELF_STT_FILE),
+		           ELF_STV_DEFAULT, 0xFFF1 /* SHN_ABS */);
+	}
+	for (size_t i = 0; i < n_secs; ++i) {
+		put_symbol(0, 0, 0, get_symbol_info(ELF_STB_LOCAL, ELF_STT_SECTION),
+		           ELF_STV_DEFAULT, elf.sections[i]->index);
+	}
+	for (int pass = 0; pass < 2; ++pass) {
+		for (size_t i = 0; i < n_syms; ++i) {
+			elf_symbol_t const *const symbol = elf.symbols[i];
+			if (!symbol->in_symtab
+			    || (symbol->bind == ELF_STB_LOCAL) != (pass == 0))
+				continue;
+			uint16_t const shndx
+				= symbol->common         ? ELF_SHN_COMMON
+				: symbol->section != NULL ? symbol->section->index
+				:                           ELF_SHN_UNDEF;
+			uint8_t const type
+				= symbol->common          ? ELF_STT_OBJECT
+				: symbol->section != NULL ? symbol->type
+				:                           ELF_STT_NOTYPE;
+			put_symbol(add_string(&strtab, symbol->name), symbol->value,
+			           symbol->size, get_symbol_info(symbol->bind, type),
+			           symbol->visibility, shndx);
+		}
+	}
+	symtab->size = obstack_object_size(&file_obst) - symtab->offset;
+
+	/* relocation sections */
+	unsigned rel_index = n_secs + 1;
+	for (size_t i = 0; i < n_secs; ++i) {
+		elf_section_t *const section = elf.sections[i];
+		size_t         const n_rels  = ARR_LEN(section->relocs);
+		if (n_rels == 0)
+			continue;
+
+		char const *const prefix = target->use_rela ? ".rela" : ".rel";
+		elf_shdr_t  *const shdr  = &shdrs[rel_index++];
+		file_align(word);
+		shdr->name    = obstack_object_size(&shstrtab);
+		obstack_printf(&shstrtab, "%s%s", prefix, section->name);
+		obstack_1grow(&shstrtab, '\0');
+		shdr->type    = target->use_rela ? ELF_SHT_RELA : ELF_SHT_REL;
+		shdr->flags   = ELF_SHF_INFO_LINK;
+		shdr->offset  = obstack_object_size(&file_obst);
+		shdr->link    = symtab_index;
+		shdr->info    = section->index;
+		shdr->align   = word;
+		shdr->entsize = (target->use_rela ? 3 : 2) * word;
+		for (size_t r = 0; r < n_rels; ++r) {
+			elf_reloc_t const *const reloc = &section->relocs[r];
+			uint64_t const sym = reloc->base != NULL ? reloc->base->sym_index
+			                                         : reloc->symbol->index;
+			file_put_word(reloc->offset);
+			file_put_word(is_64bit ? sym << 32 | reloc->kind.type
+			                       : sym << 8  | (reloc->kind.type & 0xFF));
+			if (target->use_rela)
+				file_put_word((uint64_t)reloc->addend);
+		}
+		shdr->size = obstack_object_size(&file_obst) - shdr->offset;
+	}
+
+	/* string tables */
+	elf_shdr_t *const strtab_hdr = &shdrs[strtab_index];
+	strtab_hdr->name   = add_string(&shstrtab, ".strtab");
+	strtab_hdr->type   = ELF_SHT_STRTAB;
+	strtab_hdr->offset = obstack_object_size(&file_obst);
+	strtab_hdr->size   = obstack_object_size(&strtab);
+	strtab_hdr->align  = 1;
+	obstack_grow(&file_obst, obstack_base(&strtab), strtab_hdr->size);
+
+	elf_shdr_t *const shstrtab_hdr = &shdrs[shstrtab_index];
+	shstrtab_hdr->name   = add_string(&shstrtab, ".shstrtab");
+	shstrtab_hdr->type   = ELF_SHT_STRTAB;
+	shstrtab_hdr->offset = obstack_object_size(&file_obst);
+	shstrtab_hdr->size   = obstack_object_size(&shstrtab);
+	shstrtab_hdr->align  = 1;
+	obstack_grow(&file_obst, obstack_base(&shstrtab), shstrtab_hdr->size);
+
+	/* section headers */
+	file_align(word);
+	uint64_t const shoff = obstack_object_size(&file_obst);
+	for (unsigned i = 0; i < n_shdrs; ++i) {
+		elf_shdr_t const *const shdr = &shdrs[i];
+		file_put(shdr->name, 4);
+		file_put(shdr->type, 4);
+		file_put_word(shdr->flags);
+		file_put_word(0); /* address */
+		file_put_word(shdr->offset);
+		file_put_word(shdr->size);
+		file_put(shdr->link, 4);
+		file_put(shdr->info, 4);
+		file_put_word(shdr->align);
+		file_put_word(shdr->entsize);
+	}
+
+	/* ELF header */
+	size_t const file_size = obstack_object_size(&file_obst);
+	char  *const contents  = (char*)obstack_finish(&file_obst);
+	char  *const ehdr      = contents;
+	memset(ehdr, 0, ehdr_size);
+	ehdr[0] = 0x7F;
+	ehdr[1] = 'E';
+	ehdr[2] = 'L';
+	ehdr[3] = 'F';
+	ehdr[4] = is_64bit ? ELF_CLASS64 : ELF_CLASS32;
+	ehdr[5] = elf.big_endian ? ELF_DATA2MSB : ELF_DATA2LSB;
+	ehdr[6] = ELF_EV_CURRENT;
+	char *p = ehdr + 16;
+	put_value(p, ELF_ET_REL, 2);       p += 2;
+	put_value(p, target->machine, 2);  p += 2;
+	put_value(p, ELF_EV_CURRENT, 4);   p += 4;
+	p += 2 * word; /* entry, program headers */
+	put_value(p, shoff, word);         p += word;
+	put_value(p, target->flags, 4);    p += 4;
+	put_value(p, ehdr_size, 2);        p += 2;
+	p += 4; /* program header entry size and count */
+	put_value(p, is_64bit ? 64 : 40, 2); p += 2;
+	put_value(p, n_shdrs, 2);          p += 2;
+	put_value(p, shstrtab_index, 2);
+	assert(p + 2 == ehdr + ehdr_size);
+
+	if (fwrite(contents, 1, file_size, elf.output) != file_size)
+		panic("could not write object file");
+
+	free(shdrs);
+	obstack_free(&file_obst, NULL);
+	obstack_free(&shstrtab, NULL);
+	obstack_free(&strtab, NULL);
+}
+
+void be_elf_end_compilation_unit(be_main_env_t const *const env)
+{
+	emit_globals(env, get_glob_type());
+	emit_globals(env, get_tls_type());
+	emit_globals(env, get_segment_type(IR_SEGMENT_CONSTRUCTORS));
+	emit_globals(env, get_segment_type(IR_SEGMENT_DESTRUCTORS));
+	emit_globals(env, get_segment_type(IR_SEGMENT_JCR));
+	resolve_aliases();
+
+	write_object();
+
+	for (size_t i = 0, n = ARR_LEN(elf.sections); i < n; ++i) {
+		DEL_ARR_F(elf.sections[i]->data);
+		DEL_ARR_F(elf.sections[i]->relocs);
+	}
+	DEL_ARR_F(elf.sections);
+	DEL_ARR_F(elf.symbols);
+	pmap_destroy(elf.entity_symbols);
+	obstack_free(&elf.obst, NULL);
+	memset(&elf, 0, sizeof(elf));
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes ELF relocatable object files directly.
+ *
+ * This is an alternative to the assembler output of begnuas: Functions are
+ * encoded with the binary emitter of a backend (see bejit.h), global data is
+ * serialized from the initializers and the result is written as an ELF
+ * relocatable object (ET_REL) which can be passed to the linker directly.
+ */
+#ifndef FIRM_BE_BEELF_H
+#define FIRM_BE_BEELF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "be_types.h"
+#include "jit.h"
+
+/** Describes how a backend relocation kind maps to an ELF relocation. */
+typedef struct be_elf_reloc_t {
+	uint32_t type;        /**< ELF relocation type (R_xxx) */
+	uint8_t  size;        /**< size of the relocated field in bytes */
+	bool     pc_relative; /**< field is relative to its own address */
+	/** The relocation may refer to the section symbol of a local target
+	 * instead of the target symbol itself. */
+	bool     adjustable;
+} be_elf_reloc_t;
+
+/** Target specific properties of the ELF output. */
+struct be_elf_target_t {
+	uint16_t machine;    /**< e_machine value (EM_xxx) */
+	uint32_t flags;      /**< e_flags value */
+	bool     is_64bit;   /**< produce ELFCLASS64 instead of ELFCLASS32 */
+	bool     use_rela;   /**< relocations carry explicit addends */
+	uint32_t data_reloc; /**< absolute relocation for pointers in data */
+
+	/** create @p size bytes of NOP instructions for code alignment */
+	void (*nops)(char *buffer, unsigned size);
+
+	/**
+	 * Returns the ELF relocation for a backend relocation kind as passed to
+	 * be_emit_reloc_entity() and be_emit_reloc_fragment(). The type is
+	 * ignored for relocations against code fragments, these are resolved
+	 * before writing the object.
+	 */
+	void (*get_reloc)(uint8_t be_kind, be_elf_reloc_t *reloc);
+};
+
+/**
+ * Starts a new object file which is written to @p output at the end of the
+ * compilation unit.
+ */
+void be_elf_begin_compilation_unit(FILE *output, be_elf_target_t const *target,
+                                   char const *cup_name);
+
+/**
+ * Appends the machine code of a function to the text section.
+ *
+ * @param entity    the entity of the function
+ * @param p2align   log2 of the function alignment
+ * @param function  the encoded function
+ */
+void be_elf_emit_function(ir_entity const *entity, unsigned p2align,
+                          ir_jit_function_t *function);
+
+/**
+ * Emits all global variables and writes the object file.
+ */
+void be_elf_end_compilation_unit(be_main_env_t const *env);
+
+#endif
@@ -11,20 +11,29 @@
  */
 #include "beemitter.h"
 
-#include "panic.h"
+#include <string.h>
+
 #include "irprintf.h"
+#include "panic.h"
+#include "util.h"
+
+/** Buffered output is written to the file when it exceeds this size. */
+#define EMIT_FLUSH_THRESHOLD (1024 * 1024)
 
 static FILE    *emit_file;
 struct obstack  emit_obst;
+size_t          emit_line_start;
 
 void be_emit_init(FILE *file)
 {
-	emit_file = file;
+	emit_file       = file;
+	emit_line_start = 0;
 	obstack_init(&emit_obst);
 }
 
 void be_emit_exit(void)
 {
+	be_emit_flush();
 	obstack_free(&emit_obst, NULL);
 }
 
@@ -41,10 +50,64 @@ void be_emit_irprintf(const char *fmt, ...)
 	va_end(ap);
 }
 
+void be_emit_uint(uint64_t value)
+{
+	char  buf[3 * sizeof(value)];
+	char *p = buf + sizeof(buf);
+	do {
+		*--p   = '0' + value % 10;
+		value /= 10;
+	} while (value != 0);
+	be_emit_string_len(p, buf + sizeof(buf) - p);
+}
+
+void be_emit_int(int64_t const value)
+{
+	if (value < 0) {
+		be_emit_char('-');
+		be_emit_uint(-(uint64_t)value);
+	} else {
+		be_emit_uint(value);
+	}
+}
+
+void be_emit_int_signed(int64_t const value)
+{
+	if (value >= 0)
+		be_emit_char('+');
+	be_emit_int(value);
+}
+
+void be_emit_hex(uint64_t value, unsigned const min_digits, bool const upper)
+{
+	char const *const digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	char              buf[16];
+	char             *p      = buf + sizeof(buf);
+	char       *const limit  = buf + sizeof(buf) - MIN(min_digits, sizeof(buf));
+	do {
+		*--p    = digits[value & 0xF];
+		value >>= 4;
+	} while (value != 0 || p > limit);
+	be_emit_string_len(p, buf + sizeof(buf) - p);
+}
+
+void be_emit_flush(void)
+{
+	size_t const len = obstack_object_size(&emit_obst);
+	if (emit_line_start == 0)
+		return;
+	char const *const buf = (char const*)obstack_base(&emit_obst);
+	fwrite(buf, 1, emit_line_start, emit_file);
+	/* keep a started line */
+	size_t const rest = len - emit_line_start;
+	memmove((char*)buf, buf + emit_line_start, rest);
+	obstack_blank_fast(&emit_obst, -(ptrdiff_t)emit_line_start);
+	emit_line_start = 0;
+}
+
 void be_emit_write_line(void)
 {
-	size_t const len  = obstack_object_size(&emit_obst);
-	char  *const line = (char*)obstack_finish(&emit_obst);
-	fwrite(line, 1, len, emit_file);
-	obstack_free(&emit_obst, line);
+	emit_line_start = obstack_object_size(&emit_obst);
+	if (emit_line_start >= EMIT_FLUSH_THRESHOLD)
+		be_emit_flush();
 }
@@ -10,16 +10,22 @@
  * @date        12.03.2007
  *
  * This is a framework for emitting line base text used by most backends to
- * emit assembly code.
+ * emit assembly code. Output is collected in a large buffer which is written
+ * to the file when it exceeds a threshold and by be_emit_exit(), so the
+ * emitters should prefer the unformatted be_emit_* helpers over
+ * be_emit_irprintf() in frequently used paths.
  */
 #ifndef FIRM_BE_BEEMITTER_H
 #define FIRM_BE_BEEMITTER_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "obst.h"
 
 /* don't use the following vars directly, they're only here for the inlines */
 extern struct obstack  emit_obst;
+extern size_t          emit_line_start;
 
 /**
  * Emit a character to the (assembler) output.
@@ -59,6 +65,30 @@ static inline void be_emit_string(const char *str)
 #define be_emit_cstring(str) \
 	be_emit_string_len(str, sizeof(str) - 1)
 
+/**
+ * Emit an unsigned decimal number.
+ */
+void be_emit_uint(uint64_t value);
+
+/**
+ * Emit a signed decimal number.
+ */
+void be_emit_int(int64_t value);
+
+/**
+ * Emit a signed decimal number, with a '+' sign if it is not negative.
+ */
+void be_emit_int_signed(int64_t value);
+
+/**
+ * Emit a number in hexadecimal notation (without 0x prefix).
+ *
+ * @param value      the number
+ * @param min_digits emit leading zeros up to this number of digits
+ * @param upper      use upper case digits
+ */
+void be_emit_hex(uint64_t value, unsigned min_digits, bool upper);
+
 /**
  * Initializes an emitter environment.
  *
@@ -86,14 +116,20 @@ void be_emit_irprintf(const char *fmt, ...);
 void be_emit_irvprintf(const char *fmt, va_list args);
 
 /**
- * Flush the line in the current line buffer to the emitter file.
+ * Finishes the current line. The output buffer is written to the emitter
+ * file once it gets large.
  */
 void be_emit_write_line(void);
 
+/**
+ * Writes all buffered lines to the emitter file.
+ */
+void be_emit_flush(void);
+
 /** Return column in current line. Counting starts at 0. */
 static inline size_t be_emit_get_column(void)
 {
-	return obstack_object_size(&emit_obst);
+	return obstack_object_size(&emit_obst) - emit_line_start;
 }
 
 #endif
@@ -0,0 +1,277 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Function ordering for instruction cache locality.
+ *
+ * Uses the algorithm of Pettis and Hansen ("Profile guided code positioning",
+ * PLDI 1990): The call graph is viewed as an undirected graph where each edge
+ * is weighted with the execution frequency of the call sites between two
+ * functions. Edges are processed in order of decreasing weight, the chains
+ * containing the two functions of an edge are merged. Chains are reversed
+ * when necessary so that the two functions end up as close as possible to
+ * each other. The resulting chains are emitted hottest first.
+ */
+#include "befuncorder.h"
+
+#include <stdlib.h>
+
+#include "array.h"
+#include "bemodule.h"
+#include "callgraph.h"
+#include "cgana.h"
+#include "debug.h"
+#include "entity_t.h"
+#include "execfreq.h"
+#include "hashptr.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irprog_t.h"
+#include "set.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** An undirected edge between two functions of the graph array. */
+typedef struct call_edge_t {
+	unsigned a;    /**< smaller index of the two functions */
+	unsigned b;    /**< larger index of the two functions */
+	double   freq; /**< summed execution frequency of all calls between them */
+} call_edge_t;
+
+typedef struct chain_t {
+	unsigned *funcs;  /**< flexible array of function indices */
+	double    weight; /**< summed frequency of the edges inside the chain */
+	unsigned  first;  /**< smallest original index, for stable ordering */
+} chain_t;
+
+typedef struct funcorder_env_t {
+	unsigned *irg_num;     /**< maps graph index to position in the array */
+	set      *edges;       /**< set of call_edge_t */
+	unsigned  caller;      /**< position of the currently walked graph */
+	double    caller_freq; /**< execution frequency of the walked graph */
+} funcorder_env_t;
+
+static int cmp_call_edge(const void *elt, const void *key, size_t size)
+{
+	const call_edge_t *e1 = (const call_edge_t*)elt;
+	const call_edge_t *e2 = (const call_edge_t*)key;
+	(void)size;
+	return e1->a != e2->a || e1->b != e2->b;
+}
+
+static void add_call_edge(funcorder_env_t *env, ir_entity *callee_entity,
+                          double freq)
+{
+	ir_graph *callee = get_entity_linktime_irg(callee_entity);
+	if (callee == NULL)
+		return;
+	unsigned const callee_num = env->irg_num[get_irg_idx(callee)];
+	if (callee_num == ~0u || callee_num == env->caller)
+		return;
+
+	call_edge_t key = {
+		.a    = MIN(env->caller, callee_num),
+		.b    = MAX(env->caller, callee_num),
+		.freq = 0.0,
+	};
+	unsigned     const hash = hash_combine(key.a, key.b);
+	call_edge_t *const edge
+		= set_insert(call_edge_t, env->edges, &key, sizeof(key), hash);
+	edge->freq += freq;
+}
+
+static void collect_call_edges(ir_node *node, void *data)
+{
+	if (!is_Call(node))
+		return;
+
+	funcorder_env_t *env  = (funcorder_env_t*)data;
+	double           freq = env->caller_freq
+	                        * get_block_execfreq(get_nodes_block(node));
+	if (cg_call_has_callees(node)) {
+		size_t const n_callees = cg_get_call_n_callees(node);
+		for (size_t i = 0; i < n_callees; ++i) {
+			add_call_edge(env, cg_get_call_callee(node, i), freq / n_callees);
+		}
+	} else {
+		ir_entity *const callee = get_Call_callee(node);
+		if (callee != NULL)
+			add_call_edge(env, callee, freq);
+	}
+}
+
+static int cmp_edges(const void *d1, const void *d2)
+{
+	const call_edge_t *e1 = *(const call_edge_t**)d1;
+	const call_edge_t *e2 = *(const call_edge_t**)d2;
+	if (e1->freq != e2->freq)
+		return e1->freq < e2->freq ? 1 : -1;
+	if (e1->a != e2->a)
+		return e1->a < e2->a ? -1 : 1;
+	return e1->b < e2->b ? -1 : e1->b > e2->b;
+}
+
+static int cmp_chains(const void *d1, const void *d2)
+{
+	const chain_t *c1 = *(const chain_t**)d1;
+	const chain_t *c2 = *(const chain_t**)d2;
+	if (c1->weight != c2->weight)
+		return c1->weight < c2->weight ? 1 : -1;
+	return c1->first < c2->first ? -1 : c1->first > c2->first;
+}
+
+static void reverse_chain(chain_t *chain, unsigned *pos)
+{
+	unsigned *const funcs = chain->funcs;
+	size_t    const n     = ARR_LEN(funcs);
+	for (size_t i = 0, j = n; i < --j; ++i) {
+		unsigned const t = funcs[i];
+		funcs[i] = funcs[j];
+		funcs[j] = t;
+	}
+	for (size_t i = 0; i < n; ++i)
+		pos[funcs[i]] = i;
+}
+
+void be_order_graphs(ir_graph **irgs, size_t n_irgs)
+{
+	if (n_irgs < 2)
+		return;
+
+	bool const have_callgraph
+		= get_irp_callgraph_state() != irp_callgraph_none;
+
+	funcorder_env_t env;
+	size_t const n_idx = get_irp_last_idx();
+	env.irg_num = XMALLOCN(unsigned, n_idx);
+	memset(env.irg_num, 0xFF, n_idx * sizeof(*env.irg_num));
+	for (size_t i = 0; i < n_irgs; ++i)
+		env.irg_num[get_irg_idx(irgs[i])] = i;
+
+	env.edges = new_set(cmp_call_edge, 64);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph *const irg = irgs[i];
+		env.caller      = i;
+		env.caller_freq = have_callgraph
+		                  ? get_irg_method_execution_frequency(irg) : 1.0;
+		irg_walk_graph(irg, NULL, collect_call_edges, &env);
+	}
+
+	call_edge_t **edges = NEW_ARR_F(call_edge_t*, 0);
+	foreach_set(env.edges, call_edge_t, edge) {
+		if (edge->freq > 0.0)
+			ARR_APP1(call_edge_t*, edges, edge);
+	}
+	QSORT_ARR(edges, cmp_edges);
+
+	/* every function starts in its own chain */
+	chain_t  *const chains   = XMALLOCN(chain_t, n_irgs);
+	chain_t **const chain_of = XMALLOCN(chain_t*, n_irgs);
+	unsigned *const pos      = XMALLOCN(unsigned, n_irgs);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		chain_t *const chain = &chains[i];
+		chain->funcs  = NEW_ARR_F(unsigned, 1);
+		chain->funcs[0] = i;
+		chain->weight = 0.0;
+		chain->first  = i;
+		chain_of[i]   = chain;
+		pos[i]        = 0;
+	}
+
+	for (size_t i = 0, n_edges = ARR_LEN(edges); i < n_edges; ++i) {
+		call_edge_t const *const edge = edges[i];
+		chain_t           *const ca   = chain_of[edge->a];
+		chain_t           *const cb   = chain_of[edge->b];
+		if (ca == cb) {
+			ca->weight += edge->freq;
+			continue;
+		}
+
+		DB((dbg, LEVEL_2, "merge %+F and %+F (freq %.2f)\n",
+		    irgs[edge->a], irgs[edge->b], edge->freq));
+
+		/* Orient the chains so that a is near the end of its chain and b near
+		 * the begin of its chain, then append. */
+		if (pos[edge->a] < ARR_LEN(ca->funcs) / 2)
+			reverse_chain(ca, pos);
+		if (pos[edge->b] >= (ARR_LEN(cb->funcs) + 1) / 2)
+			reverse_chain(cb, pos);
+
+		unsigned *funcs = ca->funcs;
+		for (size_t f = 0, n = ARR_LEN(cb->funcs); f < n; ++f) {
+			unsigned const func = cb->funcs[f];
+			pos[func]      = ARR_LEN(funcs);
+			chain_of[func] = ca;
+			ARR_APP1(unsigned, funcs, func);
+		}
+		ca->funcs   = funcs;
+		ca->weight += cb->weight + edge->freq;
+		ca->first   = MIN(ca->first, cb->first);
+		DEL_ARR_F(cb->funcs);
+		cb->funcs = NULL;
+	}
+
+	/* Hot chains first. Functions without calls keep their original order
+	 * behind them. */
+	chain_t **order = NEW_ARR_F(chain_t*, 0);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		if (chains[i].funcs != NULL)
+			ARR_APP1(chain_t*, order, &chains[i]);
+	}
+	QSORT_ARR(order, cmp_chains);
+
+	ir_graph **const old_irgs = XMALLOCN(ir_graph*, n_irgs);
+	MEMCPY(old_irgs, irgs, n_irgs);
+	size_t n = 0;
+	for (size_t c = 0, n_chains = ARR_LEN(order); c < n_chains; ++c) {
+		unsigned *const funcs = order[c]->funcs;
+		for (size_t f = 0, n_funcs = ARR_LEN(funcs); f < n_funcs; ++f) {
+			irgs[n++] = old_irgs[funcs[f]];
+			DB((dbg, LEVEL_1, "%+F\n", irgs[n - 1]));
+		}
+		DEL_ARR_F(funcs);
+	}
+	assert(n == n_irgs);
+
+	free(old_irgs);
+	DEL_ARR_F(order);
+	free(pos);
+	free(chain_of);
+	free(chains);
+	DEL_ARR_F(edges);
+	del_set(env.edges);
+	free(env.irg_num);
+}
+
+void be_order_irp_graphs(void)
+{
+	if (get_irp_callee_info_state() != irg_callee_info_consistent) {
+		ir_entity **free_methods;
+		cgana(&free_methods);
+		free(free_methods);
+	}
+	compute_callgraph();
+	compute_method_execution_frequencies();
+
+	size_t    const n_irgs = get_irp_n_irgs();
+	ir_graph **const irgs  = XMALLOCN(ir_graph*, n_irgs);
+	foreach_irp_irg(i, irg) {
+		irgs[i] = irg;
+	}
+	be_order_graphs(irgs, n_irgs);
+	for (size_t i = 0; i < n_irgs; ++i)
+		set_irp_irg(i, irgs[i]);
+	free(irgs);
+
+	free_callgraph();
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_funcorder)
+void be_init_funcorder(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.be.funcorder");
+}
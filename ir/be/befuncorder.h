@@ -0,0 +1,33 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Function ordering for instruction cache locality.
+ */
+#ifndef FIRM_BE_BEFUNCORDER_H
+#define FIRM_BE_BEFUNCORDER_H
+
+#include <stddef.h>
+
+#include "firm_types.h"
+
+/**
+ * Reorders the graphs in @p irgs so that functions calling each other
+ * frequently are placed next to each other (Pettis-Hansen clustering).
+ *
+ * Call sites are weighted by their block execution frequency. If a callgraph
+ * is available the method execution frequency of the caller is taken into
+ * account as well.
+ */
+void be_order_graphs(ir_graph **irgs, size_t n_irgs);
+
+/**
+ * Reorders the graphs of the program, so code generation emits them in
+ * call-graph-clustered order. Expects execution frequencies to be computed.
+ */
+void be_order_irp_graphs(void);
+
+#endif
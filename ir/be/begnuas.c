@@ -386,7 +386,7 @@ static bool entity_is_string_const(const ir_entity *ent, bool only_suffix_null)
 	return initializer_is_string_const(init, only_suffix_null);
 }
 
-static bool entity_is_zero_initialized(ir_entity const *entity)
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity)
 {
 	if (is_alias_entity(entity))
 		return false;
@@ -482,13 +482,13 @@ static be_gas_section_t determine_basic_section(const ir_entity *entity)
 			return GAS_SECTION_RODATA;
 		}
 	}
-	if (entity_is_zero_initialized(entity))
+	if (be_gas_entity_is_zero_initialized(entity))
 		return GAS_SECTION_BSS;
 
 	return GAS_SECTION_DATA;
 }
 
-static be_gas_section_t determine_section(be_main_env_t const *const main_env, ir_entity const *const entity)
+be_gas_section_t be_gas_get_section(be_main_env_t const *const main_env, ir_entity const *const entity)
 {
 	ir_type *owner = get_entity_owner(entity);
 
@@ -604,7 +604,7 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 {
 	be_dwarf_function_before(entity, parameter_infos);
 
-	be_gas_section_t const section = determine_section(NULL, entity);
+	be_gas_section_t const section = be_gas_get_section(NULL, entity);
 	emit_section(section, entity);
 
 	/* write the begin line (makes the life easier for scripts parsing the
@@ -905,7 +905,7 @@ static size_t get_initializer_size(const ir_initializer_t *initializer,
 	panic("found invalid initializer");
 }
 
-static unsigned long compute_entity_size(ir_entity const *const entity)
+unsigned long be_gas_get_entity_size(ir_entity const *const entity)
 {
 	ir_type *const type = get_entity_type(entity);
 	unsigned long  size = get_type_size(type);
@@ -1197,7 +1197,7 @@ static void emit_align(unsigned p2alignment)
 	be_emit_write_line();
 }
 
-static unsigned get_effective_entity_alignment(const ir_entity *entity)
+unsigned be_gas_get_entity_alignment(const ir_entity *entity)
 {
 	unsigned alignment = get_entity_alignment(entity);
 	if (alignment == 0) {
@@ -1210,7 +1210,7 @@ static unsigned get_effective_entity_alignment(const ir_entity *entity)
 static void emit_common(const ir_entity *entity, unsigned long size,
                         bool is_local)
 {
-	unsigned const alignment = get_effective_entity_alignment(entity);
+	unsigned const alignment = be_gas_get_entity_alignment(entity);
 
 	switch (be_gas_object_file_format) {
 	case OBJECT_FILE_FORMAT_MACH_O:
@@ -1245,7 +1245,7 @@ static void emit_zerofill(const ir_entity *entity, const char *section_segment,
 	be_emit_string(section_segment);
 	be_emit_char(',');
 	be_gas_emit_entity(entity);
-	unsigned const alignment = get_effective_entity_alignment(entity);
+	unsigned const alignment = be_gas_get_entity_alignment(entity);
 	be_emit_irprintf(",%lu,%u\n", size, log2_floor(alignment));
 	be_emit_write_line();
 }
@@ -1304,7 +1304,9 @@ void be_gas_emit_entity(const ir_entity *entity)
 {
 	if (entity->kind == IR_ENTITY_LABEL) {
 		ir_label_t label = get_entity_label(entity);
-		be_emit_irprintf("%s_%lu", be_gas_get_private_prefix(), label);
+		be_emit_string(be_gas_get_private_prefix());
+		be_emit_char('_');
+		be_emit_uint(label);
 		return;
 	}
 
@@ -1333,7 +1335,8 @@ void be_gas_emit_block_name(const ir_node *block)
 		} else {
 			nr = PTR_TO_INT(nr_val) - 1;
 		}
-		be_emit_irprintf("%s%d", be_gas_get_private_prefix(), nr);
+		be_emit_string(be_gas_get_private_prefix());
+		be_emit_int(nr);
 	}
 }
 
@@ -1386,7 +1389,7 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	/* we already emitted all functions with graphs in other functions like
 	 * be_gas_emit_function_prolog(). All others don't need to be emitted. */
-	be_gas_section_t const section = determine_section(main_env, entity);
+	be_gas_section_t const section = be_gas_get_section(main_env, entity);
 	if (kind == IR_ENTITY_METHOD && section != GAS_SECTION_PIC_TRAMPOLINES)
 		return;
 
@@ -1401,8 +1404,8 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	ir_visibility const visibility       = get_entity_visibility(entity);
 	ir_linkage    const linkage          = get_entity_linkage(entity);
-	bool          const zero_initializer = entity_is_zero_initialized(entity);
-	unsigned long       size             = compute_entity_size(entity);
+	bool          const zero_initializer = be_gas_entity_is_zero_initialized(entity);
+	unsigned long       size             = be_gas_get_entity_size(entity);
 
 	/* We need to output at least 1 byte, otherwise macho will merge
 	 * the label with the next thing */
@@ -1458,7 +1461,7 @@ static void emit_global(be_main_env_t const *const main_env,
 	}
 
 	/* alignment */
-	unsigned alignment = get_effective_entity_alignment(entity);
+	unsigned alignment = be_gas_get_entity_alignment(entity);
 	if (!is_po2_or_zero(alignment))
 		panic("alignment not a power of 2");
 	if (alignment > 1)
@@ -1655,18 +1658,47 @@ void be_gas_end_compilation_unit(const be_main_env_t *env)
 	be_dwarf_close();
 }
 
+/**
+ * Emits a node like "%+F" does. Backend nodes are written directly as this is
+ * done for every instruction in verbose mode.
+ */
+static void emit_node_name(ir_node const *const node)
+{
+	if (is_Const(node) || is_Address(node) || is_Member(node) || is_Cmp(node)) {
+		be_emit_irprintf("%+F", node);
+		return;
+	}
+	be_emit_string(get_irn_opname(node));
+	be_emit_char(' ');
+	be_emit_string(get_mode_name(get_irn_mode(node)));
+	be_emit_char('[');
+	be_emit_int(get_irn_node_nr(node));
+	be_emit_char(':');
+	be_emit_uint(get_irn_idx(node));
+	be_emit_char(']');
+}
+
 void be_emit_finish_line_gas(const ir_node *node)
 {
 	if (node && be_options.verbose_asm) {
 		be_emit_pad_comment();
-		dbg_info   *const dbg = get_irn_dbg_info(node);
-		src_loc_t   const loc = ir_retrieve_dbg_info(dbg);
-		char const *const fmt =
-			!loc.file       ? "/* %+F */\n"       :
-			loc.line   == 0 ? "/* %+F %s */\n"    :
-			loc.column == 0 ? "/* %+F %s:%u */\n" :
-			/*             */ "/* %+F %s:%u:%u */\n";
-		be_emit_irprintf(fmt, node, loc.file, loc.line, loc.column);
+		dbg_info  *const dbg = get_irn_dbg_info(node);
+		src_loc_t  const loc = ir_retrieve_dbg_info(dbg);
+		be_emit_cstring("/* ");
+		emit_node_name(node);
+		if (loc.file) {
+			be_emit_char(' ');
+			be_emit_string(loc.file);
+			if (loc.line != 0) {
+				be_emit_char(':');
+				be_emit_uint(loc.line);
+				if (loc.column != 0) {
+					be_emit_char(':');
+					be_emit_uint(loc.column);
+				}
+			}
+		}
+		be_emit_cstring(" */\n");
 	} else {
 		be_emit_char('\n');
 	}
@@ -73,6 +73,29 @@ void be_gas_emit_function_epilog(const ir_entity *entity);
 
 char const *be_gas_get_private_prefix(void);
 
+/**
+ * Returns the section an entity is placed in.
+ */
+be_gas_section_t be_gas_get_section(be_main_env_t const *main_env,
+                                    ir_entity const *entity);
+
+/**
+ * Returns true if an entity has an initializer consisting of zeros only.
+ */
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity);
+
+/**
+ * Returns the number of bytes occupied by an entity, taking the initializer
+ * of variable sized types into account.
+ */
+unsigned long be_gas_get_entity_size(ir_entity const *entity);
+
+/**
+ * Returns the alignment of an entity, falling back to the alignment of its
+ * type.
+ */
+unsigned be_gas_get_entity_alignment(const ir_entity *entity);
+
 /**
  * emit ld_ident of an entity and performs additional mangling if necessary.
  * (mangling is necessary for ir_visibility_private for example).
@@ -15,6 +15,7 @@
 #include "lc_opts.h"
 #include "lc_opts_enum.h"
 
+#include "array.h"
 #include "timing.h"
 #include "bitset.h"
 #include "irgwalk.h"
@@ -27,12 +28,12 @@
 
 void be_ifg_free(be_ifg_t *self)
 {
+	DEL_ARR_F(self->blocks);
 	free(self);
 }
 
-static void nodes_walker(ir_node *bl, void *data)
+static void nodes_walker(ir_node *bl, nodes_iter_t *it)
 {
-	nodes_iter_t     *it   = (nodes_iter_t*)data;
 	struct list_head *head = get_block_border_head(it->env, bl);
 
 	foreach_border_head(head, b) {
@@ -51,7 +52,8 @@ nodes_iter_t be_ifg_nodes_begin(be_ifg_t const *const ifg)
 	iter.curr = 0;
 	iter.env  = ifg->env;
 
-	irg_block_walk_graph(ifg->env->irg, nodes_walker, NULL, &iter);
+	for (size_t i = 0, n = ARR_LEN(ifg->blocks); i < n; ++i)
+		nodes_walker(ifg->blocks[i], &iter);
 	obstack_ptr_grow(&iter.obst, NULL);
 	iter.nodes = (ir_node**)obstack_finish(&iter.obst);
 	return iter;
@@ -251,10 +253,18 @@ int be_ifg_degree(const be_ifg_t *ifg, const ir_node *irn)
 	return degree;
 }
 
+static void collect_blocks(ir_node *bl, void *data)
+{
+	ir_node ***blocks = (ir_node***)data;
+	ARR_APP1(ir_node*, *blocks, bl);
+}
+
 be_ifg_t *be_create_ifg(const be_chordal_env_t *env)
 {
 	be_ifg_t *ifg = XMALLOC(be_ifg_t);
-	ifg->env = env;
+	ifg->env    = env;
+	ifg->blocks = NEW_ARR_F(ir_node*, 0);
+	irg_block_walk_graph(env->irg, collect_blocks, NULL, &ifg->blocks);
 
 	return ifg;
 }
@@ -19,6 +19,8 @@
 
 struct be_ifg_t {
 	const be_chordal_env_t *env;
+	ir_node               **blocks; /**< All blocks, so iterating the nodes
+	                                     does not walk the graph. */
 };
 
 typedef struct nodes_iter_t {
@@ -54,6 +54,10 @@ typedef struct be_irg_t {
 	struct obstack    obst;
 	/** Architecture specific per-graph data */
 	void             *isa_link;
+	/** Trade code quality for compile time: trivial scheduling, naive
+	 * spilling, no copy minimization, no spill slot coalescing and no
+	 * peephole optimization. Set for the fast jit tier. */
+	bool              fast_path;
 } be_irg_t;
 
 static inline be_irg_t *be_birg_from_irg(const ir_graph *irg)
@@ -66,6 +70,11 @@ static inline be_main_env_t *be_get_irg_main_env(const ir_graph *irg)
 	return be_birg_from_irg(irg)->main_env;
 }
 
+static inline bool be_is_fast_path(const ir_graph *irg)
+{
+	return be_birg_from_irg(irg)->fast_path;
+}
+
 static inline be_lv_t *be_get_irg_liveness(const ir_graph *irg)
 {
 	return be_birg_from_irg(irg)->lv;
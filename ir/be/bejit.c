@@ -258,16 +258,18 @@ static unsigned emit_relocation(ir_jit_function_t const *const function,
                                 relocation_t const *const relocation,
                                 unsigned const relocation_address,
                                 char *const relocation_abs,
+                                char const *const relocation_exec,
                                 emit_relocation_func const emit)
 {
 	switch (relocation->dest_kind) {
 	case RELOC_DEST_CODE_FRAGMENT: {
 		int32_t const dest = resolve_relocation_code(function, relocation,
 		                                             relocation_address);
-		return emit(relocation_abs, relocation->be_kind, NULL, dest);
+		return emit(relocation_abs, relocation_exec, relocation->be_kind, NULL,
+		            dest);
 	}
 	case RELOC_DEST_ENTITY:
-		return emit(relocation_abs, relocation->be_kind,
+		return emit(relocation_abs, relocation_exec, relocation->be_kind,
 		            relocation->dest.entity, relocation->dest_offset);
 	}
 	panic("Invalid relocation");
@@ -295,7 +297,8 @@ static void emit_fragment_as_asm(ir_jit_function_t const *const function,
 		emit_bytes_as_asm(b, fragment_code + offset);
 		unsigned const reloc_address = fragment_address + offset;
 		unsigned const reloc_size
-			= emit_relocation(function, relocation, reloc_address, NULL, emit);
+			= emit_relocation(function, relocation, reloc_address, NULL, NULL,
+			                  emit);
 		b = fragment_code + relocation->offset + reloc_size;
 	}
 	char const *const end = fragment_code + fragment->len;
@@ -326,6 +329,7 @@ void be_jit_emit_as_asm(ir_jit_function_t *const function,
 static void emit_fragment(ir_jit_function_t const *const function,
 						  fragment_info_t const *const fragment,
                           char const *const fragment_code, char *const buffer,
+                          char const *const address,
                           emit_relocation_func const emit)
 {
 	unsigned        const fragment_address = fragment->address;
@@ -342,7 +346,8 @@ static void emit_fragment(ir_jit_function_t const *const function,
 		b += len;
 		unsigned const reloc_address = fragment_address + offset;
 		unsigned const reloc_size
-			= emit_relocation(function, relocation, reloc_address, d, emit);
+			= emit_relocation(function, relocation, reloc_address, d,
+			                  address + (d - buffer), emit);
 		d += reloc_size;
 		b += reloc_size;
 		last_offset = offset + reloc_size;
@@ -352,7 +357,8 @@ static void emit_fragment(ir_jit_function_t const *const function,
 	memcpy(d, b, end-b);
 }
 
-void be_jit_emit_memory(char *const buffer, ir_jit_function_t *const function,
+void be_jit_emit_memory(char *const buffer, char const *const exec_address,
+                        ir_jit_function_t *const function,
                         be_jit_emit_interface_t const *const emitter)
 {
 	/* Copy fragments and resolve relocations. */
@@ -362,13 +368,13 @@ void be_jit_emit_memory(char *const buffer, ir_jit_function_t *const function,
 	for (size_t i = 0, n = function->n_fragments; i < n; ++i) {
 		fragment_info_t const *const fragment  = function->fragment_infos[i];
 		unsigned               const address   = fragment->address;
-		unsigned               const nop_bytes = last_address - address;
+		unsigned               const nop_bytes = address - last_address;
 		assert(address >= last_address);
 		if (nop_bytes > 0)
 			emitter->nops(buffer + last_address, nop_bytes);
 
 		emit_fragment(function, fragment, code+orig_address, buffer+address,
-		              emitter->relocation);
+		              exec_address+address, emitter->relocation);
 
 		orig_address += fragment->len;
 		last_address = address + fragment->len;
@@ -18,8 +18,14 @@
 #include "jit.h"
 #include "obst.h"
 
-typedef unsigned (*emit_relocation_func) (char *buffer, uint8_t be_kind,
-                                          ir_entity *entity, int32_t offset);
+/**
+ * Writes a relocation to @p buffer. @p address is the address the relocated
+ * bytes are executed at, which differs from @p buffer if the code is written
+ * through a separate view of executable memory.
+ */
+typedef unsigned (*emit_relocation_func) (char *buffer, char const *address,
+                                          uint8_t be_kind, ir_entity *entity,
+                                          int32_t offset);
 
 typedef struct be_jit_emit_interface_t {
 	/** create @p size of NOP instructions for alignment */
@@ -30,11 +36,22 @@ typedef struct be_jit_emit_interface_t {
 	emit_relocation_func relocation;
 } be_jit_emit_interface_t;
 
-void be_jit_emit_memory(char *buffer, ir_jit_function_t *function,
+/**
+ * Copies @p function to @p buffer and resolves its relocations for execution
+ * at @p exec_address.
+ */
+void be_jit_emit_memory(char *buffer, char const *exec_address,
+                        ir_jit_function_t *function,
                         be_jit_emit_interface_t const *emitter);
 
 void be_jit_emit_as_asm(ir_jit_function_t *function, emit_relocation_func emit);
 
+/**
+ * Creates executable memory, which is mapped once and made writable to change
+ * code, as on systems without a way to map it twice.
+ */
+ir_jit_memory_t *be_new_jit_memory_single_mapped(void);
+
 void be_jit_begin_function(ir_jit_segment_t *segment);
 ir_jit_function_t *be_jit_finish_function(void);
 
@@ -0,0 +1,441 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Executable memory for jit compiled functions.
+ *
+ * Code is placed in arenas of pages requested from the operating system.
+ * Where possible an arena is mapped twice: A writable view which is used to
+ * emit and patch code and an executable view. No page is ever writable and
+ * executable at the same time and permissions never change. Otherwise the
+ * arena is mapped once, pages are made writable when code is written to them
+ * and be_jit_commit_memory() makes all of them executable again at once. An
+ * entry on an executable page of such an arena is patched in a copy of the
+ * page, which replaces the page once it is executable.
+ *
+ * Functions are placed in blocks of power of two size classes. A freed block
+ * is reused for the next function of its class. Functions bigger than the
+ * largest class get an arena of their own, which is unmapped when they are
+ * freed.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "be_t.h"
+#include "bearch.h"
+#include "bejit.h"
+#include "bitset.h"
+#include "jit.h"
+#include "panic.h"
+#include "pmap.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#define MIN_CLASS_LOG 6  /**< smallest block is a cache line */
+#define MAX_CLASS_LOG 14
+#define N_CLASSES     (MAX_CLASS_LOG - MIN_CLASS_LOG + 1)
+#define LARGE_CLASS   N_CLASSES
+#define ARENA_SIZE    ((size_t)1 << 20)
+#define PATCH_SIZE    8  /**< patchable entries are a single 8 byte word */
+
+typedef struct jit_arena_t jit_arena_t;
+struct jit_arena_t {
+	jit_arena_t *next;
+	char        *write;       /**< writable view */
+	char        *exec;        /**< executable view, same as write if the
+	                               arena is mapped once */
+	size_t       size;
+	size_t       used;        /**< end of the blocks carved from the arena */
+	size_t       dirty_begin; /**< range written since the last commit */
+	size_t       dirty_end;
+	bitset_t    *writable;    /**< writable pages if the arena is mapped
+	                               once */
+};
+
+typedef struct jit_block_t jit_block_t;
+struct jit_block_t {
+	jit_arena_t *arena;
+	jit_block_t *next_free;
+	size_t       offset;
+	unsigned     size_class;
+};
+
+struct ir_jit_memory_t {
+	jit_arena_t *arenas;     /**< arenas of the size classes, blocks are
+	                              carved from the first one */
+	jit_arena_t *large;      /**< arenas of functions with LARGE_CLASS */
+	jit_block_t *free_blocks[N_CLASSES];
+	pmap        *blocks;     /**< maps executable addresses to blocks */
+	size_t       page_size;
+	bool         dual_mapped;
+};
+
+static size_t class_size(unsigned const size_class)
+{
+	return (size_t)1 << (size_class + MIN_CLASS_LOG);
+}
+
+static unsigned get_size_class(unsigned const size)
+{
+	unsigned size_class = 0;
+	while (size_class < LARGE_CLASS && class_size(size_class) < size)
+		++size_class;
+	return size_class;
+}
+
+static bool map_dual(size_t const size, char **const write, char **const exec)
+{
+#ifdef MFD_CLOEXEC
+	int const fd = memfd_create("firm-jit", MFD_CLOEXEC);
+	if (fd < 0)
+		return false;
+	void *w = MAP_FAILED;
+	void *x = MAP_FAILED;
+	if (ftruncate(fd, size) == 0) {
+		w = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		x = mmap(NULL, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (w == MAP_FAILED || x == MAP_FAILED) {
+		if (w != MAP_FAILED)
+			munmap(w, size);
+		if (x != MAP_FAILED)
+			munmap(x, size);
+		return false;
+	}
+	*write = (char*)w;
+	*exec  = (char*)x;
+	return true;
+#else
+	(void)size;
+	(void)write;
+	(void)exec;
+	return false;
+#endif
+}
+
+static jit_arena_t *new_arena(ir_jit_memory_t *const memory, size_t const size)
+{
+	jit_arena_t *const arena = XMALLOCZ(jit_arena_t);
+	arena->size        = size;
+	arena->dirty_begin = size;
+	if (memory->dual_mapped && !map_dual(size, &arena->write, &arena->exec))
+		memory->dual_mapped = false;
+	if (!memory->dual_mapped) {
+		void *const mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mem == MAP_FAILED)
+			panic("could not map jit code memory");
+		arena->write    = (char*)mem;
+		arena->exec     = (char*)mem;
+		arena->writable = bitset_malloc(size / memory->page_size);
+		bitset_set_all(arena->writable);
+	}
+	return arena;
+}
+
+static void free_arena(jit_arena_t *const arena)
+{
+	munmap(arena->exec, arena->size);
+	if (arena->write != arena->exec)
+		munmap(arena->write, arena->size);
+	free(arena->writable);
+	free(arena);
+}
+
+static void flush_icache(char *const begin, char *const end)
+{
+#if defined(__GNUC__)
+	__builtin___clear_cache(begin, end);
+#else
+	(void)begin;
+	(void)end;
+#endif
+}
+
+/**
+ * Changes the pages [@p begin, @p end) of an arena, which is mapped once, to
+ * be writable or executable. Adjacent pages are changed together.
+ */
+static void protect_pages(jit_arena_t *const arena, size_t const page_size,
+                          size_t const begin, size_t const end,
+                          bool const writable)
+{
+	bitset_t *const pages = arena->writable;
+	for (size_t page = begin; page < end;) {
+		if (bitset_is_set(pages, page) == writable) {
+			++page;
+			continue;
+		}
+		size_t run_end = page + 1;
+		while (run_end < end && bitset_is_set(pages, run_end) != writable)
+			++run_end;
+		int const prot = writable ? PROT_READ | PROT_WRITE
+		                          : PROT_READ | PROT_EXEC;
+		if (mprotect(arena->exec + page * page_size,
+		             (run_end - page) * page_size, prot) != 0)
+			panic("could not change protection of jit code memory");
+		bitset_mod_range(pages, page, run_end, writable);
+		page = run_end;
+	}
+}
+
+/** Prepares the bytes [@p begin, @p end) of @p arena for writing. */
+static void begin_write(ir_jit_memory_t const *const memory,
+                        jit_arena_t *const arena, size_t const begin,
+                        size_t const end)
+{
+	if (arena->writable != NULL) {
+		size_t const page_size = memory->page_size;
+		protect_pages(arena, page_size, begin / page_size,
+		              (end + page_size - 1) / page_size, true);
+	}
+	arena->dirty_begin = MIN(arena->dirty_begin, begin);
+	arena->dirty_end   = MAX(arena->dirty_end, end);
+}
+
+static void commit_arenas(ir_jit_memory_t const *const memory,
+                          jit_arena_t *const arenas)
+{
+	size_t const page_size = memory->page_size;
+	for (jit_arena_t *arena = arenas; arena != NULL; arena = arena->next) {
+		size_t const begin = arena->dirty_begin;
+		size_t const end   = arena->dirty_end;
+		if (begin >= end)
+			continue;
+		if (arena->writable != NULL)
+			protect_pages(arena, page_size, begin / page_size,
+			              (end + page_size - 1) / page_size, false);
+		flush_icache(arena->exec + begin, arena->exec + end);
+		arena->dirty_begin = arena->size;
+		arena->dirty_end   = 0;
+	}
+}
+
+static jit_block_t *new_block(jit_arena_t *const arena, size_t const offset,
+                              unsigned const size_class)
+{
+	jit_block_t *const block = XMALLOCZ(jit_block_t);
+	block->arena      = arena;
+	block->offset     = offset;
+	block->size_class = size_class;
+	return block;
+}
+
+static void free_block(ir_jit_memory_t *const memory, jit_block_t *const block)
+{
+	unsigned const size_class = block->size_class;
+	block->next_free = memory->free_blocks[size_class];
+	memory->free_blocks[size_class] = block;
+}
+
+/**
+ * Puts the unused end of the current arena into the free lists, so it is not
+ * wasted when a new arena is started.
+ */
+static void retire_arena(ir_jit_memory_t *const memory,
+                         jit_arena_t *const arena)
+{
+	for (unsigned size_class = N_CLASSES; size_class-- > 0;) {
+		size_t const size = class_size(size_class);
+		while (arena->size - arena->used >= size) {
+			free_block(memory, new_block(arena, arena->used, size_class));
+			arena->used += size;
+		}
+	}
+}
+
+static jit_block_t *alloc_block(ir_jit_memory_t *const memory,
+                                unsigned const size)
+{
+	unsigned const size_class = get_size_class(size);
+	if (size_class == LARGE_CLASS) {
+		size_t       const arena_size = round_up2(size, memory->page_size);
+		jit_arena_t *const arena      = new_arena(memory, arena_size);
+		arena->next   = memory->large;
+		memory->large = arena;
+		return new_block(arena, 0, LARGE_CLASS);
+	}
+
+	jit_block_t *const reused = memory->free_blocks[size_class];
+	if (reused != NULL) {
+		memory->free_blocks[size_class] = reused->next_free;
+		reused->next_free = NULL;
+		return reused;
+	}
+
+	size_t const block_size = class_size(size_class);
+	jit_arena_t *arena      = memory->arenas;
+	if (arena == NULL || arena->size - arena->used < block_size) {
+		if (arena != NULL)
+			retire_arena(memory, arena);
+		arena = new_arena(memory, round_up2(ARENA_SIZE, memory->page_size));
+		arena->next    = memory->arenas;
+		memory->arenas = arena;
+	}
+	jit_block_t *const block = new_block(arena, arena->used, size_class);
+	arena->used += block_size;
+	return block;
+}
+
+static jit_block_t *find_block(ir_jit_memory_t const *const memory,
+                              void const *const code)
+{
+	jit_block_t *const block = pmap_get(jit_block_t, memory->blocks, code);
+	if (block == NULL)
+		panic("%p is not a function installed in jit memory", code);
+	return block;
+}
+
+static ir_jit_memory_t *new_jit_memory(bool const dual_mapped)
+{
+	ir_jit_memory_t *const memory = XMALLOCZ(ir_jit_memory_t);
+	memory->blocks      = pmap_create();
+	memory->page_size   = (size_t)sysconf(_SC_PAGESIZE);
+	memory->dual_mapped = dual_mapped;
+	return memory;
+}
+
+ir_jit_memory_t *be_new_jit_memory(void)
+{
+	return new_jit_memory(true);
+}
+
+ir_jit_memory_t *be_new_jit_memory_single_mapped(void)
+{
+	return new_jit_memory(false);
+}
+
+static void free_arenas(jit_arena_t *arena)
+{
+	while (arena != NULL) {
+		jit_arena_t *const next = arena->next;
+		free_arena(arena);
+		arena = next;
+	}
+}
+
+void be_destroy_jit_memory(ir_jit_memory_t *const memory)
+{
+	foreach_pmap(memory->blocks, entry) {
+		free(entry->value);
+	}
+	for (unsigned size_class = 0; size_class < N_CLASSES; ++size_class) {
+		for (jit_block_t *block = memory->free_blocks[size_class], *next;
+		     block != NULL; block = next) {
+			next = block->next_free;
+			free(block);
+		}
+	}
+	free_arenas(memory->arenas);
+	free_arenas(memory->large);
+	pmap_destroy(memory->blocks);
+	free(memory);
+}
+
+void *be_jit_install_function(ir_jit_memory_t *const memory,
+                              ir_jit_function_t *const function)
+{
+	unsigned     const size  = be_get_function_size(function);
+	jit_block_t *const block = alloc_block(memory, size);
+	jit_arena_t *const arena = block->arena;
+	size_t       const begin = block->offset;
+	begin_write(memory, arena, begin, begin + size);
+
+	char *const code = arena->exec + begin;
+	isa_if->emit_function(arena->write + begin, code, function);
+	pmap_insert(memory->blocks, code, block);
+	return code;
+}
+
+void be_jit_commit_memory(ir_jit_memory_t *const memory)
+{
+	commit_arenas(memory, memory->arenas);
+	commit_arenas(memory, memory->large);
+}
+
+void be_jit_free_function(ir_jit_memory_t *const memory, void *const code)
+{
+	jit_block_t *const block = find_block(memory, code);
+	pmap_insert(memory->blocks, code, NULL);
+	if (block->size_class != LARGE_CLASS) {
+		free_block(memory, block);
+		return;
+	}
+
+	for (jit_arena_t **anchor = &memory->large;; anchor = &(*anchor)->next) {
+		if (*anchor == block->arena) {
+			*anchor = block->arena->next;
+			break;
+		}
+	}
+	free_arena(block->arena);
+	free(block);
+}
+
+/**
+ * Patches the entry at @p in_page of the executable @p page of @p arena
+ * without making the page writable: The entry is patched in a copy of the
+ * page, which is then made executable and atomically moved over the page.
+ */
+static void replace_page(ir_jit_memory_t const *const memory,
+                         jit_arena_t *const arena, size_t const page,
+                         size_t const in_page, void const *const target)
+{
+#ifdef MREMAP_FIXED
+	size_t const page_size = memory->page_size;
+	char  *const exec      = arena->exec + page * page_size;
+	void  *const copy      = mmap(NULL, page_size, PROT_READ | PROT_WRITE,
+	                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (copy == MAP_FAILED)
+		panic("could not map jit code memory");
+	memcpy(copy, exec, page_size);
+	isa_if->jit_patch_entry((char*)copy + in_page, exec + in_page, target);
+	if (mprotect(copy, page_size, PROT_READ | PROT_EXEC) != 0
+	    || mremap(copy, page_size, page_size, MREMAP_MAYMOVE | MREMAP_FIXED,
+	              exec) == MAP_FAILED)
+		panic("could not replace jit code memory");
+	flush_icache(exec + in_page, exec + in_page + PATCH_SIZE);
+#else
+	(void)memory;
+	(void)arena;
+	(void)page;
+	(void)in_page;
+	(void)target;
+	panic("patching jit code needs a writable mapping on this system");
+#endif
+}
+
+void be_jit_patch_installed_entry(ir_jit_memory_t *const memory,
+                                  void *const entry, void const *const target)
+{
+	if (isa_if->jit_patch_entry == NULL)
+		panic("jit entry patching not supported by target");
+
+	jit_block_t *const block  = find_block(memory, entry);
+	jit_arena_t *const arena  = block->arena;
+	size_t       const offset = block->offset;
+	char        *const exec   = arena->exec + offset;
+	if (arena->writable == NULL) {
+		isa_if->jit_patch_entry(arena->write + offset, exec, target);
+		flush_icache(exec, exec + PATCH_SIZE);
+		return;
+	}
+
+	/* A page written since the last commit is writable anyway and nothing
+	 * may run on it. */
+	size_t const page = offset / memory->page_size;
+	if (bitset_is_set(arena->writable, page)) {
+		isa_if->jit_patch_entry(exec, exec, target);
+		return;
+	}
+	replace_page(memory, arena, page, offset % memory->page_size, target);
+}
@@ -126,26 +126,24 @@ static be_lv_info_node_t *be_lv_get_or_set(be_lv_t *li, ir_node *bl,
 	return res;
 }
 
-typedef struct lv_remove_walker_t {
-	be_lv_t       *lv;
-	ir_node const *irn;
-} lv_remove_walker_t;
-
 /**
- * Removes a node from the list of live variables of a block.
+ * Removes a node from the list of live variables of a block and of all
+ * successor blocks it is live in.
+ * A value is only live in blocks, which are reachable from the block of its
+ * definition through blocks it is live in, so this only visits the blocks the
+ * value is live in and their immediate successors.
  */
-static void lv_remove_irn_walker(ir_node *const bl, void *const data)
+static void lv_remove_irn(be_lv_t *const lv, ir_node *const bl,
+                          ir_node const *const irn)
 {
-	lv_remove_walker_t *const w        = (lv_remove_walker_t*)data;
-	be_lv_info_t       *const irn_live = ir_nodehashmap_get(be_lv_info_t, &w->lv->map, bl);
+	be_lv_info_t *const irn_live = ir_nodehashmap_get(be_lv_info_t, &lv->map, bl);
 	if (irn_live == NULL)
 		return;
 
 	unsigned           const n   = irn_live->n_members;
-	ir_node     const *const irn = w->irn;
 	unsigned           const pos = _be_liveness_bsearch(irn_live, irn);
 	be_lv_info_node_t *const res = &irn_live->nodes[pos];
-	if (res->node != irn)
+	if (pos >= n || res->node != irn)
 		return;
 
 	/* The node is indeed in the block's array. Let's remove it. */
@@ -157,6 +155,10 @@ static void lv_remove_irn_walker(ir_node *const bl, void *const data)
 
 	--irn_live->n_members;
 	DBG((dbg, LEVEL_3, "\tdeleting %+F from %+F at pos %d\n", irn, bl, pos));
+
+	foreach_block_succ(bl, edge) {
+		lv_remove_irn(lv, get_edge_src_irn(edge), irn);
+	}
 }
 
 static struct {
@@ -333,10 +335,10 @@ void be_liveness_remove(be_lv_t *lv, const ir_node *irn)
 	assert(lv->sets_valid);
 
 	/* Removes a single irn from the liveness information.
-	 * Since an irn can only be live at blocks dominated by the block of its
-	 * definition, we only have to process that dominance subtree. */
-	lv_remove_walker_t w = { lv, irn };
-	dom_tree_walk(get_nodes_block(irn), lv_remove_irn_walker, NULL, &w);
+	 * The blocks an irn is live in are connected to the block of its
+	 * definition, so only they are visited. Therefore irn must still be in the
+	 * block it was in, when its liveness was computed. */
+	lv_remove_irn(lv, get_nodes_block(irn), irn);
 }
 
 void be_liveness_introduce(be_lv_t *lv, ir_node *irn)
@@ -65,6 +65,9 @@ void be_liveness_update(be_lv_t *lv, ir_node *irn);
 
 /**
  * Remove a node from the liveness information.
+ * Only the blocks the node is live in and their successors are visited, so
+ * this is cheap for values with short live ranges. The node must not have
+ * been moved to another block since its liveness was computed.
  */
 void be_liveness_remove(be_lv_t *lv, const ir_node *irn);
 
@@ -11,6 +11,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "lc_opts.h"
 #include "lc_opts_enum.h"
@@ -34,6 +35,8 @@
 
 #include "be_t.h"
 #include "bediagnostic.h"
+#include "bedwarf.h"
+#include "beelf.h"
 #include "begnuas.h"
 #include "bemodule.h"
 #include "beutil.h"
@@ -52,6 +55,7 @@
 #include "beirg.h"
 #include "bestack.h"
 #include "beemitter.h"
+#include "befuncorder.h"
 
 static struct obstack obst;
 static be_main_env_t  env;
@@ -64,8 +68,11 @@ be_options_t be_options = {
 	.opt_profile_use      = false,
 	.omit_fp              = false,
 	.do_verify            = true,
+	.verify_liveness      = false,
 	.ilp_solver           = "",
 	.verbose_asm          = true,
+	.order_functions      = false,
+	.emit_object          = false,
 	.pic_style            = BE_PIC_NONE,
 };
 
@@ -105,10 +112,13 @@ static const lc_opt_table_entry_t be_main_options[] = {
 	LC_OPT_ENT_BOOL     ("omitfp",     "omit frame pointer",                                  &be_options.omit_fp),
 	LC_OPT_ENT_ENUM_INT ("pic",        "Generate position independent code",                  &pic_style_var),
 	LC_OPT_ENT_BOOL     ("verify",     "verify the backend irg",                              &be_options.do_verify),
+	LC_OPT_ENT_BOOL     ("verifylive", "compare updated liveness sets with recomputed ones",  &be_options.verify_liveness),
 	LC_OPT_ENT_BOOL     ("time",       "get backend timing statistics",                       &be_options.timing),
 	LC_OPT_ENT_BOOL     ("profilegenerate", "instrument the code for execution count profiling", &be_options.opt_profile_generate),
 	LC_OPT_ENT_BOOL     ("profileuse",      "use existing profile data",                         &be_options.opt_profile_use),
 	LC_OPT_ENT_BOOL     ("verboseasm", "enable verbose assembler output",                        &be_options.verbose_asm),
+	LC_OPT_ENT_BOOL     ("orderfuncs", "order functions by call frequency for code locality",    &be_options.order_functions),
+	LC_OPT_ENT_BOOL     ("object",     "write an ELF object file instead of assembler",         &be_options.emit_object),
 
 	LC_OPT_ENT_STR("ilp.solver", "the ilp solver name", &be_options.ilp_solver),
 	LC_OPT_LAST
@@ -353,6 +363,28 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 	return prof_init_irg;
 }
 
+/**
+ * Stops compilation if the object file writer cannot produce what the
+ * options ask for: Debug information (including the .eh_frame call frame
+ * information) and PIC would otherwise be dropped silently.
+ */
+static void check_object_output(void)
+{
+	char const *error;
+	if (isa_if->elf_target == NULL)
+		error = "target cannot write object files";
+	else if (be_dwarf_enabled())
+		error = "debug information not supported in object files";
+	else if (be_options.pic_style != BE_PIC_NONE)
+		error = "position independent code not supported in object files";
+	else if (get_irp_n_asms() > 0)
+		error = "global asm not supported in object files";
+	else
+		return;
+	be_errorf(NULL, "%s", error);
+	exit(EXIT_FAILURE);
+}
+
 void be_begin(FILE *file_handle, const char *cup_name)
 {
 	memset(be_asm_constraint_flags, 0, sizeof(be_asm_constraint_flags));
@@ -422,7 +454,17 @@ void be_begin(FILE *file_handle, const char *cup_name)
 	if (prof_init_irg != NULL)
 		initialize_birg(&birgs[num_birgs++], prof_init_irg, &env);
 
-	be_gas_begin_compilation_unit(&env);
+	/* Emit functions calling each other frequently next to each other. */
+	if (be_options.order_functions)
+		be_order_irp_graphs();
+
+	if (be_options.emit_object) {
+		check_object_output();
+		be_elf_begin_compilation_unit(file_handle, isa_if->elf_target,
+		                              cup_name);
+	} else {
+		be_gas_begin_compilation_unit(&env);
+	}
 }
 
 void firm_be_finish(void)
@@ -491,6 +533,7 @@ static const char *get_timer_name(be_timer_id_t id)
 	case T_LIVE:           return "live";
 	case T_EXECFREQ:       return "execfreq";
 	case T_SSA_CONSTR:     return "ssa_constr";
+	case T_SPILLSLOTS:     return "spillslots";
 	case T_RA_EPILOG:      return "ra_epilog";
 	case T_RA_CONSTR:      return "ra_constr";
 	case T_RA_SPILL:       return "ra_spill";
@@ -634,7 +677,10 @@ void be_step_last(ir_graph *irg)
 
 void be_finish(void)
 {
-	be_gas_end_compilation_unit(&env);
+	if (be_options.emit_object)
+		be_elf_end_compilation_unit(&env);
+	else
+		be_gas_end_compilation_unit(&env);
 
 	if (be_options.timing) {
 		ir_timer_stop(bemain_timer);
@@ -666,8 +712,29 @@ void be_main(FILE *file_handle, const char *cup_name)
 	isa_if->generate_code(file_handle, cup_name);
 }
 
-ir_jit_function_t *be_jit_compile(ir_jit_segment_t *const segment,
-                                  ir_graph *const irg)
+/**
+ * Creates a copy of @p irg for the fast jit tier to consume, so @p irg stays
+ * available for an optimized recompilation.
+ */
+static ir_graph *copy_irg_for_jit(ir_graph *const irg)
+{
+	ir_graph *const copy = create_irg_copy(irg);
+	set_irg_entity(copy, get_irg_entity(irg));
+	add_irg_constraints(copy, irg->constraints);
+	return copy;
+}
+
+static void free_jit_copy(ir_graph *const copy)
+{
+	/* the entity still belongs to the original graph */
+	set_irg_entity(copy, NULL);
+	free_type(get_irg_frame_type(copy));
+	free_ir_graph(copy);
+}
+
+ir_jit_function_t *be_jit_compile_tier(ir_jit_segment_t *const segment,
+                                       ir_graph *const irg,
+                                       ir_jit_tier_t const tier)
 {
 	initialize_isa();
 	if (isa_if->jit_compile == NULL)
@@ -678,16 +745,50 @@ ir_jit_function_t *be_jit_compile(ir_jit_segment_t *const segment,
 	ir_entity *entity = get_irg_entity(irg);
 	if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN)
 		return NULL;
+
+	bool      const fast     = tier == ir_jit_tier_fast;
+	ir_graph *const code_irg = fast ? copy_irg_for_jit(irg) : irg;
+	if (!fast) {
+		be_timer_push(T_EXECFREQ);
+		ir_estimate_execfreq(irg);
+		be_timer_pop(T_EXECFREQ);
+	}
+
 	be_irg_t *const birg = OALLOCZ(&obst, be_irg_t);
-	initialize_birg(birg, irg, &env);
+	initialize_birg(birg, code_irg, &env);
+	birg->fast_path = fast;
 	if (isa_if->handle_intrinsics)
-		isa_if->handle_intrinsics(irg);
-	be_dump(DUMP_INITIAL, irg, "prepared");
+		isa_if->handle_intrinsics(code_irg);
+	be_dump(DUMP_INITIAL, code_irg, "prepared");
 
-	return isa_if->jit_compile(segment, irg);
+	ir_jit_function_t *const res = isa_if->jit_compile(segment, code_irg);
+	if (fast)
+		free_jit_copy(code_irg);
+	return res;
+}
+
+ir_jit_function_t *be_jit_compile(ir_jit_segment_t *const segment,
+                                  ir_graph *const irg)
+{
+	return be_jit_compile_tier(segment, irg, ir_jit_tier_optimized);
+}
+
+void be_jit_patch_entry(char *const entry, void const *const target)
+{
+	initialize_isa();
+	if (isa_if->jit_patch_entry == NULL)
+		panic("jit entry patching not supported by target");
+	isa_if->jit_patch_entry(entry, entry, target);
 }
 
 void be_emit_function(char *const buffer, ir_jit_function_t *const function)
 {
-	isa_if->emit_function(buffer, function);
+	isa_if->emit_function(buffer, buffer, function);
+}
+
+void be_jit_order_graphs(ir_graph **const irgs, size_t const n_irgs)
+{
+	for (size_t i = 0; i < n_irgs; ++i)
+		ir_estimate_execfreq(irgs[i]);
+	be_order_graphs(irgs, n_irgs);
 }
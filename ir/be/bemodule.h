@@ -48,6 +48,12 @@ typedef struct be_module_list_entry_t be_module_list_entry_t;
 void be_add_module_to_list(be_module_list_entry_t **list_head, const char *name,
                            void *module);
 
+/**
+ * Returns the data of the module named @p name in a module list or NULL if
+ * there is no such module.
+ */
+void *be_find_module(be_module_list_entry_t const *list_head, char const *name);
+
 void be_add_module_list_opt(lc_opt_entry_t *grp, const char *name,
                             const char *description,
                             be_module_list_entry_t * const * first,
@@ -78,6 +78,8 @@ static unsigned                    *normal_regs;
 static int                         *congruence_classes;
 static ir_node                    **block_order;
 static size_t                       n_block_order;
+/** values whose uses changed while allocating the current class */
+static ir_nodeset_t                 lv_changed;
 
 /** currently active assignments (while processing a basic block)
  * maps registers to values(their current copies) */
@@ -126,6 +128,20 @@ static allocation_info_t *get_allocation_info(ir_node *node)
 	return info;
 }
 
+/**
+ * Remembers that the uses of @p node changed, so its liveness must be updated.
+ * For new nodes their operands are remembered as well.
+ */
+static void mark_liveness_changed(ir_node *node, bool new_node)
+{
+	ir_nodeset_insert(&lv_changed, node);
+	if (new_node) {
+		foreach_irn_in(skip_Proj(node), i, op) {
+			ir_nodeset_insert(&lv_changed, op);
+		}
+	}
+}
+
 static allocation_info_t *try_get_allocation_info(const ir_node *node)
 {
 	return (allocation_info_t*) get_irn_link(node);
@@ -611,6 +627,7 @@ static bool try_optimistic_split(ir_node *to_split, ir_node *before,
 	ir_node               *copy  = be_new_Copy(block, to_split);
 	unsigned               width = 1;
 	mark_as_copy_of(copy, to_split);
+	mark_liveness_changed(copy, true);
 	/* hacky, but correct here */
 	if (assignments[from_reg->index] == to_split)
 		free_reg_of_value(to_split);
@@ -800,6 +817,7 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
 		DB((dbg, LEVEL_2, "Copy %+F (from %+F, before %+F) -> %s\n",
 		    copy, src, before, reg->name));
 		mark_as_copy_of(copy, src);
+		mark_liveness_changed(copy, true);
 		unsigned width = 1; /* TODO */
 		use_reg(copy, reg, width);
 
@@ -860,11 +878,13 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
 
 		ir_node *const proj0 = be_new_Proj(perm, 0);
 		mark_as_copy_of(proj0, in[0]);
+		mark_liveness_changed(proj0, true);
 		const arch_register_t *reg0 = arch_register_for_index(cls, old_r);
 		use_reg(proj0, reg0, width);
 
 		ir_node *const proj1 = be_new_Proj(perm, 1);
 		mark_as_copy_of(proj1, in[1]);
+		mark_liveness_changed(proj1, true);
 		const arch_register_t *reg1 = arch_register_for_index(cls, r2);
 		use_reg(proj1, reg1, width);
 
@@ -924,6 +944,8 @@ static void rewire_inputs(ir_node *node)
 
 		info = get_allocation_info(info->original_value);
 		if (info->current_value != op) {
+			mark_liveness_changed(op, false);
+			mark_liveness_changed(info->current_value, false);
 			set_irn_n(node, i, info->current_value);
 		}
 	}
@@ -1304,6 +1326,8 @@ static void add_phi_permutations(ir_node *block, int p)
 		   predecessor */
 		int      a  = arch_get_irn_register(phi)->index;
 		ir_node *op = pred_info->assignments[a];
+		mark_liveness_changed(get_Phi_pred(phi, p), false);
+		mark_liveness_changed(op, false);
 		set_Phi_pred(phi, p, op);
 	}
 }
@@ -1520,6 +1544,7 @@ static void allocate_coalesce_block(ir_node *block, void *data)
 			DB((dbg, LEVEL_3, "\n"));
 #endif
 			mark_as_copy_of(phi, node);
+			mark_liveness_changed(phi, true);
 			sched_add_after(block, phi);
 
 			node = phi;
@@ -1736,6 +1761,7 @@ static void be_pref_alloc_cls(void)
 {
 	be_assure_live_sets(irg);
 	lv = be_get_irg_liveness(irg);
+	ir_nodeset_init(&lv_changed);
 
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 
@@ -1752,6 +1778,15 @@ static void be_pref_alloc_cls(void)
 	}
 
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+
+	/* The allocation works with the liveness from before it inserted copies,
+	 * perms and phis, so update it only now. */
+	be_timer_push(T_LIVE);
+	foreach_ir_nodeset(&lv_changed, node, iter) {
+		be_liveness_update(lv, node);
+	}
+	be_timer_pop(T_LIVE);
+	ir_nodeset_destroy(&lv_changed);
 }
 
 /**
@@ -1803,7 +1838,7 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 
 		spill(regif);
 
-		/* verify schedule and register pressure */
+		/* verify schedule, register pressure and updated liveness */
 		if (be_options.do_verify) {
 			be_timer_push(T_VERIFY);
 			bool check_schedule = be_verify_schedule(irg);
@@ -1812,14 +1847,18 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 			be_check_verify_result(check_pressure, irg);
 			be_timer_pop(T_VERIFY);
 		}
+		be_lv_t *const live = be_get_irg_liveness(irg);
+		if (be_options.verify_liveness && live->sets_valid) {
+			be_timer_push(T_VERIFY);
+			bool check_liveness = be_liveness_check(live);
+			be_check_verify_result(check_liveness, irg);
+			be_timer_pop(T_VERIFY);
+		}
 
 		be_timer_push(T_RA_COLOR);
 		be_pref_alloc_cls();
 		be_timer_pop(T_RA_COLOR);
 
-		/* we most probably constructed new Phis so liveness info is invalid
-		 * now */
-		be_invalidate_live_sets(irg);
 		free(normal_regs);
 
 		stat_ev_ctx_pop("regcls");
@@ -1827,6 +1866,7 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 
 	free_block_order();
 	obstack_free(&obst, NULL);
+	be_invalidate_live_sets(irg);
 
 	set_optimize(last_opt_state);
 }
@@ -9,6 +9,7 @@
  * @author      Sebastian Hack
  * @date        22.11.2004
  */
+#include "beirg.h"
 #include "bemodule.h"
 #include "bera.h"
 #include "irtools.h"
@@ -26,7 +27,14 @@ void be_register_allocator(const char *name, allocate_func allocator)
 
 void be_allocate_registers(ir_graph *irg, const regalloc_if_t *regif)
 {
-	selected_allocator(irg, regif);
+	if (be_is_fast_path(irg)) {
+		/* single pass without a separate copy minimization */
+		allocate_func const pref
+			= (allocate_func)be_find_module(register_allocators, "pref");
+		pref(irg, regif);
+	} else {
+		selected_allocator(irg, regif);
+	}
 }
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_ra)
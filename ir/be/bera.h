@@ -19,6 +19,20 @@ struct regalloc_if_t {
 	unsigned spill_cost;  /**< cost for a spill node */
 	unsigned reload_cost; /**< cost for a reload node */
 
+	/**
+	 * Register class of the condition flags or NULL. Nodes which modify the
+	 * flags are only rematerialized where no value of this class is live.
+	 */
+	const arch_register_class_t *flags_cls;
+
+	/**
+	 * Returns the cost of recomputing the rematerializable node @p node
+	 * instead of reloading its value. A cost of at least spill_cost +
+	 * reload_cost prevents the rematerialization. The estimated cost of the
+	 * isa is used if this is NULL.
+	 */
+	unsigned (*get_remat_cost)(const ir_node *node);
+
 	/** mark node as rematerialized */
 	void (*mark_remat)(ir_node *node);
 
@@ -15,6 +15,7 @@
 #include "ircons.h"
 #include "irgmod.h"
 
+#include "beirg.h"
 #include "bemodule.h"
 #include "besched.h"
 #include "belistsched.h"
@@ -155,7 +156,13 @@ void be_register_scheduler(const char *name, schedule_func func)
 
 void be_schedule_graph(ir_graph *irg)
 {
-	scheduler(irg);
+	if (be_is_fast_path(irg)) {
+		schedule_func const trivial
+			= (schedule_func)be_find_module(schedulers, "trivial");
+		trivial(irg);
+	} else {
+		scheduler(irg);
+	}
 }
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_sched)
@@ -28,10 +28,12 @@
 
 bool be_coalesce_spill_slots = true;
 bool be_do_remats            = true;
+bool be_place_spills         = true;
 
 static const lc_opt_table_entry_t be_spill_options[] = {
 	LC_OPT_ENT_BOOL ("coalesce_slots", "coalesce the spill slots", &be_coalesce_spill_slots),
 	LC_OPT_ENT_BOOL ("remat", "try to rematerialize values instead of reloading", &be_do_remats),
+	LC_OPT_ENT_BOOL ("place", "move spills and reloads to less frequently executed places", &be_place_spills),
 	LC_OPT_LAST
 };
 
@@ -48,7 +50,13 @@ void be_register_spiller(const char *name, be_spill_func spiller)
 void be_do_spill(ir_graph *irg, const arch_register_class_t *cls,
 				 const regalloc_if_t *regif)
 {
-	selected_spiller(irg, cls, regif);
+	if (be_is_fast_path(irg)) {
+		be_spill_func const daemel
+			= (be_spill_func)be_find_module(spillers, "daemel");
+		daemel(irg, cls, regif);
+	} else {
+		selected_spiller(irg, cls, regif);
+	}
 }
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_spilloptions)
@@ -43,6 +43,8 @@ static unsigned                     n_regs;
 static const arch_register_class_t *cls;
 static const be_lv_t               *lv;
 static bitset_t                    *spilled_nodes;
+/** spill costs by node index, negative if not computed yet */
+static double                      *spill_costs;
 
 typedef struct spill_candidate_t spill_candidate_t;
 struct spill_candidate_t {
@@ -59,6 +61,12 @@ static int compare_spill_candidates_desc(const void *d1, const void *d2)
 
 static double get_spill_costs(ir_node *node)
 {
+	/* The costs do not depend on the place where we spill, so compute them
+	 * only once per node instead of at each place with too high pressure. */
+	double *const cached = &spill_costs[get_irn_idx(node)];
+	if (*cached >= 0)
+		return *cached;
+
 	ir_node *spill_place = skip_Proj(node);
 	double   costs       = be_get_spill_costs(spill_env, node, spill_place);
 
@@ -78,6 +86,7 @@ static double get_spill_costs(ir_node *node)
 		}
 	}
 
+	*cached = costs;
 	return costs;
 }
 
@@ -311,11 +320,15 @@ static void be_spill_daemel(ir_graph *irg, const arch_register_class_t *new_cls,
 	cls           = new_cls;
 	lv            = be_get_irg_liveness(irg);
 	spilled_nodes = bitset_malloc(get_irg_last_idx(irg));
+	spill_costs   = XMALLOCN(double, get_irg_last_idx(irg));
+	for (unsigned i = 0, n = get_irg_last_idx(irg); i < n; ++i)
+		spill_costs[i] = -1;
 
 	DBG((dbg, LEVEL_1, "*** RegClass %s\n", cls->name));
 
 	irg_block_walk_graph(irg, spill_block, NULL, NULL);
 
+	free(spill_costs);
 	free(spilled_nodes);
 
 	be_insert_spills_reloads(spill_env);
@@ -20,6 +20,9 @@
 #include "execfreq.h"
 #include "unionfind.h"
 #include "irdump_t.h"
+#include "irprintf.h"
+#include "iredges_t.h"
+#include "pqueue.h"
 
 #include "benode.h"
 #include "besched.h"
@@ -28,8 +31,8 @@
 #include "bechordal_t.h"
 #include "statev_t.h"
 #include "bemodule.h"
-#include "belive.h"
 #include "beirg.h"
+#include "be_t.h"
 #include "bespillutil.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
@@ -226,76 +229,314 @@ void be_load_needs_frame_entity(be_fec_env_t *const env, ir_node *const node,
 	merge_slotsizes(spill->web, slot_size, slot_po2align);
 }
 
-static int merge_interferences(be_fec_env_t *env, bitset_t** interferences,
-                               int* spillslot_unionfind, int s1, int s2)
+/** A half-open range [from, to) of schedule positions. */
+typedef struct live_segment_t {
+	unsigned from;
+	unsigned to;
+} live_segment_t;
+
+/** A spillslot used by the linear scan in do_linear_scan_coalescing(). */
+typedef struct scan_slot_t {
+	unsigned end;  /**< end of the live range last assigned to this slot */
+	int      rep;  /**< spill representing the slot */
+} scan_slot_t;
+
+/** Start and end of the live range of a spill set, used for sorting. */
+typedef struct scan_interval_t {
+	unsigned start;
+	unsigned end;
+	int      spill;
+} scan_interval_t;
+
+typedef struct coalesce_env_t {
+	ir_graph        *irg;
+	unsigned        *positions;  /**< schedule positions indexed by node idx */
+	unsigned         next_pos;
+	ir_node        **worklist;
+	live_segment_t  *segments;   /**< segments of the value being examined */
+	ir_node         *def_block;
+	unsigned         def_pos;
+} coalesce_env_t;
+
+/**
+ * Numbers the nodes of a block. All blocks together form one linear order in
+ * which the block start (and all Phis) come first, each scheduled node gets
+ * its own position and the block end gets the position after the last node.
+ */
+static void number_block(ir_node *block, void *data)
 {
-	/* merge spillslots and interferences */
-	int res = uf_union(spillslot_unionfind, s1, s2);
-	/* we assume that we always merge s2 to s1 so swap s1, s2 if necessary */
-	if (res != s1) {
-		int t = s1;
-		s1 = s2;
-		s2 = t;
+	coalesce_env_t *const cenv = (coalesce_env_t*)data;
+	unsigned              pos  = cenv->next_pos;
+	cenv->positions[get_irn_idx(block)] = pos;
+	sched_foreach(block, node) {
+		if (!is_Phi(node))
+			++pos;
+		cenv->positions[get_irn_idx(node)] = pos;
 	}
+	cenv->next_pos = pos + 2;
+}
+
+static unsigned get_position(const coalesce_env_t *cenv, const ir_node *node)
+{
+	return cenv->positions[get_irn_idx(node)];
+}
 
-	bitset_or(interferences[s1], interferences[s2]);
+static unsigned get_block_end(const coalesce_env_t *cenv, const ir_node *block)
+{
+	return get_position(cenv, sched_last(block)) + 1;
+}
 
-	/* update other interferences */
-	for (size_t i = 0, n = ARR_LEN(env->spills); i < n; ++i) {
-		bitset_t *intfs = interferences[i];
-		if (bitset_is_set(intfs, s2))
-			bitset_set(intfs, s1);
+/** Appends a segment, joining it with the last one if they touch. */
+static void append_segment(live_segment_t **segments, unsigned from,
+                           unsigned to)
+{
+	size_t const n = ARR_LEN(*segments);
+	if (n > 0) {
+		live_segment_t *const last = &(*segments)[n - 1];
+		if (from <= last->to) {
+			last->to = MAX(last->to, to);
+			return;
+		}
 	}
+	live_segment_t const segment = { from, to };
+	ARR_APP1(live_segment_t, *segments, segment);
+}
 
-	return res;
+static int cmp_segment(const void *d1, const void *d2)
+{
+	const live_segment_t *s1 = (const live_segment_t*)d1;
+	const live_segment_t *s2 = (const live_segment_t*)d2;
+	return (s1->from > s2->from) - (s1->from < s2->from);
+}
+
+static void add_segment(coalesce_env_t *cenv, unsigned from, unsigned to)
+{
+	live_segment_t const segment = { from, to };
+	ARR_APP1(live_segment_t, cenv->segments, segment);
+}
+
+static void add_live_in(coalesce_env_t *cenv, ir_node *block)
+{
+	if (Block_block_visited(block))
+		return;
+	mark_Block_block_visited(block);
+	ARR_APP1(ir_node*, cenv->worklist, block);
+}
+
+/** Records that the current value is used at position @p pos in @p block. */
+static void add_use(coalesce_env_t *cenv, ir_node *block, unsigned pos)
+{
+	if (block == cenv->def_block) {
+		assert(pos > cenv->def_pos);
+		add_segment(cenv, cenv->def_pos, pos);
+		return;
+	}
+	add_segment(cenv, get_position(cenv, block), pos);
+	add_live_in(cenv, block);
+}
+
+static void add_uses(coalesce_env_t *cenv, ir_node *value)
+{
+	foreach_out_edge(value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Sync(user)) {
+			add_uses(cenv, user);
+		} else if (is_Phi(user)) {
+			ir_node *const block = get_nodes_block(user);
+			ir_node *const pred
+				= get_Block_cfgpred_block(block, get_edge_src_pos(edge));
+			if (!is_Bad(pred))
+				add_use(cenv, pred, get_block_end(cenv, pred));
+		} else {
+			ir_node *const block = get_nodes_block(user);
+			unsigned const pos   = sched_is_scheduled(user)
+				? get_position(cenv, user) : get_block_end(cenv, block);
+			add_use(cenv, block, pos);
+		}
+	}
 }
 
 /**
- * A greedy coalescing algorithm for spillslots:
- *  1. Sort the list of affinity edges
- *  2. Try to merge slots with affinity edges (most expensive slots first)
- *  3. Try to merge everything else that is possible
+ * Collects the live segments of a memory value from its definition to all
+ * its uses. A Sync is live wherever one of its operands is.
  */
-static void do_greedy_coalescing(be_fec_env_t *env)
+static void collect_segments(coalesce_env_t *cenv, ir_node *value)
 {
-	spill_t **spills     = env->spills;
-	size_t    spillcount = ARR_LEN(spills);
-	if (spillcount == 0)
+	if (is_NoMem(value))
 		return;
+	if (is_Sync(value)) {
+		foreach_irn_in(value, i, in) {
+			collect_segments(cenv, in);
+		}
+		return;
+	}
 
-	DB((dbg, LEVEL_1, "Coalescing %d spillslots\n", spillcount));
+	ir_node *const def = skip_Proj(value);
+	cenv->def_block = get_nodes_block(def);
+	cenv->def_pos   = get_position(cenv, def);
+	/* the definition writes the slot even if the value is never read */
+	add_segment(cenv, cenv->def_pos, cenv->def_pos + 1);
+
+	inc_irg_block_visited(cenv->irg);
+	add_uses(cenv, value);
+	while (ARR_LEN(cenv->worklist) > 0) {
+		size_t   const n     = ARR_LEN(cenv->worklist);
+		ir_node *const block = cenv->worklist[n - 1];
+		ARR_SHRINKLEN(cenv->worklist, n - 1);
+
+		for (int i = 0, arity = get_Block_n_cfgpreds(block); i < arity; ++i) {
+			ir_node *const pred = get_Block_cfgpred_block(block, i);
+			if (is_Bad(pred))
+				continue;
+			unsigned const end = get_block_end(cenv, pred) + 1;
+			if (pred == cenv->def_block) {
+				add_segment(cenv, cenv->def_pos, end);
+			} else {
+				add_segment(cenv, get_position(cenv, pred), end);
+				add_live_in(cenv, pred);
+			}
+		}
+	}
+}
 
-	struct obstack data;
-	obstack_init(&data);
+/** Computes the sorted and joined live segments of a spill. */
+static live_segment_t *compute_live_range(coalesce_env_t *cenv,
+                                          ir_node *value)
+{
+	ARR_SHRINKLEN(cenv->segments, 0);
+	collect_segments(cenv, value);
+	QSORT_ARR(cenv->segments, cmp_segment);
 
-	bitset_t **interferences       = OALLOCN(&data, bitset_t*, spillcount);
-	int       *spillslot_unionfind = OALLOCN(&data, int,       spillcount);
+	live_segment_t *range = NEW_ARR_F(live_segment_t, 0);
+	for (size_t i = 0, n = ARR_LEN(cenv->segments); i < n; ++i) {
+		append_segment(&range, cenv->segments[i].from, cenv->segments[i].to);
+	}
+	return range;
+}
 
-	uf_init(spillslot_unionfind, spillcount);
+static bool ranges_intersect(const live_segment_t *r1,
+                             const live_segment_t *r2)
+{
+	for (size_t i1 = 0, i2 = 0, n1 = ARR_LEN(r1), n2 = ARR_LEN(r2);
+	     i1 < n1 && i2 < n2;) {
+		if (r1[i1].to <= r2[i2].from) {
+			++i1;
+		} else if (r2[i2].to <= r1[i1].from) {
+			++i2;
+		} else {
+			return true;
+		}
+	}
+	return false;
+}
 
-	for (size_t i = 0; i < spillcount; ++i) {
-		interferences[i] = bitset_obstack_alloc(&data, spillcount);
+static live_segment_t *union_ranges(const live_segment_t *r1,
+                                    const live_segment_t *r2)
+{
+	size_t const    n1    = ARR_LEN(r1);
+	size_t const    n2    = ARR_LEN(r2);
+	live_segment_t *range = NEW_ARR_F(live_segment_t, 0);
+	for (size_t i1 = 0, i2 = 0; i1 < n1 || i2 < n2;) {
+		const live_segment_t *next;
+		if (i2 == n2 || (i1 < n1 && r1[i1].from < r2[i2].from)) {
+			next = &r1[i1++];
+		} else {
+			next = &r2[i2++];
+		}
+		append_segment(&range, next->from, next->to);
 	}
+	return range;
+}
+
+/**
+ * Checks that spills sharing a spillslot are never live at the same time.
+ */
+static bool verify_slot_ranges(coalesce_env_t *cenv, spill_t *const *spills)
+{
+	size_t           const spillcount = ARR_LEN(spills);
+	live_segment_t **const slots      = XMALLOCNZ(live_segment_t*, spillcount);
+	bool                   fine       = true;
 
-	/* construct interferences */
+	ir_reserve_resources(cenv->irg, IR_RESOURCE_BLOCK_VISITED);
 	for (size_t i = 0; i < spillcount; ++i) {
-		ir_node *spill1 = spills[i]->spill;
-		if (is_NoMem(spill1))
+		spill_t         *const spill = spills[i];
+		live_segment_t  *const range = compute_live_range(cenv, spill->spill);
+		live_segment_t **const slot  = &slots[spill->spillslot];
+		if (*slot == NULL) {
+			*slot = range;
 			continue;
+		}
+		if (ranges_intersect(*slot, range)) {
+			ir_fprintf(stderr, "%+F: %+F interferes with spillslot %d\n",
+			           cenv->irg, spill->spill, spill->spillslot);
+			fine = false;
+		}
+		live_segment_t *const merged = union_ranges(*slot, range);
+		DEL_ARR_F(*slot);
+		DEL_ARR_F(range);
+		*slot = merged;
+	}
+	ir_free_resources(cenv->irg, IR_RESOURCE_BLOCK_VISITED);
 
-		for (size_t i2 = i+1; i2 < spillcount; ++i2) {
-			ir_node *spill2 = spills[i2]->spill;
-			if (is_NoMem(spill2))
-				continue;
+	for (size_t i = 0; i < spillcount; ++i) {
+		if (slots[i] != NULL)
+			DEL_ARR_F(slots[i]);
+	}
+	free(slots);
+	return fine;
+}
 
-			if (be_memory_values_interfere(spill1, spill2)) {
-				DB((dbg, LEVEL_1, "Slot %d and %d interfere\n", i, i2));
+static int cmp_scan_interval(const void *d1, const void *d2)
+{
+	const scan_interval_t *i1 = (const scan_interval_t*)d1;
+	const scan_interval_t *i2 = (const scan_interval_t*)d2;
+	if (i1->start != i2->start)
+		return i1->start < i2->start ? -1 : 1;
+	return (i1->spill > i2->spill) - (i1->spill < i2->spill);
+}
 
-				bitset_set(interferences[i], i2);
-				bitset_set(interferences[i2], i);
-			}
-		}
+/**
+ * A linear scan coalescing algorithm for spillslots:
+ *  1. Compute the live range of each spill as a list of segments in a linear
+ *     order of the schedules of all blocks.
+ *  2. Sort the list of affinity edges and merge slots connected by an affinity
+ *     edge if their live ranges do not intersect (most expensive slots first)
+ *  3. Scan the remaining slots in the order of their start positions and reuse
+ *     a slot once the live range last assigned to it has ended.
+ * In contrast to pairwise interference checks, time and memory are linear in
+ * the size of the live ranges (apart from sorting).
+ */
+static void do_linear_scan_coalescing(be_fec_env_t *env)
+{
+	spill_t **spills     = env->spills;
+	size_t    spillcount = ARR_LEN(spills);
+	if (spillcount == 0)
+		return;
+
+	DB((dbg, LEVEL_1, "Coalescing %d spillslots\n", spillcount));
+
+	struct obstack data;
+	obstack_init(&data);
+
+	ir_graph      *const irg = env->irg;
+	coalesce_env_t       cenv;
+	cenv.irg       = irg;
+	cenv.positions = OALLOCNZ(&data, unsigned, get_irg_last_idx(irg));
+	cenv.next_pos  = 0;
+	cenv.worklist  = NEW_ARR_F(ir_node*, 0);
+	cenv.segments  = NEW_ARR_F(live_segment_t, 0);
+	irg_block_walk_graph(irg, NULL, number_block, &cenv);
+
+	/* construct live ranges */
+	live_segment_t **ranges = OALLOCN(&data, live_segment_t*, spillcount);
+	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+	for (size_t i = 0; i < spillcount; ++i) {
+		ranges[i] = compute_live_range(&cenv, spills[i]->spill);
 	}
+	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+
+	int *spillslot_unionfind = OALLOCN(&data, int, spillcount);
+	uf_init(spillslot_unionfind, spillcount);
 
 	/* sort affinity edges */
 	QSORT_ARR(env->affinity_edges, cmp_affinity);
@@ -305,54 +546,102 @@ static void do_greedy_coalescing(be_fec_env_t *env)
 		const affinity_edge_t *edge = env->affinity_edges[i];
 		int s1 = uf_find(spillslot_unionfind, edge->slot1);
 		int s2 = uf_find(spillslot_unionfind, edge->slot2);
+		if (s1 == s2)
+			continue;
 
 		/* test if values interfere */
-		if (bitset_is_set(interferences[s1], s2)) {
-			assert(bitset_is_set(interferences[s2], s1));
+		if (ranges_intersect(ranges[s1], ranges[s2]))
 			continue;
-		}
 
 		DB((dbg, LEVEL_1,
 		    "Merging %d and %d because of affinity edge\n", s1, s2));
 
-		merge_interferences(env, interferences, spillslot_unionfind, s1, s2);
+		live_segment_t *const merged = union_ranges(ranges[s1], ranges[s2]);
+		DEL_ARR_F(ranges[s1]);
+		DEL_ARR_F(ranges[s2]);
+		ranges[s1] = NULL;
+		ranges[s2] = NULL;
+		int const res = uf_union(spillslot_unionfind, s1, s2);
+		ranges[res] = merged;
 	}
 
-	/* Try to merge as much remaining spillslots as possible */
+	/* sort the remaining slots by the start of their live ranges */
+	scan_interval_t *intervals = OALLOCN(&data, scan_interval_t, spillcount);
+	size_t           n_intervals = 0;
 	for (size_t i = 0; i < spillcount; ++i) {
-		int s1 = uf_find(spillslot_unionfind, i);
-		if (s1 != (int)i)
+		if (uf_find(spillslot_unionfind, i) != (int)i)
 			continue;
-
-		for (size_t i2 = i+1; i2 < spillcount; ++i2) {
-			int s2 = uf_find(spillslot_unionfind, i2);
-			if (s2 != (int)i2)
-				continue;
-
-			/* Test if values interfere, we have to test n1-n2 and n2-n1,
-			 * because only 1 side gets updated when node merging occurs */
-			if (bitset_is_set(interferences[s1], s2)) {
-				assert(bitset_is_set(interferences[s2], s1));
-				continue;
-			}
-
-			DB((dbg, LEVEL_1,
-			    "Merging %d and %d because it is possible\n", s1, s2));
-
-			if (merge_interferences(env, interferences, spillslot_unionfind,
-			                        s1, s2) != 0) {
-				/* We can break the loop here, because s2 is the new supernode
-				 * now and we'll test s2 again later anyway */
+		const live_segment_t *const range = ranges[i];
+		size_t                const n     = ARR_LEN(range);
+		if (n == 0)
+			continue; /* NoMem, handled below */
+		scan_interval_t *const interval = &intervals[n_intervals++];
+		interval->start = range[0].from;
+		interval->end   = range[n - 1].to;
+		interval->spill = (int)i;
+	}
+	QSORT(intervals, n_intervals, cmp_scan_interval);
+
+	/* assign slots */
+	int          *assigned   = OALLOCN(&data, int, spillcount);
+	pqueue_t     *active     = new_pqueue();
+	scan_slot_t **free_slots = NEW_ARR_F(scan_slot_t*, 0);
+	scan_slot_t  *first_slot = NULL;
+	for (size_t i = 0; i < n_intervals; ++i) {
+		const scan_interval_t *const interval = &intervals[i];
+
+		/* release slots whose live ranges ended before this one starts */
+		while (!pqueue_empty(active)) {
+			scan_slot_t *const slot = (scan_slot_t*)pqueue_pop_front(active);
+			if (slot->end > interval->start) {
+				pqueue_put(active, slot, -(int)slot->end);
 				break;
 			}
+			ARR_APP1(scan_slot_t*, free_slots, slot);
 		}
+
+		scan_slot_t *slot;
+		size_t const n_free = ARR_LEN(free_slots);
+		if (n_free > 0) {
+			slot = free_slots[n_free - 1];
+			ARR_SHRINKLEN(free_slots, n_free - 1);
+			DB((dbg, LEVEL_1, "Merging %d and %d because it is possible\n",
+			    slot->rep, interval->spill));
+		} else {
+			slot      = OALLOC(&data, scan_slot_t);
+			slot->rep = interval->spill;
+			if (first_slot == NULL)
+				first_slot = slot;
+		}
+		slot->end = interval->end;
+		pqueue_put(active, slot, -(int)slot->end);
+		assigned[interval->spill] = slot->rep;
 	}
+	DEL_ARR_F(free_slots);
+	del_pqueue(active);
 
 	/* Assign spillslots to spills */
+	int empty_rep = first_slot != NULL ? first_slot->rep : -1;
+	for (size_t i = 0; i < spillcount; ++i) {
+		int const root = uf_find(spillslot_unionfind, i);
+		if (root != (int)i)
+			continue;
+		if (ARR_LEN(ranges[i]) == 0) {
+			if (empty_rep < 0)
+				empty_rep = root;
+			assigned[root] = empty_rep;
+		}
+		DEL_ARR_F(ranges[i]);
+	}
 	for (size_t i = 0; i < spillcount; ++i) {
-		spills[i]->spillslot = uf_find(spillslot_unionfind, i);
+		spills[i]->spillslot = assigned[uf_find(spillslot_unionfind, i)];
 	}
 
+	if (be_options.do_verify)
+		be_check_verify_result(verify_slot_ranges(&cenv, spills), irg);
+
+	DEL_ARR_F(cenv.segments);
+	DEL_ARR_F(cenv.worklist);
 	obstack_free(&data, 0);
 }
 
@@ -553,8 +842,6 @@ be_fec_env_t *be_new_frame_entity_coalescer(ir_graph *irg)
 {
 	be_fec_env_t *env = XMALLOCZ(be_fec_env_t);
 
-	be_assure_live_chk(irg);
-
 	obstack_init(&env->obst);
 	env->irg            = irg;
 	env->spills         = NEW_ARR_F(spill_t*, 0);
@@ -594,17 +881,22 @@ void be_assign_entities(be_fec_env_t *env,
 	env->set_frame_entity = set_frame_entity;
 	env->at_begin         = alloc_entities_at_begin;
 
+	be_timer_push(T_SPILLSLOTS);
+
 	if (stat_ev_enabled)
 		stat_ev_dbl("spillslots", ARR_LEN(env->spills));
 
-	if (be_coalesce_spill_slots && !env->coalescing_forbidden)
-		do_greedy_coalescing(env);
+	if (be_coalesce_spill_slots && !env->coalescing_forbidden
+	 && !be_is_fast_path(env->irg))
+		do_linear_scan_coalescing(env);
 
 	if (stat_ev_enabled)
 		stat_ev_dbl("spillslots_after_coalescing", count_spillslots(env));
 
 	assign_spillslots(env);
 	create_memperms(env);
+
+	be_timer_pop(T_SPILLSLOTS);
 }
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_spillslots)
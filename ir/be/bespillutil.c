@@ -9,6 +9,7 @@
  * @author      Daniel Grund, Sebastian Hack, Matthias Braun
  * @date        29.09.2005
  */
+#include <math.h>
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -29,12 +30,16 @@
 #include "execfreq.h"
 #include "ident_t.h"
 #include "irbackedge_t.h"
+#include "irdom.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgwalk.h"
+#include "irloop_t.h"
 #include "irnodehashmap.h"
+#include "irnodeset.h"
 #include "irnode_t.h"
+#include "pmap.h"
 #include "statev_t.h"
 #include "type_t.h"
 #include "util.h"
@@ -74,11 +79,19 @@ struct spill_info_t {
 	                                the value of the Phi gets spilled */
 };
 
+/** A reload created for a spilled value. */
+typedef struct placed_reload_t {
+	ir_node *reload;
+	ir_node *to_spill;
+} placed_reload_t;
+
 struct spill_env_t {
 	ir_graph         *irg;
 	ir_nodehashmap_t  spillmap;
 	spill_info_t     *spills;
 	spill_info_t     *mem_phis;
+	placed_reload_t  *reloads; /**< reloads for the placement phase */
+	ir_nodeset_t      changed; /**< values whose liveness must be updated */
 	struct obstack    obst;
 	regalloc_if_t     regif;
 	unsigned          spill_count;
@@ -112,7 +125,9 @@ spill_env_t *be_new_spill_env(ir_graph *irg, const regalloc_if_t *regif)
 	spill_env_t *env = XMALLOCZ(spill_env_t);
 	env->irg         = irg;
 	env->regif       = *regif;
+	env->reloads     = NEW_ARR_F(placed_reload_t, 0);
 	ir_nodehashmap_init(&env->spillmap);
+	ir_nodeset_init(&env->changed);
 	obstack_init(&env->obst);
 	return env;
 }
@@ -120,7 +135,9 @@ spill_env_t *be_new_spill_env(ir_graph *irg, const regalloc_if_t *regif)
 void be_delete_spill_env(spill_env_t *env)
 {
 	ir_nodehashmap_destroy(&env->spillmap);
+	ir_nodeset_destroy(&env->changed);
 	obstack_free(&env->obst, NULL);
+	DEL_ARR_F(env->reloads);
 	free(env);
 }
 
@@ -235,6 +252,36 @@ void be_spill_phi(spill_env_t *const env, ir_node *const phi)
 	}
 }
 
+/**
+ * Remembers that @p node is new or changed its operands, so the liveness of
+ * the node and of its operands must be updated.
+ */
+static void mark_liveness_changed(spill_env_t *env, ir_node *node)
+{
+	ir_nodeset_insert(&env->changed, node);
+	foreach_irn_in(skip_Proj(node), i, op) {
+		ir_nodeset_insert(&env->changed, op);
+	}
+}
+
+/**
+ * Updates the liveness of all values changed since the last update, if the
+ * liveness sets are valid.
+ */
+static void update_liveness(spill_env_t *env)
+{
+	be_lv_t *const lv = be_get_irg_liveness(env->irg);
+	if (lv->sets_valid) {
+		be_timer_push(T_LIVE);
+		foreach_ir_nodeset(&env->changed, node, iter) {
+			be_liveness_update(lv, node);
+		}
+		be_timer_pop(T_LIVE);
+	}
+	ir_nodeset_destroy(&env->changed);
+	ir_nodeset_init(&env->changed);
+}
+
 static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo);
 
 /**
@@ -256,6 +303,7 @@ static void spill_irn(spill_env_t *env, spill_info_t *spillinfo)
 	     spill = spill->next) {
 		ir_node *const after = be_move_after_schedule_first(spill->after);
 		spill->spill = env->regif.new_spill(to_spill, after);
+		mark_liveness_changed(env, spill->spill);
 		DB((dbg, LEVEL_1, "\t%+F after %+F\n", spill->spill, after));
 		env->spill_count++;
 	}
@@ -304,6 +352,7 @@ static void spill_phi(spill_env_t *env, spill_info_t *spillinfo)
 		ins[i] = arg_info->spills->spill;
 	}
 	be_complete_Phi(phim, arity, ins);
+	mark_liveness_changed(env, phim);
 	DBG((dbg, LEVEL_1, "... done spilling Phi %+F, created PhiM %+F\n", phi, phim));
 }
 
@@ -347,12 +396,43 @@ static bool is_value_available(spill_env_t *env, const ir_node *arg)
 	return false;
 }
 
+/**
+ * Tests whether a node modifying the flags may be placed before @p before,
+ * i.e. no flags value is live there.
+ */
+static bool may_clobber_flags(spill_env_t *env, const ir_node *before)
+{
+	const arch_register_class_t *const cls = env->regif.flags_cls;
+	if (cls == NULL)
+		return false;
+	/* The flags are never spilled, so their liveness stays valid while
+	 * spills and reloads of other classes are inserted. */
+	const be_lv_t *const lv = be_get_irg_liveness(env->irg);
+	if (!lv->sets_valid)
+		return false;
+
+	ir_nodeset_t live;
+	ir_nodeset_init(&live);
+	be_liveness_nodes_live_before(lv, cls, before, &live);
+	bool const res = ir_nodeset_size(&live) == 0;
+	ir_nodeset_destroy(&live);
+	return res;
+}
+
+static int get_remat_cost(spill_env_t *env, const ir_node *insn)
+{
+	if (env->regif.get_remat_cost != NULL)
+		return env->regif.get_remat_cost(insn);
+	return isa_if->get_op_estimated_cost(insn);
+}
+
 /**
  * Check if a node is rematerializable. This tests for the following conditions:
  *
  * - The node itself is rematerializable
  * - All arguments of the node are available or also rematerialisable
  * - The costs for the rematerialisation operation is less or equal a limit
+ * - The node does not destroy flags which are live at the reloader
  *
  * Returns the costs needed for rematerialisation or something
  * >= REMAT_COST_INFINITE if remat is not possible.
@@ -368,16 +448,13 @@ static int check_remat_conditions_costs(spill_env_t *env,
 	if (!arch_irn_is(insn, rematerializable))
 		return REMAT_COST_INFINITE;
 
-	int costs = isa_if->get_op_estimated_cost(insn);
+	int costs = get_remat_cost(env, insn);
 	int spillcosts = env->regif.reload_cost + env->regif.spill_cost;
 	if (parentcosts + costs >= spillcosts)
 		return REMAT_COST_INFINITE;
 
-	/* never rematerialize a node which modifies the flags.
-	 * (would be better to test whether the flags are actually live at point
-	 * reloader...)
-	 */
-	if (arch_irn_is(insn, modify_flags))
+	/* never rematerialize a node which modifies live flags */
+	if (arch_irn_is(insn, modify_flags) && !may_clobber_flags(env, reloader))
 		return REMAT_COST_INFINITE;
 
 	int argremats = 0;
@@ -425,6 +502,7 @@ static ir_node *do_remat(spill_env_t *env, ir_node *spilled, ir_node *reloader)
 	ir_node *const res = new_similar_node(spilled, bl, ins);
 	if (env->regif.mark_remat)
 		env->regif.mark_remat(res);
+	mark_liveness_changed(env, res);
 
 	DBG((dbg, LEVEL_1, "Insert remat %+F of %+F before reloader %+F\n", res,
 	     spilled, reloader));
@@ -503,8 +581,8 @@ static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo)
 		return;
 	}
 
-	/* calculate sum of execution frequencies of individual spills */
-	assert(spillinfo->spills);
+	/* calculate sum of execution frequencies of individual spills, spillers
+	 * like daemel do not place any and spill after the definition */
 	double spills_execfreq = 0;
 	for (spill_t *s = spillinfo->spills; s != NULL; s = s->next) {
 		ir_node *spill_block = get_block(s->after);
@@ -518,7 +596,7 @@ static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo)
 	    spill_execfreq * env->regif.spill_cost));
 
 	/* multi-/latespill is advantageous -> return*/
-	if (spills_execfreq < spill_execfreq) {
+	if (spillinfo->spills != NULL && spills_execfreq < spill_execfreq) {
 		DB((dbg, LEVEL_1, "use latespills for %+F\n", to_spill));
 		spillinfo->spill_costs = spills_execfreq * env->regif.spill_cost;
 		return;
@@ -535,6 +613,550 @@ static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo)
 	DB((dbg, LEVEL_1, "spill %+F after definition\n", to_spill));
 }
 
+/** A block of the dominator subtree examined when sinking a spill. */
+typedef struct place_block_t {
+	ir_node *block;
+	double   children_costs; /**< costs to cover the reloads below */
+	bool     has_reload;     /**< a reload is in the block itself */
+	bool     chosen;         /**< spilling here is cheaper than below */
+	bool     covered;        /**< a spill is placed here or above */
+	bool     extended;       /**< the value must live until the block */
+	ir_node *spill;          /**< the spill placed in this block */
+} place_block_t;
+
+/** Loop information for hoisting reloads. */
+typedef struct place_loop_t {
+	ir_node *preheader; /**< single block entering the loop or NULL */
+} place_loop_t;
+
+/** A reload hoisted into a block, shared by all reloads of the spill there. */
+typedef struct hoisted_reload_t hoisted_reload_t;
+struct hoisted_reload_t {
+	hoisted_reload_t *next;
+	ir_node          *block;
+	ir_node          *reload;
+};
+
+typedef struct place_env_t {
+	spill_env_t                 *env;
+	be_lv_t                     *lv;
+	arch_register_class_t const *cls;
+	unsigned                     n_regs;
+	pmap                        *loops;       /**< ir_loop -> place_loop_t */
+	ir_nodehashmap_t             hoisted;     /**< memory -> hoisted_reload_t */
+	ir_nodehashmap_t             replaced;    /**< moved reload -> new reload */
+	ir_nodehashmap_t             pressure;    /**< block -> register pressure */
+	ir_nodehashmap_t             block_extra; /**< block -> hoisted values */
+	ir_node                    **spill_nodes;
+	double                       costs;       /**< current weighted costs */
+	unsigned                     sunk_spills;
+	unsigned                     hoisted_reloads;
+} place_env_t;
+
+/**
+ * Returns the execution frequency weighted costs of all spills and reloads
+ * known to the placement.
+ */
+static double get_weighted_spill_costs(const place_env_t *penv)
+{
+	spill_env_t const *const env   = penv->env;
+	double                   costs = 0;
+	for (size_t i = 0, n = ARR_LEN(penv->spill_nodes); i < n; ++i) {
+		ir_node const *const spill = penv->spill_nodes[i];
+		costs += env->regif.spill_cost * get_block_execfreq(get_block_const(spill));
+	}
+	for (size_t i = 0, n = ARR_LEN(env->reloads); i < n; ++i) {
+		ir_node const *const reload = env->reloads[i].reload;
+		costs += env->regif.reload_cost * get_block_execfreq(get_block_const(reload));
+	}
+	return costs;
+}
+
+/**
+ * Computes the register pressure at the instructions from the end of
+ * @p block up to and including @p stop (the whole block if NULL). Values
+ * live before an instruction as well as values live after it together with
+ * its results need registers.
+ */
+static unsigned compute_pressure(place_env_t const *const penv,
+                                 ir_node *const block, ir_node const *const stop)
+{
+	arch_register_class_t const *const cls = penv->cls;
+	ir_nodeset_t live;
+	ir_nodeset_init(&live);
+	be_liveness_end_of_block(penv->lv, cls, block, &live);
+	size_t pressure = ir_nodeset_size(&live);
+	sched_foreach_non_phi_reverse(block, node) {
+		size_t n_dead = 0;
+		be_foreach_definition(node, cls, value, req,
+			if (!ir_nodeset_contains(&live, value))
+				++n_dead;
+		);
+		pressure = MAX(pressure, ir_nodeset_size(&live) + n_dead);
+		be_liveness_transfer(cls, node, &live);
+		pressure = MAX(pressure, ir_nodeset_size(&live));
+		if (node == stop)
+			break;
+	}
+	ir_nodeset_destroy(&live);
+	return (unsigned)pressure;
+}
+
+static unsigned get_extra_pressure(place_env_t *const penv,
+                                   ir_node const *const block)
+{
+	return PTR_TO_INT(ir_nodehashmap_get(void, &penv->block_extra, block));
+}
+
+static void add_extra_pressure(place_env_t *const penv, ir_node *const block)
+{
+	unsigned const extra = get_extra_pressure(penv, block);
+	ir_nodehashmap_insert(&penv->block_extra, block, INT_TO_PTR(extra + 1));
+}
+
+static void remove_spill_or_reload(place_env_t const *const penv,
+                                   ir_node *const node)
+{
+	spill_env_t *const env  = penv->env;
+	ir_node     *const insn = skip_Proj(node);
+	sched_remove(insn);
+	/* later pressure computations must not see the killed node */
+	be_liveness_remove(penv->lv, node);
+	ir_nodeset_remove(&env->changed, node);
+	ir_nodeset_remove(&env->changed, insn);
+	foreach_irn_in(insn, i, op) {
+		ir_nodeset_insert(&env->changed, op);
+	}
+	if (insn != node)
+		kill_node(node);
+	kill_node(insn);
+}
+
+static place_block_t *get_place_block(pmap *const blocks,
+                                      struct obstack *const obst,
+                                      ir_node *const block, bool *const created)
+{
+	place_block_t *pb = pmap_get(place_block_t, blocks, block);
+	*created = pb == NULL;
+	if (pb == NULL) {
+		pb        = OALLOCZ(obst, place_block_t);
+		pb->block = block;
+		pmap_insert(blocks, block, pb);
+	}
+	return pb;
+}
+
+static int cmp_place_block_depth(const void *d1, const void *d2)
+{
+	place_block_t const *const b1 = *(place_block_t const**)d1;
+	place_block_t const *const b2 = *(place_block_t const**)d2;
+	int const depth1 = get_Block_dom_depth(b1->block);
+	int const depth2 = get_Block_dom_depth(b2->block);
+	if (depth1 != depth2)
+		return depth2 - depth1;
+	return get_irn_idx(b1->block) < get_irn_idx(b2->block) ? -1 : 1;
+}
+
+/**
+ * Tries to replace @p spill of @p value by spills in less frequently executed
+ * blocks. Every reload of the spill must stay dominated by one of the new
+ * spills. The new places are the starts of blocks where the value is still
+ * live-in anyway, or of the direct successors of the spill block if the value
+ * fits into the registers until the end of the spill block. The cheapest
+ * placement is computed bottom-up over the dominator tree between the spill
+ * and its reloads.
+ */
+static void sink_spill(place_env_t *const penv, size_t const spill_nr,
+                       ir_node *const value)
+{
+	ir_node *const spill = penv->spill_nodes[spill_nr];
+	ir_node *const store = skip_Proj(spill);
+
+	/* we can only move spills of the value itself */
+	bool stores_value = false;
+	foreach_irn_in(store, i, in) {
+		if (in == value) {
+			stores_value = true;
+			break;
+		}
+	}
+	if (!stores_value)
+		return;
+
+	struct obstack obst;
+	obstack_init(&obst);
+	pmap           *const blocks      = pmap_create();
+	place_block_t       **order       = NEW_ARR_F(place_block_t*, 0);
+	ir_node        *const spill_block = get_nodes_block(store);
+	bool                  movable     = true;
+	bool                  created;
+
+	place_block_t *const root
+		= get_place_block(blocks, &obst, spill_block, &created);
+	foreach_out_edge(spill, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (!arch_irn_is(user, reload)) {
+			movable = false;
+			break;
+		}
+		ir_node       *block = get_nodes_block(user);
+		place_block_t *pb    = get_place_block(blocks, &obst, block, &created);
+		pb->has_reload = true;
+		while (created && block != spill_block) {
+			ARR_APP1(place_block_t*, order, pb);
+			block = get_Block_idom(block);
+			pb    = get_place_block(blocks, &obst, block, &created);
+		}
+	}
+	if (!movable || root->has_reload)
+		goto end;
+
+	/* compute the cheapest placement bottom-up */
+	QSORT_ARR(order, cmp_place_block_depth);
+	int extendable = -1; /* unknown */
+	for (size_t i = 0, n = ARR_LEN(order); i < n; ++i) {
+		place_block_t *const pb    = order[i];
+		ir_node       *const block = pb->block;
+		bool candidate = be_is_live_in(penv->lv, block, value);
+		if (!candidate && get_Block_n_cfgpreds(block) == 1
+		    && get_Block_cfgpred_block(block, 0) == spill_block) {
+			if (extendable < 0) {
+				unsigned const pressure
+					= compute_pressure(penv, spill_block, sched_next(store));
+				extendable = pressure + get_extra_pressure(penv, spill_block)
+				           + 1 <= penv->n_regs;
+			}
+			candidate    = extendable;
+			pb->extended = true;
+		}
+
+		double         const own    = candidate
+			? get_block_execfreq(block) : HUGE_VAL;
+		double         const below  = pb->has_reload
+			? HUGE_VAL : pb->children_costs;
+		place_block_t *const parent
+			= pmap_get(place_block_t, blocks, get_Block_idom(block));
+		pb->chosen = own <= below;
+		parent->children_costs += pb->chosen ? own : below;
+	}
+	double const costs = get_block_execfreq(spill_block);
+	if (!(root->children_costs < costs))
+		goto end;
+
+	DB((dbg, LEVEL_1, "sinking %+F of %+F (%f -> %f)\n", spill, value, costs,
+	    root->children_costs));
+
+	/* place the new spills top-down */
+	bool extended = false;
+	for (size_t i = ARR_LEN(order); i-- > 0;) {
+		place_block_t *const pb     = order[i];
+		place_block_t *const parent
+			= pmap_get(place_block_t, blocks, get_Block_idom(pb->block));
+		pb->covered = parent->covered;
+		if (pb->covered || !pb->chosen)
+			continue;
+
+		ir_node *after = pb->block;
+		while (is_Phi(sched_next(after)))
+			after = sched_next(after);
+		after = be_move_after_schedule_first(after);
+		pb->spill   = penv->env->regif.new_spill(value, after);
+		pb->covered = true;
+		mark_liveness_changed(penv->env, pb->spill);
+		extended   |= pb->extended;
+		DB((dbg, LEVEL_1, "\t%+F after %+F\n", pb->spill, after));
+	}
+
+	/* attach the reloads to the new spills */
+	foreach_out_edge_safe(spill, edge) {
+		ir_node       *const user = get_edge_src_irn(edge);
+		place_block_t       *pb
+			= pmap_get(place_block_t, blocks, get_nodes_block(user));
+		while (pb->spill == NULL)
+			pb = pmap_get(place_block_t, blocks, get_Block_idom(pb->block));
+		set_irn_n(user, get_edge_src_pos(edge), pb->spill);
+	}
+	remove_spill_or_reload(penv, spill);
+	/* the value now stays in a register until the end of the spill block */
+	if (extended)
+		add_extra_pressure(penv, spill_block);
+	penv->costs -= penv->env->regif.spill_cost
+	             * (costs - root->children_costs);
+	++penv->sunk_spills;
+
+end:
+	DEL_ARR_F(order);
+	pmap_destroy(blocks);
+	obstack_free(&obst, NULL);
+}
+
+static bool loop_contains(ir_loop const *const outer, ir_loop const *loop)
+{
+	unsigned const depth = get_loop_depth(outer);
+	while (get_loop_depth(loop) > depth)
+		loop = get_loop_outer_loop(loop);
+	return loop == outer;
+}
+
+static place_loop_t *get_place_loop(place_env_t *const penv,
+                                    ir_loop *const loop)
+{
+	place_loop_t *pl = pmap_get(place_loop_t, penv->loops, loop);
+	if (pl != NULL)
+		return pl;
+
+	pl = OALLOCZ(&penv->env->obst, place_loop_t);
+	pmap_insert(penv->loops, loop, pl);
+
+	/* find the single block entering the loop */
+	ir_node *preheader = NULL;
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const elem = get_loop_element(loop, i);
+		if (*elem.kind != k_ir_node)
+			continue;
+		ir_node *const block = elem.node;
+		for (int p = 0, arity = get_Block_n_cfgpreds(block); p < arity; ++p) {
+			ir_node *const pred = get_Block_cfgpred_block(block, p);
+			if (is_Bad(pred) || loop_contains(loop, get_irn_loop(pred)))
+				continue;
+			if (preheader != NULL)
+				return pl;
+			preheader = pred;
+		}
+	}
+	if (preheader != NULL
+	    && get_irn_n_edges_kind(preheader, EDGE_KIND_BLOCK) == 1)
+		pl->preheader = preheader;
+	return pl;
+}
+
+/** Checks whether one more value fits into the registers in all blocks of
+ * @p loop. */
+static bool loop_has_free_register(place_env_t *const penv,
+                                   ir_loop const *const loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop) {
+			if (!loop_has_free_register(penv, elem.son))
+				return false;
+			continue;
+		}
+		ir_node *const block    = elem.node;
+		unsigned       pressure = PTR_TO_INT(
+			ir_nodehashmap_get(void, &penv->pressure, block));
+		if (pressure == 0) {
+			/* store the pressure plus one to distinguish it from "unknown" */
+			pressure = compute_pressure(penv, block, NULL) + 1;
+			ir_nodehashmap_insert(&penv->pressure, block, INT_TO_PTR(pressure));
+		}
+		if (pressure + get_extra_pressure(penv, block) > penv->n_regs)
+			return false;
+	}
+	return true;
+}
+
+/** Marks a value hoisted out of @p loop as live in all its blocks. */
+static void add_loop_pressure(place_env_t *const penv, ir_loop const *const loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			add_loop_pressure(penv, elem.son);
+		else
+			add_extra_pressure(penv, elem.node);
+	}
+}
+
+/** Checks whether @p block dominates all uses of @p value. */
+static bool dominates_users(ir_node const *const block, ir_node const *const value)
+{
+	foreach_out_edge(value, edge) {
+		ir_node const *const user = get_edge_src_irn(edge);
+		ir_node const *use_block  = get_nodes_block(user);
+		if (is_Phi(user))
+			use_block = get_Block_cfgpred_block(use_block, get_edge_src_pos(edge));
+		if (!block_dominates(block, use_block))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Tries to move a reload out of the loops containing it, into the single
+ * block entering the loop. This is done as long as the entering block is
+ * executed less often and the loop has a free register for the whole time.
+ * Reloads of the same spill hoisted into the same block are shared.
+ */
+static void hoist_reload(place_env_t *const penv, size_t const reload_nr)
+{
+	spill_env_t *const env      = penv->env;
+	ir_node     *const to_spill = env->reloads[reload_nr].to_spill;
+	ir_node           *reload   = env->reloads[reload_nr].reload;
+	for (ir_node *next; (next = ir_nodehashmap_get(ir_node, &penv->replaced,
+	                                               reload)) != NULL;) {
+		reload = next;
+	}
+
+	for (;;) {
+		ir_node *const insn  = skip_Proj(reload);
+		ir_node *const block = get_nodes_block(insn);
+		ir_loop *const loop  = get_irn_loop(block);
+		if (loop == NULL || get_loop_depth(loop) == 0)
+			break;
+
+		place_loop_t *const pl        = get_place_loop(penv, loop);
+		ir_node      *const preheader = pl->preheader;
+		double        const freq      = get_block_execfreq(block);
+		if (preheader == NULL || !(get_block_execfreq(preheader) < freq))
+			break;
+
+		ir_node *mem = NULL;
+		foreach_irn_in(insn, i, in) {
+			if (get_irn_mode(in) == mode_M) {
+				mem = in;
+				break;
+			}
+		}
+		if (mem == NULL
+		    || !block_dominates(get_nodes_block(skip_Proj(mem)), preheader)
+		    || !dominates_users(preheader, reload))
+			break;
+
+		/* share a reload already hoisted into the block */
+		hoisted_reload_t *const first
+			= ir_nodehashmap_get(hoisted_reload_t, &penv->hoisted, mem);
+		ir_node *hoisted = NULL;
+		for (hoisted_reload_t *h = first; h != NULL; h = h->next) {
+			if (h->block == preheader) {
+				hoisted = h->reload;
+				break;
+			}
+		}
+		if (hoisted != NULL) {
+			for (ir_node *next; (next = ir_nodehashmap_get(ir_node,
+			     &penv->replaced, hoisted)) != NULL;) {
+				hoisted = next;
+			}
+		} else {
+			ir_node *const before
+				= be_get_end_of_block_insertion_point(preheader);
+			if (compute_pressure(penv, preheader, before)
+			    + get_extra_pressure(penv, preheader) + 1 > penv->n_regs
+			    || !loop_has_free_register(penv, loop))
+				break;
+
+			hoisted = env->regif.new_reload(to_spill, mem, before);
+			hoisted_reload_t *const h = OALLOC(&env->obst, hoisted_reload_t);
+			h->next   = first;
+			h->block  = preheader;
+			h->reload = hoisted;
+			ir_nodehashmap_insert(&penv->hoisted, mem, h);
+			penv->costs += env->regif.reload_cost
+			             * get_block_execfreq(preheader);
+
+			/* the hoisted value is live in the whole loop */
+			add_loop_pressure(penv, loop);
+			add_extra_pressure(penv, preheader);
+		}
+
+		DB((dbg, LEVEL_1, "hoisting %+F of %+F out of loop %ld to %+F\n",
+		    reload, to_spill, get_loop_loop_nr(loop), hoisted));
+		edges_reroute(reload, hoisted);
+		mark_liveness_changed(env, hoisted);
+		remove_spill_or_reload(penv, reload);
+		ir_nodehashmap_insert(&penv->replaced, reload, hoisted);
+		penv->costs -= env->regif.reload_cost * freq;
+		++penv->hoisted_reloads;
+		reload = hoisted;
+	}
+	env->reloads[reload_nr].reload = reload;
+}
+
+/**
+ * Moves spills and reloads to less frequently executed places: Spills are
+ * sunk towards their reloads and reloads are hoisted out of loops if the
+ * register pressure allows it.
+ */
+static void place_spills_reloads(spill_env_t *const env)
+{
+	ir_graph *const irg = env->irg;
+	place_env_t     penv;
+	memset(&penv, 0, sizeof(penv));
+	penv.env         = env;
+	penv.spill_nodes = NEW_ARR_F(ir_node*, 0);
+
+	ir_node **values = NEW_ARR_F(ir_node*, 0);
+	for (spill_info_t *si = env->spills; si != NULL; si = si->next) {
+		if (si->spilled_phi)
+			continue;
+		for (spill_t *spill = si->spills; spill != NULL; spill = spill->next) {
+			if (spill->spill == NULL)
+				continue;
+			ARR_APP1(ir_node*, penv.spill_nodes, spill->spill);
+			ARR_APP1(ir_node*, values, si->to_spill);
+		}
+	}
+	if (ARR_LEN(env->reloads) == 0)
+		goto end;
+
+	be_assure_live_sets(irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	penv.lv    = be_get_irg_liveness(irg);
+	penv.costs = get_weighted_spill_costs(&penv);
+	double const costs_before = penv.costs;
+
+	ir_node *const value = env->reloads[0].to_spill;
+	penv.cls    = arch_get_irn_register_req(value)->cls;
+	penv.n_regs = be_get_n_allocatable_regs(irg, penv.cls);
+	penv.loops  = pmap_create();
+	assure_loopinfo(irg);
+	ir_nodehashmap_init(&penv.hoisted);
+	ir_nodehashmap_init(&penv.replaced);
+	ir_nodehashmap_init(&penv.pressure);
+	ir_nodehashmap_init(&penv.block_extra);
+
+	for (size_t i = 0, n = ARR_LEN(values); i < n; ++i) {
+		sink_spill(&penv, i, values[i]);
+	}
+
+	for (size_t i = 0, n = ARR_LEN(env->reloads); i < n; ++i) {
+		hoist_reload(&penv, i);
+	}
+
+	ir_nodehashmap_destroy(&penv.block_extra);
+	ir_nodehashmap_destroy(&penv.pressure);
+	ir_nodehashmap_destroy(&penv.replaced);
+	ir_nodehashmap_destroy(&penv.hoisted);
+	pmap_destroy(penv.loops);
+
+	DB((dbg, LEVEL_1, "placement: %u spills sunk, %u reloads hoisted, "
+	    "weighted costs %f -> %f\n", penv.sunk_spills, penv.hoisted_reloads,
+	    costs_before, penv.costs));
+	stat_ev_dbl("spill_weighted_costs_before", costs_before);
+	stat_ev_dbl("spill_weighted_costs_after", penv.costs);
+	stat_ev_dbl("spill_sunk_spills", penv.sunk_spills);
+	stat_ev_dbl("spill_hoisted_reloads", penv.hoisted_reloads);
+
+end:
+	ARR_SHRINKLEN(env->reloads, 0);
+	DEL_ARR_F(values);
+	DEL_ARR_F(penv.spill_nodes);
+}
+
+/**
+ * Remembers the values whose uses an SSA construction rewired: The
+ * definitions it was given and the phis it inserted.
+ */
+static void mark_ssa_construction_changed(spill_env_t *env,
+                                          be_ssa_construction_env_t *senv)
+{
+	ir_node **const definitions = be_ssa_construction_get_definitions(senv);
+	for (size_t i = 0, n = ARR_LEN(definitions); i < n; ++i) {
+		ir_nodeset_insert(&env->changed, definitions[i]);
+	}
+}
+
 void be_insert_spills_reloads(spill_env_t *env)
 {
 	be_timer_push(T_RA_SPILL_APPLY);
@@ -620,7 +1242,11 @@ void be_insert_spills_reloads(spill_env_t *env)
 				assert(si->spills != NULL);
 				copy = env->regif.new_reload(si->to_spill, si->spills->spill,
 				                             rld->reloader);
+				mark_liveness_changed(env, copy);
 				env->reload_count++;
+
+				placed_reload_t const placed = { copy, si->to_spill };
+				ARR_APP1(placed_reload_t, env->reloads, placed);
 			}
 
 			DBG((dbg, LEVEL_1, " %+F of %+F before %+F\n",
@@ -636,6 +1262,7 @@ void be_insert_spills_reloads(spill_env_t *env)
 			be_ssa_construction_add_copy(&senv, to_spill);
 			be_ssa_construction_add_copies(&senv, copies, ARR_LEN(copies));
 			be_ssa_construction_fix_users(&senv, to_spill);
+			mark_ssa_construction_changed(env, &senv);
 			be_ssa_construction_destroy(&senv);
 		}
 		/* need to reconstruct SSA form if we had multiple spills */
@@ -654,6 +1281,7 @@ void be_insert_spills_reloads(spill_env_t *env)
 			if (spill_count > 1) {
 				/* all reloads are attached to the first spill, fix them now */
 				be_ssa_construction_fix_users(&senv, si->spills->spill);
+				mark_ssa_construction_changed(env, &senv);
 			}
 
 			be_ssa_construction_destroy(&senv);
@@ -668,9 +1296,13 @@ void be_insert_spills_reloads(spill_env_t *env)
 	stat_ev_dbl("spill_remats", env->remat_count);
 	stat_ev_dbl("spill_spilled_phis", env->spilled_phi_count);
 
-	/* Matze: In theory be_ssa_construction should take care of the liveness...
-	 * try to disable this again in the future */
-	be_invalidate_live_sets(env->irg);
+	/* the placement needs exact liveness */
+	update_liveness(env);
+
+	if (be_place_spills && !be_is_fast_path(env->irg)) {
+		place_spills_reloads(env);
+		update_liveness(env);
+	}
 
 	be_remove_dead_nodes_from_schedule(env->irg);
 
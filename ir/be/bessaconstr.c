@@ -129,6 +129,8 @@ static void introduce_definition(be_ssa_construction_env_t *env, ir_node *def)
 
 	DBG((dbg, LEVEL_2, "\tintroducing definition %+F in %+F\n", def, block));
 
+	if (!def_info->is_definition)
+		ARR_APP1(ir_node*, env->definitions, def);
 	def_info->is_definition = true;
 
 	skip_info->is_definition = true;
@@ -358,8 +360,9 @@ void be_ssa_construction_init(be_ssa_construction_env_t *env, ir_graph *irg)
 	            get_Block_dom_max_subtree_pre_num(get_irg_start_block(irg)));
 
 	memset(env, 0, sizeof(env[0]));
-	env->irg       = irg;
-	env->new_phis  = NEW_ARR_F(ir_node*, 0);
+	env->irg         = irg;
+	env->new_phis    = NEW_ARR_F(ir_node*, 0);
+	env->definitions = NEW_ARR_F(ir_node*, 0);
 	deq_init(&env->worklist);
 	ir_nodemap_init(&env->infos, irg);
 	obstack_init(&env->obst);
@@ -385,6 +388,7 @@ void be_ssa_construction_destroy(be_ssa_construction_env_t *env)
 	ir_nodemap_destroy(&env->infos);
 	deq_free(&env->worklist);
 	DEL_ARR_F(env->new_phis);
+	DEL_ARR_F(env->definitions);
 
 	ir_free_resources(env->irg, IR_RESOURCE_IRN_VISITED
 	                          | IR_RESOURCE_BLOCK_VISITED | IR_RESOURCE_IRN_LINK);
@@ -442,6 +446,11 @@ ir_node **be_ssa_construction_get_new_phis(be_ssa_construction_env_t *env)
 	return env->new_phis;
 }
 
+ir_node **be_ssa_construction_get_definitions(be_ssa_construction_env_t *env)
+{
+	return env->definitions;
+}
+
 /**
  * Fixes all arguments of a newly constructed phi.
  *
@@ -547,6 +556,19 @@ void be_ssa_construction_update_liveness_phis(be_ssa_construction_env_t *env,
 	be_timer_pop(T_SSA_CONSTR);
 }
 
+void be_ssa_construction_update_liveness(be_ssa_construction_env_t *env,
+                                         be_lv_t *lv)
+{
+	be_timer_push(T_SSA_CONSTR);
+	/* The definitions include the inserted phis, which were not live before,
+	 * so removing them finds nothing to do. */
+	for (size_t i = 0, n = ARR_LEN(env->definitions); i < n; ++i) {
+		ir_node *def = env->definitions[i];
+		be_liveness_update(lv, def);
+	}
+	be_timer_pop(T_SSA_CONSTR);
+}
+
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_ssaconstr)
 void be_init_ssaconstr(void)
 {
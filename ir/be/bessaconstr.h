@@ -46,6 +46,7 @@ typedef struct be_ssa_construction_env_t {
 	const arch_register_req_t   *phi_req;
 	deq_t                        worklist;
 	ir_node                    **new_phis;
+	ir_node                    **definitions;
 	bool                         iterated_domfront_calculated;
 	ir_nodemap                   infos;
 	struct obstack               obst;
@@ -81,8 +82,25 @@ void be_ssa_construction_fix_users_array(be_ssa_construction_env_t *env,
 void be_ssa_construction_update_liveness_phis(be_ssa_construction_env_t *env,
                                              be_lv_t *lv);
 
+/**
+ * Update the liveness of all values whose uses were rewired, i.e. of the
+ * original values, their copies and the inserted phis. Liveness only changes
+ * in the blocks these values are live in, so this is much cheaper than
+ * recomputing the liveness of the whole graph.
+ * @note The sets of @p lv must have been valid before the construction.
+ */
+void be_ssa_construction_update_liveness(be_ssa_construction_env_t *env,
+                                         be_lv_t *lv);
+
 ir_node **be_ssa_construction_get_new_phis(be_ssa_construction_env_t *env);
 
+/**
+ * Returns all definitions known to the construction, i.e. the original values,
+ * their copies and the inserted phis. Only the liveness of these values
+ * changes by rewiring their users.
+ */
+ir_node **be_ssa_construction_get_definitions(be_ssa_construction_env_t *env);
+
 /**
  * Destroys an SSA construction environment.
  */
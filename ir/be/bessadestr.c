@@ -227,11 +227,15 @@ void be_ssa_destruction(ir_graph *irg, const arch_register_class_t *cls)
 {
 	FIRM_DBG_REGISTER(dbg, "ir.be.ssadestr");
 
-	be_invalidate_live_sets(irg);
-	be_assure_live_chk(irg);
+	/* Valid liveness sets are updated while inserting the shuffle code,
+	 * otherwise the liveness check is used, which is discarded afterwards. */
+	be_lv_t *const lv         = be_get_irg_liveness(irg);
+	bool     const sets_valid = lv->sets_valid;
+	if (!sets_valid)
+		be_assure_live_chk(irg);
 
 	irg_block_walk_graph(irg, insert_shuffle_code_walker, NULL, (void*)cls);
 
-	/* unfortunately updating doesn't work yet. */
-	be_invalidate_live_chk(irg);
+	if (!sets_valid)
+		be_invalidate_live_chk(irg);
 }
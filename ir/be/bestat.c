@@ -142,6 +142,13 @@ void be_subtract_node_stats(be_node_stats_t *stats, be_node_stats_t *sub)
 	}
 }
 
+void be_add_node_stats(be_node_stats_t *stats, be_node_stats_t *add)
+{
+	for (be_stat_tag_t i = BE_STAT_FIRST; i < BE_STAT_COUNT; ++i) {
+		(*stats)[i] += (*add)[i];
+	}
+}
+
 void be_copy_node_stats(be_node_stats_t *dest, be_node_stats_t *src)
 {
 	MEMCPY(dest, src, 1);
@@ -32,6 +32,8 @@ void be_collect_node_stats(be_node_stats_t *stats, ir_graph *irg);
 
 void be_subtract_node_stats(be_node_stats_t *stats, be_node_stats_t *sub);
 
+void be_add_node_stats(be_node_stats_t *stats, be_node_stats_t *add);
+
 void be_copy_node_stats(be_node_stats_t *dest, be_node_stats_t *src);
 
 void be_emit_node_stats(be_node_stats_t *stats, const char *prefix);
@@ -28,6 +28,7 @@
 #include "belive.h"
 #include "benode.h"
 #include "besched.h"
+#include "bespillutil.h"
 #include "beuses.h"
 
 #define UNKNOWN_OUTERMOST_LOOP  ((unsigned)-1)
@@ -214,7 +215,8 @@ static be_next_use_t get_next_use(be_uses_t *env, ir_node *from,
 		be_next_use_t result;
 		result.time           = step;
 		result.outermost_loop = get_loop_depth(get_irn_loop(block));
-		result.before         = block;
+		/* the reload for the phi goes to the end of the block */
+		result.before         = be_get_end_of_block_insertion_point(block);
 		return result;
 	}
 
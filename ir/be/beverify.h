@@ -47,8 +47,12 @@ bool be_verify_schedule(ir_graph *irg);
 bool be_verify_register_allocation(ir_graph *irg);
 
 /**
- * Check the given liveness information against a freshly computed one.
+ * Check the given liveness sets against freshly computed ones. Differences are
+ * reported on stderr.
+ *
+ * @param lv    The liveness information to check, its sets must be valid
+ * @return      true if the sets are equal to freshly computed ones
  */
-void be_liveness_check(be_lv_t *lv);
+bool be_liveness_check(be_lv_t *lv);
 
 #endif
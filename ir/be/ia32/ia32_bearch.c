@@ -10,6 +10,8 @@
  */
 #include "ia32_bearch_t.h"
 
+#include <limits.h>
+
 #include "be_t.h"
 #include "beflags.h"
 #include "begnuas.h"
@@ -1119,7 +1121,8 @@ static void ia32_before_emit(ir_graph *irg)
 	be_dump(DUMP_RA, irg, "x87");
 
 	/* do peephole optimizations */
-	ia32_peephole_optimization(irg);
+	if (!be_is_fast_path(irg))
+		ia32_peephole_optimization(irg);
 
 	be_remove_dead_nodes_from_schedule(irg);
 }
@@ -1423,6 +1426,22 @@ static void ia32_finish(void)
 	obstack_free(&opcodes_obst, NULL);
 }
 
+/**
+ * Immediates and address computations are recomputed instead of reloaded,
+ * this is always cheaper than the load from the spill slot. Constants from
+ * the constant pool are loaded as fast as a spilled value, but they need no
+ * spill, so they are rated slightly below the reload cost.
+ */
+static unsigned ia32_get_remat_cost(ir_node const *const node)
+{
+	if (is_ia32_Const(node) || is_ia32_Lea(node) || is_ia32_Xor0(node))
+		return 1;
+	if ((is_ia32_Load(node) || is_ia32_xLoad(node) || is_ia32_fld(node))
+	    && !get_irn_pinned(node))
+		return 4;
+	return ia32_get_op_estimated_cost(node);
+}
+
 static void ia32_mark_remat(ir_node *node)
 {
 	if (is_ia32_irn(node))
@@ -1432,6 +1451,8 @@ static void ia32_mark_remat(ir_node *node)
 static const regalloc_if_t ia32_regalloc_if = {
 	.spill_cost             = 7,
 	.reload_cost            = 5,
+	.flags_cls              = &ia32_reg_classes[CLASS_ia32_flags],
+	.get_remat_cost         = ia32_get_remat_cost,
 	.mark_remat             = ia32_mark_remat,
 	.new_spill              = ia32_new_spill,
 	.new_reload             = ia32_new_reload,
@@ -1477,7 +1498,10 @@ static void ia32_generate_code(FILE *output, const char *cup_name)
 			continue;
 
 		be_timer_push(T_EMIT);
-		ia32_emit_function(irg);
+		if (be_options.emit_object)
+			ia32_emit_object_function(irg);
+		else
+			ia32_emit_function(irg);
 		be_timer_pop(T_EMIT);
 
 		be_step_last(irg);
@@ -1508,7 +1532,7 @@ static ir_jit_function_t *ia32_jit_compile(ir_jit_segment_t *const segment,
 
 static int ia32_is_valid_clobber(const char *clobber)
 {
-	return x86_parse_clobber(ia32_additional_clobber_names, clobber) != NULL;
+	return arch_find_register(clobber) != NULL;
 }
 
 static bool is_float(ir_type const *const type)
@@ -1642,8 +1666,10 @@ static void ia32_lower_for_target(void)
 	be_after_irp_transform("lower-builtins");
 
 	foreach_irp_irg(i, irg) {
-		/* break up switches with wide ranges */
-		lower_switch(irg, 4, 256, mode_gp);
+		/* break up switches with wide ranges, the object file writer has no
+		 * jump tables */
+		unsigned const small_switch = be_options.emit_object ? UINT_MAX : 4;
+		lower_switch(irg, small_switch, 256, mode_gp);
 		be_after_transform(irg, "lower-switch");
 	}
 
@@ -1694,9 +1720,11 @@ static arch_isa_if_t const ia32_isa_if = {
 	.generate_code         = ia32_generate_code,
 	.jit_compile           = ia32_jit_compile,
 	.emit_function         = ia32_emit_jit_function,
+	.jit_patch_entry       = ia32_jit_patch_entry,
 	.lower_for_target      = ia32_lower_for_target,
 	.is_valid_clobber      = ia32_is_valid_clobber,
 	.get_op_estimated_cost = ia32_get_op_estimated_cost,
+	.elf_target            = &ia32_elf_target,
 };
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_ia32)
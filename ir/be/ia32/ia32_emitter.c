@@ -119,52 +119,15 @@ static char *get_unique_label(char *buf, size_t buflen, const char *prefix)
 	return buf;
 }
 
-static const char *get_register_name_8bit_low(const arch_register_t *reg)
-{
-	switch (reg->global_index) {
-	case REG_EAX: return "al";
-	case REG_EBX: return "bl";
-	case REG_ECX: return "cl";
-	case REG_EDX: return "dl";
-	}
-	panic("unexpected register");
-}
-
-static const char *get_register_name_8bit_high(const arch_register_t *reg)
-{
-	switch (reg->global_index) {
-	case REG_EAX: return "ah";
-	case REG_EBX: return "bh";
-	case REG_ECX: return "ch";
-	case REG_EDX: return "dh";
-	}
-	panic("unexpected register");
-}
-
-static const char *get_register_name_16bit(const arch_register_t *reg)
-{
-	switch (reg->global_index) {
-	case REG_EAX: return "ax";
-	case REG_EBX: return "bx";
-	case REG_ECX: return "cx";
-	case REG_EDX: return "dx";
-	case REG_ESI: return "si";
-	case REG_EDI: return "di";
-	case REG_ESP: return "sp";
-	case REG_EBP: return "bp";
-	}
-	panic("unexpected register");
-}
-
 static const char *get_register_name_size(arch_register_t const *const reg,
                                           x86_insn_size_t const size,
                                           bool use_8bit_high)
 {
 	switch (size) {
 	case X86_SIZE_8:
-		return use_8bit_high ? get_register_name_8bit_high(reg)
-		                     : get_register_name_8bit_low(reg);
-	case X86_SIZE_16: return get_register_name_16bit(reg);
+		return use_8bit_high ? arch_get_subreg_name(reg, arch_subreg_8h)
+		                     : arch_get_subreg_name(reg, arch_subreg_8);
+	case X86_SIZE_16: return arch_get_subreg_name(reg, arch_subreg_16);
 	case X86_SIZE_32: return reg->name;
 	case X86_SIZE_64:
 	case X86_SIZE_80:
@@ -564,11 +527,11 @@ emit_R:
 					be_emit_char('*');
 				const char *name;
 				if (mod & EMIT_HIGH_REG) {
-					name = get_register_name_8bit_high(reg);
+					name = arch_get_subreg_name(reg, arch_subreg_8h);
 				} else if (mod & EMIT_LOW_REG) {
-					name = get_register_name_8bit_low(reg);
+					name = arch_get_subreg_name(reg, arch_subreg_8);
 				} else if (mod & EMIT_16BIT_REG) {
-					name = get_register_name_16bit(reg);
+					name = arch_get_subreg_name(reg, arch_subreg_16);
 				} else if (mod & EMIT_32BIT_REG) {
 					name = reg->name;
 				} else {
@@ -608,20 +571,20 @@ emit_S:
 			case 'u':
 				if (mod & EMIT_LONG) {
 					unsigned long num = va_arg(ap, unsigned long);
-					be_emit_irprintf("%lu", num);
+					be_emit_uint(num);
 				} else {
 					unsigned num = va_arg(ap, unsigned);
-					be_emit_irprintf("%u", num);
+					be_emit_uint(num);
 				}
 				break;
 
 			case 'd':
 				if (mod & EMIT_LONG) {
 					long num = va_arg(ap, long);
-					be_emit_irprintf("%ld", num);
+					be_emit_int(num);
 				} else {
 					int num = va_arg(ap, int);
-					be_emit_irprintf("%d", num);
+					be_emit_int(num);
 				}
 				break;
 
@@ -710,7 +673,7 @@ x86_condition_code_t ia32_determine_final_cc(ir_node const *const node,
 static void ia32_emit_exc_label(const ir_node *node)
 {
 	be_emit_string(be_gas_insn_label_prefix());
-	be_emit_irprintf("%lu", get_ia32_exc_label_id(node));
+	be_emit_uint(get_ia32_exc_label_id(node));
 }
 
 static bool fallthrough_possible(const ir_node *block, const ir_node *target)
@@ -872,9 +835,9 @@ static void emit_ia32_asm_register(const arch_register_t *reg, char modifier,
 		}
 		break;
 	}
-	case 'b': name = get_register_name_8bit_low(reg); break;
-	case 'h': name = get_register_name_8bit_high(reg); break;
-	case 'w': name = get_register_name_16bit(reg); break;
+	case 'b': name = arch_get_subreg_name(reg, arch_subreg_8); break;
+	case 'h': name = arch_get_subreg_name(reg, arch_subreg_8h); break;
+	case 'w': name = arch_get_subreg_name(reg, arch_subreg_16); break;
 	case 'k': name = reg->name; break;
 	default:
 		panic("invalid asm op modifier");
@@ -1224,7 +1187,7 @@ static void emit_ia32_GetEIP(const ir_node *node)
 		ir_entity *thunk = thunks[reg->index];
 		if (thunk == NULL) {
 			ir_type    *const glob = get_glob_type();
-			char const *const name = get_register_name_16bit(reg);
+			char const *const name = arch_get_subreg_name(reg, arch_subreg_16);
 			ident      *const id   = new_id_fmt("__x86.get_pc_thunk.%s", name);
 			ir_type    *const tp   = get_thunk_type();
 			thunk = new_global_entity(glob, id, tp, ir_visibility_external_private,
@@ -1571,12 +1534,14 @@ static const lc_opt_table_entry_t ia32_emitter_options[] = {
 };
 
 static unsigned emit_jit_entity_relocation_asm(char *const buffer,
+                                               char const *const address,
                                                uint8_t const be_kind,
                                                ir_entity *const entity,
                                                int32_t const offset)
 {
 	(void)buffer;
-	assert(buffer == NULL);
+	(void)address;
+	assert(buffer == NULL && address == NULL);
 	if (be_kind == IA32_RELOCATION_RELJUMP) {
 		be_emit_irprintf("\t.long %"PRId32"\n", offset);
 		be_emit_write_line();
@@ -1593,7 +1558,7 @@ static unsigned emit_jit_entity_relocation_asm(char *const buffer,
 	}
 	x86_emit_relocation_no_offset(be_kind, entity);
 	if (offset != 0)
-		be_emit_irprintf("%+"PRId32, offset);
+		be_emit_int_signed(offset);
 	be_emit_char('\n');
 	be_emit_write_line();
 	return res;
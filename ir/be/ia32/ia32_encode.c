@@ -11,10 +11,14 @@
 #include "ia32_encode.h"
 
 #include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #include "bearch.h"
 #include "beblocksched.h"
 #include "beemithlp.h"
 #include "begnuas.h"
+#include "beelf.h"
 #include "bejit.h"
 #include "besched.h"
 #include "execfreq.h"
@@ -293,6 +297,13 @@ static void enc_copy(const ir_node *copy)
 	enc_mov(in, out);
 }
 
+static void enc_copyebpesp(const ir_node *node)
+{
+	arch_register_t const *const in  = arch_get_irn_register_in(node, 0);
+	arch_register_t const *const out = arch_get_irn_register_out(node, 0);
+	enc_mov(in, out);
+}
+
 static void enc_perm(const ir_node *node)
 {
 	arch_register_t       const *const reg0 = arch_get_irn_register_out(node, 0);
@@ -622,7 +633,7 @@ static void enc_test(ir_node const *const node)
 		if (use_eax_short_form(node)) {
 			be_emit8(0xA8 | op);
 		} else {
-			ia32_enc_unop(node, 0xF6, 0, n_ia32_Test_left);
+			ia32_enc_unop(node, 0xF6 | op, 0, n_ia32_Test_left);
 		}
 
 		enc_imm(get_ia32_immediate_attr_const(right), size);
@@ -637,7 +648,7 @@ static void enc_imulimm(const ir_node *node)
 	ia32_immediate_attr_t const *const attr  = get_ia32_immediate_attr_const(right);
 	bool                         const imm8  = ia32_is_8bit_imm(attr);
 	enc_unop_reg(node, 0x69 | (imm8 ? OP_IMM8 : 0), n_ia32_IMul_left);
-	enc_imm(attr, imm8 ? 8 : 32);
+	enc_imm(attr, imm8 ? X86_SIZE_8 : X86_SIZE_32);
 }
 
 static void enc_dec(const ir_node *node)
@@ -855,7 +866,7 @@ static void enc_push(const ir_node *node)
 		ia32_immediate_attr_t const *const attr = get_ia32_immediate_attr_const(value);
 		bool                         const imm8 = ia32_is_8bit_imm(attr);
 		be_emit8(0x68 | (imm8 ? OP_IMM8 : 0));
-		enc_imm(attr, imm8 ? 8 : 32);
+		enc_imm(attr, imm8 ? X86_SIZE_8 : X86_SIZE_32);
 	} else {
 		arch_register_t const *const reg = arch_get_irn_register(value);
 		be_emit8(0x50 + reg->encoding);
@@ -1009,6 +1020,9 @@ static void enc_ia32_jcc(const ir_node *node)
 
 static void enc_switchjmp(const ir_node *node)
 {
+	if (!ia32_cg_config.emit_machcode)
+		panic("jump tables not supported in binary output (%+F)", node);
+
 	be_emit8(0xFF); // jmp *tbl.label(,%in,4)
 	enc_mod_am(0x05, node);
 
@@ -1300,6 +1314,7 @@ static void ia32_register_binary_emitters(void)
 	be_set_emitter(op_ia32_Const,         enc_mov_const);
 	be_set_emitter(op_ia32_Conv_I2I,      enc_conv_i2i);
 	be_set_emitter(op_ia32_CopyB_i,       enc_copybi);
+	be_set_emitter(op_ia32_CopyEbpEsp,    enc_copyebpesp);
 	be_set_emitter(op_ia32_Dec,           enc_dec);
 	be_set_emitter(op_ia32_FldCW,         enc_fldcw);
 	be_set_emitter(op_ia32_FnstCW,        enc_fnstcw);
@@ -1357,7 +1372,16 @@ static void gen_binary_block(ir_node *const block)
 	unsigned fragment_num = be_begin_fragment(p2align, max_skip);
 	assert(fragment_num
 	       == (unsigned)PTR_TO_INT(ir_nodehashmap_get(void, &block_fragmentnum, block)));
-	(void)fragment_num;
+
+	/* Functions of the fast jit tier start with a nopl 0(%eax,%eax), which
+	 * ia32_jit_patch_entry() replaces by a jump to an optimized version. */
+	if (fragment_num == 0 && be_is_fast_path(irg)) {
+		be_emit8(0x0F);
+		be_emit8(0x1F);
+		be_emit8(0x44);
+		be_emit8(0x00);
+		be_emit8(0x00);
+	}
 
 	/* emit the contents of the block */
 	sched_foreach(block, node) {
@@ -1435,6 +1459,7 @@ static void enc_nop_callback(char *buffer, unsigned size)
 }
 
 static unsigned enc_relocation_callback(char *const buffer,
+                                        char const *const address,
                                         uint8_t const be_kind,
                                         ir_entity *const entity,
                                         int32_t const offset)
@@ -1449,7 +1474,7 @@ static unsigned enc_relocation_callback(char *const buffer,
 			panic("Could not resolve address of entity %+F", entity);
 		intptr_t addr = entity_addr + offset;
 		if (be_kind == X86_IMM_PCREL)
-			addr -= (intptr_t)buffer;
+			addr -= (intptr_t)address;
 		value = (uint32_t)addr;
 		if ((intptr_t)value != addr)
 			panic("Overflow in relocation");
@@ -1459,11 +1484,101 @@ static unsigned enc_relocation_callback(char *const buffer,
 	return 4;
 }
 
-void ia32_emit_jit_function(char *buffer, ir_jit_function_t *const function)
+void ia32_emit_jit_function(char *const buffer, char const *const address,
+                            ir_jit_function_t *const function)
 {
 	static const be_jit_emit_interface_t jit_emit_interface = {
 		.nops       = enc_nop_callback,
 		.relocation = enc_relocation_callback,
 	};
-	be_jit_emit_memory(buffer, function, &jit_emit_interface);
+	be_jit_emit_memory(buffer, address, function, &jit_emit_interface);
+}
+
+void ia32_jit_patch_entry(char *const entry, char const *const address,
+                          void const *const target)
+{
+	/* The 5 byte nop at the entry lies in one aligned 8 byte word, so storing
+	 * the word atomically lets concurrently running threads either execute
+	 * the nop or the complete jump. This relies on the host doing a lock-free
+	 * 64bit store: a lock based implementation is not seen by threads that
+	 * just execute the code, so they could fetch a half written jump. */
+	if ((uintptr_t)entry % 8 != 0 || (uintptr_t)address % 8 != 0)
+		panic("jit function entry is not 8 byte aligned");
+	intptr_t const rel = (intptr_t)target - (intptr_t)(address + 5);
+	int32_t  const rel32 = (int32_t)rel;
+	if ((intptr_t)rel32 != rel)
+		panic("jit patch target out of range");
+
+	uint8_t bytes[8];
+	memcpy(bytes, entry, sizeof(bytes));
+	bytes[0] = 0xE9; /* jmp rel32 */
+	memcpy(&bytes[1], &rel32, sizeof(rel32));
+	uint64_t word;
+	memcpy(&word, bytes, sizeof(word));
+#if defined(__GNUC__)
+	__atomic_store_n((uint64_t*)entry, word, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+	_InterlockedExchange64((__int64 volatile*)entry, (__int64)word);
+#else
+#	error atomic 64bit store is missing
+#endif
+}
+
+static void enc_elf_reloc(uint8_t const be_kind, be_elf_reloc_t *const reloc)
+{
+	reloc->size        = 4;
+	reloc->pc_relative = false;
+	reloc->adjustable  = true;
+	switch (be_kind) {
+	case IA32_RELOCATION_RELJUMP:
+		reloc->type        = 0;
+		reloc->pc_relative = true;
+		return;
+	case X86_IMM_ADDR:
+		reloc->type = 1;  /* R_386_32 */
+		return;
+	case X86_IMM_PCREL:
+		reloc->type        = 2;  /* R_386_PC32 */
+		reloc->pc_relative = true;
+		return;
+	case X86_IMM_GOT:
+		reloc->type       = 3;  /* R_386_GOT32 */
+		reloc->adjustable = false;
+		return;
+	case X86_IMM_PLT:
+		reloc->type        = 4;  /* R_386_PLT32 */
+		reloc->pc_relative = true;
+		reloc->adjustable  = false;
+		return;
+	case X86_IMM_GOTOFF:
+		reloc->type = 9;  /* R_386_GOTOFF */
+		return;
+	case X86_IMM_TLS_IE:
+		reloc->type       = 15; /* R_386_TLS_IE */
+		reloc->adjustable = false;
+		return;
+	case X86_IMM_TLS_LE:
+		reloc->type       = 17; /* R_386_TLS_LE */
+		reloc->adjustable = false;
+		return;
+	}
+	panic("relocation kind %u not supported in object files", be_kind);
+}
+
+be_elf_target_t const ia32_elf_target = {
+	.machine    = 3, /* EM_386 */
+	.is_64bit   = false,
+	.use_rela   = false,
+	.data_reloc = 1, /* R_386_32 */
+	.nops       = enc_nop_callback,
+	.get_reloc  = enc_elf_reloc,
+};
+
+void ia32_emit_object_function(ir_graph *const irg)
+{
+	ir_jit_segment_t  *const segment  = be_new_jit_segment();
+	ir_jit_function_t *const function = ia32_emit_jit(segment, irg);
+	be_elf_emit_function(get_irg_entity(irg),
+	                     ia32_cg_config.function_alignment, function);
+	be_destroy_jit_segment(segment);
 }
@@ -12,6 +12,7 @@
 #define FIRM_BE_IA32_IA32_ENCODE_H
 
 #include <stdint.h>
+#include "be_types.h"
 #include "firm_types.h"
 #include "jit.h"
 
@@ -21,7 +22,20 @@ enum {
 
 ir_jit_function_t *ia32_emit_jit(ir_jit_segment_t *segment, ir_graph *irg);
 
-void ia32_emit_jit_function(char *buffer, ir_jit_function_t *function);
+void ia32_emit_jit_function(char *buffer, char const *address,
+                            ir_jit_function_t *function);
+
+/**
+ * Atomically replaces the patchable entry of a fast tier function by a jump
+ * to @p target. The entry is written at @p entry and executed at @p address.
+ */
+void ia32_jit_patch_entry(char *entry, char const *address,
+                          void const *target);
+
+/** Encodes @p irg and appends it to the ELF object file. */
+void ia32_emit_object_function(ir_graph *irg);
+
+extern be_elf_target_t const ia32_elf_target;
 
 void ia32_enc_simple(uint8_t opcode);
 
@@ -39,15 +39,6 @@
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
-static bool is_hl_register(arch_register_t const *const reg)
-{
-	return
-		reg == &ia32_registers[REG_EAX] ||
-		reg == &ia32_registers[REG_EBX] ||
-		reg == &ia32_registers[REG_ECX] ||
-		reg == &ia32_registers[REG_EDX];
-}
-
 static void copy_mark(const ir_node *old, ir_node *newn)
 {
 	if (is_ia32_is_reload(old))
@@ -216,18 +207,18 @@ static void peephole_ia32_And(ir_node *const node)
 
 	arch_register_t const *const reg = arch_get_irn_register_out(node, pn_ia32_And_res);
 	uint32_t               const val = imm->imm.offset;
+	bool                   const low  = arch_register_has_subreg(reg, arch_subreg_8);
+	bool                   const high = arch_register_has_subreg(reg, arch_subreg_8h);
 	if (val == 0xFFFF0000) {
 		make_xor(node, &new_bd_ia32_Xor, X86_SIZE_16, reg);
-	} else if (is_hl_register(reg)) {
-		if (val == 0xFFFFFF00) {
-			make_xor(node, &new_bd_ia32_Xor_8bit, X86_SIZE_8, reg);
-		} else if (val == 0xFFFF00FF) {
-			make_xor_8h(node, &new_bd_ia32_Xor_8bit, X86_SIZE_8, reg);
-		} else if ((val & 0xFFFFFF80) == 0xFFFFFF00) {
-			make_binop_imm(node, &new_bd_ia32_And_8bit, val & 0xFF, X86_SIZE_8, reg);
-		} else if ((val & 0xFFFF00FF) == 0xFFFF00FF) {
-			make_binop_imm_8h(node, &new_bd_ia32_And_8bit, val >> 8 & 0xFF, X86_SIZE_8, reg);
-		}
+	} else if (low && val == 0xFFFFFF00) {
+		make_xor(node, &new_bd_ia32_Xor_8bit, X86_SIZE_8, reg);
+	} else if (high && val == 0xFFFF00FF) {
+		make_xor_8h(node, &new_bd_ia32_Xor_8bit, X86_SIZE_8, reg);
+	} else if (low && (val & 0xFFFFFF80) == 0xFFFFFF00) {
+		make_binop_imm(node, &new_bd_ia32_And_8bit, val & 0xFF, X86_SIZE_8, reg);
+	} else if (high && (val & 0xFFFF00FF) == 0xFFFF00FF) {
+		make_binop_imm_8h(node, &new_bd_ia32_And_8bit, val >> 8 & 0xFF, X86_SIZE_8, reg);
 	}
 }
 
@@ -249,13 +240,13 @@ static void peephole_ia32_Or(ir_node *const node)
 		return;
 
 	arch_register_t const *const reg = arch_get_irn_register_out(node, pn_ia32_Or_res);
-	if (is_hl_register(reg)) {
-		uint32_t const val = imm->imm.offset;
-		if ((val & 0xFFFFFF80) == 0x00000080) {
+	uint32_t               const val = imm->imm.offset;
+	if ((val & 0xFFFFFF80) == 0x00000080) {
+		if (arch_register_has_subreg(reg, arch_subreg_8))
 			make_binop_imm(node, &new_bd_ia32_Or_8bit, val, X86_SIZE_8, reg);
-		} else if ((val & 0xFFFF00FF) == 0) {
+	} else if ((val & 0xFFFF00FF) == 0) {
+		if (arch_register_has_subreg(reg, arch_subreg_8h))
 			make_binop_imm_8h(node, &new_bd_ia32_Or_8bit, val >> 8, X86_SIZE_8, reg);
-		}
 	}
 }
 
@@ -301,18 +292,18 @@ static void peephole_ia32_Xor(ir_node *const node)
 
 	arch_register_t const *const reg = arch_get_irn_register_out(node, pn_ia32_Xor_res);
 	uint32_t               const val = imm->imm.offset;
+	bool                   const low  = arch_register_has_subreg(reg, arch_subreg_8);
+	bool                   const high = arch_register_has_subreg(reg, arch_subreg_8h);
 	if (val == 0x0000FFFF) {
 		make_not(node, &new_bd_ia32_Not, X86_SIZE_16, reg);
-	} else if (is_hl_register(reg)) {
-		if (val == 0x000000FF) {
-			make_not(node, &new_bd_ia32_Not_8bit, X86_SIZE_8, reg);
-		} else if (val == 0x0000FF00) {
-			make_not_8h(node, &new_bd_ia32_Not_8bit, X86_SIZE_8, reg);
-		} else if ((val & 0xFFFFFF80) == 0x00000080) {
-			make_binop_imm(node, &new_bd_ia32_Xor_8bit, val, X86_SIZE_8, reg);
-		} else if ((val & 0xFFFF00FF) == 0) {
-			make_binop_imm_8h(node, &new_bd_ia32_Xor_8bit, val >> 8, X86_SIZE_8, reg);
-		}
+	} else if (low && val == 0x000000FF) {
+		make_not(node, &new_bd_ia32_Not_8bit, X86_SIZE_8, reg);
+	} else if (high && val == 0x0000FF00) {
+		make_not_8h(node, &new_bd_ia32_Not_8bit, X86_SIZE_8, reg);
+	} else if (low && (val & 0xFFFFFF80) == 0x00000080) {
+		make_binop_imm(node, &new_bd_ia32_Xor_8bit, val, X86_SIZE_8, reg);
+	} else if (high && (val & 0xFFFF00FF) == 0) {
+		make_binop_imm_8h(node, &new_bd_ia32_Xor_8bit, val >> 8, X86_SIZE_8, reg);
 	}
 }
 
@@ -482,8 +473,10 @@ adjust_test:;
 				set_test_imm(node, offset >> (8 * delta));
 				goto set_mode_low;
 			}
-		} else if (is_hl_register(arch_get_irn_register(left))) {
-			if ((offset & 0xFFFFFF80) == 0) {
+		} else {
+			arch_register_t const *const reg = arch_get_irn_register(left);
+			if ((offset & 0xFFFFFF80) == 0
+			 && arch_register_has_subreg(reg, arch_subreg_8)) {
 				/* testl $0x000000XX, %eRx -> testb 0xXX, %Rl */
 set_mode_low:;
 				/* Technically we should build a Test8Bit because of the
@@ -491,7 +484,8 @@ set_mode_low:;
 				 * point anymore. */
 				ia32_attr_t *const attr = get_ia32_attr(node);
 				attr->size = X86_SIZE_8;
-			} else if ((offset & 0xFFFF80FF) == 0) {
+			} else if ((offset & 0xFFFF80FF) == 0
+			        && arch_register_has_subreg(reg, arch_subreg_8h)) {
 				/* testl $0x0000XX00, %eRx -> testb 0xXX, %Rh */
 				set_test_imm(node, offset >> 8);
 				ia32_attr_t *const attr = get_ia32_attr(node);
@@ -1064,7 +1058,8 @@ static void peephole_ia32_Rol(ir_node *node)
 	if (attr->size == X86_SIZE_16) {
 		arch_register_t const *const reg
 			= arch_get_irn_register_out(node, pn_ia32_Rol_res);
-		if (is_hl_register(reg)) {
+		if (arch_register_has_subreg(reg, arch_subreg_8)
+		 && arch_register_has_subreg(reg, arch_subreg_8h)) {
 			dbg_info *const dbgi  = get_irn_dbg_info(node);
 			ir_node  *const block = get_nodes_block(node);
 			ir_node  *const val   = get_irn_n(node, n_ia32_Rol_val);
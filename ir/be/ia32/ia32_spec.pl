@@ -21,14 +21,14 @@ $mode_fpcw  = "ia32_mode_fpcw";
 
 %reg_classes = (
 	gp => [
-		{ name => "edx", encoding => 2, dwarf => 2 },
-		{ name => "ecx", encoding => 1, dwarf => 1 },
-		{ name => "eax", encoding => 0, dwarf => 0 },
-		{ name => "ebx", encoding => 3, dwarf => 3 },
-		{ name => "esi", encoding => 6, dwarf => 6 },
-		{ name => "edi", encoding => 7, dwarf => 7 },
-		{ name => "ebp", encoding => 5, dwarf => 5 },
-		{ name => "esp", encoding => 4, dwarf => 4 },
+		{ name => "edx", encoding => 2, dwarf => 2, subregs => { 8 => "dl", "8h" => "dh", 16 => "dx", 32 => "edx" } },
+		{ name => "ecx", encoding => 1, dwarf => 1, subregs => { 8 => "cl", "8h" => "ch", 16 => "cx", 32 => "ecx" } },
+		{ name => "eax", encoding => 0, dwarf => 0, subregs => { 8 => "al", "8h" => "ah", 16 => "ax", 32 => "eax" } },
+		{ name => "ebx", encoding => 3, dwarf => 3, subregs => { 8 => "bl", "8h" => "bh", 16 => "bx", 32 => "ebx" } },
+		{ name => "esi", encoding => 6, dwarf => 6, subregs => { 16 => "si", 32 => "esi" } },
+		{ name => "edi", encoding => 7, dwarf => 7, subregs => { 16 => "di", 32 => "edi" } },
+		{ name => "ebp", encoding => 5, dwarf => 5, subregs => { 16 => "bp", 32 => "ebp" } },
+		{ name => "esp", encoding => 4, dwarf => 4, subregs => { 16 => "sp", 32 => "esp" } },
 		{ name => "gp_NOREG", type => "virtual" }, # we need a dummy register for NoReg nodes
 		{ mode => $mode_gp }
 	],
@@ -126,8 +126,8 @@ my $binop_commutative = {
 			out_reqs => [ "in_r3 in_r4", "flags", "mem" ],
 		},
 		"8bit" => {
-			in_reqs  => [ "gp", "gp", "mem", "eax ebx ecx edx", "eax ebx ecx edx" ],
-			out_reqs => [ "eax ebx ecx edx in_r3 in_r4", "flags", "mem" ],
+			in_reqs  => [ "gp", "gp", "mem", "gp/8", "gp/8" ],
+			out_reqs => [ "gp/8 in_r3 in_r4", "flags", "mem" ],
 		},
 	},
 	ins       => [ "base", "index", "mem", "left", "right" ],
@@ -142,7 +142,7 @@ my $binop_flags = {
 	state     => "exc_pinned",
 	constructors => {
 		""     => { in_reqs => [ "gp", "gp", "mem", "gp", "gp" ], },
-		"8bit" => { in_reqs => [ "gp", "gp", "mem", "eax ebx ecx edx", "eax ebx ecx edx" ], }
+		"8bit" => { in_reqs => [ "gp", "gp", "mem", "gp/8", "gp/8" ], }
 	},
 	out_reqs  => [ "flags", "none", "mem" ],
 	ins       => [ "base", "index", "mem", "left", "right" ],
@@ -158,7 +158,7 @@ my $binop_mem = {
 	state     => "exc_pinned",
 	constructors => {
 		""     => { in_reqs => [ "gp", "gp", "mem", "gp" ] },
-		"8bit" => { in_reqs => [ "gp", "gp", "mem", "eax ebx ecx edx" ] },
+		"8bit" => { in_reqs => [ "gp", "gp", "mem", "gp/8" ] },
 	},
 	out_reqs  => [ "none", "flags", "mem" ],
 	ins       => [ "base", "index", "mem", "val" ],
@@ -170,7 +170,7 @@ my $shiftop = {
 	irn_flags => [ "modify_flags", "rematerializable" ],
 	constructors => {
 		""     => { in_reqs => [ "gp",              "ecx" ] },
-		"8bit" => { in_reqs => [ "eax ebx ecx edx", "ecx" ] },
+		"8bit" => { in_reqs => [ "gp/8", "ecx" ] },
 	},
 	out_reqs  => [ "in_r0 !in_r1", "flags" ],
 	ins       => [ "val", "count" ],
@@ -564,8 +564,8 @@ Sub => {
 			out_reqs => [ "in_r3", "flags", "mem" ],
 		},
 		"8bit" => {
-			in_reqs  => [ "gp", "gp", "mem", "eax ebx ecx edx", "eax ebx ecx edx" ],
-			out_reqs => [ "eax ebx ecx edx in_r3", "flags", "mem" ],
+			in_reqs  => [ "gp", "gp", "mem", "gp/8", "gp/8" ],
+			out_reqs => [ "gp/8 in_r3", "flags", "mem" ],
 		},
 	},
 	ins       => [ "base", "index", "mem", "minuend", "subtrahend" ],
@@ -781,7 +781,7 @@ Not => {
 	template => $unop_no_flags,
 	constructors => {
 		""     => { in_reqs => [ "gp" ] },
-		"8bit" => { in_reqs => [ "eax ebx ecx edx" ] },
+		"8bit" => { in_reqs => [ "gp/8" ] },
 	},
 	emit     => "not%M %D0",
 	encode   => "ia32_enc_unop(node, 0xF7, 2, n_ia32_Not_val)",
@@ -833,8 +833,8 @@ Cmp => {
 XorHighLow => {
 	irn_flags => [ "modify_flags", "rematerializable" ],
 	state     => "exc_pinned",
-	in_reqs   => [ "eax ebx ecx edx" ],
-	out_reqs  => [ "eax ebx ecx edx in_r0", "flags" ],
+	in_reqs   => [ "gp/8h" ],
+	out_reqs  => [ "gp/8h in_r0", "flags" ],
 	fixed     => "x86_insn_size_t const size = X86_SIZE_8;",
 	emit      => "xorb %>D0, %<D0",
 	ins       => [ "value" ],
@@ -851,7 +851,7 @@ Test => {
 Setcc => {
 	#irn_flags => [ "rematerializable" ],
 	in_reqs   => [ "eflags" ],
-	out_reqs  => [ "eax ebx ecx edx" ],
+	out_reqs  => [ "gp/8" ],
 	ins       => [ "eflags" ],
 	outs      => [ "res" ],
 	attr_type => "ia32_condcode_attr_t",
@@ -1063,7 +1063,7 @@ Store => {
 	state    => "exc_pinned",
 	constructors => {
 		""     => { in_reqs => [ "gp", "gp", "mem", "gp" ] },
-		"8bit" => { in_reqs => [ "gp", "gp", "mem", "eax ebx ecx edx" ] }
+		"8bit" => { in_reqs => [ "gp", "gp", "mem", "gp/8" ] }
 	},
 	out_reqs => [ "mem", "exec", "exec" ],
 	ins      => [ "base", "index", "mem", "val" ],
@@ -1268,8 +1268,8 @@ Bswap => {
 
 Bswap16 => {
 	irn_flags => [ "rematerializable" ],
-	in_reqs   => [ "eax ebx ecx edx" ],
-	out_reqs  => [ "eax ebx ecx edx in_r0" ],
+	in_reqs   => [ "gp/8h" ],
+	out_reqs  => [ "gp/8h in_r0" ],
 	fixed     => "x86_insn_size_t const size = X86_SIZE_8;",
 	emit      => "xchg %<D0, %>D0",
 	ins       => [ "val" ],
@@ -1594,7 +1594,7 @@ Conv_I2I => {
 	state    => "exc_pinned",
 	constructors => {
 		""     => { in_reqs => [ "gp", "gp", "mem", "gp" ] },
-		"8bit" => { in_reqs => [ "gp", "gp", "mem", "eax ebx ecx edx" ] }
+		"8bit" => { in_reqs => [ "gp", "gp", "mem", "gp/8" ] }
 	},
 	out_reqs => [ "gp", "none", "mem", "exec", "exec" ],
 	ins      => [ "base", "index", "mem", "val" ],
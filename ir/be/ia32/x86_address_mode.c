@@ -186,6 +186,22 @@ static bool eat_shl(x86_address_t *addr, ir_node *node)
 			be_warningf(node, "found unoptimized Shl x,0");
 
 		shifted_val = get_Shl_left(node);
+	} else if (is_Mul(node)) {
+		/* Mul with 1, 2, 4 or 8 (Shl is canonicalized to Mul) */
+		ir_node *right = get_Mul_right(node);
+		if (!is_Const(right))
+			return false;
+		ir_tarval *tv = get_Const_tarval(right);
+		if (!tarval_is_long(tv))
+			return false;
+
+		long const factor = get_tarval_long(tv);
+		if (factor == 1 || factor == 2 || factor == 4 || factor == 8)
+			val = factor == 1 ? 0 : factor == 2 ? 1 : factor == 4 ? 2 : 3;
+		else
+			return false;
+
+		shifted_val = get_Mul_left(node);
 	} else if (is_Add(node)) {
 		/* might be an add x, x */
 		ir_node *left  = get_Add_left(node);
@@ -261,7 +277,7 @@ void x86_create_address_mode(x86_address_t *addr, ir_node *node,
 	}
 
 	/* starting point Add, Sub or Shl, FrameAddr */
-	if (is_Shl(node)) {
+	if (is_Shl(node) || is_Mul(node)) {
 		/* We don't want to eat add x, x as shl here, so only test for real Shl
 		 * instructions, because we want the former as Lea x, x, not Shl x, 1 */
 		if (eat_shl(addr, node)) {
@@ -37,11 +37,6 @@ typedef struct x86_asm_operand_t {
 	} u;
 } x86_asm_operand_t;
 
-typedef struct x86_clobber_name_t {
-	const char *name;
-	unsigned    index;
-} x86_clobber_name_t;
-
 typedef enum x86_asm_constraint_kind_t {
 	MATCH_INVALID,
 	MATCH_REG,
@@ -61,9 +56,7 @@ typedef x86_asm_constraint_t x86_asm_constraint_list_t[128];
 typedef void (*emit_register_func)(const arch_register_t *reg, char modifier,
                                    ir_mode *mode);
 
-arch_register_t const *x86_parse_clobber(x86_clobber_name_t const *additional_clobber_names, char const *name);
-
-ir_node *x86_match_ASM(ir_node const *node, x86_clobber_name_t const *names, x86_asm_constraint_list_t const *constraints);
+ir_node *x86_match_ASM(ir_node const *node, x86_asm_constraint_list_t const *constraints);
 
 void x86_set_be_asm_constraint_support(const x86_asm_constraint_list_t *constraints);
 
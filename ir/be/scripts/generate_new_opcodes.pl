@@ -22,6 +22,7 @@ our %init_attr;
 our $custom_init_attr_func;
 our %reg_classes;
 our %custom_irn_flags;
+our @cost_models;
 
 # include spec file
 unless (my $return = do $specfile) {
@@ -51,6 +52,7 @@ my $obst_free_irop   = ""; # buffer for free_ir_op calls
 my $obst_enum_op     = ""; # buffer for creating the <arch>_opcode enum
 my $obst_header      = ""; # buffer for function prototypes
 my $obst_proj        = ""; # buffer for the pn_ numbers
+my $obst_cost        = ""; # buffer for the cost table
 my $orig_op;
 my $ARITY_VARIABLE = -1;
 my %requirements = ();
@@ -75,6 +77,59 @@ foreach my $class_name (sort(keys(%reg_classes))) {
 	$regclass2len{$class_name} = $idx;
 }
 
+# "<class>/<subreg>" in a requirement stands for all registers of the class,
+# which have the given sub-register, e.g. "gp/8" for byte addressable ones
+my %subreg_reqs = ();
+foreach my $class_name (sort(keys(%reg_classes))) {
+	my @class = @{$reg_classes{$class_name}};
+	pop(@class);
+
+	foreach my $reg (@class) {
+		my $subregs = $reg->{subregs} // {};
+		foreach my $size (keys(%$subregs)) {
+			push(@{$subreg_reqs{"$class_name/$size"}}, $reg->{name});
+		}
+	}
+}
+
+sub expand_subreg_requirements
+{
+	my ($reqs) = @_;
+	return if !defined($reqs) || ref($reqs) ne "ARRAY";
+
+	foreach my $req (@$reqs) {
+		my ($regs, $flags) = split(/:/, $req, 2);
+		my @expanded;
+		foreach my $alt (split(/ /, $regs)) {
+			if ($alt =~ /^(!?)(\w+\/\w+)$/) {
+				my $subreg_regs = $subreg_reqs{$2}
+					// die("Fatal error: no registers for requirement '$alt'");
+				push(@expanded, map { "$1$_" } @$subreg_regs);
+			} else {
+				push(@expanded, $alt);
+			}
+		}
+		$req = join(" ", @expanded);
+		$req .= ":$flags" if defined($flags);
+	}
+}
+
+sub expand_node_subreg_requirements
+{
+	my ($n) = @_;
+	expand_subreg_requirements($n->{in_reqs});
+	expand_subreg_requirements($n->{out_reqs});
+	foreach my $constr (values(%{ $n->{constructors} // {} })) {
+		expand_subreg_requirements($constr->{in_reqs});
+		expand_subreg_requirements($constr->{out_reqs});
+	}
+}
+
+foreach my $n (values(%nodes)) {
+	expand_node_subreg_requirements($n);
+	expand_node_subreg_requirements($n->{template}) if $n->{template};
+}
+
 
 $obst_header .= <<EOF;
 void ${arch}_create_opcodes(void);
@@ -351,6 +406,17 @@ foreach my $op (sort(keys(%nodes))) {
 		}
 	}
 
+	if (@cost_models) {
+		$obst_cost .= "\t[iro_${arch}_$op] = {";
+		foreach my $model (@cost_models) {
+			my $cost = get_op_cost($op, $model);
+			$obst_cost .= " { $cost->{latency}, $cost->{uops}, $cost->{throughput} },";
+		}
+		$obst_cost .= " },\n";
+	} elsif (exists($n{costs})) {
+		die "Fatal error: Op $op has costs but no cost models are declared\n";
+	}
+
 	my $ins  = $n{ins};
 	my $outs = $n{outs};
 
@@ -521,6 +587,39 @@ EOF
 $obst_enum_op .= "\tiro_${arch}_last\n";
 $obst_enum_op .= "} ${arch}_opcodes;\n\n";
 
+my $obst_cost_header = "";
+my $obst_cost_func   = "";
+if (@cost_models) {
+	my $n_models = scalar(@cost_models);
+	$obst_cost_header .= "\ntypedef enum ${arch}_cost_model_t {\n";
+	foreach my $model (@cost_models) {
+		$obst_cost_header .= "\t".get_cost_model_enum($model).",\n";
+	}
+	$obst_cost_header .= "} ${arch}_cost_model_t;\n\n";
+	$obst_cost_header .= "const be_op_cost_t *${arch}_get_opcode_cost(${arch}_cost_model_t model, unsigned opcode);\n";
+	$obst_cost_header .= "const be_op_cost_t *${arch}_get_op_cost(${arch}_cost_model_t model, const ir_node *node);\n\n";
+
+	$obst_cost_func .= <<EOF;
+/** Latency, micro-operations and reciprocal throughput for each cost model. */
+static const be_op_cost_t ${arch}_op_costs[iro_${arch}_last][$n_models] = {
+$obst_cost};
+
+/** Return the cost of the $arch opcode \@p opcode in cost model \@p model */
+const be_op_cost_t *${arch}_get_opcode_cost(${arch}_cost_model_t model, unsigned opcode)
+{
+	assert((unsigned)model < $n_models);
+	assert(opcode < iro_${arch}_last);
+	return &${arch}_op_costs[opcode][model];
+}
+
+/** Return the cost of the $arch machine node \@p node in cost model \@p model */
+const be_op_cost_t *${arch}_get_op_cost(${arch}_cost_model_t model, const ir_node *node)
+{
+	return ${arch}_get_opcode_cost(model, get_${arch}_irn_opcode(node));
+}
+EOF
+}
+
 # build the FOURCC arguments from $arch
 my @four = split("", $arch);
 my ($a, $b, $c, $d) = @four;
@@ -574,7 +673,7 @@ int get_${arch}_irn_opcode(const ir_node *node)
 $obst_limit_func
 $obst_reg_reqs
 $obst_constructor
-
+$obst_cost_func
 /**
  * Creates the $arch specific Firm machine operations
  * needed for the assembler irgs.
@@ -620,13 +719,68 @@ int is_${arch}_irn(const ir_node *node);
 int is_${arch}_op(const ir_op *op);
 
 int get_${arch}_irn_opcode(const ir_node *node);
-$obst_header
+$obst_cost_header$obst_header
 $obst_proj
 
 #endif
 EOF
 close($out_h);
 
+###
+# Returns the enum constant naming the cost model $model.
+###
+sub get_cost_model_enum
+{
+	my ($model) = @_;
+	my $name = uc("${arch}_cost_model_$model");
+	$name =~ s/[^A-Z0-9_]/_/g;
+	return $name;
+}
+
+###
+# Determines latency, micro-operation count and reciprocal throughput of $op
+# for the cost model $model. A "costs" hash may give "latency", "uops" and
+# "throughput" and override them for single models in a nested hash named
+# after the model. The costs of a node override those of its template,
+# unspecified values default to 1.
+# @return hash with the cost values
+###
+sub get_op_cost
+{
+	my ($op, $model) = @_;
+	my %cost = ( latency => 1, uops => 1, throughput => 1 );
+
+	my $n = $nodes{$op};
+	my @sources;
+	if (my $template = $n->{template}) {
+		push(@sources, $template->{costs}) if $template->{costs};
+	}
+	push(@sources, $n->{costs}) if $n->{costs};
+
+	foreach my $costs (@sources) {
+		foreach my $key (keys(%$costs)) {
+			my $value = $costs->{$key};
+			if (ref($value) eq "HASH") {
+				if (!grep { $_ eq $key } @cost_models) {
+					die "Fatal error: Op $op has costs for unknown model '$key'\n";
+				}
+			} elsif (!exists($cost{$key})) {
+				die "Fatal error: Op $op has unknown cost '$key'\n";
+			}
+		}
+		my $override = $costs->{$model};
+		foreach my $level ($costs, $override) {
+			next if !defined($level);
+			foreach my $key (keys(%cost)) {
+				$cost{$key} = $level->{$key} if defined($level->{$key});
+			}
+		}
+	}
+
+	$cost{throughput} = sprintf("%.2ff", $cost{throughput});
+	return \%cost;
+}
+
 ###
 # Translates numeric arity into string constant.
 ###
@@ -140,6 +140,13 @@ EOF
 		my $dwarf_number = $_->{dwarf} // 0;
 		my $encoding     = $_->{encoding} // $local_idx;
 		my $is_virtual   = has_flag("virtual", $_->{type});
+		my $subregs      = "";
+		if (defined(my $sub = $_->{subregs})) {
+			foreach my $size (sort(keys(%$sub))) {
+				$subregs .= "\n\t\t\t[arch_subreg_$size] = \"$sub->{$size}\",";
+			}
+			$subregs = "\n\t\t.subreg_names = {$subregs\n\t\t},";
+		}
 
 		$regdef  .= "\t$global_idx,\n";
 		$regdef2 .= "\t$local_idx,\n";
@@ -153,7 +160,7 @@ EOF
 		.global_index = $global_idx,
 		.dwarf_number = $dwarf_number,
 		.encoding     = $encoding,
-		.is_virtual   = $is_virtual,
+		.is_virtual   = $is_virtual,$subregs
 	},
 EOF
 
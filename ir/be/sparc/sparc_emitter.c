@@ -652,7 +652,10 @@ void sparc_emitf(ir_node const *const node, char const *fmt, ...)
 
 		case 'd': {
 			int const num = va_arg(ap, int);
-			be_emit_irprintf(plus ? "%+d" : "%d", num);
+			if (plus)
+				be_emit_int_signed(num);
+			else
+				be_emit_int(num);
 			break;
 		}
 
@@ -664,7 +667,7 @@ void sparc_emitf(ir_node const *const node, char const *fmt, ...)
 
 		case 'u': {
 			unsigned const num = va_arg(ap, unsigned);
-			be_emit_irprintf(plus ? "%+u" : "%u", num);
+			be_emit_uint(num);
 			break;
 		}
 
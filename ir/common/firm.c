@@ -61,6 +61,7 @@ void ir_init(void)
 	firm_init_funccalls();
 	firm_init_inline();
 	firm_init_scalar_replace();
+	firm_init_escape_ana();
 	/* Builds a construct allowing to access all information to be constructed
 	   later. */
 	init_irprog_2();
@@ -712,7 +712,7 @@ static struct magicu_info compute_unsigned_magic_info(ir_tarval *divisor,
 
 	/* divisor must be larger than zero and not a power of 2
 	 * D & (D-1) > 0 */
-	assert(get_tarval_long(AND(divisor, SUB(divisor, ONE(mode)))));
+	assert(!tarval_is_null(AND(divisor, SUB(divisor, ONE(mode)))));
 
 	/* Bits in ir_tarval */
 	const unsigned UINT_BITS = get_mode_size_bits(mode);
@@ -866,7 +866,7 @@ static ir_node *replace_div_by_mulh(ir_node *div, ir_tarval *tv)
 			ir_node *increment = new_rd_Builtin(dbg, block, no_mem, 1, in,
 			                                    ir_bk_saturating_increment, utype);
 
-			n = new_r_Proj(increment, mode_Iu, pn_Builtin_max + 1);
+			n = new_r_Proj(increment, mode, pn_Builtin_max + 1);
 		}
 
 		/* generate the Mulh instruction */
@@ -153,6 +153,8 @@ struct ir_graph {
 	unsigned           *callee_isbe; /**< Callgraph: bitset if backedge info is
 	                                      calculated. */
 	ir_loop            *l;           /**< For callgraph analysis. */
+	double              method_execfreq; /**< Callgraph: estimated number of
+	                                          invocations. */
 
 #ifdef DEBUG_libfirm
 	/** Unique graph number for each graph to make output readable. */
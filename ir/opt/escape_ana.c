@@ -0,0 +1,398 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Escape analysis and stack promotion of heap allocations.
+ *
+ * A heap allocation is a Call of a function returning fresh memory (see
+ * get_alloc_size_func). The address returned by such a call escapes if it
+ * may be used after the function returns: it is returned, stored into memory,
+ * converted to an integer or passed to a function which lets it escape.
+ * Addresses derived via Member, Sel, Add, Phi and Mux are followed.
+ * Arguments of calls are analyzed interprocedurally by looking at the uses of
+ * the corresponding parameter in all possible callees (using the callee
+ * information computed by cgana when available).
+ *
+ * Allocations of constant, bounded size that do not escape and are not
+ * inside a loop are replaced by frame entities. Calls freeing such an
+ * allocation are removed. A subsequent scalar_replacement_opt() can split
+ * the new frame entities into SSA values.
+ */
+#include <stdbool.h>
+
+#include "array.h"
+#include "be.h"
+#include "cgana.h"
+#include "debug.h"
+#include "entity_t.h"
+#include "ircons.h"
+#include "irgmod.h"
+#include "irgwalk.h"
+#include "irloop.h"
+#include "irnode_t.h"
+#include "irnodeset.h"
+#include "iroptimize.h"
+#include "irouts_t.h"
+#include "opt_init.h"
+#include "pmap.h"
+#include "tv.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Escape state of a method parameter. */
+typedef enum param_state_t {
+	PARAM_UNKNOWN = 0, /**< not analyzed yet */
+	PARAM_IN_PROGRESS, /**< currently analyzed (recursion) */
+	PARAM_NO_ESCAPE,   /**< the parameter does not escape */
+	PARAM_ESCAPES,     /**< the parameter may escape */
+} param_state_t;
+
+typedef struct escape_env_t {
+	ir_nodeset_t      visited;
+	ir_node          *root;  /**< the address returned by the allocation */
+	ir_node         **frees; /**< calls freeing root, NULL if frees escape */
+	is_free_call_func is_free;
+} escape_env_t;
+
+typedef struct promotion_t {
+	ir_node  *call;  /**< the allocating Call */
+	ir_node  *res;   /**< the address result, NULL if unused */
+	unsigned  size;  /**< allocation size in bytes */
+	ir_node **frees; /**< Calls freeing the allocation */
+} promotion_t;
+
+/** Maps method entities to arrays of param_state_t. */
+static pmap *param_states;
+
+static bool param_escapes(ir_entity *callee, size_t pos,
+                          is_free_call_func is_free);
+
+/**
+ * Returns true if passing @p value as argument to Call @p call may let it
+ * escape.
+ */
+static bool call_lets_escape(escape_env_t *env, ir_node *call, ir_node *value)
+{
+	if (get_Call_ptr(call) == value)
+		return true;
+
+	if (env->is_free != NULL && env->is_free(call)) {
+		/* A free inside a callee or of a derived pointer cannot be removed */
+		if (env->frees == NULL || value != env->root)
+			return true;
+		/* only the first argument is freed, other arguments may escape */
+		for (size_t p = 1, n = get_Call_n_params(call); p < n; ++p) {
+			if (get_Call_param(call, p) == value)
+				return true;
+		}
+		if (get_Call_n_params(call) == 0 || get_Call_param(call, 0) != value)
+			return true;
+		foreach_irn_out_r(call, i, proj) {
+			if (is_Proj(proj) && get_Proj_num(proj) >= pn_Call_X_regular)
+				return true;
+		}
+		ARR_APP1(ir_node*, env->frees, call);
+		return false;
+	}
+
+	ir_entity  *single = get_Call_callee(call);
+	size_t      n_callees;
+	if (cg_call_has_callees(call)) {
+		n_callees = cg_get_call_n_callees(call);
+	} else if (single != NULL) {
+		n_callees = 1;
+	} else {
+		return true;
+	}
+
+	for (size_t c = 0; c < n_callees; ++c) {
+		ir_entity *callee = cg_call_has_callees(call)
+		                    ? cg_get_call_callee(call, c) : single;
+		if (is_unknown_entity(callee))
+			return true;
+		size_t n_params = get_method_n_params(get_entity_type(callee));
+		for (size_t p = 0, n = get_Call_n_params(call); p < n; ++p) {
+			if (get_Call_param(call, p) != value)
+				continue;
+			/* variadic arguments are not analyzed */
+			if (p >= n_params || param_escapes(callee, p, env->is_free))
+				return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Returns true if the address @p value may escape the current function.
+ */
+static bool escapes(escape_env_t *env, ir_node *value)
+{
+	if (!ir_nodeset_insert(&env->visited, value))
+		return false;
+
+	foreach_irn_out_r(value, i, succ) {
+		switch (get_irn_opcode(succ)) {
+		case iro_Load:
+		case iro_CopyB:
+		case iro_Cmp:
+		case iro_End:
+			continue;
+
+		case iro_Store:
+			/* the address itself is written to memory */
+			if (get_Store_value(succ) == value)
+				return true;
+			continue;
+
+		case iro_Call:
+			if (call_lets_escape(env, succ, value))
+				return true;
+			continue;
+
+		case iro_Member:
+		case iro_Sel:
+		case iro_Add:
+		case iro_Sub:
+		case iro_Phi:
+		case iro_Mux:
+		case iro_Confirm:
+		case iro_Id:
+			/* pointer differences do not let the object escape */
+			if (!mode_is_reference(get_irn_mode(succ)))
+				continue;
+			if (escapes(env, succ))
+				return true;
+			continue;
+
+		default:
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool param_escapes(ir_entity *callee, size_t pos,
+                          is_free_call_func is_free)
+{
+	/* the graph might be replaced at link time */
+	ir_graph *irg = get_entity_linktime_irg(callee);
+	if (irg == NULL)
+		return true;
+
+	unsigned char *states = pmap_get(unsigned char, param_states, callee);
+	if (states == NULL) {
+		size_t n_params = get_method_n_params(get_entity_type(callee));
+		states = XMALLOCNZ(unsigned char, n_params);
+		pmap_insert(param_states, callee, states);
+	}
+	switch ((param_state_t)states[pos]) {
+	case PARAM_NO_ESCAPE:   return false;
+	/* be pessimistic for recursive calls */
+	case PARAM_IN_PROGRESS:
+	case PARAM_ESCAPES:     return true;
+	case PARAM_UNKNOWN:     break;
+	}
+
+	states[pos] = PARAM_IN_PROGRESS;
+	assure_irg_outs(irg);
+
+	escape_env_t env = { .root = NULL, .frees = NULL, .is_free = is_free };
+	ir_nodeset_init(&env.visited);
+	bool res = false;
+	foreach_irn_out_r(get_irg_args(irg), i, arg) {
+		if (is_Proj(arg) && get_Proj_num(arg) == pos && escapes(&env, arg)) {
+			res = true;
+			break;
+		}
+	}
+	ir_nodeset_destroy(&env.visited);
+
+	DB((dbg, LEVEL_3, "parameter %zu of %+F %s\n", pos, callee,
+	    res ? "escapes" : "does not escape"));
+	states[pos] = res ? PARAM_ESCAPES : PARAM_NO_ESCAPE;
+	return res;
+}
+
+/**
+ * Default allocation detection: calls of malloc-like functions with the
+ * size as their only argument.
+ */
+static ir_node *get_malloc_size(const ir_node *call)
+{
+	ir_entity *callee = get_Call_callee(call);
+	if (callee == NULL
+	    || !(get_entity_additional_properties(callee) & mtp_property_malloc)
+	    || get_Call_n_params(call) != 1)
+		return NULL;
+	return get_Call_param(call, 0);
+}
+
+static void collect_calls(ir_node *node, void *data)
+{
+	ir_node ***calls = (ir_node***)data;
+	if (is_Call(node))
+		ARR_APP1(ir_node*, *calls, node);
+}
+
+/**
+ * Returns the compound type all direct field accesses of @p res belong to, or
+ * NULL if there is no such type.
+ */
+static ir_type *find_access_type(ir_node *res, unsigned size)
+{
+	ir_type *type = NULL;
+	foreach_irn_out_r(res, i, succ) {
+		if (is_End(succ))
+			continue;
+		if (!is_Member(succ))
+			return NULL;
+		ir_type *owner = get_entity_owner(get_Member_entity(succ));
+		if (type != NULL && owner != type)
+			return NULL;
+		type = owner;
+	}
+	if (type == NULL || !is_compound_type(type) || get_type_size(type) != size)
+		return NULL;
+	return type;
+}
+
+static void promote(ir_graph *irg, promotion_t const *const p)
+{
+	ir_node *const call = p->call;
+	DB((dbg, LEVEL_1, "promote %+F (%u bytes) to the stack\n", call, p->size));
+
+	if (p->res != NULL) {
+		ir_type *type = find_access_type(p->res, p->size);
+		if (type == NULL) {
+			/* malloc guarantees an alignment suitable for any type */
+			ir_type *byte = get_type_for_mode(mode_Bu);
+			type = new_type_array(byte, p->size);
+			set_type_alignment(type, 2 * get_mode_size_bytes(mode_P));
+		}
+		ir_type   *const frame_type = get_irg_frame_type(irg);
+		ir_entity *const entity     = new_entity(frame_type,
+		                                         id_unique("$alloc"), type);
+		ir_node   *const frame      = get_irg_frame(irg);
+		ir_node   *const member     = new_r_Member(get_irg_start_block(irg),
+		                                           frame, entity);
+		exchange(p->res, member);
+	}
+
+	/* remove the allocating and the freeing calls from the memory chain */
+	ir_node *const *frees = p->frees;
+	for (size_t f = 0, n = frees != NULL ? ARR_LEN(frees) : 0; f <= n; ++f) {
+		ir_node *const node = f < n ? frees[f] : call;
+		ir_node *const mem  = get_Call_mem(node);
+		foreach_irn_out_r(node, i, proj) {
+			if (is_Proj(proj) && get_Proj_num(proj) == pn_Call_M)
+				exchange(proj, mem);
+		}
+	}
+}
+
+/**
+ * Checks whether the allocation @p call can be promoted to the stack.
+ */
+static bool analyze_alloc(ir_node *call, unsigned max_size,
+                          get_alloc_size_func get_size,
+                          is_free_call_func is_free, promotion_t *p)
+{
+	ir_node *size = get_size(call);
+	if (size == NULL || !is_Const(size))
+		return false;
+	ir_tarval *tv = get_Const_tarval(size);
+	if (!tarval_is_long(tv) || get_tarval_long(tv) <= 0
+	    || (unsigned long)get_tarval_long(tv) > max_size)
+		return false;
+
+	/* a single stack slot cannot represent the objects of several
+	 * iterations */
+	if (get_loop_depth(get_irn_loop(get_nodes_block(call))) > 0)
+		return false;
+
+	ir_node *res = NULL;
+	foreach_irn_out_r(call, i, proj) {
+		if (!is_Proj(proj))
+			continue;
+		unsigned pn = get_Proj_num(proj);
+		if (pn == pn_Call_X_regular || pn == pn_Call_X_except)
+			return false;
+		if (pn != pn_Call_T_result)
+			continue;
+		foreach_irn_out_r(proj, j, res_proj) {
+			if (is_Proj(res_proj) && get_Proj_num(res_proj) == 0)
+				res = res_proj;
+		}
+	}
+	if (res != NULL && get_irn_mode(res) != mode_P)
+		return false;
+
+	escape_env_t env = {
+		.root    = res,
+		.frees   = NEW_ARR_F(ir_node*, 0),
+		.is_free = is_free,
+	};
+	ir_nodeset_init(&env.visited);
+	bool const escaped = res != NULL && escapes(&env, res);
+	ir_nodeset_destroy(&env.visited);
+	if (escaped) {
+		DB((dbg, LEVEL_2, "%+F escapes\n", call));
+		DEL_ARR_F(env.frees);
+		return false;
+	}
+
+	p->call  = call;
+	p->res   = res;
+	p->size  = (unsigned)get_tarval_long(tv);
+	p->frees = env.frees;
+	return true;
+}
+
+void escape_analysis(ir_graph *irg, unsigned max_size,
+                     get_alloc_size_func get_size, is_free_call_func is_free)
+{
+	if (get_size == NULL)
+		get_size = get_malloc_size;
+
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+	                         | IR_GRAPH_PROPERTY_NO_TUPLES
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+	ir_node **calls = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, NULL, collect_calls, &calls);
+
+	/* analyze all allocations before changing the graph, param_escapes()
+	 * might need the outs of this graph */
+	param_states = pmap_create();
+	assure_irg_outs(irg);
+	promotion_t *promotions = NEW_ARR_F(promotion_t, 0);
+	for (size_t i = 0, n = ARR_LEN(calls); i < n; ++i) {
+		promotion_t p;
+		if (analyze_alloc(calls[i], max_size, get_size, is_free, &p))
+			ARR_APP1(promotion_t, promotions, p);
+	}
+	foreach_pmap(param_states, entry) {
+		free(entry->value);
+	}
+	pmap_destroy(param_states);
+	DEL_ARR_F(calls);
+
+	size_t const n_promotions = ARR_LEN(promotions);
+	for (size_t i = 0; i < n_promotions; ++i) {
+		promote(irg, &promotions[i]);
+		DEL_ARR_F(promotions[i].frees);
+	}
+	DEL_ARR_F(promotions);
+
+	confirm_irg_properties(irg, n_promotions > 0
+		? IR_GRAPH_PROPERTIES_CONTROL_FLOW : IR_GRAPH_PROPERTIES_ALL);
+}
+
+void firm_init_escape_ana(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.escape_ana");
+}
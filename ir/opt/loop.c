@@ -6,7 +6,7 @@
 /**
  * @file
  * @author   Christian Helmer
- * @brief    loop inversion and loop unrolling
+ * @brief    loop inversion, loop unrolling and loop unswitching
  *
  */
 
@@ -16,6 +16,7 @@
 #include "util.h"
 #include "array.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "panic.h"
 #include "irbackedge_t.h"
 #include "ircons_t.h"
@@ -91,6 +92,9 @@ typedef struct loop_stats_t {
 	unsigned constant_unroll;
 	unsigned invariant_unroll;
 
+	unsigned unswitched;
+	unsigned unswitch_cold;
+
 	unsigned unhandled;
 } loop_stats_t;
 
@@ -115,6 +119,8 @@ static void print_stats(void)
 	DB((dbg, LEVEL_2, "u_simple_counting :   %d\n", stats.u_simple_counting_loop));
 	DB((dbg, LEVEL_2, "constant_unroll   :   %d\n", stats.constant_unroll));
 	DB((dbg, LEVEL_2, "invariant_unroll  :   %d\n", stats.invariant_unroll));
+	DB((dbg, LEVEL_2, "unswitched        :   %d\n", stats.unswitched));
+	DB((dbg, LEVEL_2, "unswitch_cold     :   %d\n", stats.unswitch_cold));
 	DB((dbg, LEVEL_2, "=======================================\n"));
 }
 
@@ -132,6 +138,9 @@ typedef struct loop_opt_params_t {
 	bool     allow_const_unrolling;
 	bool     allow_invar_unrolling;
 	unsigned invar_unrolling_min_size;  /* [nodes] */
+
+	unsigned max_unswitch_size;   /* Maximum loop size for unswitching [nodes] */
+	double   min_unswitch_trips;  /* Minimum estimated iterations per entry */
 } loop_opt_params_t;
 
 static loop_opt_params_t opt_params;
@@ -189,7 +198,8 @@ static struct obstack obst;
 typedef enum loop_op_t {
 	loop_op_inversion,
 	loop_op_unrolling,
-	loop_op_peeling
+	loop_op_peeling,
+	loop_op_unswitching
 } loop_op_t;
 
 /* Returns the maximum nodes for the given nest depth */
@@ -2224,6 +2234,212 @@ static void unroll_loop(ir_graph *const irg)
 	}
 }
 
+/***** Unswitching *****/
+
+/* Collects all nodes of cur_loop. */
+static void collect_loop_nodes(ir_node *const node, void *const env)
+{
+	ir_node ***const nodes = (ir_node***)env;
+	if (is_in_loop(node))
+		ARR_APP1(ir_node*, *nodes, node);
+}
+
+/* Returns true if the given Proj leads to a block inside cur_loop. */
+static bool proj_stays_in_loop(const ir_node *const proj)
+{
+	foreach_out_edge(proj, edge) {
+		if (!is_in_loop(get_edge_src_irn(edge)))
+			return false;
+	}
+	return true;
+}
+
+/* Returns true if the selector of cond does not change inside cur_loop,
+ * i.e. it is defined outside or it is a Cmp of values defined outside. */
+static bool is_unswitchable_cond(const ir_node *const cond)
+{
+	ir_node const *const block    = get_nodes_block(cond);
+	ir_node       *const selector = get_Cond_selector(cond);
+	if (!is_loop_invariant(selector, block)
+	    && (!is_Cmp(selector)
+	        || !is_loop_invariant(get_Cmp_left(selector), block)
+	        || !is_loop_invariant(get_Cmp_right(selector), block)))
+		return false;
+
+	/* Conditions leaving the loop are handled by inversion and peeling. */
+	foreach_out_edge(cond, edge) {
+		if (!proj_stays_in_loop(get_edge_src_irn(edge)))
+			return false;
+	}
+	return true;
+}
+
+/* Returns the single entry position of loop_head, or -1 if there is more
+ * than one entry. */
+static int get_loop_entry_pos(void)
+{
+	int entry_pos = -1;
+	for (int i = 0, n = get_Block_n_cfgpreds(loop_head); i < n; ++i) {
+		if (is_own_backedge(loop_head, i))
+			continue;
+		if (entry_pos >= 0)
+			return -1;
+		entry_pos = i;
+	}
+	return entry_pos;
+}
+
+/* Returns the maximum nodes of a loop to be unswitched, depending on its
+ * nest depth and its estimated number of iterations. */
+static unsigned get_max_unswitch_nodes(unsigned const depth, double const trips)
+{
+	double const perc   = 100.0 + (double)opt_params.depth_adaption;
+	double const factor = pow(perc / 100.0, depth)
+	                    * MIN(trips / opt_params.min_unswitch_trips, 4.0);
+
+	return (unsigned)((double)opt_params.max_unswitch_size * factor);
+}
+
+/* Replaces the Cond by a Jmp to the successor chosen by value and
+ * disconnects the other successor. */
+static void fold_cond(ir_node *const cond, bool const value)
+{
+	ir_graph *const irg   = get_irn_irg(cond);
+	ir_node  *const block = get_nodes_block(cond);
+	foreach_out_edge_safe(cond, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if ((get_Proj_num(proj) == pn_Cond_true) == value)
+			exchange(proj, new_r_Jmp(block));
+		else
+			exchange(proj, new_r_Bad(irg, mode_X));
+	}
+}
+
+/* Unswitches cur_loop at cond: The loop is duplicated, a new block in front
+ * of both loops evaluates the condition once, and each loop keeps only one
+ * of the successors of cond. */
+static void unswitch_walk(ir_graph *const irg, ir_node **const loop_nodes, ir_node *const cond, int const entry_pos)
+{
+	loop_entries = NEW_ARR_F(entry_edge, 0);
+	irg_walk_graph(irg, get_loop_entries, NULL, NULL);
+
+	ir_nodemap_init(&map, irg);
+
+	/* 1. copy the whole loop */
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
+	inc_irg_visited(irg);
+	for (size_t i = 0, n = ARR_LEN(loop_nodes); i < n; ++i)
+		copy_walk(loop_nodes[i], is_in_loop, cur_loop);
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
+
+	/* 2. evaluate the condition in front of the loop and enter the original
+	 *    loop on true, the copy on false */
+	ir_node *const head_cp   = get_inversion_copy(loop_head);
+	ir_node *const entry     = get_Block_cfgpred(loop_head, entry_pos);
+	ir_node *const guard     = new_r_Block(irg, 1, &entry);
+	ir_node       *selector  = get_Cond_selector(cond);
+	if (!is_loop_invariant(selector, get_nodes_block(cond))) {
+		selector = new_r_Cmp(guard, get_Cmp_left(selector),
+		                     get_Cmp_right(selector),
+		                     get_Cmp_relation(selector));
+	}
+	ir_node *const guard_cond = new_r_Cond(guard, selector);
+	set_Block_cfgpred(loop_head, entry_pos,
+	                  new_r_Proj(guard_cond, mode_X, pn_Cond_true));
+	set_Block_cfgpred(head_cp, entry_pos,
+	                  new_r_Proj(guard_cond, mode_X, pn_Cond_false));
+
+	/* 3. the loop exits get the exits of the copy as additional preds */
+	ir_node *const end = get_irg_end(irg);
+	for (size_t i = 0, n = ARR_LEN(loop_entries); i < n; ++i) {
+		entry_edge const entry = loop_entries[i];
+		if (entry.node == end)
+			add_End_keepalive(end, get_inversion_copy(entry.pred));
+		else if (is_Block(entry.node))
+			extend_ins_by_copy(entry.node, entry.pos);
+	}
+
+	/* 4. values defined in the loop have a second definition now */
+	for (size_t i = 0, n = ARR_LEN(loop_entries); i < n; ++i) {
+		entry_edge const entry = loop_entries[i];
+		if (entry.node == end || is_Block(entry.node))
+			continue;
+
+		ir_node *const pred    = entry.pred;
+		ir_node *const cppred  = get_inversion_copy(pred);
+		ir_node *const block   = get_nodes_block(pred);
+		ir_node *const cpblock = get_nodes_block(cppred);
+		construct_ssa(block, pred, cpblock, cppred);
+	}
+
+	/* 5. remove the now constant condition from both loops */
+	fold_cond(get_inversion_copy(cond), false);
+	fold_cond(cond, true);
+
+	ir_nodemap_destroy(&map);
+	DEL_ARR_F(loop_entries);
+}
+
+/* Performs loop unswitching of cur_loop if possible and reasonable. */
+static void unswitch_loop(ir_graph *const irg)
+{
+	if (loop_info.nodes == 0 || loop_info.cf_outs == 0)
+		return;
+
+	int const entry_pos = get_loop_entry_pos();
+	if (entry_pos < 0) {
+		++stats.unhandled;
+		return;
+	}
+
+	/* Estimated iterations per loop entry. */
+	ir_node *const entry_block = get_Block_cfgpred_block(loop_head, entry_pos);
+	double   const entry_freq  = get_block_execfreq(entry_block);
+	double   const trips       = entry_freq > 0.0
+	                             ? get_block_execfreq(loop_head) / entry_freq
+	                             : 0.0;
+	if (trips < opt_params.min_unswitch_trips) {
+		DB((dbg, LEVEL_2, "Estimated trips %.2f < %.2f\n",
+		    trips, opt_params.min_unswitch_trips));
+		++stats.unswitch_cold;
+		return;
+	}
+
+	/* Depth of 0 is the procedure and 1 a topmost loop. */
+	int      const loop_depth = get_loop_depth(cur_loop) - 1;
+	unsigned const max_nodes  = get_max_unswitch_nodes(loop_depth, trips);
+	if (loop_info.nodes > max_nodes) {
+		DB((dbg, LEVEL_2, "Nodes %d > allowed nodes (depth %d, trips %.2f) %d\n",
+		    loop_info.nodes, loop_depth, trips, max_nodes));
+		++stats.too_large_adapted;
+		return;
+	}
+
+	ir_node **loop_nodes = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, collect_loop_nodes, NULL, &loop_nodes);
+
+	ir_node *cond = NULL;
+	for (size_t i = 0, n = ARR_LEN(loop_nodes); i < n; ++i) {
+		ir_node *const node = loop_nodes[i];
+		if (is_Cond(node) && is_unswitchable_cond(node)) {
+			cond = node;
+			break;
+		}
+	}
+
+	if (cond != NULL) {
+		DB((dbg, LEVEL_2, " *** Unswitching at %+F ***\n", cond));
+		unswitch_walk(irg, loop_nodes, cond, entry_pos);
+
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		                   | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
+		                   | IR_GRAPH_PROPERTY_NO_BADS);
+		++stats.unswitched;
+	}
+
+	DEL_ARR_F(loop_nodes);
+}
+
 /* Analyzes the loop, and checks if size is within allowed range.
  * Decides if loop will be processed. */
 static void init_analyze(ir_graph *const irg, ir_loop *const loop, loop_op_t const loop_op)
@@ -2257,6 +2473,7 @@ static void init_analyze(ir_graph *const irg, ir_loop *const loop, loop_op_t con
 	switch (loop_op) {
 		case loop_op_inversion: loop_inversion(irg); break;
 		case loop_op_unrolling: unroll_loop(irg);    break;
+		case loop_op_unswitching: unswitch_loop(irg); break;
 		default: panic("loop optimization not implemented");
 	}
 	DB((dbg, LEVEL_1, "       <<<< end of loop with node %ld >>>>\n", get_loop_loop_nr(loop)));
@@ -2291,6 +2508,8 @@ static void set_loop_params(void)
 	opt_params.invar_unrolling_min_size =   20;
 	opt_params.max_unrolled_loop_size   =  400;
 	opt_params.max_branches             = 9999;
+	opt_params.max_unswitch_size        =  200;
+	opt_params.min_unswitch_trips       =  2.0;
 }
 
 /**
@@ -2372,6 +2591,13 @@ void do_loop_peeling(ir_graph *const irg)
 	loop_optimization(irg, loop_op_peeling);
 }
 
+void do_loop_unswitching(ir_graph *const irg)
+{
+	/* The size limit depends on the estimated trip count. */
+	ir_estimate_execfreq(irg);
+	loop_optimization(irg, loop_op_unswitching);
+}
+
 void firm_init_loop_opt(void)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.opt.loop");
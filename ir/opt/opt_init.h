@@ -19,6 +19,8 @@ void firm_init_reassociation(void);
 
 void firm_init_scalar_replace(void);
 
+void firm_init_escape_ana(void);
+
 void firm_init_loop_opt(void);
 
 #endif
@@ -9,6 +9,7 @@
  * @author   Michael Beck, Goetz Lindenmaier
  */
 #include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <assert.h>
 
@@ -45,6 +46,9 @@
 #include "irtools.h"
 #include "iropt_dbg.h"
 #include "irnodemap.h"
+#include "irprofile.h"
+#include "execfreq.h"
+#include "callgraph.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -635,6 +639,7 @@ typedef struct call_entry {
 	list_head  list;        /**< List head for linking the next one. */
 	int        loop_depth;  /**< The loop depth of this call. */
 	int        benefice;    /**< The calculated benefice of this call. */
+	double     weight;      /**< Estimated or profiled execution count. */
 	bool       all_const:1; /**< Set if this call has only constant parameters. */
 } call_entry;
 
@@ -651,6 +656,7 @@ typedef struct {
 	unsigned  n_call_nodes_orig; /**< for statistics */
 	unsigned  n_callers;         /**< Number of known graphs that call this graphs. */
 	unsigned  n_callers_orig;    /**< for statistics */
+	double    freq;              /**< Estimated or profiled execution count of the graph. */
 	unsigned  got_inline:1;      /**< Set, if at least one call inside this graph was inlined. */
 	unsigned  recursive:1;       /**< Set, if this function is self recursive. */
 } inline_irg_env;
@@ -670,6 +676,7 @@ static inline_irg_env *alloc_inline_irg_env(void)
 	env->n_call_nodes_orig = 0;
 	env->n_callers         = 0;
 	env->n_callers_orig    = 0;
+	env->freq              = 0.0;
 	env->got_inline        = 0;
 	env->recursive         = 0;
 	return env;
@@ -752,6 +759,7 @@ static void collect_calls2(ir_node *node, void *ctx)
 		entry->callee     = callee;
 		entry->loop_depth = get_irn_loop(get_nodes_block(node))->depth;
 		entry->benefice   = 0;
+		entry->weight     = 0.0;
 		entry->all_const  = false;
 
 		list_add_tail(&entry->list, &x->calls);
@@ -773,6 +781,7 @@ static call_entry *duplicate_call_entry(const call_entry *entry,
 	nentry->call       = new_call;
 	nentry->callee     = entry->callee;
 	nentry->benefice   = entry->benefice;
+	nentry->weight     = entry->weight;
 	nentry->loop_depth = entry->loop_depth + loop_depth_delta;
 	nentry->all_const  = entry->all_const;
 
@@ -1308,6 +1317,562 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 	current_ir_graph = rem;
 }
 
+/**
+ * Minimum fraction of the executions of a callee that must leave through its
+ * early exit before the callee is considered for partial inlining.
+ */
+#define PARTIAL_MIN_HOT_RATIO 0.7
+
+/**
+ * Checks whether a node on the entry path of a callee may be executed twice:
+ * once in the inlined entry path and once more in the outlined remainder.
+ */
+static bool is_reexecutable(const ir_node *node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load:
+		return get_Load_volatility(node) == volatility_non_volatile;
+	case iro_Alloc:
+	case iro_ASM:
+	case iro_Builtin:
+	case iro_Call:
+	case iro_CopyB:
+	case iro_Free:
+	case iro_Raise:
+	case iro_Store:
+		return false;
+	default:
+		return true;
+	}
+}
+
+typedef struct partial_env_t {
+	ir_node **blocks;  /**< blocks of the entry path followed by the hot exit */
+	size_t    n_entry; /**< number of blocks on the entry path */
+	unsigned  n_hot;   /**< number of nodes in the hot part */
+	unsigned  n_nodes; /**< number of nodes in the whole graph */
+	bool      ok;      /**< cleared if the entry path has side effects */
+} partial_env_t;
+
+/**
+ * Post-walker: count the nodes of the hot part and check the entry path.
+ */
+static void count_partial_nodes(ir_node *node, void *ctx)
+{
+	partial_env_t *env = (partial_env_t*)ctx;
+	if (is_nop(node) || is_Block(node))
+		return;
+	++env->n_nodes;
+
+	ir_node *const block = get_nodes_block(node);
+	for (size_t i = 0, n = ARR_LEN(env->blocks); i < n; ++i) {
+		if (env->blocks[i] != block)
+			continue;
+		++env->n_hot;
+		if (i < env->n_entry && !is_reexecutable(node))
+			env->ok = false;
+		break;
+	}
+}
+
+/**
+ * Collects the entry path ending in @p block into @p blocks. The entry path
+ * consists of the start block and the blocks following it by unconditional
+ * jumps.
+ *
+ * @return true if @p block is on the entry path
+ */
+static bool collect_entry_path(ir_node *block, ir_node ***blocks)
+{
+	ir_graph *const irg         = get_irn_irg(block);
+	ir_node  *const start_block = get_irg_start_block(irg);
+	inc_irg_block_visited(irg);
+	for (;;) {
+		ARR_APP1(ir_node*, *blocks, block);
+		if (block == start_block)
+			return true;
+		if (Block_block_visited(block) || get_Block_n_cfgpreds(block) != 1)
+			return false;
+		mark_Block_block_visited(block);
+		ir_node *const pred = get_Block_cfgpred(block, 0);
+		if (!is_Jmp(pred))
+			return false;
+		block = get_nodes_block(pred);
+	}
+}
+
+/**
+ * Searches the most frequently executed Return of @p irg that is reached from
+ * the entry path by a single conditional jump. On success the entry path and
+ * the block of the Return are collected into @p blocks.
+ *
+ * @return the End block predecessor number of the Return or -1
+ */
+static int find_hot_exit(ir_graph *irg, ir_node ***blocks)
+{
+	ir_node *const end_block = get_irg_end_block(irg);
+	int            best      = -1;
+	double         best_freq = 0.0;
+	for (int i = 0, n = get_Block_n_cfgpreds(end_block); i < n; ++i) {
+		ir_node *const ret = get_Block_cfgpred(end_block, i);
+		if (!is_Return(ret))
+			continue;
+		ir_node *const block = get_nodes_block(ret);
+		if (get_Block_n_cfgpreds(block) != 1)
+			continue;
+		ir_node *const proj = get_Block_cfgpred(block, 0);
+		if (!is_Proj(proj) || !is_Cond(get_Proj_pred(proj)))
+			continue;
+
+		double const freq = get_block_execfreq(block);
+		if (freq <= best_freq)
+			continue;
+
+		ARR_SHRINKLEN(*blocks, 0);
+		if (!collect_entry_path(get_nodes_block(get_Proj_pred(proj)), blocks))
+			continue;
+		best      = i;
+		best_freq = freq;
+	}
+	if (best < 0)
+		return -1;
+
+	double const entry_freq = get_block_execfreq(get_irg_start_block(irg));
+	if (best_freq < PARTIAL_MIN_HOT_RATIO * entry_freq)
+		return -1;
+
+	/* recollect, a later candidate may have overwritten the path */
+	ir_node *const ret   = get_Block_cfgpred(end_block, best);
+	ir_node *const block = get_nodes_block(ret);
+	ir_node *const cond  = get_Proj_pred(get_Block_cfgpred(block, 0));
+	ARR_SHRINKLEN(*blocks, 0);
+	collect_entry_path(get_nodes_block(cond), blocks);
+	ARR_APP1(ir_node*, *blocks, block);
+	return best;
+}
+
+/**
+ * Block walker: disconnect all successors of a Cond except the hot one.
+ */
+static void cut_cold_edges(ir_node *block, void *ctx)
+{
+	ir_node *const hot_proj = (ir_node*)ctx;
+	ir_node *const cond     = get_Proj_pred(hot_proj);
+	for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+		ir_node *const pred = get_Block_cfgpred(block, i);
+		if (pred != hot_proj && is_Proj(pred) && get_Proj_pred(pred) == cond)
+			set_Block_cfgpred(block, i, new_r_Bad(get_irn_irg(block), mode_X));
+	}
+}
+
+/**
+ * Creates a copy of @p callee for partial inlining. The copy keeps the entry
+ * path and the hot early exit of the callee; every other path is replaced by
+ * a call of the original function, which re-evaluates the side effect free
+ * entry path and continues with the cold remainder.
+ *
+ * @return the copy or NULL if the callee is not suitable
+ */
+static ir_graph *create_partial_copy(ir_graph *callee)
+{
+	ir_entity *const ent = get_irg_entity(callee);
+	ir_type   *const mtp = get_entity_type(ent);
+	if (is_method_variadic(mtp))
+		return NULL;
+	size_t const n_params = get_method_n_params(mtp);
+	for (size_t i = 0; i < n_params; ++i) {
+		if (!is_atomic_type(get_method_param_type(mtp, i)))
+			return NULL;
+	}
+	size_t const n_res = get_method_n_ress(mtp);
+	for (size_t i = 0; i < n_res; ++i) {
+		if (!is_atomic_type(get_method_res_type(mtp, i)))
+			return NULL;
+	}
+
+	partial_env_t env;
+	env.blocks = NEW_ARR_F(ir_node*, 0);
+	int const pos = find_hot_exit(callee, &env.blocks);
+	if (pos < 0) {
+		DEL_ARR_F(env.blocks);
+		return NULL;
+	}
+	env.n_entry = ARR_LEN(env.blocks) - 1;
+	env.n_hot   = 0;
+	env.n_nodes = 0;
+	env.ok      = true;
+	irg_walk_graph(callee, NULL, count_partial_nodes, &env);
+	DEL_ARR_F(env.blocks);
+	/* only worthwhile if the hot part is clearly smaller */
+	if (!env.ok || 2 * env.n_hot > env.n_nodes)
+		return NULL;
+
+	ir_graph *const copy = create_irg_copy(callee);
+	set_irg_entity(copy, ent);
+
+	ir_node *const end_block = get_irg_end_block(copy);
+	ir_node *const ret       = get_Block_cfgpred(end_block, pos);
+	ir_node *const hot_proj  = get_Block_cfgpred(get_nodes_block(ret), 0);
+	ir_node *const cond      = get_Proj_pred(hot_proj);
+	irg_block_walk_graph(copy, cut_cold_edges, NULL, hot_proj);
+
+	/* the cold path calls the original function */
+	unsigned const cold_pn = get_Proj_num(hot_proj) == pn_Cond_true
+	                       ? pn_Cond_false : pn_Cond_true;
+	ir_node  *const cold_proj  = new_r_Proj(cond, mode_X, cold_pn);
+	ir_node  *const cold_block = new_r_Block(copy, 1, &cold_proj);
+	ir_node  *const args       = get_irg_args(copy);
+	ir_node **const in         = ALLOCAN(ir_node*, n_params);
+	for (size_t i = 0; i < n_params; ++i) {
+		ir_mode *const mode = get_type_mode(get_method_param_type(mtp, i));
+		in[i] = new_r_Proj(args, mode, i);
+	}
+	ir_node *const mem      = get_irg_initial_mem(copy);
+	ir_node *const addr     = new_r_Address(copy, ent);
+	ir_node *const call     = new_r_Call(cold_block, mem, addr, n_params, in,
+	                                     mtp);
+	ir_node *const call_mem = new_r_Proj(call, mode_M, pn_Call_M);
+	ir_node *const call_res = new_r_Proj(call, mode_T, pn_Call_T_result);
+	ir_node **const res     = ALLOCAN(ir_node*, n_res);
+	for (size_t i = 0; i < n_res; ++i) {
+		ir_mode *const mode = get_type_mode(get_method_res_type(mtp, i));
+		res[i] = new_r_Proj(call_res, mode, i);
+	}
+	ir_node *const cold_ret = new_r_Return(cold_block, call_mem, n_res, res);
+
+	int       const n_end_preds = get_Block_n_cfgpreds(end_block);
+	ir_node **const end_in      = ALLOCAN(ir_node*, n_end_preds + 1);
+	for (int i = 0; i < n_end_preds; ++i)
+		end_in[i] = get_Block_cfgpred(end_block, i);
+	end_in[n_end_preds] = cold_ret;
+	set_irn_in(end_block, n_end_preds + 1, end_in);
+
+	confirm_irg_properties(copy, IR_GRAPH_PROPERTIES_NONE);
+	remove_unreachable_code(copy);
+	remove_bads(copy);
+
+	DB((dbg, LEVEL_2, "%+F: partial copy with %u of %u nodes\n", callee,
+	    env.n_hot, env.n_nodes));
+	return copy;
+}
+
+/**
+ * Returns the (cached) partial copy of @p callee or NULL if the callee is not
+ * suitable for partial inlining.
+ */
+static ir_graph *get_partial_copy(pmap *partial_graphs, ir_graph *callee)
+{
+	/* unsuitable callees are mapped to themselves */
+	ir_graph *copy = pmap_get(ir_graph, partial_graphs, callee);
+	if (copy != NULL)
+		return copy != callee ? copy : NULL;
+
+	copy = create_partial_copy(callee);
+	if (copy == NULL) {
+		pmap_insert(partial_graphs, callee, callee);
+		return NULL;
+	}
+	pmap_insert(partial_graphs, callee, copy);
+
+	inline_irg_env *const callee_env = (inline_irg_env*)get_irg_link(callee);
+	inline_irg_env *const copy_env   = alloc_inline_irg_env();
+	copy_env->freq = callee_env->freq;
+	set_irg_link(copy, copy_env);
+
+	ir_graph *const rem = current_ir_graph;
+	current_ir_graph = copy;
+	assure_irg_properties(copy, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	wenv_t wenv = { .x = copy_env, .ignore_callers = true };
+	irg_walk_graph(copy, NULL, collect_calls2, &wenv);
+	current_ir_graph = rem;
+	return copy;
+}
+
+/**
+ * Returns the estimated execution count of a call per node of code growth.
+ */
+static double get_call_density(const call_entry *entry)
+{
+	inline_irg_env const *const callee_env
+		= (inline_irg_env const*)get_irg_link(entry->callee);
+	return entry->weight / MAX(callee_env->n_nodes, 1u);
+}
+
+static int cmp_call_density(const void *p1, const void *p2)
+{
+	const call_entry *e1 = *(const call_entry**)p1;
+	const call_entry *e2 = *(const call_entry**)p2;
+	double const d1 = get_call_density(e1);
+	double const d2 = get_call_density(e2);
+	if (d1 != d2)
+		return d1 < d2 ? 1 : -1;
+	return get_irn_idx(e1->call) < get_irn_idx(e2->call) ? -1
+	     : get_irn_idx(e1->call) > get_irn_idx(e2->call);
+}
+
+/**
+ * Checks whether inlining @p callee_env at @p entry fits the hot cutoff, the
+ * remaining budget and the maximum graph size.
+ */
+static bool profitable_inline(const call_entry *entry,
+                              const inline_irg_env *env,
+                              const inline_irg_env *callee_env,
+                              unsigned maxsize, double cutoff, unsigned budget)
+{
+	unsigned const cost = callee_env->n_nodes;
+	return entry->weight / MAX(cost, 1u) >= cutoff
+	    && cost <= budget
+	    && env->n_nodes + cost <= maxsize;
+}
+
+/**
+ * Inline the calls of a graph in order of decreasing profit until the
+ * global budget is exhausted. Calls which only appear in a graph because a
+ * callee was inlined have already been judged in the callee and are not
+ * considered again.
+ */
+static void inline_into_profiled(ir_graph *irg, unsigned maxsize,
+                                 double cutoff, unsigned *budget,
+                                 pmap *partial_graphs)
+{
+	inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+	if (env->n_call_nodes == 0)
+		return;
+
+	call_entry **calls = NEW_ARR_F(call_entry*, 0);
+	list_for_each_entry(call_entry, entry, &env->calls, list) {
+		if (entry->callee != irg)
+			ARR_APP1(call_entry*, calls, entry);
+	}
+	QSORT_ARR(calls, cmp_call_density);
+
+	ir_entity                 *caller_ent   = get_irg_entity(irg);
+	mtp_additional_properties  caller_props
+		= get_entity_additional_properties(caller_ent);
+
+	current_ir_graph = irg;
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
+
+	bool phiproj_computed = false;
+	for (size_t i = 0, n = ARR_LEN(calls); i < n; ++i) {
+		call_entry     *curr_call  = calls[i];
+		ir_graph       *callee     = curr_call->callee;
+		inline_irg_env *callee_env = (inline_irg_env*)get_irg_link(callee);
+		ir_entity      *ent        = get_irg_entity(callee);
+		mtp_additional_properties props
+			= get_entity_additional_properties(ent);
+
+		bool const always_inline = props & mtp_property_always_inline;
+		if (!always_inline) {
+			/* see maybe_push_call() */
+			if (caller_props & mtp_property_always_inline)
+				continue;
+			if (curr_call->weight <= 0.0)
+				continue;
+			if (!profitable_inline(curr_call, env, callee_env, maxsize, cutoff,
+			                       *budget)) {
+				if (partial_graphs == NULL)
+					continue;
+				ir_graph *copy = get_partial_copy(partial_graphs, callee);
+				if (copy == NULL)
+					continue;
+				inline_irg_env *copy_env = (inline_irg_env*)get_irg_link(copy);
+				if (!profitable_inline(curr_call, env, copy_env, maxsize,
+				                       cutoff, *budget))
+					continue;
+				DB((dbg, LEVEL_1, "Partially inlining %+F into %+F\n", callee,
+				    irg));
+				callee     = copy;
+				callee_env = copy_env;
+			}
+		}
+
+		if (!phiproj_computed) {
+			phiproj_computed = true;
+			collect_phiprojs_and_start_block_nodes(irg);
+		}
+		ir_reserve_resources(callee, IR_RESOURCE_IRN_LINK);
+		bool did_inline = inline_method(curr_call->call, callee);
+		if (!did_inline) {
+			ir_free_resources(callee, IR_RESOURCE_IRN_LINK);
+			continue;
+		}
+		phiproj_computed = false;
+
+		list_del(&curr_call->list);
+		env->got_inline = 1;
+		--env->n_call_nodes;
+
+		/* the inlined calls execute as often as the call site does */
+		double const scale = callee_env->freq > 0.0
+		                   ? curr_call->weight / callee_env->freq : 0.0;
+		list_for_each_entry(call_entry, centry, &callee_env->calls, list) {
+			inline_irg_env *penv = (inline_irg_env*)get_irg_link(centry->callee);
+			++penv->n_callers;
+
+			ir_node *new_call = (ir_node*)get_irn_link(centry->call);
+			if (get_irn_irg(new_call) != irg)
+				continue;
+			assert(is_Call(new_call));
+
+			call_entry *new_entry = duplicate_call_entry(centry, new_call,
+			                                             curr_call->loop_depth);
+			new_entry->weight *= scale;
+			list_add_tail(&new_entry->list, &env->calls);
+		}
+		ir_free_resources(callee, IR_RESOURCE_IRN_LINK);
+
+		env->n_call_nodes += callee_env->n_call_nodes;
+		env->n_nodes      += callee_env->n_nodes;
+		--callee_env->n_callers;
+		if (!always_inline)
+			*budget -= MIN(callee_env->n_nodes, *budget);
+	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
+	DEL_ARR_F(calls);
+}
+
+/*
+ * Profile-driven inliner: visits the call graph bottom-up and inlines the
+ * calls with the highest execution count per node of code growth until the
+ * growth budget is exhausted.
+ */
+void inline_functions_profiled(const char *profile_filename, unsigned maxsize,
+                               unsigned growth_budget, int partial,
+                               opt_ptr after_inline_opt)
+{
+	ir_graph *rem = current_ir_graph;
+	obstack_init(&temp_obst);
+
+	bool const have_profile
+		= profile_filename != NULL && ir_profile_read(profile_filename);
+	if (have_profile) {
+		ir_create_execfreqs_from_profile();
+	} else {
+		DB((dbg, LEVEL_1, "no profile, using estimated frequencies\n"));
+		foreach_irp_irg(i, irg) {
+			ir_estimate_execfreq(irg);
+		}
+	}
+
+	ir_graph **irgs   = create_irg_list();
+	size_t     n_irgs = get_irp_n_irgs();
+	for (size_t i = 0; i < n_irgs; ++i)
+		set_irg_link(irgs[i], alloc_inline_irg_env());
+
+	/* execution counts of the graphs, relative to one call of the roots if
+	 * estimated */
+	if (!have_profile) {
+		compute_callgraph();
+		compute_method_execution_frequencies();
+	}
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph       *irg = irgs[i];
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+		env->freq = have_profile
+			? ir_profile_get_block_execcount(get_irg_start_block(irg))
+			: get_irg_method_execution_frequency(irg);
+	}
+	if (!have_profile)
+		free_callgraph();
+
+	wenv_t wenv;
+	wenv.ignore_callers = false;
+	unsigned n_total = 0;
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph *irg = irgs[i];
+
+		free_callee_info(irg);
+
+		wenv.x = (inline_irg_env*)get_irg_link(irg);
+		current_ir_graph = irg;
+		assure_loopinfo(irg);
+		irg_walk_graph(irg, NULL, collect_calls2, &wenv);
+		n_total += wenv.x->n_nodes;
+	}
+
+	/* weigh the call sites, block numbers still match the profile here */
+	call_entry **all_calls = NEW_ARR_F(call_entry*, 0);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph       *irg = irgs[i];
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+		list_for_each_entry(call_entry, entry, &env->calls, list) {
+			ir_node *block = get_nodes_block(entry->call);
+			entry->weight = have_profile
+				? ir_profile_get_block_execcount(block)
+				: env->freq * get_block_execfreq(block);
+			if (entry->weight > 0.0 && entry->callee != irg)
+				ARR_APP1(call_entry*, all_calls, entry);
+		}
+	}
+
+	/* The hot cutoff is the lowest density of the calls that still fit into
+	 * the budget when calls are taken greedily by density. Partial copies are
+	 * created from the callees before anything is inlined into them. */
+	pmap    *partial_graphs = partial ? pmap_create() : NULL;
+	unsigned budget         = (unsigned)((double)n_total * growth_budget / 100);
+	unsigned remaining      = budget;
+	double   cutoff         = HUGE_VAL;
+	QSORT_ARR(all_calls, cmp_call_density);
+	for (size_t i = 0, n = ARR_LEN(all_calls); i < n; ++i) {
+		call_entry     *entry      = all_calls[i];
+		inline_irg_env *callee_env = (inline_irg_env*)get_irg_link(entry->callee);
+		unsigned        cost       = callee_env->n_nodes;
+		if (cost > remaining && partial_graphs != NULL) {
+			ir_graph *copy = get_partial_copy(partial_graphs, entry->callee);
+			if (copy != NULL)
+				cost = ((inline_irg_env*)get_irg_link(copy))->n_nodes;
+		}
+		if (cost > remaining)
+			continue;
+		remaining -= cost;
+		cutoff     = MIN(cutoff, entry->weight / MAX(cost, 1u));
+	}
+	DEL_ARR_F(all_calls);
+	DB((dbg, LEVEL_1, "budget %u nodes, hot cutoff %f\n", budget, cutoff));
+
+	/* -- and now inline, callees first. -- */
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph *irg = irgs[i];
+		inline_into_profiled(irg, maxsize, cutoff, &budget, partial_graphs);
+	}
+
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph *irg = irgs[i];
+
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+		if (env->got_inline && after_inline_opt != NULL) {
+			/* this irg got calls inlined: optimize it */
+			after_inline_opt(irg);
+		}
+		if (env->got_inline || (env->n_callers_orig != env->n_callers)) {
+			DB((dbg, LEVEL_1, "Nodes:%3d ->%3d, calls:%3d ->%3d, callers:%3d ->%3d, -- %s\n",
+			env->n_nodes_orig, env->n_nodes, env->n_call_nodes_orig, env->n_call_nodes,
+			env->n_callers_orig, env->n_callers,
+			get_entity_name(get_irg_entity(irg))));
+		}
+	}
+	DB((dbg, LEVEL_1, "%u nodes of budget left\n", budget));
+
+	if (partial_graphs != NULL) {
+		foreach_pmap(partial_graphs, pm_entry) {
+			ir_graph *copy = (ir_graph*)pm_entry->value;
+			if (copy == pm_entry->key)
+				continue;
+			set_irg_entity(copy, NULL);
+			free_ir_graph(copy);
+		}
+		pmap_destroy(partial_graphs);
+	}
+
+	free(irgs);
+	if (have_profile)
+		ir_profile_free();
+
+	obstack_free(&temp_obst, NULL);
+	current_ir_graph = rem;
+}
+
 void firm_init_inline(void)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.opt.inline");
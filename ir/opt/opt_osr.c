@@ -17,6 +17,7 @@
 
 #include "array.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "hashptr.h"
 #include "ircons.h"
 #include "irdom.h"
@@ -26,6 +27,7 @@
 #include "irgwalk.h"
 #include "irhooks.h"
 #include "irloop_t.h"
+#include "irnodeset.h"
 #include "irop_t.h"
 #include "iroptimize.h"
 #include "irouts.h"
@@ -1357,3 +1359,310 @@ void opt_osr(ir_graph *irg, unsigned flags)
 
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 }
+
+/** Cache line size assumed by the prefetch insertion. */
+#define PREFETCH_LINE_SIZE 64
+
+/** Maximum depth of address expressions analyzed for prefetching. */
+#define PREFETCH_MAX_DEPTH 8
+
+/** The environment for prefetch insertion. */
+typedef struct prefetch_env_t {
+	iv_env        iv;            /**< the induction variable environment */
+	unsigned      distance;      /**< number of iterations to prefetch ahead */
+	unsigned      min_stride;    /**< minimum stride for prefetching */
+	unsigned      min_footprint; /**< minimum footprint for prefetching */
+	ir_nodeset_t  prefetched;    /**< addresses already prefetched */
+	unsigned      inserted;      /**< number of inserted prefetches */
+} prefetch_env_t;
+
+/** The type of the prefetch builtin, shared by all graphs. */
+static ir_type *prefetch_type;
+
+static ir_type *get_prefetch_type(void)
+{
+	if (prefetch_type == NULL) {
+		ir_type *ptr_type = new_type_pointer(get_type_for_mode(mode_Bu));
+		ir_type *int_type = get_type_for_mode(mode_Is);
+		prefetch_type = new_type_method(3, 0, false, cc_cdecl_set,
+		                                mtp_no_property);
+		set_method_param_type(prefetch_type, 0, ptr_type);
+		set_method_param_type(prefetch_type, 1, int_type);
+		set_method_param_type(prefetch_type, 2, int_type);
+	}
+	return prefetch_type;
+}
+
+/**
+ * Process a SCC for prefetch insertion: only classify induction variables.
+ *
+ * @param pscc  the SCC
+ * @param env   the environment
+ */
+static void process_iv_only_scc(scc *pscc, iv_env *env)
+{
+	node_entry *e = (node_entry*)get_irn_link(pscc->head);
+	if (e->next != NULL)
+		classify_iv(pscc, env);
+}
+
+/**
+ * Get the constant amount an induction variable changes per iteration.
+ *
+ * @param iv    any node of the induction variable
+ * @param incr  points to the increment on success
+ * @param env   the environment
+ *
+ * @return true if the IV has a single constant increment
+ */
+static bool get_iv_increment(ir_node *iv, long *incr, iv_env *env)
+{
+	scc     *pscc = get_iv_scc(iv, env);
+	ir_node *add  = NULL;
+	for (ir_node *irn = pscc->head, *next; irn != NULL; irn = next) {
+		node_entry *e = get_irn_ne(irn, env);
+		next = e->next;
+		if (is_Phi(irn))
+			continue;
+		if (add != NULL)
+			return false;
+		add = irn;
+	}
+	if (add == NULL)
+		return false;
+
+	ir_node *right = get_binop_right(add);
+	ir_node *left  = get_binop_left(add);
+	if (is_Add(add) && get_iv_scc(right, env) == pscc) {
+		ir_node *t = left;
+		left  = right;
+		right = t;
+	}
+	if (get_iv_scc(left, env) != pscc || !is_Const(right))
+		return false;
+
+	ir_tarval *tv = get_Const_tarval(right);
+	if (!tarval_is_long(tv))
+		return false;
+	*incr = is_Sub(add) ? -get_tarval_long(tv) : get_tarval_long(tv);
+	return true;
+}
+
+/**
+ * Find the header of an induction variable an address expression depends on.
+ */
+static ir_node *find_address_iv_header(ir_node *node, unsigned depth,
+                                       iv_env *env)
+{
+	ir_node *header = is_iv(node, env);
+	if (header != NULL || depth == 0)
+		return header;
+
+	switch (get_irn_opcode(node)) {
+	case iro_Add:
+	case iro_Sub:
+		header = find_address_iv_header(get_binop_left(node), depth - 1, env);
+		if (header == NULL)
+			header = find_address_iv_header(get_binop_right(node), depth - 1,
+			                                env);
+		return header;
+	case iro_Mul:
+	case iro_Shl:
+		return find_address_iv_header(get_binop_left(node), depth - 1, env);
+	case iro_Conv:
+		return find_address_iv_header(get_Conv_op(node), depth - 1, env);
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * Compute the amount an address expression changes per iteration of the
+ * loop with the given header.
+ *
+ * @return true if the expression is an affine function of induction
+ *         variables of the loop
+ */
+static bool get_address_stride(ir_node *node, ir_node *header, unsigned depth,
+                               long *stride, iv_env *env)
+{
+	if (is_rc(node, header)) {
+		*stride = 0;
+		return true;
+	}
+	if (is_iv(node, env) == header)
+		return get_iv_increment(node, stride, env);
+	if (depth == 0)
+		return false;
+
+	long left;
+	long right;
+	switch (get_irn_opcode(node)) {
+	case iro_Add:
+		if (!get_address_stride(get_Add_left(node), header, depth - 1, &left, env)
+		 || !get_address_stride(get_Add_right(node), header, depth - 1, &right, env))
+			return false;
+		*stride = left + right;
+		return true;
+	case iro_Sub:
+		if (!get_address_stride(get_Sub_left(node), header, depth - 1, &left, env)
+		 || !get_address_stride(get_Sub_right(node), header, depth - 1, &right, env))
+			return false;
+		*stride = left - right;
+		return true;
+	case iro_Mul: {
+		ir_node *c = get_Mul_right(node);
+		if (!is_Const(c) || !tarval_is_long(get_Const_tarval(c))
+		 || !get_address_stride(get_Mul_left(node), header, depth - 1, &left, env))
+			return false;
+		*stride = left * get_tarval_long(get_Const_tarval(c));
+		return true;
+	}
+	case iro_Shl: {
+		ir_node *c = get_Shl_right(node);
+		if (!is_Const(c) || !tarval_is_long(get_Const_tarval(c)))
+			return false;
+		long const amount = get_tarval_long(get_Const_tarval(c));
+		if (amount < 0 || amount >= 32
+		 || !get_address_stride(get_Shl_left(node), header, depth - 1, &left, env))
+			return false;
+		/* shift unsigned, left may be negative */
+		*stride = (long)((unsigned long)left << amount);
+		return true;
+	}
+	case iro_Conv:
+		return get_address_stride(get_Conv_op(node), header, depth - 1, stride,
+		                          env);
+	default:
+		return false;
+	}
+}
+
+/**
+ * Estimate the number of iterations per entry of the loop with the given
+ * header.
+ */
+static double get_estimated_trips(ir_node *header)
+{
+	double entry_freq = 0.0;
+	for (int i = get_Block_n_cfgpreds(header); i-- > 0; ) {
+		if (!is_backedge(header, i))
+			entry_freq += get_block_execfreq(get_Block_cfgpred_block(header, i));
+	}
+	return entry_freq > 0.0 ? get_block_execfreq(header) / entry_freq : 0.0;
+}
+
+/**
+ * Post-walker: insert a prefetch in front of Loads that sweep through memory
+ * with a large stride or footprint.
+ */
+static void insert_prefetch(ir_node *irn, void *ctx)
+{
+	if (!is_Load(irn))
+		return;
+
+	prefetch_env_t *env    = (prefetch_env_t*)ctx;
+	ir_node        *ptr    = get_Load_ptr(irn);
+	ir_node        *header = find_address_iv_header(ptr, PREFETCH_MAX_DEPTH,
+	                                                &env->iv);
+	if (header == NULL)
+		return;
+
+	/* the address must change with every iteration of the innermost loop */
+	ir_node *block = get_nodes_block(irn);
+	if (get_irn_loop(block) != get_irn_loop(header))
+		return;
+
+	long stride;
+	if (!get_address_stride(ptr, header, PREFETCH_MAX_DEPTH, &stride, &env->iv)
+	    || stride == 0)
+		return;
+
+	unsigned long const abs_stride = stride < 0 ? -stride : stride;
+	double        const footprint  = abs_stride * get_estimated_trips(header);
+	if (abs_stride < env->min_stride && footprint < env->min_footprint)
+		return;
+
+	/* several Loads from the same address need only one prefetch */
+	if (!ir_nodeset_insert(&env->prefetched, ptr))
+		return;
+
+	DB((dbg, LEVEL_2, "  prefetch for %+F (stride %ld, footprint %f)\n",
+	    irn, stride, footprint));
+
+	/* Every iteration touches another cache line with large strides, so
+	 * these lines will most likely not be used again. */
+	ir_graph *irg       = get_irn_irg(irn);
+	ir_mode  *mode      = get_irn_mode(ptr);
+	ir_mode  *off_mode  = get_reference_offset_mode(mode);
+	int       locality  = abs_stride >= PREFETCH_LINE_SIZE ? 0 : 3;
+	ir_node  *offset    = new_r_Const_long(irg, off_mode,
+	                                       stride * (long)env->distance);
+	ir_node  *addr      = new_r_Add(block, ptr, offset);
+	ir_node  *in[]      = {
+		addr,
+		new_r_Const_long(irg, mode_Is, 0),
+		new_r_Const_long(irg, mode_Is, locality),
+	};
+	ir_node  *mem       = get_Load_mem(irn);
+	ir_node  *prefetch  = new_r_Builtin(block, mem, ARRAY_SIZE(in), in,
+	                                    ir_bk_prefetch, get_prefetch_type());
+	set_Load_mem(irn, new_r_Proj(prefetch, mode_M, pn_Builtin_M));
+	++env->inserted;
+}
+
+/* Inserts prefetches for Loads indexed by induction variables. */
+void opt_prefetch(ir_graph *irg, unsigned distance, unsigned min_stride,
+                  unsigned min_footprint)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.prefetch");
+
+	ir_estimate_execfreq(irg);
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+	DB((dbg, LEVEL_1, "Doing prefetch insertion for %+F\n", irg));
+
+	prefetch_env_t env;
+	iv_env *iv = &env.iv;
+	obstack_init(&iv->obst);
+	iv->stack         = NEW_ARR_F(ir_node *, 128);
+	iv->tos           = 0;
+	iv->nextDFSnum    = 0;
+	iv->POnum         = 0;
+	iv->quad_map      = NULL;
+	iv->lftr_edges    = NULL;
+	iv->replaced      = 0;
+	iv->lftr_replaced = 0;
+	iv->osr_flags     = 0;
+	iv->need_postpass = false;
+	iv->process_scc   = process_iv_only_scc;
+	env.distance      = distance;
+	env.min_stride    = min_stride;
+	env.min_footprint = min_footprint;
+	env.inserted      = 0;
+	ir_nodeset_init(&env.prefetched);
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	irg_walk_graph(irg, NULL, firm_clear_link, NULL);
+
+	irg_block_edges_walk(get_irg_start_block(irg), NULL, assign_po, iv);
+
+	/* calculate the SCC's and classify the induction variables */
+	do_dfs(irg, iv);
+
+	irg_walk_graph(irg, NULL, insert_prefetch, &env);
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_nodeset_destroy(&env.prefetched);
+
+	DB((dbg, LEVEL_1, "Prefetches: %u\n\n", env.inserted));
+
+	DEL_ARR_F(iv->stack);
+	obstack_free(&iv->obst, NULL);
+
+	confirm_irg_properties(irg, env.inserted > 0 || iv->replaced > 0
+		? IR_GRAPH_PROPERTIES_CONTROL_FLOW : IR_GRAPH_PROPERTIES_ALL);
+}
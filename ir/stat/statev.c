@@ -66,6 +66,9 @@ static void stat_ev_printf(char ev, const char *key, const char *fmt, ...)
 
 void stat_ev_tim_push(void)
 {
+	/* the timer stack is shared, only touch it when writing statistics */
+	if (!stat_ev_enabled)
+		return;
 	int            sp   = stat_ev_timer_sp++;
 	assert((size_t)sp < ARRAY_SIZE(stat_ev_timer_start));
 	timing_ticks_t temp = timing_ticks();
@@ -81,12 +84,14 @@ void stat_ev_tim_push(void)
 
 void stat_ev_tim_pop(const char *name)
 {
+	if (!stat_ev_enabled)
+		return;
 	int sp = --stat_ev_timer_sp;
 	assert(sp >= 0);
 	timing_ticks_t temp = timing_ticks();
 	temp -= stat_ev_timer_start[sp];
 	stat_ev_timer_elapsed[sp] += temp;
-	if (name != NULL && stat_ev_enabled)
+	if (name != NULL)
 		stat_ev_ull(name, stat_ev_timer_elapsed[sp]);
 
 	if (sp == 0) {
@@ -0,0 +1,126 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "firm.h"
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/wait.h>
+#include <unistd.h>
+
+static ir_type *t_int;
+
+/**
+ * Creates function @p name returning the parity of its int argument converted
+ * to @p mode. The conversion to a narrow mode leaves the upper register bits
+ * alone, so the parity must ignore them.
+ */
+static void create_parity(char const *const name, ir_mode *const mode)
+{
+	ir_type *const type = new_type_method(1, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(type, 0, t_int);
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_type *const builtin_type = new_type_method(1, 1, false, cc_cdecl_set,
+	                                              mtp_no_property);
+	set_method_param_type(builtin_type, 0, new_type_primitive(mode));
+	set_method_res_type(builtin_type, 0, t_int);
+
+	ir_node *const arg     = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const in[]    = { new_Conv(arg, mode) };
+	ir_node *const builtin = new_Builtin(get_store(), 1, in, ir_bk_parity,
+	                                     builtin_type);
+	ir_node *const res[]  = { new_Proj(builtin, mode_Is, pn_Builtin_max + 1) };
+	ir_node *const ret    = new_Return(get_store(), 1, res);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+}
+
+static char const checker[] =
+	"int parity8(int), parity16(int), parity32(int);\n"
+	"int main(void)\n"
+	"{\n"
+	"\tfor (unsigned i = 0; i < 1u << 20; ++i) {\n"
+	"\t\tunsigned const x = i * 2654435761u;\n"
+	"\t\tif (parity8((int)x) != __builtin_parity(x & 0xFF)\n"
+	"\t\t || parity16((int)x) != __builtin_parity(x & 0xFFFF)\n"
+	"\t\t || parity32((int)x) != __builtin_parity(x))\n"
+	"\t\t\treturn 1;\n"
+	"\t}\n"
+	"\treturn 0;\n"
+	"}\n";
+
+/**
+ * Compiles the parity functions with or without popcnt and runs them against
+ * the parity of the host compiler. Returns false on a mismatch.
+ */
+static bool check_parity(bool const popcnt)
+{
+	char const *const asm_name     = popcnt ? "amd64parity_popcnt.s"
+	                                        : "amd64parity.s";
+	char const *const checker_name = "amd64parity_main.c";
+
+	ir_init();
+	be_parse_arg("isa=amd64");
+	be_parse_arg(popcnt ? "amd64-popcnt=true" : "amd64-popcnt=false");
+	t_int = new_type_primitive(mode_Is);
+	create_parity("parity8",  mode_Bs);
+	create_parity("parity16", mode_Hs);
+	create_parity("parity32", mode_Is);
+	lower_highlevel();
+	FILE *const out = fopen(asm_name, "w");
+	be_main(out, "amd64parity");
+	fclose(out);
+	ir_finish();
+
+	FILE *const main_file = fopen(checker_name, "w");
+	fputs(checker, main_file);
+	fclose(main_file);
+
+	char command[256];
+	snprintf(command, sizeof(command),
+	         "cc -o amd64parity.out %s %s 2>/dev/null && ./amd64parity.out",
+	         checker_name, asm_name);
+	int const status = system(command);
+	remove(asm_name);
+	remove(checker_name);
+	remove("amd64parity.out");
+	return status == 0;
+}
+
+int main(void)
+{
+	/* the generated code is checked against the host compiler */
+	if (system("cc --version >/dev/null 2>&1") != 0)
+		return 0;
+
+	/* backend options cannot change after initialization, so every variant
+	 * is compiled in a process of its own */
+	for (int popcnt = 0; popcnt < 2; ++popcnt) {
+		pid_t const pid = fork();
+		if (pid == 0)
+			exit(check_parity(popcnt) ? 0 : 1);
+		int status;
+		waitpid(pid, &status, 0);
+		assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+		(void)status;
+	}
+	return 0;
+}
+
+#else
+
+int main(void)
+{
+	/* the generated code can only run on an x86_64 host */
+	return 0;
+}
+
+#endif
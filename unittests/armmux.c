@@ -0,0 +1,92 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "firm.h"
+
+static ir_type *t_int;
+
+/**
+ * Creates a function returning a < b ? x : y with an if/else diamond, where
+ * a and b have mode @p cmp_mode.
+ */
+static ir_graph *create_select(char const *const name, ir_mode *const cmp_mode)
+{
+	ir_type *const t_cmp = new_type_primitive(cmp_mode);
+	ir_type *const type  = new_type_method(4, 1, false, cc_cdecl_set,
+	                                       mtp_no_property);
+	set_method_param_type(type, 0, t_cmp);
+	set_method_param_type(type, 1, t_cmp);
+	set_method_param_type(type, 2, t_int);
+	set_method_param_type(type, 3, t_int);
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *const args = get_irg_args(irg);
+	ir_node *const cmp  = new_Cmp(new_Proj(args, cmp_mode, 0),
+	                              new_Proj(args, cmp_mode, 1), ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+	ir_node *const join = new_immBlock();
+	ir_node *const in_true[]  = { new_Proj(cond, mode_X, pn_Cond_true) };
+	ir_node *const in_false[] = { new_Proj(cond, mode_X, pn_Cond_false) };
+	ir_node *const block_true  = new_Block(1, in_true);
+	ir_node *const block_false = new_Block(1, in_false);
+	set_cur_block(block_true);
+	add_immBlock_pred(join, new_Jmp());
+	set_cur_block(block_false);
+	add_immBlock_pred(join, new_Jmp());
+	mature_immBlock(join);
+	set_cur_block(join);
+
+	ir_node *const phi_in[] = {
+		new_Proj(args, mode_Is, 2), new_Proj(args, mode_Is, 3)
+	};
+	ir_node *const res[]  = { new_Phi(2, phi_in, mode_Is) };
+	ir_node *const ret    = new_Return(get_store(), 1, res);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static void count_mux(ir_node *node, void *env)
+{
+	if (is_Mux(node))
+		++*(unsigned*)env;
+}
+
+static unsigned n_mux(ir_graph *const irg)
+{
+	unsigned n = 0;
+	irg_walk_graph(irg, count_mux, NULL, &n);
+	return n;
+}
+
+int main(void)
+{
+	ir_init();
+	be_parse_arg("isa=arm");
+	t_int = new_type_primitive(mode_Is);
+
+	/* 32bit compares select with a conditional mov */
+	ir_graph *const narrow = create_select("narrow", mode_Is);
+	opt_if_conv(narrow);
+	assert(n_mux(narrow) == 1);
+
+	/* 64bit compares are lowered to several 32bit compares, which cannot
+	 * select a Mux */
+	ir_graph *const wide = create_select("wide", mode_Ls);
+	opt_if_conv(wide);
+	assert(n_mux(wide) == 0);
+
+	be_lower_for_target();
+	FILE *const out = tmpfile();
+	be_main(out, "armmux");
+	fclose(out);
+
+	ir_finish();
+	return 0;
+}
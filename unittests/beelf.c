@@ -0,0 +1,453 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "firm.h"
+
+#if defined(__unix__)
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define N_TABLE   8
+#define MAX_LINES 256
+
+static ir_type *t_int;
+
+static ir_type *new_function_type(unsigned const n_params)
+{
+	ir_type *const type = new_type_method(n_params, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	for (unsigned i = 0; i < n_params; ++i)
+		set_method_param_type(type, i, t_int);
+	set_method_res_type(type, 0, t_int);
+	return type;
+}
+
+static ir_graph *new_function(char const *const name,
+                              ir_visibility const visibility,
+                              int const n_locals)
+{
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name),
+	                                     new_function_type(1));
+	set_entity_visibility(entity, visibility);
+	ir_graph *const irg = new_ir_graph(entity, n_locals);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void add_return(ir_node *const value)
+{
+	ir_node *const in[]   = { value };
+	ir_node *const ret    = new_Return(get_store(), 1, in);
+	ir_node *const end_bl = get_irg_end_block(get_current_ir_graph());
+	add_immBlock_pred(end_bl, ret);
+}
+
+static void finish_function(ir_graph *const irg)
+{
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static ir_node *call(ir_entity *const callee, ir_node *const arg)
+{
+	ir_node *const in[] = { arg };
+	ir_node *const call = new_Call(get_store(), new_Address(callee), 1, in,
+	                               get_entity_type(callee));
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node *const res  = new_Proj(call, mode_T, pn_Call_T_result);
+	return new_Proj(res, mode_Is, 0);
+}
+
+static ir_node *load(ir_node *const ptr, ir_mode *const mode,
+                     ir_type *const type)
+{
+	ir_node *const load = new_Load(get_store(), ptr, mode, type, cons_none);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	return new_Proj(load, mode, pn_Load_res);
+}
+
+/**
+ * Creates a compilation unit with references to local and external code and
+ * data:
+ *
+ *   extern int ext(int);
+ *   static int table[N_TABLE] = { 1, 2, ... };
+ *   int *ptrs[2] = { &table[1], &table[N_TABLE - 1] };
+ *   static int helper(int x) { return ext(x) + table[x & 7]; }
+ *   int sum(int n)
+ *   {
+ *       int s = 0;
+ *       for (int i = 0; i < n; ++i)
+ *           s += helper(i);
+ *       return s + *ptrs[1];
+ *   }
+ */
+static void create_unit(void)
+{
+	ir_type *const t_ptr = new_type_pointer(t_int);
+
+	ir_entity *const ext = new_entity(get_glob_type(), new_id_from_str("ext"),
+	                                  new_function_type(1));
+
+	ir_entity *const table = new_entity(get_glob_type(),
+	                                    new_id_from_str("table"),
+	                                    new_type_array(t_int, N_TABLE));
+	set_entity_visibility(table, ir_visibility_local);
+	ir_initializer_t *const table_init = create_initializer_compound(N_TABLE);
+	for (unsigned i = 0; i < N_TABLE; ++i) {
+		ir_tarval *const tv = new_tarval_from_long(i + 1, mode_Is);
+		set_initializer_compound_value(table_init, i,
+		                               create_initializer_tarval(tv));
+	}
+	set_entity_initializer(table, table_init);
+
+	ir_graph  *const const_irg   = get_const_code_irg();
+	ir_mode   *const offset_mode = get_reference_offset_mode(mode_P);
+	ir_entity *const ptrs        = new_entity(get_glob_type(),
+	                                          new_id_from_str("ptrs"),
+	                                          new_type_array(t_ptr, 2));
+	ir_initializer_t *const ptrs_init  = create_initializer_compound(2);
+	unsigned          const elements[] = { 1, N_TABLE - 1 };
+	for (unsigned i = 0; i < 2; ++i) {
+		ir_node *const address = new_r_Address(const_irg, table);
+		ir_node *const offset  = new_r_Const_long(const_irg, offset_mode,
+		                                          4 * elements[i]);
+		ir_node *const value   = new_r_Add(get_irg_start_block(const_irg),
+		                                   address, offset);
+		set_initializer_compound_value(ptrs_init, i,
+		                               create_initializer_const(value));
+	}
+	set_entity_initializer(ptrs, ptrs_init);
+
+	ir_graph *irg = new_function("helper", ir_visibility_local, 0);
+	ir_node  *const x      = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node  *const index  = new_And(x, new_Const_long(mode_Is, N_TABLE - 1));
+	ir_node  *const offset = new_Mul(new_Conv(index, offset_mode),
+	                                 new_Const_long(offset_mode, 4));
+	ir_node  *const value  = load(new_Add(new_Address(table), offset),
+	                              mode_Is, t_int);
+	add_return(new_Add(call(ext, x), value));
+	finish_function(irg);
+	ir_entity *const helper = get_irg_entity(irg);
+
+	irg = new_function("sum", ir_visibility_external, 2);
+	ir_node *const n = new_Proj(get_irg_args(irg), mode_Is, 0);
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const head = new_immBlock();
+	add_immBlock_pred(head, new_Jmp());
+	set_cur_block(head);
+	ir_node *const cmp  = new_Cmp(get_value(1, mode_Is), n, ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const i = get_value(1, mode_Is);
+	set_value(0, new_Add(get_value(0, mode_Is), call(helper, i)));
+	set_value(1, new_Add(i, new_Const_long(mode_Is, 1)));
+	add_immBlock_pred(head, new_Jmp());
+	mature_immBlock(head);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *const ptr = load(new_Add(new_Address(ptrs),
+	                                  new_Const_long(offset_mode, 4)),
+	                          mode_P, t_ptr);
+	add_return(new_Add(get_value(0, mode_Is), load(ptr, mode_Is, t_int)));
+	finish_function(irg);
+}
+
+/**
+ * Creates "int select(int x) { switch (x) { case 0: return 10; ... } }" with
+ * N_TABLE dense cases, which the assembler output turns into a jump table.
+ */
+static void create_switch(void)
+{
+	ir_graph *const irg   = new_function("select", ir_visibility_external, 0);
+	ir_node  *const x     = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_switch_table *const table = ir_new_switch_table(irg, N_TABLE);
+	for (unsigned i = 0; i < N_TABLE; ++i) {
+		ir_tarval *const tv = new_tarval_from_long(i, mode_Iu);
+		ir_switch_table_set(table, i, tv, tv, i + 1);
+	}
+	ir_node *const sw = new_Switch(new_Conv(x, mode_Iu), N_TABLE + 1, table);
+	for (unsigned i = 0; i <= N_TABLE; ++i) {
+		ir_node *const block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(sw, mode_X, i));
+		mature_immBlock(block);
+		set_cur_block(block);
+		add_return(new_Const_long(mode_Is, 10 * i));
+	}
+	finish_function(irg);
+}
+
+/** Compiles with the backend options @p options, a NULL terminated list. */
+static void compile(char const *const name, char const *const *const options,
+                    void (*const create)(void))
+{
+	ir_init();
+	for (char const *const *option = options; *option != NULL; ++option)
+		be_parse_arg(*option);
+	t_int = new_type_primitive(mode_Is);
+	create();
+	lower_highlevel();
+	FILE *const out = fopen(name, "w");
+	be_main(out, "beelf");
+	fclose(out);
+	ir_finish();
+}
+
+static void compile_asm(void)
+{
+	char const *const options[] = { "isa=ia32", NULL };
+	compile("beelf_as.s", options, create_unit);
+}
+
+static void compile_object(void)
+{
+	char const *const options[] = { "isa=ia32", "object=true", NULL };
+	compile("beelf.o", options, create_unit);
+}
+
+static void compile_switch(void)
+{
+	char const *const options[] = { "isa=ia32", "object=true", NULL };
+	compile("beelf_switch.o", options, create_switch);
+}
+
+static void compile_debug(void)
+{
+	char const *const options[] = {
+		"isa=ia32", "object=true", "debug=basic", NULL
+	};
+	compile("beelf_fail.o", options, create_unit);
+}
+
+static void compile_amd64(void)
+{
+	char const *const options[] = { "isa=amd64", "object=true", NULL };
+	compile("beelf_fail.o", options, create_switch);
+}
+
+/**
+ * Runs @p function in a process of its own, backend options cannot change
+ * after initialization. Returns the exit status.
+ */
+static int run_child(void (*const function)(void))
+{
+	pid_t const pid = fork();
+	if (pid == 0) {
+		freopen("/dev/null", "w", stderr);
+		function();
+		exit(0);
+	}
+	int status;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/** Reads the output of @p command into a string. */
+static char *read_command(char const *const command)
+{
+	FILE *const f = popen(command, "r");
+	assert(f != NULL);
+	size_t size = 0;
+	char  *res  = NULL;
+	char   buf[4096];
+	for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0; size += n) {
+		res = (char*)realloc(res, size + n + 1);
+		memcpy(res + size, buf, n);
+	}
+	pclose(f);
+	if (res == NULL)
+		res = (char*)calloc(1, 1);
+	res[size] = '\0';
+	return res;
+}
+
+static bool starts_with(char const *const str, char const *const prefix)
+{
+	return strncmp(str, prefix, strlen(prefix)) == 0;
+}
+
+/** Tests whether @p insn is one of the padding instructions of as. */
+static bool is_nop(char const *const insn)
+{
+	return strstr(insn, "nop") != NULL
+	    || starts_with(insn, "xchg   %ax,%ax")
+	    || (strstr(insn, "lea    0x0(%esi") != NULL && strstr(insn, ",%esi"))
+	    || (strstr(insn, "lea    0x0(%edi") != NULL && strstr(insn, ",%edi"));
+}
+
+typedef struct line_t {
+	unsigned long address;  /**< address of an instruction */
+	char const   *function; /**< function of an instruction, NULL otherwise */
+	unsigned      index;    /**< index of the instruction in its function */
+	char         *text;
+} line_t;
+
+/**
+ * Returns the disassembly and the text relocations of @p object without
+ * addresses, encodings and padding. Branch targets are replaced by the index
+ * of the target instruction, so the choice of short or near jumps and the
+ * alignment of functions and loops do not matter.
+ */
+static char *disassemble(char const *const object)
+{
+	char command[256];
+	snprintf(command, sizeof(command),
+	         "objdump -dr --no-show-raw-insn %s", object);
+	char *const output = read_command(command);
+
+	line_t      lines[MAX_LINES];
+	size_t      n_lines  = 0;
+	char const *function = NULL;
+	unsigned    index    = 0;
+	for (char *line = strtok(output, "\n"); line != NULL;
+	     line = strtok(NULL, "\n")) {
+		unsigned long address;
+		char          name[64];
+		int           pos = 0;
+		assert(n_lines < MAX_LINES);
+		line_t *const l = &lines[n_lines];
+		if (sscanf(line, "%lx <%63[^>]>:", &address, name) == 2) {
+			function = strcpy((char*)malloc(strlen(name) + 1), name);
+			index    = 0;
+			*l = (line_t){ .text = strchr(line, '<') };
+			++n_lines;
+		} else if (sscanf(line, " %lx:\t%n", &address, &pos) == 1 && pos > 0) {
+			if (is_nop(line + pos))
+				continue;
+			*l = (line_t){ address, function, index++, line + pos };
+			++n_lines;
+		} else if (sscanf(line, " %lx: R_%n", &address, &pos) == 1
+		           && pos > 0) {
+			/* relocation, without the offset */
+			*l = (line_t){ .text = strchr(line, 'R') };
+			++n_lines;
+		}
+	}
+
+	size_t size = 0;
+	char  *res  = (char*)malloc(MAX_LINES * 128);
+	for (size_t i = 0; i < n_lines; ++i) {
+		char *const text   = lines[i].text;
+		char *const target = strstr(text, " <");
+		bool        is_branch
+			= lines[i].function != NULL && target != NULL
+			&& (text[0] == 'j' || starts_with(text, "call"));
+		if (!is_branch) {
+			size += sprintf(res + size, "%s\n", text);
+			continue;
+		}
+		/* replace "<address> <symbol+offset>" by the target instruction */
+		char *start = target;
+		while (start > text && start[-1] != ' ')
+			--start;
+		unsigned long const address = strtoul(start, NULL, 16);
+		*start = '\0';
+		line_t const *dest = NULL;
+		for (size_t j = 0; j < n_lines; ++j) {
+			if (lines[j].function != NULL && lines[j].address == address)
+				dest = &lines[j];
+		}
+		if (dest != NULL) {
+			size += sprintf(res + size, "%s<%s#%u>\n", text, dest->function,
+			                dest->index);
+		} else {
+			/* the relocated field of an external call */
+			size += sprintf(res + size, "%s<reloc>\n", text);
+		}
+	}
+	free(output);
+	return res;
+}
+
+/** Returns the output of @p command for @p object without the file name. */
+static char *dump(char const *const command, char const *const object)
+{
+	char cmd[256];
+	snprintf(cmd, sizeof(cmd), "%s %s | grep -v 'file format'", command,
+	         object);
+	return read_command(cmd);
+}
+
+/**
+ * Returns the symbols of @p object sorted by name. The values and sizes of
+ * functions depend on the instruction encoding and are left out.
+ */
+static char *get_symbols(char const *const object)
+{
+	char cmd[256];
+	snprintf(cmd, sizeof(cmd),
+	         "objdump -t %s | grep -v 'file format\\|df \\*ABS\\*\\| d  '"
+	         " | awk '$3 == \"F\" { $1 = \"\"; $5 = \"\" } { print }' | sort",
+	         object);
+	return read_command(cmd);
+}
+
+static void check_same(char *const expected, char *const actual)
+{
+	if (strcmp(expected, actual) != 0) {
+		fprintf(stderr, "expected:\n%s\nactual:\n%s\n", expected, actual);
+		assert(false);
+	}
+	free(expected);
+	free(actual);
+}
+
+int main(void)
+{
+	/* the output is compared with the GNU assembler */
+	if (system("as --32 --version >/dev/null 2>&1") != 0
+	    || system("objdump --version >/dev/null 2>&1") != 0)
+		return 0;
+
+	assert(run_child(compile_asm) == 0);
+	assert(run_child(compile_object) == 0);
+	int const res = system("as --32 -o beelf_as.o beelf_as.s");
+	assert(res == 0);
+	(void)res;
+
+	check_same(disassemble("beelf_as.o"), disassemble("beelf.o"));
+	check_same(get_symbols("beelf_as.o"), get_symbols("beelf.o"));
+	check_same(dump("objdump -r -j .data", "beelf_as.o"),
+	           dump("objdump -r -j .data", "beelf.o"));
+	check_same(dump("objdump -s -j .data", "beelf_as.o"),
+	           dump("objdump -s -j .data", "beelf.o"));
+
+	/* switches become compare chains instead of jump tables */
+	assert(run_child(compile_switch) == 0);
+	char *const code = disassemble("beelf_switch.o");
+	assert(strstr(code, "jmp    *") == NULL);
+	assert(strstr(code, "cmp") != NULL);
+	free(code);
+
+	/* unsupported options are rejected instead of being ignored */
+	assert(run_child(compile_debug) == EXIT_FAILURE);
+	assert(run_child(compile_amd64) == EXIT_FAILURE);
+
+	remove("beelf_as.s");
+	remove("beelf_as.o");
+	remove("beelf.o");
+	remove("beelf_switch.o");
+	remove("beelf_fail.o");
+	return 0;
+}
+
+#else
+
+int main(void)
+{
+	/* the comparison needs the GNU binutils */
+	return 0;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "beemithlp.h"
+#include "beemitter.h"
+#include "firm.h"
+#include "util.h"
+
+static char *read_file(FILE *f)
+{
+	long const size = ftell(f);
+	char *const res = (char*)malloc(size + 1);
+	rewind(f);
+	size_t const n = fread(res, 1, size, f);
+	res[n] = '\0';
+	return res;
+}
+
+static void check_formatters(void)
+{
+	FILE *const f = tmpfile();
+	be_emit_init(f);
+	be_emit_uint(0);
+	be_emit_char(' ');
+	be_emit_uint(18446744073709551615ULL);
+	be_emit_char(' ');
+	be_emit_int(-42);
+	be_emit_char(' ');
+	be_emit_int(INT64_MIN);
+	be_emit_char(' ');
+	be_emit_int_signed(7);
+	be_emit_char(' ');
+	be_emit_int_signed(-7);
+	be_emit_char(' ');
+	be_emit_hex(0xBEEF, 0, false);
+	be_emit_char(' ');
+	be_emit_hex(0x5, 2, true);
+	be_emit_char(' ');
+	be_emit_hex(-1, 0, true);
+	be_emit_char('\n');
+	be_emit_write_line();
+	be_emit_cstring("\tmovl");
+	assert(be_emit_get_column() == 5);
+	be_emit_char('\n');
+	be_emit_write_line();
+	be_emit_exit();
+
+	char *const text = read_file(f);
+	assert(streq(text, "0 18446744073709551615 -42 -9223372036854775808 +7 -7 "
+	                   "beef 05 FFFFFFFFFFFFFFFF\n\tmovl\n"));
+	free(text);
+	fclose(f);
+}
+
+/**
+ * Fills the buffer with complete lines up to just below the flush threshold
+ * and lets a started line cross it. Flushing then must keep the started line
+ * and its column.
+ */
+static void check_partial_flush(void)
+{
+	FILE *const f = tmpfile();
+	be_emit_init(f);
+	size_t const n_lines = 1024 * 1024 / 64 - 1;
+	for (size_t i = 0; i < n_lines; ++i) {
+		be_emit_irprintf("%63zu\n", i);
+		be_emit_write_line();
+	}
+	be_emit_irprintf("%127zu", n_lines);
+	assert(be_emit_get_column() == 127);
+	be_emit_flush();
+	assert(be_emit_get_column() == 127);
+	be_emit_cstring(" end\n");
+	be_emit_write_line();
+	be_emit_exit();
+	fflush(f);
+
+	char *const text = read_file(f);
+	char       *p    = text;
+	for (size_t i = 0; i <= n_lines; ++i) {
+		char line[160];
+		if (i < n_lines)
+			snprintf(line, sizeof(line), "%63zu\n", i);
+		else
+			snprintf(line, sizeof(line), "%127zu end\n", i);
+		assert(strncmp(p, line, strlen(line)) == 0);
+		p += strlen(line);
+	}
+	assert(*p == '\0');
+	free(text);
+	fclose(f);
+}
+
+/** Emits @p n_lines of a synthetic function. */
+static void emit_synthetic_function(FILE *const out, unsigned const n_lines,
+                                    bool const formatted)
+{
+	be_emit_init(out);
+	be_emit_cstring("\t.text\nbench:\n");
+	be_emit_write_line();
+	for (unsigned i = 0; i < n_lines; ++i) {
+		if (i % 16 == 0) {
+			if (formatted) {
+				be_emit_irprintf(".L%u:\n", i);
+			} else {
+				be_emit_cstring(".L");
+				be_emit_uint(i);
+				be_emit_cstring(":\n");
+			}
+			be_emit_write_line();
+		}
+		int const offset = (int)(i % 512) * 4 - 1024;
+		if (formatted) {
+			be_emit_irprintf("\tmovl %d(%%esp), %%eax", offset);
+		} else {
+			be_emit_cstring("\tmovl ");
+			be_emit_int(offset);
+			be_emit_cstring("(%esp), %eax");
+		}
+		be_emit_pad_comment();
+		if (formatted) {
+			be_emit_irprintf("/* ia32_Load Iu[%ld:%u] */\n", 1000L + i, i);
+		} else {
+			be_emit_cstring("/* ia32_Load Iu[");
+			be_emit_int(1000 + i);
+			be_emit_char(':');
+			be_emit_uint(i);
+			be_emit_cstring("] */\n");
+		}
+		be_emit_write_line();
+	}
+	be_emit_exit();
+	fflush(out);
+}
+
+int main(void)
+{
+	ir_init();
+	check_formatters();
+	check_partial_flush();
+
+	/* Both ways of emitting must produce the same text. */
+	FILE *const f1 = tmpfile();
+	FILE *const f2 = tmpfile();
+	emit_synthetic_function(f1, 2000, true);
+	emit_synthetic_function(f2, 2000, false);
+	char *const t1 = read_file(f1);
+	char *const t2 = read_file(f2);
+	assert(streq(t1, t2));
+	free(t1);
+	free(t2);
+	fclose(f1);
+	fclose(f2);
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "firm.h"
+#include "jit.h"
+
+static ir_type *t_int;
+
+/** Creates "int jit(int a, int b) { return a * b + 1; }". */
+static ir_graph *create_function(void)
+{
+	ir_type *const type = new_type_method(2, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(type, 0, t_int);
+	set_method_param_type(type, 1, t_int);
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str("jit"), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *const a      = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const b      = new_Proj(get_irg_args(irg), mode_Is, 1);
+	ir_node *const res    = new_Add(new_Mul(a, b), new_Const_long(mode_Is, 1));
+	ir_node *const in[]   = { res };
+	ir_node *const ret    = new_Return(get_store(), 1, in);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+int main(void)
+{
+	ir_init();
+	be_parse_arg("isa=ia32");
+	t_int = new_type_primitive(mode_Is);
+
+	ir_graph *const irg = create_function();
+	be_lower_for_target();
+
+	/* The fast tier leaves the graph intact and starts with a 5 byte nop. */
+	ir_jit_segment_t  *const segment = be_new_jit_segment();
+	ir_jit_function_t *const fast
+		= be_jit_compile_tier(segment, irg, ir_jit_tier_fast);
+	assert(fast != NULL);
+	assert(irg_verify(irg));
+
+	/* Recompile the hot function into the same segment. */
+	ir_jit_function_t *const optimized
+		= be_jit_compile_tier(segment, irg, ir_jit_tier_optimized);
+	assert(optimized != NULL);
+
+	unsigned const fast_size = be_get_function_size(fast);
+	unsigned const opt_begin = (fast_size + 15) & ~15u;
+	unsigned const opt_size  = be_get_function_size(optimized);
+	char    *const code      = (char*)malloc(opt_begin + opt_size + 8);
+	char    *const entry     = code + (8 - (uintptr_t)code % 8) % 8;
+	char    *const upgraded  = entry + opt_begin;
+	be_emit_function(entry, fast);
+	be_emit_function(upgraded, optimized);
+	assert(memcmp(entry, "\x0F\x1F\x44\x00\x00", 5) == 0);
+	char const after_entry[3] = { entry[5], entry[6], entry[7] };
+
+	be_jit_patch_entry(entry, upgraded);
+	int32_t rel;
+	memcpy(&rel, entry + 1, sizeof(rel));
+	assert((uint8_t)entry[0] == 0xE9);
+	assert(entry + 5 + rel == upgraded);
+	assert(memcmp(entry + 5, after_entry, sizeof(after_entry)) == 0);
+	(void)after_entry;
+
+	free(code);
+	be_destroy_jit_segment(segment);
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,200 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bejit.h"
+#include "firm.h"
+#include "jit.h"
+
+static ir_type   *t_int;
+static ir_entity *ext;
+
+static ir_graph *new_function(char const *const name, unsigned const n_params)
+{
+	ir_type *const type = new_type_method(n_params, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	for (unsigned i = 0; i < n_params; ++i)
+		set_method_param_type(type, i, i == 0 ? new_type_pointer(t_int) : t_int);
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void finish_function(ir_graph *const irg, ir_node *const res)
+{
+	ir_node *const in[]   = { res };
+	ir_node *const ret    = new_Return(get_store(), 1, in);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+}
+
+/** Creates a function returning its parameter plus the result of ext(). */
+static ir_graph *create_calling_function(void)
+{
+	ir_graph *const irg   = new_function("call", 2);
+	ir_node  *const param = new_Proj(get_irg_args(irg), mode_Is, 1);
+	ir_node  *const call  = new_Call(get_store(), new_Address(ext), 0, NULL,
+	                                 get_entity_type(ext));
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node  *const results = new_Proj(call, mode_T, pn_Call_T_result);
+	ir_node  *const res     = new_Proj(results, mode_Is, 0);
+	finish_function(irg, new_Add(param, res));
+	return irg;
+}
+
+/**
+ * Creates a function @p name summing the first @p n_values elements of an
+ * array.
+ */
+static ir_graph *create_sum_function(char const *const name,
+                                     unsigned const n_values)
+{
+	ir_graph *const irg         = new_function(name, 1);
+	ir_mode  *const offset_mode = get_reference_offset_mode(mode_P);
+	ir_node  *const ptr         = new_Proj(get_irg_args(irg), mode_P, 0);
+	ir_node        *sum         = new_Const_long(mode_Is, 0);
+	for (unsigned i = 0; i < n_values; ++i) {
+		ir_node *const offset = new_Const_long(offset_mode, 4 * i);
+		ir_node *const load   = new_Load(get_store(), new_Add(ptr, offset),
+		                                 mode_Is, t_int, cons_none);
+		set_store(new_Proj(load, mode_M, pn_Load_M));
+		sum = new_Add(sum, new_Proj(load, mode_Is, pn_Load_res));
+	}
+	finish_function(irg, sum);
+	return irg;
+}
+
+/** Checks that the code at @p code contains a call of @p target. */
+static bool calls(char const *const code, unsigned const size,
+                  char const *const target)
+{
+	for (unsigned i = 0; i + 5 <= size; ++i) {
+		int32_t rel;
+		memcpy(&rel, code + i + 1, sizeof(rel));
+		if ((uint8_t)code[i] == 0xE8 && code + i + 5 + rel == target)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Checks that the page at @p code is executable and not writable, if the
+ * system tells.
+ */
+static bool is_executable_only(void const *const code)
+{
+	FILE *const maps = fopen("/proc/self/maps", "r");
+	if (maps == NULL)
+		return true;
+	bool res = true;
+	char line[512];
+	while (fgets(line, sizeof(line), maps) != NULL) {
+		uintptr_t begin;
+		uintptr_t end;
+		char      perms[5];
+		if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " %4s", &begin, &end,
+		           perms) != 3)
+			continue;
+		if (begin <= (uintptr_t)code && (uintptr_t)code < end) {
+			res = perms[0] == 'r' && perms[1] == '-' && perms[2] == 'x';
+			break;
+		}
+	}
+	fclose(maps);
+	return res;
+}
+
+int main(void)
+{
+	ir_init();
+	be_parse_arg("isa=ia32");
+	t_int = new_type_primitive(mode_Is);
+	ir_type *const ext_type = new_type_method(0, 1, false, cc_cdecl_set,
+	                                          mtp_no_property);
+	set_method_res_type(ext_type, 0, t_int);
+	ext = new_entity(get_glob_type(), new_id_from_str("ext"), ext_type);
+
+	ir_graph *const small = create_sum_function("small", 4);
+	ir_graph *const call  = create_calling_function();
+	ir_graph *const large = create_sum_function("large", 3000);
+	be_lower_for_target();
+
+	ir_jit_memory_t   *const memory  = be_new_jit_memory();
+	ir_jit_segment_t  *const segment = be_new_jit_segment();
+	ir_jit_function_t *const fast
+		= be_jit_compile_tier(segment, small, ir_jit_tier_fast);
+	char *const entry = (char*)be_jit_install_function(memory, fast);
+	char *const other = (char*)be_jit_install_function(memory, fast);
+	assert((uintptr_t)entry % 8 == 0 && (uintptr_t)other % 8 == 0);
+	assert(entry != other);
+
+	/* Freed memory is reused for a function of the same size. */
+	be_jit_free_function(memory, other);
+	assert(be_jit_install_function(memory, fast) == other);
+
+	/* Relocations are resolved for the executable address. */
+	be_jit_set_entity_addr(ext, entry + 0x10000);
+	ir_jit_function_t *const caller = be_jit_compile(segment, call);
+	char *const caller_code = (char*)be_jit_install_function(memory, caller);
+	be_jit_commit_memory(memory);
+	assert(calls(caller_code, be_get_function_size(caller), entry + 0x10000));
+
+	/* Upgrade the fast function in place. */
+	ir_jit_function_t *const optimized = be_jit_compile(segment, small);
+	char *const upgraded = (char*)be_jit_install_function(memory, optimized);
+	be_jit_commit_memory(memory);
+	assert(memcmp(entry, "\x0F\x1F\x44\x00\x00", 5) == 0);
+	be_jit_patch_installed_entry(memory, entry, upgraded);
+	int32_t rel;
+	memcpy(&rel, entry + 1, sizeof(rel));
+	assert((uint8_t)entry[0] == 0xE9);
+	assert(entry + 5 + rel == upgraded);
+
+	/* Without a separate writable mapping the page is replaced by a patched
+	 * copy, which is never writable. Other functions on the page stay the
+	 * same. */
+	ir_jit_memory_t *const single = be_new_jit_memory_single_mapped();
+	char *const single_entry = (char*)be_jit_install_function(single, fast);
+	char *const single_other = (char*)be_jit_install_function(single, fast);
+	char *const single_upgraded
+		= (char*)be_jit_install_function(single, optimized);
+	be_jit_commit_memory(single);
+	assert(is_executable_only(single_entry));
+	unsigned const fast_size = be_get_function_size(fast);
+	char    *const other_code = (char*)malloc(fast_size);
+	memcpy(other_code, single_other, fast_size);
+	be_jit_patch_installed_entry(single, single_entry, single_upgraded);
+	assert(is_executable_only(single_entry));
+	memcpy(&rel, single_entry + 1, sizeof(rel));
+	assert((uint8_t)single_entry[0] == 0xE9);
+	assert(single_entry + 5 + rel == single_upgraded);
+	assert(memcmp(single_other, other_code, fast_size) == 0);
+	free(other_code);
+	be_destroy_jit_memory(single);
+
+	/* Functions bigger than the size classes get pages of their own. */
+	ir_jit_function_t *const big
+		= be_jit_compile_tier(segment, large, ir_jit_tier_fast);
+	assert(be_get_function_size(big) > 1u << 14);
+	char *const big_code = (char*)be_jit_install_function(memory, big);
+	be_jit_commit_memory(memory);
+	assert(memcmp(big_code, "\x0F\x1F\x44\x00\x00", 5) == 0);
+	be_jit_free_function(memory, big_code);
+	(void)big_code;
+	(void)caller_code;
+
+	/* The compiled functions are not needed after installing them. */
+	be_destroy_jit_segment(segment);
+	be_destroy_jit_memory(memory);
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,265 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "bearch.h"
+#include "bespill.h"
+#include "entity_t.h"
+#include "firm.h"
+
+#define N_VALUES 12
+
+static ir_type   *t_int;
+static ir_entity *ext;
+
+/**
+ * Creates a function @p name with @p n_blocks diamonds. Each of them loads
+ * N_VALUES values which are live across a call and therefore spilled.
+ */
+static ir_graph *create_spilling_function(char const *const name,
+                                          unsigned const n_blocks)
+{
+	ir_type *const type = new_type_method(1, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(type, 0, new_type_pointer(t_int));
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 1);
+	set_current_ir_graph(irg);
+
+	ir_mode *const offset_mode = get_reference_offset_mode(mode_P);
+	ir_node *const ptr         = new_Proj(get_irg_args(irg), mode_P, 0);
+	set_value(0, new_Const_long(mode_Is, 0));
+	for (unsigned b = 0; b < n_blocks; ++b) {
+		ir_node *values[N_VALUES];
+		for (unsigned i = 0; i < N_VALUES; ++i) {
+			ir_node *const offset
+				= new_Const_long(offset_mode, 4 * ((b * N_VALUES + i) % 64));
+			ir_node *const load = new_Load(get_store(), new_Add(ptr, offset),
+			                               mode_Is, t_int, cons_none);
+			set_store(new_Proj(load, mode_M, pn_Load_M));
+			values[i] = new_Add(new_Proj(load, mode_Is, pn_Load_res),
+			                    new_Const_long(mode_Is, b));
+		}
+
+		ir_node *const call = new_Call(get_store(), new_Address(ext), 0, NULL,
+		                               get_entity_type(ext));
+		set_store(new_Proj(call, mode_M, pn_Call_M));
+		ir_node *const results = new_Proj(call, mode_T, pn_Call_T_result);
+		ir_node *const res     = new_Proj(results, mode_Is, 0);
+
+		ir_node *sum = new_Const_long(mode_Is, 0);
+		for (unsigned i = 0; i < N_VALUES; ++i) {
+			ir_node *const mixed = new_Eor(values[i], res);
+			sum = new_Add(sum, new_Mul(mixed, new_Const_long(mode_Is, i + 1)));
+		}
+
+		ir_node *const odd  = new_And(values[0], new_Const_long(mode_Is, 1));
+		ir_node *const cmp  = new_Cmp(odd, new_Const_long(mode_Is, 0),
+		                              ir_relation_equal);
+		ir_node *const cond = new_Cond(cmp);
+		ir_node *const acc  = get_value(0, mode_Is);
+		ir_node *const join = new_immBlock();
+
+		ir_node *const block_true = new_immBlock();
+		add_immBlock_pred(block_true, new_Proj(cond, mode_X, pn_Cond_true));
+		mature_immBlock(block_true);
+		set_cur_block(block_true);
+		set_value(0, new_Add(acc, sum));
+		add_immBlock_pred(join, new_Jmp());
+
+		ir_node *const block_false = new_immBlock();
+		add_immBlock_pred(block_false, new_Proj(cond, mode_X, pn_Cond_false));
+		mature_immBlock(block_false);
+		set_cur_block(block_false);
+		set_value(0, new_Sub(acc, sum));
+		add_immBlock_pred(join, new_Jmp());
+
+		mature_immBlock(join);
+		set_cur_block(join);
+	}
+
+	ir_node *const in[]   = { get_value(0, mode_Is) };
+	ir_node *const ret    = new_Return(get_store(), 1, in);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+/**
+ * Creates a function @p name which loads N_VALUES values and keeps them live
+ * across a call, so they get spilled. A loop behind the call then uses all of
+ * them in every iteration.
+ */
+static ir_graph *create_loop_function(char const *const name)
+{
+	ir_type *const type = new_type_method(2, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(type, 0, new_type_pointer(t_int));
+	set_method_param_type(type, 1, t_int);
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(name), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+
+	ir_mode *const offset_mode = get_reference_offset_mode(mode_P);
+	ir_node *const ptr         = new_Proj(get_irg_args(irg), mode_P, 0);
+	ir_node *const n           = new_Proj(get_irg_args(irg), mode_Is, 1);
+	ir_node       *values[N_VALUES];
+	for (unsigned i = 0; i < N_VALUES; ++i) {
+		ir_node *const offset = new_Const_long(offset_mode, 4 * i);
+		ir_node *const load   = new_Load(get_store(), new_Add(ptr, offset),
+		                                 mode_Is, t_int, cons_none);
+		set_store(new_Proj(load, mode_M, pn_Load_M));
+		values[i] = new_Proj(load, mode_Is, pn_Load_res);
+	}
+	ir_node *const call = new_Call(get_store(), new_Address(ext), 0, NULL,
+	                               get_entity_type(ext));
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	set_value(0, new_Proj(new_Proj(call, mode_T, pn_Call_T_result), mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+
+	ir_node *const head = new_immBlock();
+	add_immBlock_pred(head, new_Jmp());
+	set_cur_block(head);
+	ir_node *const cmp  = new_Cmp(get_value(1, mode_Is), n, ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const i      = get_value(1, mode_Is);
+	ir_node *const amount = new_Conv(i, mode_Iu);
+	ir_node       *acc    = get_value(0, mode_Is);
+	for (unsigned v = 0; v < N_VALUES; ++v) {
+		acc = new_Add(acc, new_Shl(values[v], amount));
+	}
+	set_value(0, acc);
+	set_value(1, new_Add(i, new_Const_long(mode_Is, 1)));
+	add_immBlock_pred(head, new_Jmp());
+	mature_immBlock(head);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *sum = get_value(0, mode_Is);
+	for (unsigned i = 0; i < N_VALUES; ++i) {
+		sum = new_Add(sum, new_Mul(values[i], new_Const_long(mode_Is, i + 1)));
+	}
+
+	ir_node *const in[]   = { sum };
+	ir_node *const ret    = new_Return(get_store(), 1, in);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static void count_loop_reloads(ir_node *const node, void *const env)
+{
+	if (!is_Block(node) && !is_Proj(node) && arch_irn_is(node, reload)) {
+		ir_loop const *const loop = get_irn_loop(get_nodes_block(node));
+		if (loop != NULL && get_loop_depth(loop) > 0)
+			++*(unsigned*)env;
+	}
+}
+
+/**
+ * Counts and removes the spillslots of a compiled function, so the type
+ * walkers of the next compilation do not stumble over them.
+ */
+static unsigned free_spillslots(ir_graph *const irg)
+{
+	ir_type *const frame = get_irg_frame_type(irg);
+	unsigned       n     = 0;
+	for (size_t i = get_compound_n_members(frame); i-- > 0;) {
+		ir_entity *const member = get_compound_member(frame, i);
+		if (get_entity_kind(member) == IR_ENTITY_SPILLSLOT) {
+			free_entity(member);
+			++n;
+		}
+	}
+	return n;
+}
+
+/**
+ * Compiles a generated function and returns the number of spillslots in its
+ * frame.
+ */
+static unsigned compile(FILE *const out, char const *const name,
+                        unsigned const n_blocks, bool const coalesce)
+{
+	ir_graph *const irg = create_spilling_function(name, n_blocks);
+	lower_highlevel();
+	be_coalesce_spill_slots = coalesce;
+	be_main(out, "bespillslots");
+
+	unsigned const n_slots = free_spillslots(irg);
+	free_ir_graph(irg);
+	return n_slots;
+}
+
+/**
+ * Compiles a generated loop and returns the number of reloads inside the
+ * loop.
+ */
+static unsigned compile_loop(FILE *const out, char const *const name,
+                             bool const place)
+{
+	ir_graph *const irg = create_loop_function(name);
+	lower_highlevel();
+	be_place_spills = place;
+	be_main(out, "bespillslots");
+
+	assure_loopinfo(irg);
+	unsigned n_reloads = 0;
+	irg_walk_graph(irg, count_loop_reloads, NULL, &n_reloads);
+	free_spillslots(irg);
+	free_ir_graph(irg);
+	return n_reloads;
+}
+
+int main(void)
+{
+	ir_init();
+	be_parse_arg("isa=amd64");
+	/* the coalescer then checks that spills sharing a slot have disjoint
+	 * live ranges */
+	be_parse_arg("verify=true");
+	/* and the liveness sets updated while spilling are compared with
+	 * recomputed ones */
+	be_parse_arg("verifylive=true");
+	/* reloads in front of every use, also inside of loops */
+	be_parse_arg("spill-algo=daemel");
+	t_int = new_type_primitive(mode_Is);
+	ir_type *const ext_type = new_type_method(0, 1, false, cc_cdecl_set,
+	                                          mtp_no_property);
+	set_method_res_type(ext_type, 0, t_int);
+	ext = new_entity(get_glob_type(), new_id_from_str("ext"), ext_type);
+
+	FILE *const null = fopen("/dev/null", "w");
+
+	/* The values of different diamonds are never live at the same time, so
+	 * their spills share slots. */
+	unsigned const n_spills = compile(null, "uncoalesced", 20, false);
+	unsigned const n_slots  = compile(null, "coalesced", 20, true);
+	assert(n_spills >= 20 * N_VALUES / 2);
+	assert(n_slots < 2 * N_VALUES);
+
+	/* daemel reloads in front of every use inside the loop. As long as the
+	 * loop has free registers, the placement moves them in front of it. */
+	unsigned const n_unplaced = compile_loop(null, "unplaced", false);
+	unsigned const n_placed   = compile_loop(null, "placed", true);
+	assert(n_unplaced >= N_VALUES / 2);
+	assert(n_placed < n_unplaced);
+
+	fclose(null);
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,33 @@
+#include <assert.h>
+#include "bearch.h"
+#include "firm.h"
+#include "util.h"
+
+int main(void)
+{
+	ir_init();
+	be_parse_arg("isa=amd64");
+
+	/* sub-register names are valid clobbers of their full register */
+	assert(be_is_valid_clobber("rax"));
+	assert(be_is_valid_clobber("eax"));
+	assert(be_is_valid_clobber("ax"));
+	assert(be_is_valid_clobber("al"));
+	assert(be_is_valid_clobber("ah"));
+	assert(be_is_valid_clobber("sil"));
+	assert(be_is_valid_clobber("r9d"));
+	assert(be_is_valid_clobber("r15w"));
+	assert(!be_is_valid_clobber("sih"));
+	assert(!be_is_valid_clobber("r16"));
+
+	arch_register_t const *const rax = arch_find_register("al");
+	arch_register_t const *const r12 = arch_find_register("r12b");
+	assert(rax == arch_find_register("rax"));
+	assert(streq(arch_get_subreg_name(rax, arch_subreg_8h), "ah"));
+	assert(streq(arch_get_subreg_name(rax, arch_subreg_32), "eax"));
+	assert(streq(arch_get_subreg_name(r12, arch_subreg_16), "r12w"));
+	assert(!arch_register_has_subreg(r12, arch_subreg_8h));
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,121 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "firm.h"
+
+static ir_type *t_int;
+
+/** Creates a function entity taking @p n_params ints and returning an int. */
+static ir_entity *new_function(char const *const name, unsigned const n_params)
+{
+	ir_type *const type = new_type_method(n_params, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	for (unsigned i = 0; i < n_params; ++i)
+		set_method_param_type(type, i, t_int);
+	set_method_res_type(type, 0, t_int);
+	return new_entity(get_glob_type(), new_id_from_str(name), type);
+}
+
+static void finish_function(ir_graph *const irg, ir_node *const value)
+{
+	ir_node *const in[]   = { value };
+	ir_node *const ret    = new_Return(get_store(), 1, in);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+}
+
+/** Creates "int load(int i) { return arr[i]; }" with the index as Mul. */
+static void create_load(ir_entity *const arr)
+{
+	ir_graph *const irg = new_ir_graph(new_function("load", 1), 0);
+	set_current_ir_graph(irg);
+
+	ir_node *const i      = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_mode *const mode   = get_reference_offset_mode(mode_P);
+	ir_node *const index  = new_Mul(new_Conv(i, mode), new_Const_long(mode, 4));
+	ir_node *const ptr    = new_Add(new_Address(arr), index);
+	ir_node *const load   = new_Load(get_store(), ptr, mode_Is, t_int,
+	                                 cons_none);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	finish_function(irg, new_Proj(load, mode_Is, pn_Load_res));
+}
+
+/**
+ * Creates "int scale(int a, int b) { int x = a ^ b; return x + (x - a) * 8; }".
+ * The arguments live on the stack, the operations on computed values keep
+ * source address modes out of the way.
+ */
+static void create_scale(void)
+{
+	ir_graph *const irg = new_ir_graph(new_function("scale", 2), 0);
+	set_current_ir_graph(irg);
+
+	ir_node *const a      = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *const b      = new_Proj(get_irg_args(irg), mode_Is, 1);
+	ir_node *const x      = new_Eor(a, b);
+	ir_node *const scaled = new_Mul(new_Sub(x, a), new_Const_long(mode_Is, 8));
+	finish_function(irg, new_Add(x, scaled));
+}
+
+static char *read_file(FILE *f)
+{
+	long const size = ftell(f);
+	char *const res = (char*)malloc(size + 1);
+	rewind(f);
+	size_t const n = fread(res, 1, size, f);
+	res[n] = '\0';
+	return res;
+}
+
+/** Returns a copy of the assembly of function @p name in @p text. */
+static char *get_function(char const *const text, char const *const name)
+{
+	char begin[64];
+	snprintf(begin, sizeof(begin), "\n%s:\n", name);
+	char const *const start = strstr(text, begin);
+	assert(start != NULL);
+	char const *const end = strstr(start, "# -- End");
+	assert(end != NULL);
+	size_t const len = end - start;
+	char  *const res = (char*)malloc(len + 1);
+	memcpy(res, start, len);
+	res[len] = '\0';
+	return res;
+}
+
+int main(void)
+{
+	ir_init();
+	be_parse_arg("isa=ia32");
+	t_int = new_type_primitive(mode_Is);
+	ir_entity *const arr = new_entity(get_glob_type(), new_id_from_str("arr"),
+	                                  new_type_array(t_int, 16));
+	create_load(arr);
+	create_scale();
+	lower_highlevel();
+
+	FILE *const f = tmpfile();
+	be_main(f, "ia32addressmode");
+	char *const text = read_file(f);
+
+	/* A Mul by a power of two up to 8 becomes the scaled index of an address
+	 * mode, both in a Load and in a Lea. */
+	char *const load  = get_function(text, "load");
+	char *const scale = get_function(text, "scale");
+	assert(strstr(load, "movl arr(,%") != NULL);
+	assert(strstr(load, ",4), %") != NULL);
+	assert(strstr(scale, "leal (%") != NULL);
+	assert(strstr(scale, ",8), %") != NULL);
+	assert(strstr(load, "\timul") == NULL && strstr(load, "\tshl") == NULL);
+	assert(strstr(scale, "\timul") == NULL && strstr(scale, "\tshl") == NULL);
+	free(load);
+	free(scale);
+	free(text);
+	fclose(f);
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "bearch.h"
+#include "firm.h"
+#include "raw_bitset.h"
+
+#define N_VALUES 6
+
+static ir_type *t_int;
+
+/**
+ * Creates a function storing the low bytes of sums of N_VALUES loaded values,
+ * which are all live at the same time. Some of them end up in registers
+ * without a byte sub-register.
+ */
+static ir_graph *create_function(void)
+{
+	ir_type *const t_char = new_type_primitive(mode_Bs);
+	ir_type *const type   = new_type_method(2, 1, false, cc_cdecl_set,
+	                                        mtp_no_property);
+	set_method_param_type(type, 0, new_type_pointer(t_char));
+	set_method_param_type(type, 1, new_type_pointer(t_int));
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str("bytes"), type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_mode *const offset_mode = get_reference_offset_mode(mode_P);
+	ir_node *const dst         = new_Proj(get_irg_args(irg), mode_P, 0);
+	ir_node *const src         = new_Proj(get_irg_args(irg), mode_P, 1);
+	ir_node       *values[N_VALUES];
+	for (unsigned i = 0; i < N_VALUES; ++i) {
+		ir_node *const offset = new_Const_long(offset_mode, 4 * i);
+		ir_node *const load   = new_Load(get_store(), new_Add(src, offset),
+		                                 mode_Is, t_int, cons_none);
+		set_store(new_Proj(load, mode_M, pn_Load_M));
+		values[i] = new_Proj(load, mode_Is, pn_Load_res);
+	}
+	ir_node *sum = new_Const_long(mode_Is, 0);
+	for (unsigned i = 0; i < N_VALUES; ++i) {
+		ir_node *const value  = new_Add(values[i], values[(i + 1) % N_VALUES]);
+		ir_node *const offset = new_Const_long(offset_mode, i);
+		ir_node *const store  = new_Store(get_store(), new_Add(dst, offset),
+		                                  new_Conv(value, mode_Bs), t_char,
+		                                  cons_none);
+		set_store(new_Proj(store, mode_M, pn_Store_M));
+		sum = new_Add(sum, values[i]);
+	}
+
+	ir_node *const in[]   = { sum };
+	ir_node *const ret    = new_Return(get_store(), 1, in);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+/** Tests whether @p req only allows registers with a low byte. */
+static bool is_byte_req(arch_register_req_t const *const req)
+{
+	if (req->limited == NULL)
+		return false;
+	arch_register_class_t const *const cls = req->cls;
+	for (unsigned i = 0; i < cls->n_regs; ++i) {
+		if (rbitset_is_set(req->limited, i)
+		    && !arch_register_has_subreg(&cls->regs[i], arch_subreg_8))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Checks that the registers of inputs with a byte requirement have a low
+ * byte and counts these inputs.
+ */
+static void check_byte_inputs(ir_node *const node, void *const env)
+{
+	if (is_Block(node) || is_Proj(node))
+		return;
+	arch_register_req_t const **const reqs = arch_get_irn_register_reqs_in(node);
+	if (reqs == NULL)
+		return;
+	foreach_irn_in(node, i, op) {
+		arch_register_req_t const *const req = reqs[i];
+		if (!is_byte_req(req))
+			continue;
+		arch_register_t const *const reg = arch_get_irn_register(op);
+		assert(rbitset_is_set(req->limited, reg->index));
+		assert(arch_register_has_subreg(reg, arch_subreg_8));
+		(void)reg;
+		++*(unsigned*)env;
+	}
+}
+
+int main(void)
+{
+	ir_init();
+	be_parse_arg("isa=ia32");
+	t_int = new_type_primitive(mode_Is);
+
+	ir_graph *const irg = create_function();
+	lower_highlevel();
+	FILE *const null = fopen("/dev/null", "w");
+	be_main(null, "ia32byteregs");
+	fclose(null);
+
+	/* every byte store got a register with a low byte */
+	unsigned n_byte_inputs = 0;
+	irg_walk_graph(irg, check_byte_inputs, NULL, &n_byte_inputs);
+	assert(n_byte_inputs >= N_VALUES);
+	(void)n_byte_inputs;
+
+	ir_finish();
+	return 0;
+}
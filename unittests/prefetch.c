@@ -0,0 +1,95 @@
+#include <assert.h>
+#include <stdbool.h>
+#include "firm.h"
+
+/**
+ * Creates a function summing arr[64 * i] for i < n, where every element is
+ * loaded twice, before and after a call.
+ */
+static ir_graph *create_loop(void)
+{
+	ir_type *const t_int = new_type_primitive(mode_Is);
+	ir_type *const type  = new_type_method(1, 1, false, cc_cdecl_set,
+	                                       mtp_no_property);
+	set_method_param_type(type, 0, t_int);
+	set_method_res_type(type, 0, t_int);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str("sum"), type);
+	ir_type   *const t_arr  = new_type_array(t_int, 64 * 1000);
+	ir_entity *const arr    = new_entity(get_glob_type(),
+	                                     new_id_from_str("arr"), t_arr);
+	ir_type   *const t_ext  = new_type_method(0, 0, false, cc_cdecl_set,
+	                                        mtp_no_property);
+	ir_entity *const ext    = new_entity(get_glob_type(),
+	                                     new_id_from_str("ext"), t_ext);
+	ir_graph  *const irg    = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+
+	ir_node *const n = new_Proj(get_irg_args(irg), mode_Is, 0);
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const head = new_immBlock();
+	add_immBlock_pred(head, new_Jmp());
+	set_cur_block(head);
+	ir_node *const cmp  = new_Cmp(get_value(1, mode_Is), n, ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const index  = new_Mul(get_value(1, mode_Is),
+	                                new_Const_long(mode_Is, 64 * 4));
+	ir_node *const offset = new_Conv(index, get_reference_offset_mode(mode_P));
+	ir_node *const ptr    = new_Add(new_Address(arr), offset);
+	for (unsigned i = 0; i < 2; ++i) {
+		if (i > 0) {
+			ir_node *const call = new_Call(get_store(), new_Address(ext), 0,
+			                               NULL, t_ext);
+			set_store(new_Proj(call, mode_M, pn_Call_M));
+		}
+		ir_node *const load = new_Load(get_store(), ptr, mode_Is, t_int,
+		                               cons_none);
+		set_store(new_Proj(load, mode_M, pn_Load_M));
+		set_value(0, new_Add(get_value(0, mode_Is),
+		                     new_Proj(load, mode_Is, pn_Load_res)));
+	}
+	set_value(1, new_Add(get_value(1, mode_Is), new_Const_long(mode_Is, 1)));
+	add_immBlock_pred(head, new_Jmp());
+	mature_immBlock(head);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *const res[]  = { get_value(0, mode_Is) };
+	ir_node *const ret    = new_Return(get_store(), 1, res);
+	ir_node *const end_bl = get_irg_end_block(irg);
+	add_immBlock_pred(end_bl, ret);
+	mature_immBlock(end_bl);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static void count_prefetch(ir_node *node, void *env)
+{
+	if (is_Builtin(node) && get_Builtin_kind(node) == ir_bk_prefetch)
+		++*(unsigned*)env;
+}
+
+int main(void)
+{
+	ir_init();
+
+	/* both Loads of the same address share one prefetch */
+	ir_graph *const irg = create_loop();
+	opt_prefetch(irg, 4, 64, 4096);
+	assert(irg_verify(irg));
+	unsigned n_prefetches = 0;
+	irg_walk_graph(irg, count_prefetch, NULL, &n_prefetches);
+	assert(n_prefetches == 1);
+	(void)n_prefetches;
+
+	ir_finish();
+	return 0;
+}